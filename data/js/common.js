@@ -4,6 +4,7 @@
  * ========================================================================
  * Zawiera uniwersalne funkcje wykorzystywane na wszystkich stronach:
  * - Komunikacja EventSource z serwerem
+ * - Binarna telemetria stanu przez WebSocket
  * - System komunikatów użytkownika
  * - Zarządzanie statusem karty SD
  * - Funkcje pomocnicze debugowania
@@ -51,6 +52,120 @@ function handleEventSource(onMachineStatus) {
   };
 }
 
+// ================= TELEMETRIA BINARNA (WEBSOCKET) =================
+
+// Pola ramki w kolejności bitów maski (zgodnie z TelemetryField w TelemetryEncoder.h)
+const TELEMETRY_FIELDS = [
+  ["state", "u8"],
+  ["flags", "u8"],
+  ["feedOverride", "u8"],
+  ["errorID", "u8"],
+  ["hotWirePower", "u8"],
+  ["fanPower", "u8"],
+  ["currentX", "f32"],
+  ["currentY", "f32"],
+  ["currentLine", "u32"],
+  ["totalLines", "u32"],
+  ["jobProgress", "f32"],
+  ["jobRunTime", "u32"],
+  ["currentProject", "str"],
+  ["activeProfile", "u8"],
+];
+
+// Bity pola flags rozwijane do nazw używanych w statusie EventSource
+const TELEMETRY_FLAGS = ["isPaused", "estopOn", "limitXOn", "limitYOn", "hotWireOn", "fanOn", "relativeMode"];
+
+const TELEMETRY_FRAME_DELTA = 0x01;
+const TELEMETRY_FRAME_KEY = 0x02;
+
+/**
+ * Dekodowanie ramki telemetrii i nałożenie zmienionych pól na bieżący stan
+ * @param {DataView} view - Ramka binarna
+ * @param {Object} state - Stan uzupełniany polami z ramki
+ */
+function applyTelemetryFrame(view, state) {
+  const mask = view.getUint16(3, true);
+  let offset = 5;
+
+  TELEMETRY_FIELDS.forEach(([name, type], bit) => {
+    if (!(mask & (1 << bit))) return;
+
+    switch (type) {
+      case "u8":
+        state[name] = view.getUint8(offset);
+        offset += 1;
+        break;
+      case "u32":
+        state[name] = view.getUint32(offset, true);
+        offset += 4;
+        break;
+      case "f32":
+        state[name] = view.getFloat32(offset, true);
+        offset += 4;
+        break;
+      case "str": {
+        const length = view.getUint8(offset);
+        const bytes = new Uint8Array(view.buffer, view.byteOffset + offset + 1, length);
+        state[name] = new TextDecoder().decode(bytes);
+        offset += 1 + length;
+        break;
+      }
+    }
+  });
+
+  TELEMETRY_FLAGS.forEach((name, bit) => {
+    state[name] = (state.flags & (1 << bit)) !== 0;
+  });
+}
+
+/**
+ * Strumień statusu maszyny przez WebSocket /ws/status (ramki różnicowe, do 50 Hz)
+ * Ramki różnicowe są stosowane dopiero po ramce kluczowej i przy ciągłej numeracji;
+ * gdy WebSocket jest niedostępny, status odbierany jest przez EventSource
+ * @param {Function} onMachineStatus - Funkcja wykonywana przy odbiorze statusu
+ */
+function handleTelemetrySocket(onMachineStatus) {
+  const protocol = window.location.protocol === "https:" ? "wss:" : "ws:";
+  const socket = new WebSocket(`${protocol}//${window.location.host}/ws/status`);
+  socket.binaryType = "arraybuffer";
+
+  const state = {};
+  let synchronized = false;
+  let expectedFrame = 0;
+  let received = false;
+
+  socket.onmessage = (event) => {
+    if (!(event.data instanceof ArrayBuffer) || event.data.byteLength < 5) return;
+
+    const view = new DataView(event.data);
+    const type = view.getUint8(0);
+    const frame = view.getUint16(1, true);
+
+    if (type === TELEMETRY_FRAME_KEY) {
+      synchronized = true;
+    } else if (type !== TELEMETRY_FRAME_DELTA || frame !== expectedFrame) {
+      // Utracona ramka - oczekiwanie na kolejną ramkę kluczową
+      synchronized = false;
+    }
+    expectedFrame = (frame + 1) & 0xffff;
+
+    if (!synchronized) return;
+
+    received = true;
+    applyTelemetryFrame(view, state);
+    onMachineStatus({ ...state });
+  };
+
+  socket.onclose = () => {
+    if (!received) {
+      // Serwer bez telemetrii WebSocket - status przez EventSource
+      handleEventSource(onMachineStatus);
+      return;
+    }
+    setTimeout(() => handleTelemetrySocket(onMachineStatus), 2000);
+  };
+}
+
 // ================= SYSTEM KOMUNIKATÓW UŻYTKOWNIKA =================
 
 /**
@@ -7,6 +7,8 @@
  * - Konfiguracja prędkości pracy i szybkich ruchów
  * - Ustawienia bezpieczeństwa (E-STOP, krańcówki)
  * - Kontrola mocy drutu grzejnego i wentylatora
+ * - Import i eksport konfiguracji (plik JSON na karcie SD)
+ * - Zegar SPI karty SD i test wydajności karty
  * - Walidacja wprowadzanych danych
  */
 
@@ -105,6 +107,7 @@ function loadConfiguration() {
       const limitSwitchType = document.getElementById("limitSwitchType");
       const hotWirePower = document.getElementById("hotWirePower");
       const fanPower = document.getElementById("fanPower");
+      const sdSpiFrequency = document.getElementById("sdSpiFrequency");
       
       if (useGCodeFeedRate) useGCodeFeedRate.checked = config.useGCodeFeedRate || false;
       if (delayAfterStartup) delayAfterStartup.value = config.delayAfterStartup || 0;
@@ -113,6 +116,7 @@ function loadConfiguration() {
       if (limitSwitchType) limitSwitchType.value = config.limitSwitchType || 0;
       if (hotWirePower) hotWirePower.value = config.hotWirePower || 0;
       if (fanPower) fanPower.value = config.fanPower || 0;
+      if (sdSpiFrequency) sdSpiFrequency.value = (config.sdSpiFrequency || 0) / 1e6;
 
       showMessage("Configuration loaded successfully");
       document.getElementById("saveBtn").disabled = false;
@@ -172,6 +176,7 @@ function saveConfiguration(event) {
     limitSwitchType: parseInt(formData.get("limitSwitchType")) || 0,
     hotWirePower: parseFloat(formData.get("hotWirePower")) || 0,
     fanPower: parseFloat(formData.get("fanPower")) || 0,
+    sdSpiFrequency: Math.round((parseFloat(formData.get("sdSpiFrequency")) || 0) * 1e6),
   };
 
   console.log("Saving config:", config);
@@ -181,16 +186,15 @@ function saveConfiguration(event) {
     headers: { "Content-Type": "application/json" },
     body: JSON.stringify(config),
   })
-    .then((response) => {
-      if (!response.ok)
-        throw new Error(`HTTP error! Status: ${response.status}`);
-      return response.json();
-    })
+    .then((response) => response.json())
     .then((data) => {
+      showValidationErrors(data.errors);
       if (data.success) showMessage("Configuration saved successfully");
       else
         showMessage(
-          "Failed to save configuration: " + (data.message || "Unknown error"),
+          "Failed to save configuration: " +
+            (data.message || "Unknown error") +
+            describeValidationErrors(data.errors),
           "error"
         );
     })
@@ -205,6 +209,158 @@ function saveConfiguration(event) {
     });
 }
 
+// ================= BŁĘDY WALIDACJI =================
+
+/**
+ * Oznaczenie pól odrzuconych przez walidację konfiguracji w firmware
+ * (nazwy pól jak atrybuty name formularza, np. "xAxis.rapidFeedRate")
+ */
+
+function showValidationErrors(errors) {
+  document
+    .querySelectorAll("#configForm .is-invalid")
+    .forEach((input) => {
+      input.classList.remove("is-invalid");
+      input.removeAttribute("title");
+    });
+  if (!Array.isArray(errors)) return;
+
+  errors.forEach((error) => {
+    const input = document.querySelector(`#configForm [name="${error.field}"]`);
+    if (!input) return;
+    input.classList.add("is-invalid");
+    input.title = `${error.message} (limit: ${formatLimit(error)})`;
+  });
+}
+
+function formatLimit(error) {
+  const limit = Number(error.limit);
+  const text = Number.isInteger(limit) ? String(limit) : limit.toFixed(3);
+  return error.unit ? `${text} ${error.unit}` : text;
+}
+
+function describeValidationErrors(errors) {
+  if (!Array.isArray(errors) || errors.length === 0) return "";
+  return (
+    " - " +
+    errors
+      .map((error) => `${error.field}: ${error.message} (limit: ${formatLimit(error)})`)
+      .join("; ")
+  );
+}
+
+// ================= IMPORT I EKSPORT =================
+
+/**
+ * Import konfiguracji z pliku na karcie SD (import) lub zapis aktywnej konfiguracji do pliku (export)
+ * @param {string} direction - "import" lub "export"
+ */
+function transferConfiguration(direction) {
+  const button = document.getElementById(`${direction}Btn`);
+  button.disabled = true;
+
+  fetch(`/api/config-${direction}`, { method: "POST" })
+    .then((response) => response.json())
+    .then((data) => {
+      if (!data.success)
+        throw new Error(
+          (data.message || "Unknown error") + describeValidationErrors(data.errors)
+        );
+      showMessage(data.message);
+      // Po imporcie formularz pokazuje nową konfigurację
+      if (direction === "import") loadConfiguration();
+    })
+    .catch((error) => {
+      console.error(`Error during configuration ${direction}:`, error);
+      showMessage(`Configuration ${direction} failed: ${error.message}`, "error");
+    })
+    .finally(() => {
+      button.disabled = false;
+    });
+}
+
+// ================= TEST KARTY SD =================
+
+/**
+ * Uruchomienie testu karty SD z próbą zegarów SPI i odpytywanie o wynik
+ */
+
+function runSdBenchmark() {
+  const button = document.getElementById("sdBenchmarkBtn");
+  const spinner = document.getElementById("sdBenchmarkSpinner");
+  const output = document.getElementById("sdBenchmarkResult");
+  const apply = document.getElementById("sdBenchmarkApply").checked;
+
+  button.disabled = true;
+  spinner.style.display = "inline-block";
+  output.textContent = "Running...";
+
+  const finish = () => {
+    button.disabled = false;
+    spinner.style.display = "none";
+  };
+
+  const poll = () => {
+    fetch("/api/sd-benchmark")
+      .then((response) => response.json())
+      .then((data) => {
+        if (data.running) {
+          setTimeout(poll, 1000);
+          return;
+        }
+        output.textContent = formatSdBenchmark(data);
+        if (data.saved) {
+          document.getElementById("sdSpiFrequency").value = data.currentSpiFrequency / 1e6;
+          showMessage("SD SPI clock saved");
+        }
+        finish();
+      })
+      .catch((error) => {
+        output.textContent = `Benchmark failed: ${error.message}`;
+        finish();
+      });
+  };
+
+  fetch(`/api/sd-benchmark?sweep=1${apply ? "&apply=1" : ""}`, { method: "POST" })
+    .then((response) => response.json())
+    .then((data) => {
+      if (!data.success) throw new Error(data.message || "Unknown error");
+      setTimeout(poll, 1000);
+    })
+    .catch((error) => {
+      output.textContent = `Benchmark failed: ${error.message}`;
+      finish();
+    });
+}
+
+/**
+ * Podsumowanie wyniku testu karty SD
+ * @param {Object} data - Wynik GET /api/sd-benchmark
+ * @returns {string} Tekst podsumowania
+ */
+
+function formatSdBenchmark(data) {
+  if (!data.success) return `Benchmark failed: ${data.status || data.message}`;
+
+  const mhz = (hz) => (hz / 1e6).toFixed(1);
+  const lines = [
+    `Clock ${mhz(data.spiFrequency)} MHz: read ${data.readMBps.toFixed(2)} MB/s, write ${data.writeMBps.toFixed(2)} MB/s`,
+    `Random ${data.randomRead.bytes} B read: p50 ${data.randomRead.p50Us} us, p95 ${data.randomRead.p95Us} us, p99 ${data.randomRead.p99Us} us, max ${data.randomRead.maxUs} us`,
+    `Open/close ${data.openCloseUs} us, directory scan ${data.scanUs} us (${data.scanEntries} entries)`,
+  ];
+  (data.frequencies || []).forEach((result) => {
+    lines.push(result.stable
+      ? `${mhz(result.frequency)} MHz: read ${result.readMBps.toFixed(2)} MB/s, write ${result.writeMBps.toFixed(2)} MB/s`
+      : `${mhz(result.frequency)} MHz: unstable`);
+  });
+  if (data.frequencies) {
+    lines.push(data.fastestStableFrequency
+      ? `Fastest stable clock: ${mhz(data.fastestStableFrequency)} MHz${data.applied ? " (applied)" : ""}`
+      : "No stable clock found");
+  }
+  return lines.join("\n");
+}
+
 // ================= WALIDACJA DANYCH =================
 
 /**
@@ -260,6 +416,18 @@ document.addEventListener("DOMContentLoaded", function () {
     .getElementById("configForm")
     .addEventListener("submit", saveConfiguration);
 
+  document
+    .getElementById("importBtn")
+    .addEventListener("click", () => transferConfiguration("import"));
+
+  document
+    .getElementById("exportBtn")
+    .addEventListener("click", () => transferConfiguration("export"));
+
+  document
+    .getElementById("sdBenchmarkBtn")
+    .addEventListener("click", runSdBenchmark);
+
   // Walidacja w czasie rzeczywistym dla pól numerycznych
   document
     .querySelectorAll('#configForm input[type="number"]')
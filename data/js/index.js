@@ -4,9 +4,9 @@
 ===============================================================================
 Plik obsługuje główną stronę kontrolera CNC (index.html):
 - Wyświetlanie statusu maszyny i postępu zadań
-- Wizualizacja ścieżki ruchu na canvasie
+- Wizualizacja wykonanej ścieżki na canvasie (ślad z /api/trace)
 - Sterowanie podstawowymi operacjami (start/pause/stop)
-- Aktualizacja interfejsu w czasie rzeczywistym przez EventSource
+- Aktualizacja interfejsu w czasie rzeczywistym przez telemetrię WebSocket (EventSource jako rezerwa)
 
 Autor: ESP32 CNC Controller Project
 ===============================================================================
@@ -15,9 +15,15 @@ Autor: ESP32 CNC Controller Project
 // ===============================================================================
 // ZMIENNE GLOBALNE - Śledzenie ścieżki ruchu maszyny
 // ===============================================================================
-let pathPoints = [];     // Tablica punktów ścieżki ruchu maszyny
+let pathPoints = [];     // Tablica punktów ścieżki ruchu maszyny (null = przerwa w śladzie)
 let lastX = null, lastY = null;  // Ostatnie współrzędne do optymalizacji rysowania
 
+// Ślad wykonanej ścieżki z /api/trace - gdy niedostępny, ścieżka rysowana z próbek statusu
+const TRACE_POLL_INTERVAL_MS = 200;
+const TRACE_RETRY_INTERVAL_MS = 2000;
+let traceNext = 0;           // Numer sekwencji następnego punktu śladu
+let traceAvailable = false;  // true = ścieżka rysowana wyłącznie ze śladu
+
 // ===============================================================================
 // AKTUALIZACJA INTERFEJSU - Funkcje zarządzania widokiem statusu
 // ===============================================================================
@@ -114,6 +120,16 @@ function updateUIWithMachineState(data) {
     progressBarElement.setAttribute("aria-valuenow", progress);
   }
 
+  // Profil materiału aktywny w zadaniu - w trakcie pracy może go zmienić M700 w pliku
+  const profileSelect = document.getElementById("profileSelect");
+  if (profileSelect) {
+    const running = data.state === 1;
+    if (running && data.activeProfile !== undefined) profileSelect.value = String(data.activeProfile);
+    profileSelect.disabled = running;
+  }
+  const parallelCheck = document.getElementById("parallelCheck");
+  if (parallelCheck) parallelCheck.disabled = data.state === 1;
+
   // Aktualizacja dostępności przycisków sterowania
   updateButtonStates(data.state, data.isPaused);
 }
@@ -167,15 +183,57 @@ function updateButtonStates(machineState, isPaused) {
  * @param {number} y - Współrzędna Y
  */
 function updatePathCanvas(x, y) {
-  if (x == null || y == null) return;
-  if (lastX !== x || lastY !== y) {
-    pathPoints.push({ x, y });
-    lastX = x;
-    lastY = y;
+  if (appendPathPoint(x, y)) {
     drawPath();
   }
 }
 
+/**
+ * Dopisanie punktu ścieżki bez rysowania
+ * @returns {boolean} true = punkt dodany (pozycja zmieniona)
+ */
+function appendPathPoint(x, y) {
+  if (x == null || y == null) return false;
+  if (lastX === x && lastY === y) return false;
+  pathPoints.push({ x, y });
+  lastX = x;
+  lastY = y;
+  return true;
+}
+
+/**
+ * Przyrostowe pobieranie śladu wykonanej ścieżki od ostatniego numeru sekwencji
+ * Kolejna porcja pobierana od razu, gdy w buforze kontrolera czekają następne punkty
+ */
+async function pollTrace() {
+  let delay = TRACE_POLL_INTERVAL_MS;
+  try {
+    const response = await fetch(`/api/trace?since=${traceNext}`);
+    if (!response.ok) throw new Error(`HTTP ${response.status}`);
+    const data = await response.json();
+
+    // Utracone punkty (nadpisane przed odczytem) - przerwa zamiast fałszywego odcinka
+    let changed = false;
+    if (data.lost && pathPoints.length > 0) {
+      pathPoints.push(null);
+      lastX = null;
+      lastY = null;
+    }
+    for (const [, x, y] of data.points) {
+      changed = appendPathPoint(x, y) || changed;
+    }
+    if (changed) drawPath();
+
+    traceNext = data.next;
+    traceAvailable = true;
+    if (data.more) delay = 0;
+  } catch (error) {
+    traceAvailable = false;
+    delay = TRACE_RETRY_INTERVAL_MS;
+  }
+  setTimeout(pollTrace, delay);
+}
+
 /**
  * Renderowanie ścieżki ruchu na canvasie z siatką współrzędnych
  */
@@ -221,9 +279,18 @@ function drawPath() {
     ctx.strokeStyle = "#007bff";
     ctx.lineWidth = 2;
     ctx.beginPath();
-    ctx.moveTo(pathPoints[0].x, canvas.height - pathPoints[0].y);
-    for (let i = 1; i < pathPoints.length; i++) {
-      ctx.lineTo(pathPoints[i].x, canvas.height - pathPoints[i].y);
+    let penDown = false;
+    for (const point of pathPoints) {
+      if (point === null) {
+        penDown = false;
+        continue;
+      }
+      if (penDown) {
+        ctx.lineTo(point.x, canvas.height - point.y);
+      } else {
+        ctx.moveTo(point.x, canvas.height - point.y);
+        penDown = true;
+      }
     }
     ctx.stroke();
     ctx.lineWidth = 1;
@@ -235,10 +302,35 @@ function drawPath() {
 // ===============================================================================
 
 /**
- * Rozpoczęcie wykonywania wybranego projektu
+ * Wczytanie listy profili materiałów do wyboru przed startem zadania
+ */
+function loadProfiles() {
+  const profileSelect = document.getElementById("profileSelect");
+  if (!profileSelect) return;
+
+  fetch("/api/profiles")
+    .then((response) => response.json())
+    .then((data) => {
+      if (!data.success || !Array.isArray(data.profiles)) return;
+      data.profiles.forEach((profile) => {
+        const option = document.createElement("option");
+        option.value = String(profile.slot);
+        option.textContent = `${profile.slot}: ${profile.name}`;
+        profileSelect.appendChild(option);
+      });
+    })
+    .catch((error) => {
+      console.error("Profile list error:", error);
+    });
+}
+
+/**
+ * Rozpoczęcie wykonywania wybranego projektu z wybranym profilem materiału
  */
 function startProcessing() {
-  fetch("/api/start", { method: "POST" })
+  const profile = document.getElementById("profileSelect")?.value ?? "0";
+  const parallel = document.getElementById("parallelCheck")?.checked ? "1" : "0";
+  fetch(`/api/start?profile=${encodeURIComponent(profile)}&parallel=${parallel}`, { method: "POST" })
     .then((response) => response.json())
     .then((data) => {
       showMessage(data.success ? "Processing started" : "Failed to start processing: " + data.message, data.success ? "success" : "error");
@@ -304,12 +396,19 @@ function showMessage(msg, type = "success") {
 // ===============================================================================
 
 document.addEventListener("DOMContentLoaded", () => {
-  // Inicjalizacja połączenia EventSource z funkcją callback dla aktualizacji UI
-  handleEventSource((data) => {
+  // Status maszyny z telemetrii WebSocket (EventSource gdy WebSocket niedostępny)
+  handleTelemetrySocket((data) => {
     updateUIWithMachineState(data);
-    updatePathCanvas(data.currentX, data.currentY);
+    if (!traceAvailable) {
+      updatePathCanvas(data.currentX, data.currentY);
+    }
   });
 
+  // Ślad wykonanej ścieżki bez przerw między próbkami statusu
+  pollTrace();
+
+  loadProfiles();
+
   document.getElementById("resetPathBtn")?.addEventListener("click", () => {
     pathPoints = [];
     lastX = null;
@@ -3,7 +3,7 @@
  * KONTROLER STEROWANIA RUCHEM JOG - ESP32-CNC-CONTROLLER
  * ========================================================================
  * Zarządzanie ruchem manualnym maszyny CNC z funkcjami:
- * - Ruch JOG w osiach X/Y z kontrolą prędkości
+ * - Ruch JOG w osiach X/Y z kontrolą prędkości (krokowy lub ciągły przez WebSocket)
  * - Bazowanie i zerowanie pozycji
  * - Sterowanie drutem grzejnym i wentylatorem
  * - Obsługa klawiatury i interfejsu dotykowego
@@ -25,6 +25,14 @@ let machineState = {
 // Połączenie EventSource do odbioru aktualizacji stanu
 let eventSource;
 
+// Połączenie WebSocket ruchu ciągłego JOG
+let jogSocket;
+
+// Okres wysyłania prędkości JOG - sygnał podtrzymania (sterownik hamuje po 150 ms ciszy)
+const JOG_HEARTBEAT_INTERVAL_MS = 50;
+let jogHeartbeatTimer = null;
+let jogDirection = { x: 0, y: 0 };
+
 // ================= KOMUNIKACJA Z SERWEREM =================
 
 /**
@@ -57,6 +65,27 @@ function initEventSource() {
   };
 }
 
+/**
+ * Nawiązanie połączenia WebSocket dla ruchu ciągłego JOG
+ */
+function initJogSocket() {
+  jogSocket = new WebSocket(`ws://${window.location.host}/ws/jog`);
+
+  jogSocket.onopen = function () {
+    console.log("Połączenie WebSocket JOG nawiązane");
+  };
+
+  jogSocket.onclose = function () {
+    // Przerwanie ruchu po stronie klienta i ponowne połączenie
+    stopContinuousJog();
+    setTimeout(initJogSocket, 2000);
+  };
+
+  jogSocket.onerror = function (e) {
+    console.error("Błąd WebSocket JOG:", e);
+  };
+}
+
 // ================= AKTUALIZACJA INTERFEJSU =================
 
 /**
@@ -120,6 +149,7 @@ function updateButtonStates(machineState) {
   const fanSwitch = document.getElementById("fanSwitch");
   const jogDistance = document.getElementById("jogDistance");
   const speedModeButtons = document.querySelectorAll('input[name="jogSpeedMode"]');
+  const jogModeButtons = document.querySelectorAll('input[name="jogMode"]');
 
   // Sprawdzenie czy dozwolony jest ruch JOG (IDLE lub aktywny JOG)
   const canJog = machineState === 0 || machineState === 2;
@@ -138,6 +168,14 @@ function updateButtonStates(machineState) {
   speedModeButtons.forEach((radio) => {
     radio.disabled = !canJog;
   });
+  jogModeButtons.forEach((radio) => {
+    radio.disabled = !canJog;
+  });
+
+  // Przerwanie ruchu ciągłego, gdy maszyna opuściła tryb ręczny
+  if (!canJog) {
+    stopContinuousJog();
+  }
 
   // Przełączniki urządzeń - blokowane tylko przy błędzie krytycznym
   wireSwitch.disabled = machineState === 5;
@@ -256,6 +294,63 @@ function jog(xDir, yDir) {
     });
 }
 
+/**
+ * Sprawdzenie czy wybrano tryb ruchu ciągłego
+ * @returns {boolean} true = ruch ciągły (przytrzymanie przycisku)
+ */
+function isContinuousJogMode() {
+  const jogModeRadio = document.querySelector('input[name="jogMode"]:checked');
+  return jogModeRadio !== null && jogModeRadio.value === "continuous";
+}
+
+/**
+ * Wysłanie bieżącej prędkości ruchu ciągłego (jednocześnie sygnał podtrzymania)
+ */
+function sendJogVelocity() {
+  if (!jogSocket || jogSocket.readyState !== WebSocket.OPEN) {
+    return;
+  }
+
+  const speedModeRadio = document.querySelector('input[name="jogSpeedMode"]:checked');
+
+  jogSocket.send(
+    JSON.stringify({
+      x: jogDirection.x,
+      y: jogDirection.y,
+      speedMode: speedModeRadio ? speedModeRadio.value : "work",
+    })
+  );
+}
+
+/**
+ * Rozpoczęcie ruchu ciągłego - prędkość wysyłana cyklicznie do zwolnienia przycisku
+ * @param {number} xDir - Kierunek X (-1, 0, 1)
+ * @param {number} yDir - Kierunek Y (-1, 0, 1)
+ */
+function startContinuousJog(xDir, yDir) {
+  jogDirection = { x: xDir, y: yDir };
+  sendJogVelocity();
+
+  if (!jogHeartbeatTimer) {
+    jogHeartbeatTimer = setInterval(sendJogVelocity, JOG_HEARTBEAT_INTERVAL_MS);
+  }
+}
+
+/**
+ * Zakończenie ruchu ciągłego - sterownik wyhamowuje osie z zadaną akceleracją
+ */
+function stopContinuousJog() {
+  if (!jogHeartbeatTimer) {
+    return;
+  }
+
+  clearInterval(jogHeartbeatTimer);
+  jogHeartbeatTimer = null;
+
+  jogDirection = { x: 0, y: 0 };
+  sendJogVelocity();
+}
+
 /**
  * Wyzerowanie aktualnej pozycji roboczej (bez ruchu fizycznego)
  */
@@ -434,19 +529,19 @@ function handleKeyboardControl(event) {
   switch (event.key) {
     case "ArrowUp":
       event.preventDefault();
-      jog(0, 1);
+      jogByKeyboard(event, 0, 1);
       break;
     case "ArrowDown":
       event.preventDefault();
-      jog(0, -1);
+      jogByKeyboard(event, 0, -1);
       break;
     case "ArrowLeft":
       event.preventDefault();
-      jog(-1, 0);
+      jogByKeyboard(event, -1, 0);
       break;
     case "ArrowRight":
       event.preventDefault();
-      jog(1, 0);
+      jogByKeyboard(event, 1, 0);
       break;
     case "Home":
       event.preventDefault();
@@ -473,6 +568,34 @@ function handleKeyboardControl(event) {
   }
 }
 
+/**
+ * Ruch z klawiatury - w trybie ciągłym trwa do zwolnienia klawisza
+ * @param {KeyboardEvent} event - Zdarzenie klawiatury
+ * @param {number} xDir - Kierunek X (-1, 0, 1)
+ * @param {number} yDir - Kierunek Y (-1, 0, 1)
+ */
+function jogByKeyboard(event, xDir, yDir) {
+  if (!isContinuousJogMode()) {
+    jog(xDir, yDir);
+    return;
+  }
+
+  // Autopowtarzanie klawisza nie restartuje ruchu - podtrzymanie wysyła timer
+  if (!event.repeat) {
+    startContinuousJog(xDir, yDir);
+  }
+}
+
+/**
+ * Zwolnienie strzałki kończy ruch ciągły
+ * @param {KeyboardEvent} event - Zdarzenie klawiatury
+ */
+function handleKeyboardRelease(event) {
+  if (["ArrowUp", "ArrowDown", "ArrowLeft", "ArrowRight"].includes(event.key)) {
+    stopContinuousJog();
+  }
+}
+
 // ================= INICJALIZACJA =================
 
 /**
@@ -481,15 +604,30 @@ function handleKeyboardControl(event) {
 document.addEventListener("DOMContentLoaded", function () {
   // Nawiązanie połączenia z serwerem dla aktualizacji czasu rzeczywistego
   initEventSource();
+  initJogSocket();
 
   // Konfiguracja przycisków kierunkowych JOG
   document.querySelectorAll(".jog-button").forEach((button) => {
     if (button.classList.contains("jog-center")) return;
 
+    const xDir = parseInt(button.getAttribute("data-x") || "0");
+    const yDir = parseInt(button.getAttribute("data-y") || "0");
+
+    // Tryb krokowy - pojedynczy ruch o zadaną odległość
     button.addEventListener("click", function () {
-      const xDir = parseInt(this.getAttribute("data-x") || "0");
-      const yDir = parseInt(this.getAttribute("data-y") || "0");
-      jog(xDir, yDir);
+      if (!isContinuousJogMode()) {
+        jog(xDir, yDir);
+      }
+    });
+
+    // Tryb ciągły - ruch trwa dopóki przycisk jest przytrzymany
+    button.addEventListener("pointerdown", function () {
+      if (isContinuousJogMode() && !button.disabled) {
+        startContinuousJog(xDir, yDir);
+      }
+    });
+    ["pointerup", "pointerleave", "pointercancel"].forEach((eventName) => {
+      button.addEventListener(eventName, stopContinuousJog);
     });
   });
 
@@ -503,4 +641,8 @@ document.addEventListener("DOMContentLoaded", function () {
 
   // Aktywacja sterowania klawiaturą
   document.addEventListener("keydown", handleKeyboardControl);
+  document.addEventListener("keyup", handleKeyboardRelease);
+
+  // Utrata fokusu okna (np. przełączenie karty) kończy ruch ciągły
+  window.addEventListener("blur", stopContinuousJog);
 });
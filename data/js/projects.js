@@ -20,6 +20,13 @@ let selectedFilename = null;        // Aktualnie wybrany plik do wykonania
 let eventSource;                    // Połączenie EventSource z serwerem
 let gcodePreviewAbortController = null;  // Kontrola anulowania podglądu G-code
 
+const FILE_LIST_PAGE_SIZE = 20;          // Wpisy listy projektów na jedno zapytanie (CONFIG::PROJECT_LIST_MAX_PAGE_SIZE)
+
+// Podgląd ścieżki generowany przez kontroler (/api/preview)
+const PREVIEW_TOLERANCE_PX = 0.5;       // Dopuszczalne odchylenie uproszczonej ścieżki [px]
+const PREVIEW_COORDINATE_SCALE = 100;   // Jednostek współrzędnych na mm (CONFIG::PREVIEW_COORDINATE_SCALE)
+const PREVIEW_RECORD = { CUT: 0x01, RAPID: 0x02, END: 0xFF };
+
 // ===============================================================================
 // ZARZĄDZANIE WYBOREM PLIKU - Funkcje obsługi aktywnego projektu
 // ===============================================================================
@@ -56,9 +63,25 @@ function handleEventSource() {
 // LISTA PLIKÓW - Funkcje zarządzania wyświetlaniem plików z karty SD
 // ===============================================================================
 
+/**
+ * Opis metadanych pliku projektu (rozmiar, liczba linii, wymiary ścieżki)
+ * @param {Object} info - Wpis listy projektów z /api/list-files
+ * @returns {string} Tekst opisu
+ */
+function describeProjectFile(info) {
+  const size = info.size >= 1024 * 1024 ? `${(info.size / (1024 * 1024)).toFixed(1)} MB`
+    : info.size >= 1024 ? `${(info.size / 1024).toFixed(1)} kB` : `${info.size} B`;
+  const parts = [size, `${info.lines} linii`];
+  if (info.moves > 0 && Array.isArray(info.bounds)) {
+    const [minX, minY, maxX, maxY] = info.bounds;
+    parts.push(`${(maxX - minX).toFixed(1)} × ${(maxY - minY).toFixed(1)} mm`);
+  }
+  return parts.join(" · ");
+}
+
 /**
  * Aktualizacja wyświetlanej listy plików w tabeli
- * @param {Array} files - Tablica nazw plików do wyświetlenia
+ * @param {Array} files - Tablica wpisów projektów ({ name, size, modified, lines, moves, bounds })
  */
 
 function updateFileList(files) {
@@ -71,9 +94,9 @@ function updateFileList(files) {
     return;
   }
   noFilesMessage.style.display = "none";
-  // Uporządkowanie plików alfabetycznie
-  files.sort();
-  for (const file of files) {
+  // Kolejność alfabetyczna ustalana przez serwer
+  for (const info of files) {
+    const file = info.name;
     const row = document.createElement("tr");
 
     // Kolumna wyboru pliku z elementem radio
@@ -82,7 +105,9 @@ function updateFileList(files) {
       <div class="form-check">
         <input class="form-check-input" type="radio" name="selectedFile" id="file-${file}" value="${file}" 
           ${selectedFilename === file ? "checked" : ""}>
-        <label class="form-check-label" for="file-${file}">${file}</label>
+        <label class="form-check-label" for="file-${file}">${file}
+          <small class="text-muted d-block">${describeProjectFile(info)}</small>
+        </label>
       </div>
     `;
 
@@ -107,50 +132,59 @@ function updateFileList(files) {
   }
 }
 
+/**
+ * Pobranie całej listy projektów stronami - tabela aktualizowana po każdej stronie
+ * @returns {Promise<Array>} Wpisy projektów posortowane wg nazwy
+ */
+async function fetchProjectPages() {
+  const files = [];
+  let total = Infinity;
+  while (files.length < total) {
+    const response = await fetch(`/api/list-files?offset=${files.length}&limit=${FILE_LIST_PAGE_SIZE}&sort=name`);
+    if (!response.ok) throw new Error("Failed to get file list");
+    const data = await response.json();
+    if (!data || !data.success || !Array.isArray(data.files)) {
+      throw new Error(data && data.message ? data.message : "Received invalid data format from server");
+    }
+    total = data.total;
+    if (data.files.length === 0) break;
+    files.push(...data.files);
+    updateFileList(files);
+  }
+  if (files.length === 0) updateFileList(files);
+  return files;
+}
+
 /**
  * Pobieranie aktualnej listy plików z serwera
  */
 function fetchFileList() {
-  fetch("/api/list-files")
-    .then((response) => response.json())
-    .then((data) => {
-      if (data && data.success && Array.isArray(data.files)) {
-        updateFileList(data.files);
-        const storedFile = localStorage.getItem("selectedFile");
-        // Przywrócenie poprzednio wybranego pliku jeśli nadal istnieje
-        if (storedFile && data.files.includes(storedFile)) {
-          setSelectedFile(storedFile);
-        }
-      } else {
-        updateFileList([]);
-        showMessage(data && data.message ? data.message : "Received invalid data format from server", "error");
+  fetchProjectPages()
+    .then((files) => {
+      const storedFile = localStorage.getItem("selectedFile");
+      // Przywrócenie poprzednio wybranego pliku jeśli nadal istnieje
+      if (storedFile && files.some((info) => info.name === storedFile)) {
+        setSelectedFile(storedFile);
       }
     })
-    .catch(() => {
-      showMessage("Error fetching file list. Please check SD card connection.", "error");
+    .catch((error) => {
+      updateFileList([]);
+      showMessage(`Error fetching file list: ${error.message}. Please check SD card connection.`, "error");
     });
 }
 
 /**
  * Odświeżenie listy plików z wymuszeniem ponownego skanowania karty SD
+ * Serwer analizuje wyłącznie pliki nowe lub zmienione od ostatniego skanowania
  */
 function refreshFileList() {
   fetch("/api/refresh-files", { method: "POST" })
     .then((response) => {
       if (!response.ok) throw new Error("Failed to refresh files on ESP32");
-      return fetch("/api/list-files");
+      return fetchProjectPages();
     })
-    .then((response) => {
-      if (!response.ok) throw new Error("Failed to get file list");
-      return response.json();
-    })
-    .then((data) => {
-      if (data && data.success && Array.isArray(data.files)) {
-        updateFileList(data.files);
-        showMessage("File list refreshed successfully");
-      } else {
-        showMessage("Received invalid data format from server", "warning");
-      }
+    .then(() => {
+      showMessage("File list refreshed successfully");
     })
     .catch((error) => {
       showMessage(`Failed to refresh file list: ${error.message}`, "error");
@@ -239,18 +273,31 @@ async function previewFile(filename) {
   modal.show();
 
   try {
-    const response = await fetch("/api/sd_content?file=" + encodeURIComponent(filename), { signal });
-    if (!response.ok) {
-      throw new Error("Nie udało się pobrać pliku: " + response.statusText);
+    // Uproszczony podgląd generowany przez kontroler; pełny plik tylko gdy podgląd niedostępny
+    let preview = null;
+    try {
+      preview = await fetchToolpathPreview(filename, canvas, signal);
+    } catch (previewError) {
+      if (previewError.name === 'AbortError') throw previewError;
+      console.warn("Podgląd z kontrolera niedostępny, analiza pełnego pliku:", previewError.message);
     }
-    const gcode = await response.text();
 
-    if (signal.aborted) {
-      console.log("Preview fetch aborted.");
-      return;
-    }
+    if (preview) {
+      renderToolpathPreview(preview, canvas);
+    } else {
+      const response = await fetch("/api/sd_content?file=" + encodeURIComponent(filename), { signal });
+      if (!response.ok) {
+        throw new Error("Nie udało się pobrać pliku: " + response.statusText);
+      }
+      const gcode = await response.text();
 
-    await processGCodeChunked(gcode, "gcodePreviewCanvas", signal);
+      if (signal.aborted) {
+        console.log("Preview fetch aborted.");
+        return;
+      }
+
+      await processGCodeChunked(gcode, "gcodePreviewCanvas", signal);
+    }
     
     if (!signal.aborted) {
         if (loadingIndicator) loadingIndicator.style.display = "none";
@@ -285,6 +332,150 @@ async function previewFile(filename) {
   }
 }
 
+/**
+ * Pobranie uproszczonego podglądu ścieżki z kontrolera (/api/preview)
+ * Tolerancja uproszczenia wyrażona w pikselach obszaru rysowania canvasa
+ * @param {string} filename - Nazwa pliku projektu
+ * @param {HTMLCanvasElement} canvas - Canvas docelowy (wyznacza rozdzielczość podglądu)
+ * @param {AbortSignal} signal - Sygnał anulowania operacji
+ * @returns {Promise<Object>} Łamane ruchów, zakres współrzędnych i statystyki
+ */
+async function fetchToolpathPreview(filename, canvas, signal) {
+  const params = new URLSearchParams({
+    file: filename,
+    tolerance: PREVIEW_TOLERANCE_PX,
+    width: Math.max(canvas.width - 40, 1),
+    height: Math.max(canvas.height - 40, 1),
+  });
+  const response = await fetch("/api/preview?" + params.toString(), { signal });
+  if (!response.ok) {
+    throw new Error("Podgląd niedostępny: " + response.status);
+  }
+  return parseToolpathPreview(await response.arrayBuffer());
+}
+
+/**
+ * Dekodowanie binarnego podglądu ścieżki (format opisany w ToolpathPreview.h)
+ * @param {ArrayBuffer} buffer - Dane odpowiedzi /api/preview
+ * @returns {Object} { paths: [{ rapid, points: [[x, y], ...] }], bounds, moves, points }
+ */
+function parseToolpathPreview(buffer) {
+  const view = new DataView(buffer);
+  if (view.byteLength < 3 || view.getUint8(0) !== 0x54 || view.getUint8(1) !== 0x50 || view.getUint8(2) !== 1) {
+    throw new Error("Nieprawidłowy format podglądu");
+  }
+
+  const scale = 1 / PREVIEW_COORDINATE_SCALE;
+  const paths = [];
+  let offset = 3;
+
+  while (offset < view.byteLength) {
+    const type = view.getUint8(offset);
+    offset += 1;
+
+    if (type === PREVIEW_RECORD.END) {
+      const bounds = {
+        minX: view.getFloat32(offset, true),
+        minY: view.getFloat32(offset + 4, true),
+        maxX: view.getFloat32(offset + 8, true),
+        maxY: view.getFloat32(offset + 12, true),
+      };
+      return {
+        paths,
+        bounds,
+        moves: view.getUint32(offset + 16, true),
+        points: view.getUint32(offset + 20, true),
+      };
+    }
+
+    if (type !== PREVIEW_RECORD.CUT && type !== PREVIEW_RECORD.RAPID) {
+      throw new Error("Nieznany rekord podglądu: " + type);
+    }
+
+    // Punkt początkowy w int32, kolejne jako przyrosty int16 (jednostka 1/PREVIEW_COORDINATE_SCALE mm)
+    const count = view.getUint16(offset, true);
+    let x = view.getInt32(offset + 2, true);
+    let y = view.getInt32(offset + 6, true);
+    offset += 10;
+
+    const points = [[x * scale, y * scale]];
+    for (let i = 1; i < count; i++) {
+      x += view.getInt16(offset, true);
+      y += view.getInt16(offset + 2, true);
+      offset += 4;
+      points.push([x * scale, y * scale]);
+    }
+    paths.push({ rapid: type === PREVIEW_RECORD.RAPID, points });
+  }
+
+  throw new Error("Niekompletne dane podglądu");
+}
+
+/**
+ * Rysowanie uproszczonego podglądu ścieżki - ruchy tnące liniami ciągłymi, szybkie przerywanymi
+ * @param {Object} preview - Wynik parseToolpathPreview()
+ * @param {HTMLCanvasElement} canvas - Canvas docelowy
+ */
+function renderToolpathPreview(preview, canvas) {
+  const ctx = canvas.getContext("2d");
+  ctx.clearRect(0, 0, canvas.width, canvas.height);
+
+  if (preview.moves === 0) {
+    ctx.font = "16px Arial"; ctx.fillStyle = "#333"; ctx.textAlign = "center";
+    ctx.fillText("Brak prawidłowych ruchów G-code w pliku", canvas.width / 2, canvas.height / 2);
+    return;
+  }
+
+  // === Obliczenie skali i przesunięcia dla dopasowania do canvasa ===
+  const { minX, minY, maxX, maxY } = preview.bounds;
+  const canvasWidth = canvas.width - 40; const canvasHeight = canvas.height - 40;
+  const contentWidth = maxX - minX || 1; const contentHeight = maxY - minY || 1;
+  const scale = Math.min(canvasWidth / contentWidth, canvasHeight / contentHeight);
+  const offsetX = (canvas.width - contentWidth * scale) / 2;
+  const offsetY = (canvas.height - contentHeight * scale) / 2;
+  const toScreen = (point) => [(point[0] - minX) * scale + offsetX, canvas.height - ((point[1] - minY) * scale + offsetY)];
+
+  drawGrid(ctx, canvas.width, canvas.height, 20, "#E0E0E0");
+  drawAxes(ctx, canvas.width, canvas.height);
+
+  // Jedna ścieżka canvasa na typ ruchu - dwa wywołania stroke() niezależnie od liczby łamanych
+  ctx.lineWidth = 2;
+  for (const rapid of [true, false]) {
+    ctx.beginPath();
+    ctx.strokeStyle = rapid ? "#FF5722" : "#1E88E5";
+    ctx.setLineDash(rapid ? [4, 4] : []);
+    for (const path of preview.paths) {
+      if (path.rapid !== rapid) continue;
+      path.points.forEach((point, index) => {
+        const [x, y] = toScreen(point);
+        if (index === 0) ctx.moveTo(x, y); else ctx.lineTo(x, y);
+      });
+    }
+    ctx.stroke();
+  }
+  ctx.setLineDash([]);
+
+  // Dodanie wskaźnika punktu startowego
+  if (preview.paths.length > 0) {
+    const [startX, startY] = toScreen(preview.paths[0].points[0]);
+    ctx.beginPath(); ctx.fillStyle = "#4CAF50"; ctx.arc(startX, startY, 5, 0, 2 * Math.PI); ctx.fill();
+    ctx.font = "12px Arial"; ctx.fillStyle = "#000"; ctx.textAlign = "left"; ctx.fillText("Start", startX + 10, startY);
+  }
+
+  // Zakres współrzędnych i stopień uproszczenia
+  const infoText = `X: ${minX.toFixed(2)} do ${maxX.toFixed(2)}, Y: ${minY.toFixed(2)} do ${maxY.toFixed(2)}` +
+    ` | ruchy: ${preview.moves}, punkty podglądu: ${preview.points}`;
+  ctx.font = "12px Arial"; ctx.fillStyle = "#000"; ctx.textAlign = "left"; ctx.fillText(infoText, 10, 20);
+
+  // Dodanie legendy kolorów
+  const legendY = canvas.height - 20;
+  ctx.beginPath(); ctx.strokeStyle = "#1E88E5"; ctx.lineWidth = 2; ctx.moveTo(10, legendY); ctx.lineTo(40, legendY); ctx.stroke();
+  ctx.font = "12px Arial"; ctx.fillStyle = "#000"; ctx.textAlign = "left"; ctx.fillText("Ruch tnący (G1)", 45, legendY + 4);
+  ctx.beginPath(); ctx.strokeStyle = "#FF5722"; ctx.setLineDash([4, 4]); ctx.moveTo(150, legendY); ctx.lineTo(180, legendY); ctx.stroke();
+  ctx.setLineDash([]);
+  ctx.fillText("Szybki ruch (G0)", 185, legendY + 4);
+}
+
 /**
  * Funkcja zastępcza dla kompatybilności - zalecane używanie previewFile()
  * @param {string} filename - Nazwa pliku do wizualizacji
@@ -532,7 +723,7 @@ function deleteFile(filename) {
     .then((data) => {
       if (data.success) {
         showMessage(`File "${filename}" deleted successfully`);
-        refreshFileList();
+        fetchFileList();
         if (selectedFilename === filename) {
           setSelectedFile(null);
           // Anulowanie generowania podglądu jeśli usuwany plik był podglądany
@@ -588,15 +779,16 @@ function uploadFile() {
   fetch("/api/upload-file", { method: "POST", body: formData })
     .then((response) => {
       if (!response.ok) return response.text().then((text) => { throw new Error(text); });
-      return response.text();
+      return response.json();
     })
-    .then(() => {
+    .then((result) => {
       progressBar.style.width = "100%";
       progressBar.textContent = "100%";
-      uploadMessage.textContent = "Plik przesłany pomyślnie!";
+      const throughput = typeof result.throughputMBps === "number" ? ` (${result.throughputMBps.toFixed(2)} MB/s)` : "";
+      uploadMessage.textContent = "Plik przesłany pomyślnie!" + throughput;
       uploadMessage.className = "alert alert-success";
       uploadMessage.style.display = "block";
-      refreshFileList();
+      fetchFileList();
       fileInput.value = "";
       setTimeout(() => {
         const modal = bootstrap.Modal.getInstance(document.getElementById("uploadModal"));
@@ -0,0 +1,128 @@
+// ================================================================================
+//                    BACKEND SYSTEMU PLIKÓW ARDUINO (SD, LITTLEFS)
+// ================================================================================
+// Adapter fs::FS / fs::File na interfejs Storage
+
+#ifdef ARDUINO
+
+#include "ArduinoFSStorage.h"
+
+#include <new>
+#include <utility>
+
+namespace {
+    class ArduinoFSFile : public StorageFile {
+        private:
+        File file;
+
+        public:
+        explicit ArduinoFSFile(File&& opened) : file { std::move(opened) } {}
+
+        ~ArduinoFSFile() override {
+            close();
+        }
+
+        size_t read(uint8_t* buffer, size_t length) override {
+            const int count { file.read(buffer, length) };
+            return count > 0 ? static_cast<size_t>(count) : 0;
+        }
+
+        size_t write(const uint8_t* buffer, size_t length) override {
+            return file.write(buffer, length);
+        }
+
+        bool seek(size_t position) override {
+            return file.seek(static_cast<uint32_t>(position), SeekSet);
+        }
+
+        size_t position() const override {
+            return file.position();
+        }
+
+        size_t size() const override {
+            return file.size();
+        }
+
+        uint32_t getLastWrite() override {
+            return static_cast<uint32_t>(file.getLastWrite());
+        }
+
+        void close() override {
+            if (file) {
+                file.close();
+            }
+        }
+
+        bool isOpen() const override {
+            return static_cast<bool>(file);
+        }
+    };
+}
+
+ArduinoFSStorage::ArduinoFSStorage(fs::FS& fileSystem) : fileSystem { fileSystem } {}
+
+std::unique_ptr<StorageFile> ArduinoFSStorage::open(const char* path, StorageMode mode) {
+    const char* fileMode { FILE_READ };
+    if (mode == StorageMode::WRITE) {
+        fileMode = FILE_WRITE;
+    }
+    else if (mode == StorageMode::APPEND) {
+        fileMode = FILE_APPEND;
+    }
+
+    File file { fileSystem.open(path, fileMode) };
+    if (!file) {
+        return nullptr;
+    }
+    if (file.isDirectory()) {
+        file.close();
+        return nullptr;
+    }
+    return std::unique_ptr<StorageFile>(new (std::nothrow) ArduinoFSFile(std::move(file)));
+}
+
+bool ArduinoFSStorage::exists(const char* path) {
+    return fileSystem.exists(path);
+}
+
+bool ArduinoFSStorage::remove(const char* path) {
+    return fileSystem.remove(path);
+}
+
+bool ArduinoFSStorage::rename(const char* from, const char* to) {
+    // FAT (f_rename) nie nadpisuje istniejącego pliku docelowego
+    if (fileSystem.exists(to)) {
+        fileSystem.remove(to);
+    }
+    return fileSystem.rename(from, to);
+}
+
+bool ArduinoFSStorage::mkdir(const char* path) {
+    return fileSystem.mkdir(path);
+}
+
+bool ArduinoFSStorage::list(const char* path, const ListCallback& callback) {
+    File directory { fileSystem.open(path) };
+    if (!directory || !directory.isDirectory()) {
+        return false;
+    }
+
+    File entry { directory.openNextFile() };
+    while (entry) {
+        StorageEntry info {};
+        info.name = entry.name();
+        info.directory = entry.isDirectory();
+        info.size = static_cast<uint32_t>(entry.size());
+        info.modified = static_cast<uint32_t>(entry.getLastWrite());
+        const bool proceed { callback(info) };
+        entry.close();
+        if (!proceed) {
+            break;
+        }
+        entry = directory.openNextFile();
+    }
+    directory.close();
+    return true;
+}
+
+#endif
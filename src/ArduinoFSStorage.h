@@ -0,0 +1,27 @@
+#pragma once
+
+#ifdef ARDUINO
+
+#include <Arduino.h>
+#include <FS.h>
+
+#include "Storage.h"
+
+// Backend Storage dla systemów plików rdzenia Arduino-ESP32 (fs::FS): karta SD (SD)
+// i pamięć flash (LittleFS). Synchronizacja dostępu pozostaje po stronie wywołującego.
+class ArduinoFSStorage : public Storage {
+    private:
+    fs::FS& fileSystem;
+
+    public:
+    explicit ArduinoFSStorage(fs::FS& fileSystem);
+
+    std::unique_ptr<StorageFile> open(const char* path, StorageMode mode) override;
+    bool exists(const char* path) override;
+    bool remove(const char* path) override;
+    bool rename(const char* from, const char* to) override;
+    bool mkdir(const char* path) override;
+    bool list(const char* path, const ListCallback& callback) override;
+};
+
+#endif
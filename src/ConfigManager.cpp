@@ -1,14 +1,115 @@
 // ================================================================================
 //                            MENADŻER KONFIGURACJI CNC
 // ================================================================================
-// Zarządzanie parametrami maszyny CNC z persystencją na karcie SD
-// Obsługuje ładowanie/zapisywanie konfiguracji w formacie JSON
-// Thread-safe dzięki mutexom FreeRTOS
+// Zarządzanie parametrami maszyny CNC z persystencją w NVS (ConfigStore)
+// Plik JSON na karcie SD służy do importu i eksportu konfiguracji
+// Odczyt bez blokad przez niezmienne wersje konfiguracji (RCU), zapisujący serializowani mutexem FreeRTOS
 
 #include "ConfigManager.h"
-#include <SD.h>
+#include <string.h>
+#include "Storage.h"
 #include <ArduinoJson.h>
 #include "CONFIGURATION.H"
+#include "JsonWriter.h"
+#include "ConfigRegistry.h"
+#include "ConfigStore.h"
+#include "ConfigValidator.h"
+#include "MaterialProfiles.h"
+
+namespace {
+    // Pola odrzucone przy wczytywaniu JSON jako błędy zakresu z wartościami z dokumentu
+    void reportRejected(ConfigValidationReport* report, JsonObjectConst root, const ConfigParamDescriptor* const* rejected, size_t rejectedCount) {
+        if (report == nullptr) {
+            return;
+        }
+        const size_t stored { rejectedCount < CONFIG::CONFIG_VALIDATION_MAX_ERRORS ? rejectedCount : CONFIG::CONFIG_VALIDATION_MAX_ERRORS };
+        for (size_t index { 0 }; index < stored; ++index) {
+            ConfigValidator::addRangeError(*report, *rejected[index], ConfigRegistry::jsonValue(root, *rejected[index]).as<double>());
+        }
+        report->total += rejectedCount - stored;
+    }
+}
+
+// ================================================================================
+//                          WERSJE KONFIGURACJI (RCU)
+// ================================================================================
+
+ConfigSnapshotRef::~ConfigSnapshotRef() {
+    release();
+}
+
+ConfigSnapshotRef::ConfigSnapshotRef(ConfigSnapshotRef&& other) : snapshot(other.snapshot) {
+    other.snapshot = nullptr;
+}
+
+ConfigSnapshotRef& ConfigSnapshotRef::operator=(ConfigSnapshotRef&& other) {
+    if (this != &other) {
+        release();
+        snapshot = other.snapshot;
+        other.snapshot = nullptr;
+    }
+    return *this;
+}
+
+void ConfigSnapshotRef::release() {
+    if (snapshot != nullptr) {
+        snapshot->references.fetch_sub(1, std::memory_order_release);
+        snapshot = nullptr;
+    }
+}
+
+ConfigSnapshotRef ConfigSnapshotPool::acquire() {
+    while (true) {
+        ConfigSnapshot* snapshot { current.load(std::memory_order_acquire) };
+        if (snapshot == nullptr) {
+            return ConfigSnapshotRef {};
+        }
+
+        // Odwołanie ważne, gdy wersja nie jest w trakcie zapisu i nadal jest bieżąca -
+        // wersja bieżąca ma własne odwołanie, więc nie zostanie ponownie użyta przed release()
+        const uint32_t previous { snapshot->references.fetch_add(1, std::memory_order_acq_rel) };
+        if ((previous & WRITER) == 0 && current.load(std::memory_order_acquire) == snapshot) {
+            return ConfigSnapshotRef { snapshot };
+        }
+
+        // Wersja zastąpiona między odczytem wskaźnika a pobraniem odwołania - ponowna próba
+        snapshot->references.fetch_sub(1, std::memory_order_release);
+    }
+}
+
+uint32_t ConfigSnapshotPool::version() const {
+    return currentVersion.load(std::memory_order_acquire);
+}
+
+bool ConfigSnapshotPool::publish(const MachineConfig& config) {
+    // Zajęcie miejsca bez odwołań - czytelnik, który zdąży pobrać odwołanie, wycofa je po bicie WRITER
+    ConfigSnapshot* slot { nullptr };
+    for (ConfigSnapshot& candidate : slots) {
+        uint32_t expected { 0 };
+        if (candidate.references.compare_exchange_strong(expected, WRITER, std::memory_order_acquire)) {
+            slot = &candidate;
+            break;
+        }
+    }
+    if (slot == nullptr) {
+        return false;
+    }
+
+    slot->config = config;
+    slot->version = currentVersion.load(std::memory_order_relaxed) + 1;
+
+    // Zdjęcie bitu WRITER i odwołanie należące do wersji bieżącej w jednej operacji
+    slot->references.fetch_sub(WRITER - 1, std::memory_order_release);
+
+    ConfigSnapshot* previous { current.exchange(slot, std::memory_order_acq_rel) };
+    currentVersion.store(slot->version, std::memory_order_release);
+
+    // Poprzednia wersja zwalniana po oddaniu odwołań przez ostatniego czytelnika
+    if (previous != nullptr) {
+        previous->references.fetch_sub(1, std::memory_order_release);
+    }
+    return true;
+}
 
 // ================================================================================
 //                           KONSTRUKTOR I DESTRUKTOR
@@ -17,6 +118,7 @@
 ConfigManager::ConfigManager(SDCardManager* sdManager) : sdManager(sdManager) {
     // Mutex zapewnia bezpieczny dostęp do konfiguracji z wielu wątków
     configMutex = xSemaphoreCreateMutex();
+    profilesMutex = xSemaphoreCreateMutex();
 }
 
 ConfigManager::~ConfigManager() {
@@ -25,6 +127,10 @@ ConfigManager::~ConfigManager() {
         vSemaphoreDelete(configMutex);
         configMutex = nullptr;
     }
+    if (profilesMutex != nullptr) {
+        vSemaphoreDelete(profilesMutex);
+        profilesMutex = nullptr;
+    }
 }
 
 // ================================================================================
@@ -32,29 +138,68 @@ ConfigManager::~ConfigManager() {
 // ================================================================================
 
 ConfigManagerStatus ConfigManager::init() {
-    // Sprawdzenie dostępności karty SD
-    if (!sdManager || !sdManager->isCardInitialized()) {
-        this->configInitialized = false;
-        return ConfigManagerStatus::SD_ACCESS_ERROR;
+    // Profile materiałów z NVS - brak zapisu oznacza pustą tablicę
+    MaterialProfileTable storedProfiles {};
+    if (ConfigStore::loadProfiles(storedProfiles) != ConfigStoreStatus::OK) {
+        #ifdef DEBUG_CONFIG_MANAGER
+        Serial.println("DEBUG CONFIG: Brak profili materiałów w NVS");
+        #endif
+    }
+    if (xSemaphoreTake(profilesMutex, portMAX_DELAY) == pdTRUE) {
+        storedProfiles.version = profiles.version + 1;
+        profiles = storedProfiles;
+        profileTableVersion.store(profiles.version);
+        xSemaphoreGive(profilesMutex);
     }
 
-    constexpr int MAX_NUM_OF_TRIES { 5 };
-    ConfigManagerStatus status {};
+    // Aktywna konfiguracja z NVS - bez karty SD i parsowania JSON
+    MachineConfig stored {};
+    #ifdef DEBUG_CONFIG_MANAGER
+    const uint32_t loadStart { static_cast<uint32_t>(micros()) };
+    #endif
+    const ConfigStoreStatus storeStatus { ConfigStore::load(stored) };
+    if (storeStatus == ConfigStoreStatus::OK && xSemaphoreTake(configMutex, portMAX_DELAY) == pdTRUE) {
+        // Zapis niespełniający reguł (np. po zaostrzeniu walidacji) pozostaje aktywny do poprawienia
+        // przez użytkownika - start zadania blokuje kontrola w initializeGCodeProcessing
+        validate(stored, nullptr);
+        const ConfigManagerStatus status { publish(stored) };
+        xSemaphoreGive(configMutex);
+        if (status != ConfigManagerStatus::OK) {
+            return status;
+        }
 
-    // Próba wczytania konfiguracji z pliku - maksymalnie 5 prób
-    for (int i { 0 }; i < MAX_NUM_OF_TRIES; ++i) {
-        status = readConfigFromSD();
-        if (status == ConfigManagerStatus::OK) {
-            #ifdef DEBUG_CONFIG_MANAGER
-            Serial.println("DEBUG CONFIG: Konfiguracja wczytana z pliku");
-            #endif
-            this->configInitialized = true;
-            return ConfigManagerStatus::OK;
+        #ifdef DEBUG_CONFIG_MANAGER
+        Serial.printf("DEBUG CONFIG: Konfiguracja wczytana z NVS (%lu us)\n",
+            static_cast<unsigned long>(static_cast<uint32_t>(micros()) - loadStart));
+        #endif
+        this->configInitialized = true;
+        return ConfigManagerStatus::OK;
+    }
+
+    #ifdef DEBUG_CONFIG_MANAGER
+    Serial.printf("DEBUG CONFIG: Brak konfiguracji w NVS (%s)\n", ConfigStore::statusName(storeStatus));
+    #endif
+
+    // Pierwsze uruchomienie lub uszkodzony zapis - import pliku JSON z karty SD
+    if (sdManager != nullptr && sdManager->isCardInitialized()) {
+        constexpr int MAX_NUM_OF_TRIES { 5 };
+        for (int i { 0 }; i < MAX_NUM_OF_TRIES; ++i) {
+            const ConfigManagerStatus importStatus { readConfigFromSD() };
+            if (importStatus == ConfigManagerStatus::OK) {
+                #ifdef DEBUG_CONFIG_MANAGER
+                Serial.println("DEBUG CONFIG: Konfiguracja zaimportowana z pliku");
+                #endif
+                this->configInitialized = true;
+                return saveConfig();
+            }
+            if (importStatus == ConfigManagerStatus::VALIDATION_FAILED) {
+                break;  // Plik odrzucony przez walidację - ponowny odczyt nic nie zmieni
+            }
         }
     }
 
-    // Fallback - użycie domyślnej konfiguracji jeśli plik niedostępny
-    status = loadDefaultConfig();
+    // Fallback - domyślna konfiguracja (bez zapisu - plik z karty może zostać zaimportowany później)
+    const ConfigManagerStatus status { loadDefaultConfig() };
     if (status == ConfigManagerStatus::OK) {
         #ifdef DEBUG_CONFIG_MANAGER
         Serial.println("DEBUG CONFIG: Wczytano domyślną konfigurację");
@@ -70,13 +215,33 @@ ConfigManagerStatus ConfigManager::init() {
     return status;
 }
 
+// ================================================================================
+//                              ZAPIS W NVS
+// ================================================================================
+
+ConfigManagerStatus ConfigManager::saveConfig() {
+    const ConfigSnapshotRef current { snapshots.acquire() };
+    if (!current) {
+        return ConfigManagerStatus::MANAGER_NOT_INITIALIZED;
+    }
+
+    const ConfigStoreStatus status { ConfigStore::save(*current) };
+    if (status != ConfigStoreStatus::OK) {
+        #ifdef DEBUG_CONFIG_MANAGER
+        Serial.printf("ERROR CONFIG: Zapis NVS nieudany: %s\n", ConfigStore::statusName(status));
+        #endif
+        return ConfigManagerStatus::NVS_WRITE_FAILED;
+    }
+    return ConfigManagerStatus::OK;
+}
+
 // ================================================================================
 //                            OPERACJE NA PLIKACH SD
 // ================================================================================
 
-ConfigManagerStatus ConfigManager::readConfigFromSD() {
+ConfigManagerStatus ConfigManager::readConfigFromSD(ConfigValidationReport* report) {
     // Blokada dostępu do karty SD (thread-safe)
-    if (!sdManager->takeSD()) {
+    if (!sdManager || !sdManager->takeSD()) {
         return ConfigManagerStatus::SD_ACCESS_ERROR;
     }
 
@@ -84,28 +249,28 @@ ConfigManagerStatus ConfigManager::readConfigFromSD() {
     std::string configFilePath { CONFIG::CONFIG_DIR };
     configFilePath += CONFIG::CONFIG_FILE;
 
-    if (!SD.exists(configFilePath.c_str())) {
-        sdManager->giveSD();
-        return ConfigManagerStatus::FILE_OPEN_FAILED;
-    }
-
-    File configFile { SD.open(configFilePath.c_str(), FILE_READ) };
+    std::unique_ptr<StorageFile> configFile { sdManager->getStorage().open(configFilePath.c_str(), StorageMode::READ) };
     if (!configFile) {
         sdManager->giveSD();
         return ConfigManagerStatus::FILE_OPEN_FAILED;
     }
 
-    // Wczytanie całego pliku do pamięci
+    // Wczytanie całego pliku do pamięci blokami
     String jsonString = "";
-    while (configFile.available()) {
-        jsonString += (char)configFile.read();
+    jsonString.reserve(configFile->size());
+    char block[CONFIG::SD_SECTOR_SIZE + 1];
+    size_t count { configFile->read(reinterpret_cast<uint8_t*>(block), CONFIG::SD_SECTOR_SIZE) };
+    while (count > 0) {
+        block[count] = '\0';
+        jsonString += block;
+        count = configFile->read(reinterpret_cast<uint8_t*>(block), CONFIG::SD_SECTOR_SIZE);
     }
 
-    configFile.close();
+    configFile->close();
     sdManager->giveSD();
 
     // Parsowanie JSON i aktualizacja struktury konfiguracji
-    return configFromJson(jsonString);
+    return configFromJson(jsonString, report);
 }
 
 ConfigManagerStatus ConfigManager::writeConfigToSD() {
@@ -129,7 +294,18 @@ ConfigManagerStatus ConfigManager::writeConfigToSD() {
     std::string configFilePath { CONFIG::CONFIG_DIR };
     configFilePath += CONFIG::CONFIG_FILE;
 
-    File configFile { SD.open(configFilePath.c_str(), FILE_WRITE) };
+    // Konwersja konfiguracji do formatu JSON przed otwarciem pliku - błąd nie nadpisuje zapisanej konfiguracji
+    char jsonBuffer[CONFIG::CONFIG_JSON_BUFFER_SIZE];
+    const size_t jsonLength { configToJson(jsonBuffer, sizeof(jsonBuffer)) };
+    if (jsonLength == 0) {
+        sdManager->giveSD();
+        #ifdef DEBUG_CONFIG_MANAGER
+        Serial.println("ERROR: Config JSON does not fit in buffer");
+        #endif
+        return ConfigManagerStatus::JSON_SERIALIZE_ERROR;
+    }
+
+    std::unique_ptr<StorageFile> configFile { sdManager->getStorage().open(configFilePath.c_str(), StorageMode::WRITE) };
     if (!configFile) {
         sdManager->giveSD();
         #ifdef DEBUG_CONFIG_MANAGER
@@ -138,12 +314,9 @@ ConfigManagerStatus ConfigManager::writeConfigToSD() {
         return ConfigManagerStatus::FILE_OPEN_FAILED;
     }
 
-    // Konwersja konfiguracji do formatu JSON
-    String jsonString { configToJson() };
-
     // Zapis JSON do pliku z walidacją
-    if (configFile.print(jsonString) == 0) {
-        configFile.close();
+    if (configFile->write(reinterpret_cast<const uint8_t*>(jsonBuffer), jsonLength) != jsonLength) {
+        configFile->close();
         sdManager->giveSD();
         #ifdef DEBUG_CONFIG_MANAGER
         Serial.println("ERROR: Failed to write to config file");
@@ -151,7 +324,7 @@ ConfigManagerStatus ConfigManager::writeConfigToSD() {
         return ConfigManagerStatus::FILE_WRITE_FAILED;
     }
 
-    configFile.close();
+    configFile->close();
     sdManager->giveSD();
     return ConfigManagerStatus::OK;
 }
@@ -161,35 +334,14 @@ ConfigManagerStatus ConfigManager::writeConfigToSD() {
 // ================================================================================
 
 ConfigManagerStatus ConfigManager::loadDefaultConfig() {
-    // Thread-safe dostęp do struktury konfiguracji
-    if (xSemaphoreTake(configMutex, portMAX_DELAY) == pdTRUE) {
-        // Inicjalizacja parametrów osi X z wartości domyślnych
-        config.X.stepsPerMM = DEFAULTS::X_STEPS_PER_MM;
-        config.X.rapidFeedRate = DEFAULTS::X_RAPID_FEEDRATE;
-        config.X.rapidAcceleration = DEFAULTS::X_RAPID_ACCELERATION;
-        config.X.workFeedRate = DEFAULTS::X_WORK_FEEDRATE;
-        config.X.workAcceleration = DEFAULTS::X_WORK_ACCELERATION;
-        config.X.offset = DEFAULTS::X_OFFSET;
-
-        // Inicjalizacja parametrów osi Y z wartości domyślnych
-        config.Y.stepsPerMM = DEFAULTS::Y_STEPS_PER_MM;
-        config.Y.rapidFeedRate = DEFAULTS::Y_RAPID_FEEDRATE;
-        config.Y.rapidAcceleration = DEFAULTS::Y_RAPID_ACCELERATION;
-        config.Y.workFeedRate = DEFAULTS::Y_WORK_FEEDRATE;
-        config.Y.workAcceleration = DEFAULTS::Y_WORK_ACCELERATION;
-        config.Y.offset = DEFAULTS::Y_OFFSET;
-
-        // Inicjalizacja parametrów systemowych
-        config.useGCodeFeedRate = DEFAULTS::USE_GCODE_FEEDRATE;
-        config.delayAfterStartup = DEFAULTS::DELAY_AFTER_STARTUP;
-        config.deactivateESTOP = DEFAULTS::DEACTIVATE_ESTOP;
-        config.deactivateLimitSwitches = DEFAULTS::DEACTIVATE_LIMIT_SWITCHES;
-        config.limitSwitchType = DEFAULTS::LIMIT_SWITCH_TYPE;
-        config.hotWirePower = DEFAULTS::WIRE_POWER;
-        config.fanPower = DEFAULTS::FAN_POWER;
+    // Wartości domyślne z rejestru parametrów (DEFAULTS w CONFIGURATION.h)
+    MachineConfig defaults {};
+    ConfigRegistry::loadDefaults(defaults);
 
+    if (xSemaphoreTake(configMutex, portMAX_DELAY) == pdTRUE) {
+        const ConfigManagerStatus status { publish(defaults) };
         xSemaphoreGive(configMutex);
-        return ConfigManagerStatus::OK;
+        return status;
     }
     return ConfigManagerStatus::UNKNOWN_ERROR;
 }
@@ -203,30 +355,39 @@ ConfigManagerStatus ConfigManager::getConfig(MachineConfig& targetConfig) {
         return ConfigManagerStatus::MANAGER_NOT_INITIALIZED;
     }
 
-    MachineConfig configcpy {};
-
-    // Thread-safe kopiowanie konfiguracji do struktury docelowej
-    if (xSemaphoreTake(configMutex, portMAX_DELAY) == pdTRUE) {
-        targetConfig = config;
-        xSemaphoreGive(configMutex);
-
-        #ifdef DEBUG_CONFIG_MANAGER
-        Serial.println("DEBUG CONFIG: Configuration copied to target struct");
-        #endif
-        return ConfigManagerStatus::OK;
+    // Kopia z bieżącej wersji - bez blokady zapisujących
+    const ConfigSnapshotRef current { snapshots.acquire() };
+    if (!current) {
+        return ConfigManagerStatus::MANAGER_NOT_INITIALIZED;
     }
+    targetConfig = *current;
+    return ConfigManagerStatus::OK;
+}
 
-    return ConfigManagerStatus::UNKNOWN_ERROR;
+ConfigSnapshotRef ConfigManager::snapshot() {
+    return snapshots.acquire();
 }
 
-ConfigManagerStatus ConfigManager::updateConfig(const MachineConfig& newConfig) {
-    // Atomowa aktualizacja całej konfiguracji
+uint32_t ConfigManager::configVersion() const {
+    return snapshots.version();
+}
+
+ConfigManagerStatus ConfigManager::updateConfig(const MachineConfig& newConfig, ConfigValidationReport* report) {
+    ConfigManagerStatus status { validate(newConfig, report) };
+    if (status != ConfigManagerStatus::OK) {
+        return status;
+    }
+
+    // Publikacja nowej wersji całej konfiguracji
     if (xSemaphoreTake(configMutex, portMAX_DELAY) == pdTRUE) {
-        config = newConfig;
+        status = publish(newConfig);
         xSemaphoreGive(configMutex);
+        if (status != ConfigManagerStatus::OK) {
+            return status;
+        }
 
-        // Natychmiastowy zapis do pliku dla persystencji
-        return writeConfigToSD();
+        // Natychmiastowy zapis w NVS dla persystencji
+        return saveConfig();
     }
 
     return ConfigManagerStatus::UNKNOWN_ERROR;
@@ -236,48 +397,23 @@ ConfigManagerStatus ConfigManager::updateConfig(const MachineConfig& newConfig)
 //                          KONWERSJA JSON ↔ KONFIGURACJA
 // ================================================================================
 
-String ConfigManager::configToJson() {
-    JsonDocument doc {};
-
-    // Thread-safe serializacja konfiguracji do JSON
-    if (xSemaphoreTake(configMutex, portMAX_DELAY) == pdTRUE) {
-        // Budowa obiektu JSON dla osi X
-        JsonObject xAxis = doc["xAxis"].to<JsonObject>();
-        xAxis["stepsPerMM"] = config.X.stepsPerMM;
-        xAxis["workFeedRate"] = config.X.workFeedRate;
-        xAxis["workAcceleration"] = config.X.workAcceleration;
-        xAxis["rapidFeedRate"] = config.X.rapidFeedRate;
-        xAxis["rapidAcceleration"] = config.X.rapidAcceleration;
-        xAxis["offset"] = config.X.offset;
-
-        // Budowa obiektu JSON dla osi Y
-        JsonObject yAxis = doc["yAxis"].to<JsonObject>();
-        yAxis["stepsPerMM"] = config.Y.stepsPerMM;
-        yAxis["workFeedRate"] = config.Y.workFeedRate;
-        yAxis["workAcceleration"] = config.Y.workAcceleration;
-        yAxis["rapidFeedRate"] = config.Y.rapidFeedRate;
-        yAxis["rapidAcceleration"] = config.Y.rapidAcceleration;
-        yAxis["offset"] = config.Y.offset;
-
-        // Parametry systemowe
-        doc["useGCodeFeedRate"] = config.useGCodeFeedRate;
-        doc["delayAfterStartup"] = config.delayAfterStartup;
-        doc["deactivateESTOP"] = config.deactivateESTOP;
-        doc["deactivateLimitSwitches"] = config.deactivateLimitSwitches;
-        doc["limitSwitchType"] = config.limitSwitchType;
-        doc["hotWirePower"] = config.hotWirePower;
-        doc["fanPower"] = config.fanPower;
+size_t ConfigManager::configToJson(char* buffer, size_t capacity) {
+    JsonWriter writer { buffer, capacity };
 
-        xSemaphoreGive(configMutex);
+    // Serializacja bieżącej wersji konfiguracji bez blokady
+    const ConfigSnapshotRef current { snapshots.acquire() };
+    if (!current) {
+        return 0;
     }
+    writer.beginObject();
+    ConfigRegistry::writeJson(*current, writer);
+    writer.endObject();
 
-    // Konwersja dokumentu JSON na string
-    String result;
-    serializeJson(doc, result);
-    return result;
+    // Niekompletny dokument nie może trafić do pliku ani do klienta
+    return writer.isComplete() ? writer.size() : 0;
 }
 
-ConfigManagerStatus ConfigManager::configFromJson(const String& jsonString) {
+ConfigManagerStatus ConfigManager::configFromJson(const String& jsonString, ConfigValidationReport* report) {
     JsonDocument doc {};
 
     // Parsowanie JSON z walidacją błędów
@@ -290,104 +426,262 @@ ConfigManagerStatus ConfigManager::configFromJson(const String& jsonString) {
         return ConfigManagerStatus::JSON_PARSE_ERROR;
     }
 
-    // Thread-safe aktualizacja konfiguracji z JSON
+    // Nowa wersja z JSON nałożonego na bieżącą - wartość spoza zakresu odrzuca cały dokument
     if (xSemaphoreTake(configMutex, portMAX_DELAY) == pdTRUE) {
-        // Bezpieczne parsowanie parametrów osi X z walidacją typów
-        if (doc["xAxis"].is<JsonObject>()) {
-            JsonObject xAxis = doc["xAxis"];
-            if (xAxis["stepsPerMM"].is<float>()) config.X.stepsPerMM = xAxis["stepsPerMM"].as<float>();
-            if (xAxis["workFeedRate"].is<float>()) config.X.workFeedRate = xAxis["workFeedRate"].as<float>();
-            if (xAxis["workAcceleration"].is<float>()) config.X.workAcceleration = xAxis["workAcceleration"].as<float>();
-            if (xAxis["rapidFeedRate"].is<float>()) config.X.rapidFeedRate = xAxis["rapidFeedRate"].as<float>();
-            if (xAxis["rapidAcceleration"].is<float>()) config.X.rapidAcceleration = xAxis["rapidAcceleration"].as<float>();
-            if (xAxis["offset"].is<float>()) config.X.offset = xAxis["offset"].as<float>();
+        MachineConfig next {};
+        currentOrDefaults(next);
+
+        const JsonObjectConst root { doc.as<JsonObjectConst>() };
+        const ConfigParamDescriptor* rejected[CONFIG::CONFIG_VALIDATION_MAX_ERRORS] {};
+        const size_t rejectedCount { ConfigRegistry::readJson(root, next, rejected, CONFIG::CONFIG_VALIDATION_MAX_ERRORS) };
+
+        ConfigManagerStatus status { ConfigManagerStatus::VALIDATION_FAILED };
+        if (rejectedCount == 0) {
+            status = validate(next, report);
+            if (status == ConfigManagerStatus::OK) {
+                status = publish(next);
+            }
+        }
+        xSemaphoreGive(configMutex);
+
+        // Pola spoza zakresu z wartościami z dokumentu (konfiguracja z nimi nie powstała)
+        if (rejectedCount > 0) {
+            reportRejected(report, root, rejected, rejectedCount);
+
+            #ifdef DEBUG_CONFIG_MANAGER
+            Serial.printf("DEBUG CONFIG: %u value(s) out of range, first: %s\n", static_cast<unsigned>(rejectedCount), rejected[0]->field.key);
+            #endif
+            return status;
         }
 
-        // Bezpieczne parsowanie parametrów osi Y z walidacją typów
-        if (doc["yAxis"].is<JsonObject>()) {
-            JsonObject yAxis = doc["yAxis"];
-            if (yAxis["stepsPerMM"].is<float>()) config.Y.stepsPerMM = yAxis["stepsPerMM"].as<float>();
-            if (yAxis["workFeedRate"].is<float>()) config.Y.workFeedRate = yAxis["workFeedRate"].as<float>();
-            if (yAxis["workAcceleration"].is<float>()) config.Y.workAcceleration = yAxis["workAcceleration"].as<float>();
-            if (yAxis["rapidFeedRate"].is<float>()) config.Y.rapidFeedRate = yAxis["rapidFeedRate"].as<float>();
-            if (yAxis["rapidAcceleration"].is<float>()) config.Y.rapidAcceleration = yAxis["rapidAcceleration"].as<float>();
-            if (yAxis["offset"].is<float>()) config.Y.offset = yAxis["offset"].as<float>();
+        #ifdef DEBUG_CONFIG_MANAGER
+        if (status == ConfigManagerStatus::OK) {
+            Serial.println("DEBUG CONFIG: Configuration successfully loaded from JSON");
         }
+        #endif
+
+        return status;
+    }
 
-        // Bezpieczne parsowanie parametrów systemowych z walidacją typów
-        if (doc["useGCodeFeedRate"].is<bool>()) config.useGCodeFeedRate = doc["useGCodeFeedRate"].as<bool>();
-        if (doc["delayAfterStartup"].is<int>()) config.delayAfterStartup = doc["delayAfterStartup"].as<int>();
-        if (doc["deactivateESTOP"].is<bool>()) config.deactivateESTOP = doc["deactivateESTOP"].as<bool>();
-        if (doc["deactivateLimitSwitches"].is<bool>()) config.deactivateLimitSwitches = doc["deactivateLimitSwitches"].as<bool>();
-        if (doc["limitSwitchType"].is<uint8_t>()) config.limitSwitchType = doc["limitSwitchType"].as<uint8_t>();
-        if (doc["hotWirePower"].is<float>()) config.hotWirePower = doc["hotWirePower"].as<float>();
-        if (doc["fanPower"].is<float>()) config.fanPower = doc["fanPower"].as<float>();
+    return ConfigManagerStatus::UNKNOWN_ERROR;
+}
 
-        xSemaphoreGive(configMutex);
+// ================================================================================
+//                              PROFILE MATERIAŁÓW
+// ================================================================================
 
+ConfigManagerStatus ConfigManager::getProfiles(MaterialProfileTable& target, TickType_t timeout) {
+    if (xSemaphoreTake(profilesMutex, timeout) != pdTRUE) {
+        return ConfigManagerStatus::SNAPSHOT_UNAVAILABLE;
+    }
+    target = profiles;
+    xSemaphoreGive(profilesMutex);
+    return ConfigManagerStatus::OK;
+}
+
+uint32_t ConfigManager::profilesVersion() const {
+    return profileTableVersion.load();
+}
+
+ConfigManagerStatus ConfigManager::profileFromJson(const String& jsonString, ConfigValidationReport* report) {
+    JsonDocument doc {};
+    DeserializationError error = deserializeJson(doc, jsonString);
+    if (error) {
         #ifdef DEBUG_CONFIG_MANAGER
-        Serial.println("DEBUG CONFIG: Configuration successfully loaded from JSON");
+        Serial.print("DEBUG CONFIG: Profile JSON parse error: ");
+        Serial.println(error.c_str());
         #endif
+        return ConfigManagerStatus::JSON_PARSE_ERROR;
+    }
 
-        return ConfigManagerStatus::OK;
+    const JsonObjectConst root { doc.as<JsonObjectConst>() };
+    if (!root["slot"].is<int>() || !root["name"].is<const char*>()) {
+        return ConfigManagerStatus::INVALID_PROFILE;
+    }
+    const int slot { root["slot"].as<int>() };
+    const char* name { root["name"].as<const char*>() };
+    if (slot < 1 || slot > static_cast<int>(CONFIG::MATERIAL_PROFILE_SLOTS)
+        || name[0] == '\0' || strlen(name) >= CONFIG::MATERIAL_PROFILE_NAME_LENGTH) {
+        return ConfigManagerStatus::INVALID_PROFILE;
     }
 
-    return ConfigManagerStatus::UNKNOWN_ERROR;
+    // Punkt wyjścia: profil zapisany w tym miejscu lub parametry bieżącej konfiguracji
+    MachineConfig base {};
+    currentOrDefaults(base);
+    MaterialProfile profile {};
+    if (xSemaphoreTake(profilesMutex, portMAX_DELAY) != pdTRUE) {
+        return ConfigManagerStatus::UNKNOWN_ERROR;
+    }
+    profile = profiles.slots[slot - 1];
+    xSemaphoreGive(profilesMutex);
+    if (!MaterialProfiles::isOccupied(profile)) {
+        MaterialProfiles::capture(base, profile);
+    }
+    strncpy(profile.name, name, sizeof(profile.name) - 1);
+    profile.name[sizeof(profile.name) - 1] = '\0';
+
+    const ConfigParamDescriptor* rejected[CONFIG::CONFIG_VALIDATION_MAX_ERRORS] {};
+    const size_t rejectedCount { MaterialProfiles::readJson(root, profile, rejected, CONFIG::CONFIG_VALIDATION_MAX_ERRORS) };
+    if (rejectedCount > 0) {
+        reportRejected(report, root, rejected, rejectedCount);
+        return ConfigManagerStatus::VALIDATION_FAILED;
+    }
+
+    // Reguły sprawdzane dla konfiguracji bazowej z nałożonym profilem (np. posuw roboczy a szybki)
+    MachineConfig effective { base };
+    MaterialProfiles::apply(profile, effective);
+    const ConfigManagerStatus status { validate(effective, report) };
+    if (status != ConfigManagerStatus::OK) {
+        return status;
+    }
+
+    return storeProfile(static_cast<uint8_t>(slot), profile);
+}
+
+ConfigManagerStatus ConfigManager::deleteProfile(uint8_t slot) {
+    if (slot < 1 || slot > CONFIG::MATERIAL_PROFILE_SLOTS) {
+        return ConfigManagerStatus::INVALID_PROFILE;
+    }
+    return storeProfile(slot, MaterialProfile {});
+}
+
+ConfigManagerStatus ConfigManager::storeProfile(uint8_t slot, const MaterialProfile& profile) {
+    // Nowa wersja tablicy widoczna dla zadania CNC od razu, zapis w NVS poza sekcją krytyczną
+    MaterialProfileTable updated {};
+    if (xSemaphoreTake(profilesMutex, portMAX_DELAY) != pdTRUE) {
+        return ConfigManagerStatus::UNKNOWN_ERROR;
+    }
+    profiles.slots[slot - 1] = profile;
+    ++profiles.version;
+    profileTableVersion.store(profiles.version);
+    updated = profiles;
+    xSemaphoreGive(profilesMutex);
+
+    const ConfigStoreStatus status { ConfigStore::saveProfiles(updated) };
+    if (status != ConfigStoreStatus::OK) {
+        #ifdef DEBUG_CONFIG_MANAGER
+        Serial.printf("ERROR CONFIG: Zapis profili w NVS nieudany: %s\n", ConfigStore::statusName(status));
+        #endif
+        return ConfigManagerStatus::NVS_WRITE_FAILED;
+    }
+    return ConfigManagerStatus::OK;
+}
+
+size_t ConfigManager::profilesToJson(char* buffer, size_t capacity) {
+    MaterialProfileTable table {};
+    if (getProfiles(table) != ConfigManagerStatus::OK) {
+        return 0;
+    }
+
+    JsonWriter writer { buffer, capacity };
+    writer.beginObject();
+    writer.field("success", true);
+    writer.field("slots", static_cast<unsigned long>(CONFIG::MATERIAL_PROFILE_SLOTS));
+    writer.beginArray("profiles");
+    for (size_t slot { 0 }; slot < CONFIG::MATERIAL_PROFILE_SLOTS; ++slot) {
+        const MaterialProfile& profile { table.slots[slot] };
+        if (!MaterialProfiles::isOccupied(profile)) {
+            continue;
+        }
+        writer.beginObject();
+        writer.field("slot", static_cast<unsigned long>(slot + 1));
+        MaterialProfiles::writeJson(profile, writer);
+        writer.endObject();
+    }
+    writer.endArray();
+    writer.endObject();
+
+    return writer.isComplete() ? writer.size() : 0;
 }
 
 // ================================================================================
 //                         AKTUALIZACJA POJEDYNCZYCH PARAMETRÓW
 // ================================================================================
 
-template<typename T>
-ConfigManagerStatus ConfigManager::updateParameter(const std::string& paramName, T value) {
+ConfigManagerStatus ConfigManager::setParameter(const char* paramName, double value) {
     // Auto-inicjalizacja jeśli potrzebna
     if (!configInitialized) {
         init();
     }
-    
-    // Thread-safe aktualizacja wybranego parametru
-    if (xSemaphoreTake(configMutex, portMAX_DELAY) == pdTRUE) {
-        // Mapowanie nazw parametrów na pola struktury konfiguracji
-        // Parametry kinematyki osi X
-        if (paramName == "xAxis.stepsPerMM") config.X.stepsPerMM = static_cast<float>(value);
-        else if (paramName == "xAxis.workFeedRate") config.X.workFeedRate = static_cast<float>(value);
-        else if (paramName == "xAxis.workAcceleration") config.X.workAcceleration = static_cast<float>(value);
-        else if (paramName == "xAxis.rapidFeedRate") config.X.rapidFeedRate = static_cast<float>(value);
-        else if (paramName == "xAxis.rapidAcceleration") config.X.rapidAcceleration = static_cast<float>(value);
-        else if (paramName == "xAxis.offset") config.X.offset = static_cast<float>(value);
-
-        // Parametry kinematyki osi Y
-        else if (paramName == "yAxis.stepsPerMM") config.Y.stepsPerMM = static_cast<float>(value);
-        else if (paramName == "yAxis.workFeedRate") config.Y.workFeedRate = static_cast<float>(value);
-        else if (paramName == "yAxis.workAcceleration") config.Y.workAcceleration = static_cast<float>(value);
-        else if (paramName == "yAxis.rapidFeedRate") config.Y.rapidFeedRate = static_cast<float>(value);
-        else if (paramName == "yAxis.rapidAcceleration") config.Y.rapidAcceleration = static_cast<float>(value);
-        else if (paramName == "yAxis.offset") config.Y.offset = static_cast<float>(value);
-
-
-        // Parametry systemowe maszyny
-        else if (paramName == "useGCodeFeedRate") config.useGCodeFeedRate = static_cast<bool>(value);
-        else if (paramName == "delayAfterStartup") config.delayAfterStartup = static_cast<int>(value);
-        else if (paramName == "deactivateESTOP") config.deactivateESTOP = static_cast<bool>(value);
-        else if (paramName == "deactivateLimitSwitches") config.deactivateLimitSwitches = static_cast<bool>(value);
-        else if (paramName == "limitSwitchType") config.limitSwitchType = static_cast<uint8_t>(value);
-        else if (paramName == "hotWirePower") config.hotWirePower = static_cast<float>(value);
-        else if (paramName == "fanPower") config.fanPower = static_cast<float>(value);
 
+    // Wyszukanie parametru w rejestrze (tablica mieszająca nazw)
+    const ConfigParamDescriptor* descriptor { ConfigRegistry::find(paramName) };
+    if (descriptor == nullptr) {
+        return ConfigManagerStatus::UNKNOWN_PARAMETER;
+    }
+
+    // Nowa wersja z wybranym parametrem zmienionym z kontrolą zakresu
+    if (xSemaphoreTake(configMutex, portMAX_DELAY) == pdTRUE) {
+        MachineConfig next {};
+        currentOrDefaults(next);
+        const bool accepted { ConfigRegistry::setValue(next, *descriptor, value) };
+        ConfigManagerStatus status { accepted ? validate(next, nullptr) : ConfigManagerStatus::VALUE_OUT_OF_RANGE };
+        if (status == ConfigManagerStatus::OK) {
+            status = publish(next);
+        }
         xSemaphoreGive(configMutex);
 
-        // Natychmiastowy zapis zmiany do pliku
-        return writeConfigToSD();
+        if (status != ConfigManagerStatus::OK) {
+            return status;
+        }
+
+        // Natychmiastowy zapis zmiany w NVS
+        return saveConfig();
     }
 
     return ConfigManagerStatus::UNKNOWN_ERROR;
 }
 
 // ================================================================================
-//                          JAWNE INSTANCJE SZABLONÓW
+//                         PUBLIKACJA WERSJI KONFIGURACJI
 // ================================================================================
-// Definicje dla kompilera - obsługiwane typy danych w updateParameter
-template ConfigManagerStatus ConfigManager::updateParameter<float>(const std::string& paramName, float value);
-template ConfigManagerStatus ConfigManager::updateParameter<int>(const std::string& paramName, int value);
-template ConfigManagerStatus ConfigManager::updateParameter<bool>(const std::string& paramName, bool value);
\ No newline at end of file
+
+void ConfigManager::currentOrDefaults(MachineConfig& target) {
+    const ConfigSnapshotRef current { snapshots.acquire() };
+    if (current) {
+        target = *current;
+    }
+    else {
+        ConfigRegistry::loadDefaults(target);
+    }
+}
+
+ConfigManagerStatus ConfigManager::validate(const MachineConfig& candidate, ConfigValidationReport* report) {
+    ConfigValidationReport localReport {};
+    ConfigValidationReport& target { report != nullptr ? *report : localReport };
+    #ifdef DEBUG_CONFIG_MANAGER
+    const size_t firstError { target.count };
+    #endif
+    if (ConfigValidator::validate(candidate, target)) {
+        return ConfigManagerStatus::OK;
+    }
+
+    #ifdef DEBUG_CONFIG_MANAGER
+    for (size_t index { firstError }; index < target.count; ++index) {
+        const ConfigValidationError& error { target.errors[index] };
+        Serial.printf("DEBUG CONFIG: Validation: %s - %s (value %.3f, limit %.3f)\n",
+            error.parameter != nullptr ? error.parameter->field.key : "?", ConfigValidator::ruleMessage(error.rule),
+            error.value, error.limit);
+    }
+    #endif
+    return ConfigManagerStatus::VALIDATION_FAILED;
+}
+
+ConfigManagerStatus ConfigManager::publish(const MachineConfig& next) {
+    // Miejsca zwalniane są przez czytelników po krótkich odczytach - oczekiwanie ograniczone czasem
+    const TickType_t start { xTaskGetTickCount() };
+    while (!snapshots.publish(next)) {
+        if (xTaskGetTickCount() - start >= pdMS_TO_TICKS(CONFIG::CONFIG_SNAPSHOT_PUBLISH_TIMEOUT_MS)) {
+            #ifdef DEBUG_CONFIG_MANAGER
+            Serial.println("ERROR CONFIG: Brak wolnego miejsca na nową wersję konfiguracji");
+            #endif
+            return ConfigManagerStatus::SNAPSHOT_UNAVAILABLE;
+        }
+        vTaskDelay(1);
+    }
+
+    #ifdef DEBUG_CONFIG_MANAGER
+    Serial.printf("DEBUG CONFIG: Opublikowano wersję konfiguracji %lu\n", static_cast<unsigned long>(snapshots.version()));
+    #endif
+    return ConfigManagerStatus::OK;
+}
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <atomic>
 #include <string>
 #include <Arduino.h>
 #include <ArduinoJson.h>
@@ -19,12 +20,38 @@ struct MachineConfig {
         float workFeedRate {};      // G1 Prędkość [steps/s]
         float workAcceleration {};  // G1 Przyspieszenie [steps/s^2]
         float offset {};            // Przejazd po nagrzaniu drutu [mm]
+        uint8_t shaperType {};      // Filtr kształtujący (0 - brak, 1 - ZV, 2 - MZV)
+        float shaperFrequency {};   // Częstotliwość rezonansu osi [Hz]
+        float shaperDamping {};     // Współczynnik tłumienia rezonansu [-]
+        float backlash {};          // Luz mechaniczny kasowany przy zmianie kierunku [mm]
+    };
+
+    // Kinematyka drutu - rzutowanie ze ścian bloku na płaszczyzny wież
+    struct KinematicsConfig {
+        bool enabled {};            // Czy rzutować współrzędne na wieże
+        float towerDistance {};     // Odległość między wieżami XY i UV [mm]
+        float blockOffset {};       // Odległość ściany XY bloku od wieży XY [mm]
+        float blockWidth {};        // Szerokość bloku między ścianami [mm]
+    };
+
+    // Bazowanie - szybkie wyszukanie krańcówek obu osi i powolny, precyzyjny dojazd
+    struct HomingConfig {
+        float seekSpeed {};         // Prędkość wyszukiwania krańcówek [mm/s]
+        float approachSpeed {};     // Prędkość precyzyjnego dojazdu [mm/s]
+        float acceleration {};      // Przyspieszenie ruchów bazowania [mm/s^2]
+        float backoffDistance {};   // Wycofanie przed precyzyjnym dojazdem [mm]
+        float pulloffDistance {};   // Odjazd od krańcówki do punktu zerowego [mm]
+        float maxTravel {};         // Maksymalna droga wyszukiwania krańcówki [mm]
     };
 
     // Osie 
     MotorConfig X {};
     MotorConfig Y {};
 
+    KinematicsConfig kinematics {};
+
+    HomingConfig homing {};
+
     // Parametry drutu
     float hotWirePower {};          // Moc drutu grzejnego [0-100%]
     float fanPower {};              // Moc wentylatora [0-100%]
@@ -35,6 +62,91 @@ struct MachineConfig {
     bool deactivateESTOP {};       // Wyłączenie zabezpieczenia ESTOP
     bool deactivateLimitSwitches {}; // Wyłączenie wyłączników krańcowych
     uint8_t limitSwitchType {};     // Typ wyłączników krańcowych (0 - NO, 1 - NC)
+    uint32_t sdSpiFrequency {};     // Zegar SPI karty SD [Hz]
+};
+
+// ================================================================================
+//                              PROFILE MATERIAŁÓW
+// ================================================================================
+
+// Nazwany zestaw parametrów cięcia nakładany na konfigurację bazową
+// (kolejność wartości wg MaterialProfiles::parameter())
+struct MaterialProfile {
+    static constexpr size_t PARAMETER_COUNT { 7 };
+
+    char name[CONFIG::MATERIAL_PROFILE_NAME_LENGTH] {};    // Pusta nazwa = wolne miejsce
+    float values[PARAMETER_COUNT] {};
+};
+
+// Profile w stałych miejscach - numer profilu = indeks + 1, numery w plikach G-code nie zmieniają się
+struct MaterialProfileTable {
+    MaterialProfile slots[CONFIG::MATERIAL_PROFILE_SLOTS] {};
+    uint32_t version { 0 };
+};
+
+// ================================================================================
+//                          WERSJE KONFIGURACJI (RCU)
+// ================================================================================
+
+// Niezmienna wersja konfiguracji z licznikiem odwołań
+class ConfigSnapshot {
+    private:
+    friend class ConfigSnapshotPool;
+    friend class ConfigSnapshotRef;
+
+    MachineConfig config {};
+    uint32_t version { 0 };
+    std::atomic<uint32_t> references { 0 };    // Odwołania czytelników i wersji bieżącej; bit WRITER = zapis w toku
+};
+
+// Odwołanie do wersji konfiguracji - wersja nie zostanie nadpisana, dopóki odwołanie istnieje
+class ConfigSnapshotRef {
+    private:
+    friend class ConfigSnapshotPool;
+
+    ConfigSnapshot* snapshot { nullptr };
+
+    explicit ConfigSnapshotRef(ConfigSnapshot* snapshot) : snapshot(snapshot) {}
+
+    public:
+    ConfigSnapshotRef() = default;
+    ~ConfigSnapshotRef();
+
+    ConfigSnapshotRef(ConfigSnapshotRef&& other);
+    ConfigSnapshotRef& operator=(ConfigSnapshotRef&& other);
+    ConfigSnapshotRef(const ConfigSnapshotRef&) = delete;
+    ConfigSnapshotRef& operator=(const ConfigSnapshotRef&) = delete;
+
+    explicit operator bool() const { return snapshot != nullptr; }
+    const MachineConfig& operator*() const { return snapshot->config; }
+    const MachineConfig* operator->() const { return &snapshot->config; }
+
+    // Numer wersji (0 = brak konfiguracji)
+    uint32_t version() const { return snapshot != nullptr ? snapshot->version : 0; }
+
+    void release();
+};
+
+// Pula wersji konfiguracji. Odczyt bez blokad i bez kopiowania (licznik odwołań),
+// zapis przygotowuje nową wersję w wolnym miejscu i publikuje ją atomową zamianą wskaźnika.
+// Zapisujący muszą być serializowani przez wywołującego (ConfigManager::configMutex).
+class ConfigSnapshotPool {
+    private:
+    static constexpr uint32_t WRITER { 0x80000000u };
+
+    ConfigSnapshot slots[CONFIG::CONFIG_SNAPSHOT_SLOTS] {};
+    std::atomic<ConfigSnapshot*> current { nullptr };
+    std::atomic<uint32_t> currentVersion { 0 };
+
+    public:
+    // Bieżąca wersja; puste odwołanie przed pierwszą publikacją
+    ConfigSnapshotRef acquire();
+
+    // Numer bieżącej wersji bez pobierania odwołania (0 = brak konfiguracji)
+    uint32_t version() const;
+
+    // Publikacja nowej wersji; false = wszystkie miejsca zajęte przez czytelników
+    bool publish(const MachineConfig& config);
 };
 
 enum class ConfigManagerStatus {
@@ -45,22 +157,50 @@ enum class ConfigManagerStatus {
     JSON_SERIALIZE_ERROR,
     SD_ACCESS_ERROR,
     MANAGER_NOT_INITIALIZED,
+    UNKNOWN_PARAMETER,
+    VALUE_OUT_OF_RANGE,
+    NVS_WRITE_FAILED,
+    SNAPSHOT_UNAVAILABLE,
+    VALIDATION_FAILED,
+    INVALID_PROFILE,
     UNKNOWN_ERROR
 };
 
+struct ConfigValidationReport;
+
 class ConfigManager {
     private:
 
     SDCardManager* sdManager {};
 
-    MachineConfig config {};
+    // Opublikowane wersje konfiguracji - odczyt bez blokad
+    ConfigSnapshotPool snapshots {};
 
-    // Mutex do synchronizacji dostępu do konfiguracji
+    // Mutex serializujący zapisujących (odczyt przez snapshots)
     SemaphoreHandle_t configMutex {};
 
-    // Flaga wskazująca, czy konfiguracja została załadowana z pliku
+    // Profile materiałów - krótkie sekcje krytyczne (kopia tablicy), także w zadaniu CNC
+    MaterialProfileTable profiles {};
+    std::atomic<uint32_t> profileTableVersion { 0 };
+    SemaphoreHandle_t profilesMutex {};
+
+    // Flaga wskazująca, czy konfiguracja została załadowana
     bool configInitialized { false };
 
+    ConfigManagerStatus setParameter(const char* paramName, double value);
+
+    // Punkt wyjścia nowej wersji: bieżąca konfiguracja lub wartości domyślne przed init()
+    void currentOrDefaults(MachineConfig& target);
+
+    // Walidacja przed publikacją (ConfigValidator) - błędy w raporcie wywołującego, jeśli podany
+    ConfigManagerStatus validate(const MachineConfig& candidate, ConfigValidationReport* report);
+
+    // Publikacja nowej wersji konfiguracji (wywołanie przy zajętym configMutex)
+    ConfigManagerStatus publish(const MachineConfig& next);
+
+    // Zmiana miejsca w tablicy profili (pusty profil = usunięcie) z zapisem tablicy w NVS
+    ConfigManagerStatus storeProfile(uint8_t slot, const MaterialProfile& profile);
+
     public:
     // Konstruktor
     ConfigManager(SDCardManager* sdManager);
@@ -68,31 +208,60 @@ class ConfigManager {
     // Destruktor
     ~ConfigManager();
 
-    // Inicjalizacja managera konfiguracji
+    // Inicjalizacja managera konfiguracji: NVS, a przy braku zapisu import z karty SD lub wartości domyślne
     ConfigManagerStatus init();
 
-    // Pobranie bieżącej konfiguracji
+    // Kopia bieżącej konfiguracji
     ConfigManagerStatus getConfig(MachineConfig& targetConfig);
 
-    // Wczytanie konfiguracji z pliku
-    ConfigManagerStatus readConfigFromSD();
+    // Bieżąca wersja konfiguracji bez kopiowania i blokad (puste odwołanie przed init())
+    ConfigSnapshotRef snapshot();
+
+    // Numer bieżącej wersji - zmiana oznacza nową konfigurację do przejęcia
+    uint32_t configVersion() const;
+
+    // Zapis aktywnej konfiguracji w NVS
+    ConfigManagerStatus saveConfig();
 
-    // Zapisanie konfiguracji do pliku
+    // Import konfiguracji z pliku JSON na karcie SD (bez zapisu w NVS - saveConfig())
+    ConfigManagerStatus readConfigFromSD(ConfigValidationReport* report = nullptr);
+
+    // Eksport konfiguracji do pliku JSON na karcie SD
     ConfigManagerStatus writeConfigToSD();
 
     // Wczytanie domyślnej konfiguracji zawartej w pliku CONFIGURATION.h
     ConfigManagerStatus loadDefaultConfig();
 
-    // Ustawienie całej konfiguracji
-    ConfigManagerStatus updateConfig(const MachineConfig& newConfig);
+    // Ustawienie całej konfiguracji z walidacją i zapisem w NVS
+    ConfigManagerStatus updateConfig(const MachineConfig& newConfig, ConfigValidationReport* report = nullptr);
 
-    // Aktualizacja pojedynczego parametru
+    // Aktualizacja pojedynczego parametru wg nazwy z rejestru ("xAxis.stepsPerMM", "fanPower")
+    // z kontrolą zakresu, walidacją całej konfiguracji i zapisem w NVS
     template<typename T>
-    ConfigManagerStatus updateParameter(const std::string& paramName, T value);
+    ConfigManagerStatus updateParameter(const std::string& paramName, T value) {
+        return setParameter(paramName.c_str(), static_cast<double>(value));
+    }
+
+    // Serializacja konfiguracji do JSON w buforze wywołującego (bez alokacji)
+    // Zwraca długość tekstu lub 0, gdy konfiguracja nie zmieściła się w buforze
+    size_t configToJson(char* buffer, size_t capacity);
+
+    // Deserializacja konfiguracji z JSON z walidacją - odrzucona konfiguracja nie jest publikowana
+    ConfigManagerStatus configFromJson(const String& jsonString, ConfigValidationReport* report = nullptr);
+
+    // Kopia tablicy profili materiałów; timeout pozwala zadaniu CNC nie czekać na zapisującego
+    ConfigManagerStatus getProfiles(MaterialProfileTable& target, TickType_t timeout = portMAX_DELAY);
+
+    // Numer wersji tablicy profili - zmiana oznacza profile do przeliczenia
+    uint32_t profilesVersion() const;
+
+    // Zapis profilu z JSON ({"slot", "name", parametry jak w /api/config}) z walidacją
+    // konfiguracji bazowej z nałożonym profilem i zapisem tablicy w NVS
+    ConfigManagerStatus profileFromJson(const String& jsonString, ConfigValidationReport* report = nullptr);
 
-    // Serializacja konfiguracji do JSON
-    String configToJson();
+    // Usunięcie profilu z miejsca 1..MATERIAL_PROFILE_SLOTS z zapisem tablicy w NVS
+    ConfigManagerStatus deleteProfile(uint8_t slot);
 
-    // Deserializacja konfiguracji z JSON
-    ConfigManagerStatus configFromJson(const String& jsonString);
+    // Zajęte miejsca profili jako JSON w buforze wywołującego; 0 = bufor za mały
+    size_t profilesToJson(char* buffer, size_t capacity);
 };
\ No newline at end of file
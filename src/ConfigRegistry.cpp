@@ -0,0 +1,310 @@
+// ================================================================================
+//                         REJESTR PARAMETRÓW KONFIGURACJI
+// ================================================================================
+// Tablica opisów parametrów MachineConfig i operacje sterowane tablicą:
+// wartości domyślne, JSON (API i plik na SD), kontrola zakresu, wyszukiwanie po nazwie
+
+#include "ConfigRegistry.h"
+
+#include <math.h>
+#include <string.h>
+
+#include "CONFIGURATION.H"
+
+namespace {
+    constexpr double STEP_RATE_MAX { 200000.0 };        // [steps/s] Górna granica prędkości i przyspieszeń w krokach
+    constexpr double TRAVEL_MAX { 10000.0 };            // [mm] Górna granica wymiarów i dróg przejazdu
+
+    // Kolejność wpisów = kolejność pól w JSON; pola jednej grupy muszą występować kolejno
+    constexpr ConfigParamDescriptor PARAMETERS[] {
+        // Oś X
+        CONFIG_PARAM("xAxis", "stepsPerMM", X.stepsPerMM, 1.0, 100000.0, DEFAULTS::X_STEPS_PER_MM, "steps/mm"),
+        CONFIG_PARAM("xAxis", "rapidFeedRate", X.rapidFeedRate, 1.0, STEP_RATE_MAX, DEFAULTS::X_RAPID_FEEDRATE, "steps/s"),
+        CONFIG_PARAM("xAxis", "rapidAcceleration", X.rapidAcceleration, 1.0, STEP_RATE_MAX * 10.0, DEFAULTS::X_RAPID_ACCELERATION, "steps/s^2"),
+        CONFIG_PARAM("xAxis", "workFeedRate", X.workFeedRate, 1.0, STEP_RATE_MAX, DEFAULTS::X_WORK_FEEDRATE, "steps/s"),
+        CONFIG_PARAM("xAxis", "workAcceleration", X.workAcceleration, 1.0, STEP_RATE_MAX * 10.0, DEFAULTS::X_WORK_ACCELERATION, "steps/s^2"),
+        CONFIG_PARAM("xAxis", "offset", X.offset, -TRAVEL_MAX, TRAVEL_MAX, DEFAULTS::X_OFFSET, "mm"),
+        CONFIG_PARAM("xAxis", "shaperType", X.shaperType, 0.0, 2.0, DEFAULTS::X_SHAPER_TYPE, ""),
+        CONFIG_PARAM("xAxis", "shaperFrequency", X.shaperFrequency, 1.0, 500.0, DEFAULTS::X_SHAPER_FREQUENCY, "Hz"),
+        CONFIG_PARAM("xAxis", "shaperDamping", X.shaperDamping, 0.0, 1.0, DEFAULTS::X_SHAPER_DAMPING, ""),
+        CONFIG_PARAM("xAxis", "backlash", X.backlash, 0.0, 10.0, DEFAULTS::X_BACKLASH, "mm"),
+
+        // Oś Y
+        CONFIG_PARAM("yAxis", "stepsPerMM", Y.stepsPerMM, 1.0, 100000.0, DEFAULTS::Y_STEPS_PER_MM, "steps/mm"),
+        CONFIG_PARAM("yAxis", "rapidFeedRate", Y.rapidFeedRate, 1.0, STEP_RATE_MAX, DEFAULTS::Y_RAPID_FEEDRATE, "steps/s"),
+        CONFIG_PARAM("yAxis", "rapidAcceleration", Y.rapidAcceleration, 1.0, STEP_RATE_MAX * 10.0, DEFAULTS::Y_RAPID_ACCELERATION, "steps/s^2"),
+        CONFIG_PARAM("yAxis", "workFeedRate", Y.workFeedRate, 1.0, STEP_RATE_MAX, DEFAULTS::Y_WORK_FEEDRATE, "steps/s"),
+        CONFIG_PARAM("yAxis", "workAcceleration", Y.workAcceleration, 1.0, STEP_RATE_MAX * 10.0, DEFAULTS::Y_WORK_ACCELERATION, "steps/s^2"),
+        CONFIG_PARAM("yAxis", "offset", Y.offset, -TRAVEL_MAX, TRAVEL_MAX, DEFAULTS::Y_OFFSET, "mm"),
+        CONFIG_PARAM("yAxis", "shaperType", Y.shaperType, 0.0, 2.0, DEFAULTS::Y_SHAPER_TYPE, ""),
+        CONFIG_PARAM("yAxis", "shaperFrequency", Y.shaperFrequency, 1.0, 500.0, DEFAULTS::Y_SHAPER_FREQUENCY, "Hz"),
+        CONFIG_PARAM("yAxis", "shaperDamping", Y.shaperDamping, 0.0, 1.0, DEFAULTS::Y_SHAPER_DAMPING, ""),
+        CONFIG_PARAM("yAxis", "backlash", Y.backlash, 0.0, 10.0, DEFAULTS::Y_BACKLASH, "mm"),
+
+        // Parametry systemowe
+        CONFIG_PARAM(nullptr, "useGCodeFeedRate", useGCodeFeedRate, 0.0, 1.0, DEFAULTS::USE_GCODE_FEEDRATE, ""),
+        CONFIG_PARAM(nullptr, "delayAfterStartup", delayAfterStartup, 0.0, 600000.0, DEFAULTS::DELAY_AFTER_STARTUP, "ms"),
+        CONFIG_PARAM(nullptr, "deactivateESTOP", deactivateESTOP, 0.0, 1.0, DEFAULTS::DEACTIVATE_ESTOP, ""),
+        CONFIG_PARAM(nullptr, "deactivateLimitSwitches", deactivateLimitSwitches, 0.0, 1.0, DEFAULTS::DEACTIVATE_LIMIT_SWITCHES, ""),
+        CONFIG_PARAM(nullptr, "limitSwitchType", limitSwitchType, 0.0, 1.0, DEFAULTS::LIMIT_SWITCH_TYPE, ""),
+        CONFIG_PARAM(nullptr, "sdSpiFrequency", sdSpiFrequency, 0.0, CONFIG::SD_SPI_MAX_FREQUENCY, DEFAULTS::SD_SPI_FREQUENCY, "Hz"),
+        CONFIG_PARAM(nullptr, "hotWirePower", hotWirePower, 0.0, 100.0, DEFAULTS::WIRE_POWER, "%"),
+        CONFIG_PARAM(nullptr, "fanPower", fanPower, 0.0, 100.0, DEFAULTS::FAN_POWER, "%"),
+
+        // Kinematyka drutu
+        CONFIG_PARAM("kinematics", "enabled", kinematics.enabled, 0.0, 1.0, DEFAULTS::KINEMATICS_ENABLED, ""),
+        CONFIG_PARAM("kinematics", "towerDistance", kinematics.towerDistance, 1.0, TRAVEL_MAX, DEFAULTS::TOWER_DISTANCE, "mm"),
+        CONFIG_PARAM("kinematics", "blockOffset", kinematics.blockOffset, 0.0, TRAVEL_MAX, DEFAULTS::BLOCK_OFFSET, "mm"),
+        CONFIG_PARAM("kinematics", "blockWidth", kinematics.blockWidth, 0.0, TRAVEL_MAX, DEFAULTS::BLOCK_WIDTH, "mm"),
+
+        // Bazowanie
+        CONFIG_PARAM("homing", "seekSpeed", homing.seekSpeed, 0.1, 1000.0, DEFAULTS::HOMING_SEEK_SPEED, "mm/s"),
+        CONFIG_PARAM("homing", "approachSpeed", homing.approachSpeed, 0.1, 100.0, DEFAULTS::HOMING_APPROACH_SPEED, "mm/s"),
+        CONFIG_PARAM("homing", "acceleration", homing.acceleration, 1.0, 100000.0, DEFAULTS::HOMING_ACCELERATION, "mm/s^2"),
+        CONFIG_PARAM("homing", "backoffDistance", homing.backoffDistance, 0.0, 100.0, DEFAULTS::HOMING_BACKOFF_DISTANCE, "mm"),
+        CONFIG_PARAM("homing", "pulloffDistance", homing.pulloffDistance, 0.0, 100.0, DEFAULTS::HOMING_PULLOFF_DISTANCE, "mm"),
+        CONFIG_PARAM("homing", "maxTravel", homing.maxTravel, 1.0, TRAVEL_MAX, DEFAULTS::HOMING_MAX_TRAVEL, "mm"),
+    };
+
+    constexpr size_t PARAMETER_COUNT { sizeof(PARAMETERS) / sizeof(PARAMETERS[0]) };
+
+    // Wartości domyślne w zakresie parametrów - sprawdzane przy kompilacji
+    constexpr bool defaultsInRange(size_t index) {
+        return index == PARAMETER_COUNT || (PARAMETERS[index].defaultValue >= PARAMETERS[index].minimum
+            && PARAMETERS[index].defaultValue <= PARAMETERS[index].maximum && defaultsInRange(index + 1));
+    }
+    static_assert(defaultsInRange(0), "Wartość domyślna parametru spoza zakresu");
+
+    // Tablica mieszająca z adresowaniem otwartym - wypełnienie najwyżej 50%
+    constexpr size_t INDEX_SIZE { 128 };
+    static_assert(PARAMETER_COUNT * 2 <= INDEX_SIZE, "Zwiększ INDEX_SIZE rejestru parametrów");
+    static_assert(PARAMETER_COUNT < UINT8_MAX, "Indeks parametru nie mieści się w uint8_t");
+
+    constexpr uint32_t FNV_OFFSET_BASIS { 2166136261U };
+    constexpr uint32_t FNV_PRIME { 16777619U };
+
+    constexpr uint32_t hashAppend(uint32_t hash, const char* text) {
+        return *text == '\0' ? hash : hashAppend((hash ^ static_cast<uint8_t>(*text)) * FNV_PRIME, text + 1);
+    }
+
+    // Skrót pełnej nazwy "grupa.klucz" liczony bez składania tekstu
+    constexpr uint32_t descriptorHash(const ConfigParamDescriptor& descriptor) {
+        return hashAppend(descriptor.group != nullptr
+            ? hashAppend(hashAppend(FNV_OFFSET_BASIS, descriptor.group), ".") : FNV_OFFSET_BASIS, descriptor.field.key);
+    }
+
+    // Skrót nazwy identyfikuje parametr także w zapisie binarnym (ConfigStore) - bez kolizji
+    constexpr bool hashUnique(size_t index, size_t other) {
+        return other == PARAMETER_COUNT
+            || (descriptorHash(PARAMETERS[index]) != descriptorHash(PARAMETERS[other]) && hashUnique(index, other + 1));
+    }
+    constexpr bool hashesUnique(size_t index) {
+        return index == PARAMETER_COUNT || (hashUnique(index, index + 1) && hashesUnique(index + 1));
+    }
+    static_assert(hashesUnique(0), "Kolizja skrótów nazw parametrów - zmień nazwę parametru");
+
+    bool nameMatches(const ConfigParamDescriptor& descriptor, const char* name) {
+        if (descriptor.group != nullptr) {
+            const size_t groupLength { strlen(descriptor.group) };
+            if (strncmp(name, descriptor.group, groupLength) != 0 || name[groupLength] != '.') {
+                return false;
+            }
+            name += groupLength + 1;
+        }
+        return strcmp(name, descriptor.field.key) == 0;
+    }
+
+    // Sloty: numer parametru + 1 (0 = pusty slot); skróty nazw wg numeru parametru
+    struct ParameterIndex {
+        uint8_t slots[INDEX_SIZE] {};
+        uint32_t hashes[PARAMETER_COUNT] {};
+
+        ParameterIndex() {
+            for (size_t index { 0 }; index < PARAMETER_COUNT; ++index) {
+                hashes[index] = descriptorHash(PARAMETERS[index]);
+                size_t slot { hashes[index] & (INDEX_SIZE - 1) };
+                while (slots[slot] != 0) {
+                    slot = (slot + 1) & (INDEX_SIZE - 1);
+                }
+                slots[slot] = static_cast<uint8_t>(index + 1);
+            }
+        }
+    };
+
+    const ParameterIndex& parameterIndex() {
+        static const ParameterIndex index {};
+        return index;
+    }
+
+    bool sameGroup(const char* left, const char* right) {
+        return left == right || (left != nullptr && right != nullptr && strcmp(left, right) == 0);
+    }
+}
+
+// ================================================================================
+//                              DOSTĘP DO TABLICY
+// ================================================================================
+
+const ConfigParamDescriptor* ConfigRegistry::descriptors() {
+    return PARAMETERS;
+}
+
+size_t ConfigRegistry::count() {
+    return PARAMETER_COUNT;
+}
+
+const ConfigParamDescriptor* ConfigRegistry::find(const char* name) {
+    if (name == nullptr) {
+        return nullptr;
+    }
+
+    const ParameterIndex& index { parameterIndex() };
+    const uint32_t hash { hashAppend(FNV_OFFSET_BASIS, name) };
+    size_t slot { hash & (INDEX_SIZE - 1) };
+    while (index.slots[slot] != 0) {
+        const size_t parameter { static_cast<size_t>(index.slots[slot] - 1) };
+        if (index.hashes[parameter] == hash && nameMatches(PARAMETERS[parameter], name)) {
+            return &PARAMETERS[parameter];
+        }
+        slot = (slot + 1) & (INDEX_SIZE - 1);
+    }
+    return nullptr;
+}
+
+const ConfigParamDescriptor* ConfigRegistry::findByHash(uint32_t hash) {
+    const ParameterIndex& index { parameterIndex() };
+    size_t slot { hash & (INDEX_SIZE - 1) };
+    while (index.slots[slot] != 0) {
+        const size_t parameter { static_cast<size_t>(index.slots[slot] - 1) };
+        if (index.hashes[parameter] == hash) {
+            return &PARAMETERS[parameter];
+        }
+        slot = (slot + 1) & (INDEX_SIZE - 1);
+    }
+    return nullptr;
+}
+
+uint32_t ConfigRegistry::nameHash(const ConfigParamDescriptor& descriptor) {
+    return parameterIndex().hashes[&descriptor - PARAMETERS];
+}
+
+// ================================================================================
+//                              WARTOŚCI PÓL
+// ================================================================================
+
+double ConfigRegistry::getValue(const MachineConfig& config, const ConfigParamDescriptor& descriptor) {
+    const uint8_t* field { reinterpret_cast<const uint8_t*>(&config) + descriptor.field.offset };
+    switch (descriptor.field.type) {
+        case JsonFieldType::BOOL: { bool flag; memcpy(&flag, field, sizeof(flag)); return flag ? 1.0 : 0.0; }
+        case JsonFieldType::FLOAT: { float number; memcpy(&number, field, sizeof(number)); return number; }
+        case JsonFieldType::SIGNED:
+            switch (descriptor.field.size) {
+                case sizeof(int8_t): { int8_t number; memcpy(&number, field, sizeof(number)); return number; }
+                case sizeof(int16_t): { int16_t number; memcpy(&number, field, sizeof(number)); return number; }
+                default: { int32_t number; memcpy(&number, field, sizeof(number)); return number; }
+            }
+        case JsonFieldType::UNSIGNED:
+            switch (descriptor.field.size) {
+                case sizeof(uint8_t): { uint8_t number; memcpy(&number, field, sizeof(number)); return number; }
+                case sizeof(uint16_t): { uint16_t number; memcpy(&number, field, sizeof(number)); return number; }
+                default: { uint32_t number; memcpy(&number, field, sizeof(number)); return number; }
+            }
+        case JsonFieldType::STRING:
+            break;
+    }
+    return 0.0;
+}
+
+bool ConfigRegistry::isValid(const ConfigParamDescriptor& descriptor, double value) {
+    if (isnan(value) || value < descriptor.minimum || value > descriptor.maximum) {
+        return false;
+    }
+    // Pola całkowite i logiczne przyjmują tylko wartości całkowite
+    return descriptor.field.type == JsonFieldType::FLOAT || floor(value) == value;
+}
+
+bool ConfigRegistry::setValue(MachineConfig& config, const ConfigParamDescriptor& descriptor, double value) {
+    if (!isValid(descriptor, value)) {
+        return false;
+    }
+
+    uint8_t* field { reinterpret_cast<uint8_t*>(&config) + descriptor.field.offset };
+    switch (descriptor.field.type) {
+        case JsonFieldType::BOOL: { const bool flag { value != 0.0 }; memcpy(field, &flag, sizeof(flag)); return true; }
+        case JsonFieldType::FLOAT: { const float number { static_cast<float>(value) }; memcpy(field, &number, sizeof(number)); return true; }
+        case JsonFieldType::SIGNED:
+            switch (descriptor.field.size) {
+                case sizeof(int8_t): { const int8_t number { static_cast<int8_t>(value) }; memcpy(field, &number, sizeof(number)); return true; }
+                case sizeof(int16_t): { const int16_t number { static_cast<int16_t>(value) }; memcpy(field, &number, sizeof(number)); return true; }
+                default: { const int32_t number { static_cast<int32_t>(value) }; memcpy(field, &number, sizeof(number)); return true; }
+            }
+        case JsonFieldType::UNSIGNED:
+            switch (descriptor.field.size) {
+                case sizeof(uint8_t): { const uint8_t number { static_cast<uint8_t>(value) }; memcpy(field, &number, sizeof(number)); return true; }
+                case sizeof(uint16_t): { const uint16_t number { static_cast<uint16_t>(value) }; memcpy(field, &number, sizeof(number)); return true; }
+                default: { const uint32_t number { static_cast<uint32_t>(value) }; memcpy(field, &number, sizeof(number)); return true; }
+            }
+        case JsonFieldType::STRING:
+            break;
+    }
+    return false;
+}
+
+void ConfigRegistry::loadDefaults(MachineConfig& config) {
+    for (const ConfigParamDescriptor& descriptor : PARAMETERS) {
+        setValue(config, descriptor, descriptor.defaultValue);
+    }
+}
+
+// ================================================================================
+//                                   JSON
+// ================================================================================
+
+void ConfigRegistry::writeJson(const MachineConfig& config, JsonWriter& writer) {
+    const char* openGroup { nullptr };
+    for (const ConfigParamDescriptor& descriptor : PARAMETERS) {
+        if (!sameGroup(descriptor.group, openGroup)) {
+            if (openGroup != nullptr) {
+                writer.endObject();
+            }
+            if (descriptor.group != nullptr) {
+                writer.beginObject(descriptor.group);
+            }
+            openGroup = descriptor.group;
+        }
+        writer.fields(&config, &descriptor.field, 1);
+    }
+    if (openGroup != nullptr) {
+        writer.endObject();
+    }
+}
+
+JsonVariantConst ConfigRegistry::jsonValue(JsonObjectConst root, const ConfigParamDescriptor& descriptor) {
+    return descriptor.group != nullptr ? root[descriptor.group][descriptor.field.key] : root[descriptor.field.key];
+}
+
+size_t ConfigRegistry::readJson(JsonObjectConst root, MachineConfig& config, const ConfigParamDescriptor** rejected, size_t capacity) {
+    // Zmiany na kopii - dokument z wartością spoza zakresu nie zmienia konfiguracji
+    MachineConfig updated { config };
+    size_t rejectedCount { 0 };
+    for (const ConfigParamDescriptor& descriptor : PARAMETERS) {
+        const JsonVariantConst value { jsonValue(root, descriptor) };
+
+        if (descriptor.field.type == JsonFieldType::BOOL) {
+            if (value.is<bool>()) {
+                setValue(updated, descriptor, value.as<bool>() ? 1.0 : 0.0);
+            }
+        }
+        else if (value.is<double>() && !setValue(updated, descriptor, value.as<double>())) {
+            if (rejected != nullptr && rejectedCount < capacity) {
+                rejected[rejectedCount] = &descriptor;
+            }
+            ++rejectedCount;
+        }
+    }
+
+    if (rejectedCount == 0) {
+        config = updated;
+    }
+    return rejectedCount;
+}
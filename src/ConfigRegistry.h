@@ -0,0 +1,67 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <utility>
+#include <ArduinoJson.h>
+
+#include "ConfigManager.h"
+#include "JsonWriter.h"
+
+// Opis parametru konfiguracji: położenie w MachineConfig, zakres, wartość domyślna i jednostka.
+// Jedna tablica opisów (ConfigRegistry.cpp) steruje wartościami domyślnymi, serializacją,
+// deserializacją z kontrolą zakresu i aktualizacją pojedynczego parametru po nazwie.
+struct ConfigParamDescriptor {
+    const char* group;          // Obiekt JSON grupy (np. "xAxis"); nullptr = pole na najwyższym poziomie
+    JsonFieldDescriptor field;  // Klucz JSON, rodzaj i położenie pola w MachineConfig
+    double minimum;
+    double maximum;
+    double defaultValue;
+    const char* unit;           // Jednostka wartości ("" = bezwymiarowa)
+};
+
+// Parametr wg składowej MachineConfig (także zagnieżdżonej, np. X.stepsPerMM) - rodzaj,
+// przesunięcie i rozmiar wyznaczane przez kompilator, tablica nie rozjedzie się ze strukturą
+#define CONFIG_PARAM(group, key, member, minimum, maximum, defaultValue, unit) \
+    ConfigParamDescriptor { group, JsonFieldDescriptor { key, \
+        jsonFieldType<decltype(std::declval<MachineConfig&>().member)>(), \
+        offsetof(MachineConfig, member), sizeof(std::declval<MachineConfig&>().member) }, \
+        minimum, maximum, defaultValue, unit }
+
+// Rejestr parametrów konfiguracji. Wyszukiwanie po nazwie ("xAxis.stepsPerMM", "fanPower")
+// przez tablicę mieszającą FNV-1a budowaną raz przy pierwszym użyciu.
+class ConfigRegistry {
+    public:
+    ConfigRegistry() = delete;
+
+    static const ConfigParamDescriptor* descriptors();
+    static size_t count();
+
+    // Opis parametru wg pełnej nazwy; nullptr = nieznany parametr
+    static const ConfigParamDescriptor* find(const char* name);
+
+    // Skrót FNV-1a pełnej nazwy - trwały identyfikator parametru w zapisie binarnym
+    static uint32_t nameHash(const ConfigParamDescriptor& descriptor);
+    static const ConfigParamDescriptor* findByHash(uint32_t hash);
+
+    // Wartość pola jako double (dokładna dla wszystkich typów całkowitych 32-bitowych)
+    static double getValue(const MachineConfig& config, const ConfigParamDescriptor& descriptor);
+
+    // Zapis wartości z kontrolą zakresu i całkowitości; false = wartość odrzucona (pole bez zmian)
+    static bool setValue(MachineConfig& config, const ConfigParamDescriptor& descriptor, double value);
+    static bool isValid(const ConfigParamDescriptor& descriptor, double value);
+
+    static void loadDefaults(MachineConfig& config);
+
+    // Konfiguracja jako pola obiektu JSON otwartego przez wywołującego (grupy jako obiekty zagnieżdżone)
+    static void writeJson(const MachineConfig& config, JsonWriter& writer);
+
+    // Wartość parametru w dokumencie JSON (pusta, gdy pola brak)
+    static JsonVariantConst jsonValue(JsonObjectConst root, const ConfigParamDescriptor& descriptor);
+
+    // Wartości z dokumentu JSON; brakujące pola i pola innego typu pozostają bez zmian.
+    // Wartość spoza zakresu odrzuca cały dokument (config niezmieniony). Zwraca liczbę odrzuconych pól,
+    // opisy pierwszych z nich (do capacity) trafiają do rejected
+    static size_t readJson(JsonObjectConst root, MachineConfig& config,
+        const ConfigParamDescriptor** rejected = nullptr, size_t capacity = 0);
+};
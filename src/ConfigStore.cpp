@@ -0,0 +1,286 @@
+// ================================================================================
+//                       KONFIGURACJA W NVS (ZAPIS BINARNY)
+// ================================================================================
+// Wersjonowany blok parametrów z sumą CRC32 - odczyt przy starcie bez karty SD i parsowania JSON
+
+#include "ConfigStore.h"
+
+#include <Preferences.h>
+#include <esp_crc.h>
+#include <string.h>
+
+#include "ConfigRegistry.h"
+#include "MaterialProfiles.h"
+#include "CONFIGURATION.H"
+
+namespace {
+    // Położenie pól nagłówka
+    constexpr size_t MAGIC_OFFSET { 0 };
+    constexpr size_t VERSION_OFFSET { 4 };
+    constexpr size_t COUNT_OFFSET { 6 };
+    constexpr size_t CRC_OFFSET { 8 };
+
+    template <typename T>
+    void writeValue(uint8_t* output, size_t offset, T value) {
+        memcpy(output + offset, &value, sizeof(T));
+    }
+
+    template <typename T>
+    T readValue(const uint8_t* input, size_t offset) {
+        T value;
+        memcpy(&value, input + offset, sizeof(T));
+        return value;
+    }
+
+    // Suma CRC nagłówka (bez pola CRC) i rekordów
+    uint32_t blockCrc(const uint8_t* data, size_t length) {
+        const uint32_t headerCrc { esp_crc32_le(0, data, CRC_OFFSET) };
+        return esp_crc32_le(headerCrc, data + ConfigStore::HEADER_SIZE, length - ConfigStore::HEADER_SIZE);
+    }
+
+    void writeHeader(uint8_t* buffer, uint32_t magic, uint16_t version, uint16_t count, size_t length) {
+        writeValue(buffer, MAGIC_OFFSET, magic);
+        writeValue(buffer, VERSION_OFFSET, version);
+        writeValue(buffer, COUNT_OFFSET, count);
+        writeValue(buffer, CRC_OFFSET, blockCrc(buffer, length));
+    }
+
+    // Nagłówek, rozmiar wg liczby rekordów i suma CRC; wynik: liczba rekordów lub -1
+    int checkHeader(const uint8_t* data, size_t length, uint32_t magic, size_t recordSize) {
+        if (data == nullptr || length < ConfigStore::HEADER_SIZE || readValue<uint32_t>(data, MAGIC_OFFSET) != magic) {
+            return -1;
+        }
+        const uint16_t count { readValue<uint16_t>(data, COUNT_OFFSET) };
+        if (length != ConfigStore::HEADER_SIZE + static_cast<size_t>(count) * recordSize
+            || readValue<uint32_t>(data, CRC_OFFSET) != blockCrc(data, length)) {
+            return -1;
+        }
+        return count;
+    }
+}
+
+static_assert(ConfigStore::HEADER_SIZE == CRC_OFFSET + sizeof(uint32_t), "Układ nagłówka ConfigStore");
+
+// ================================================================================
+//                             FORMAT BLOKU
+// ================================================================================
+
+size_t ConfigStore::encode(const MachineConfig& config, uint8_t* buffer, size_t capacity) {
+    const size_t count { ConfigRegistry::count() };
+    const size_t length { HEADER_SIZE + count * RECORD_SIZE };
+    if (buffer == nullptr || capacity < length || count > UINT16_MAX) {
+        return 0;
+    }
+
+    const ConfigParamDescriptor* descriptors { ConfigRegistry::descriptors() };
+    size_t offset { HEADER_SIZE };
+    for (size_t index { 0 }; index < count; ++index) {
+        const ConfigParamDescriptor& descriptor { descriptors[index] };
+        const double value { ConfigRegistry::getValue(config, descriptor) };
+
+        writeValue(buffer, offset, ConfigRegistry::nameHash(descriptor));
+        buffer[offset + 4] = static_cast<uint8_t>(descriptor.field.type);
+        switch (descriptor.field.type) {
+            case JsonFieldType::FLOAT: writeValue(buffer, offset + 5, static_cast<float>(value)); break;
+            case JsonFieldType::SIGNED: writeValue(buffer, offset + 5, static_cast<int32_t>(value)); break;
+            default: writeValue(buffer, offset + 5, static_cast<uint32_t>(value)); break;
+        }
+        offset += RECORD_SIZE;
+    }
+
+    writeHeader(buffer, MAGIC, VERSION, static_cast<uint16_t>(count), length);
+    return length;
+}
+
+ConfigStoreStatus ConfigStore::decode(const uint8_t* data, size_t length, MachineConfig& config) {
+    const int records { checkHeader(data, length, MAGIC, RECORD_SIZE) };
+    if (records < 0) {
+        return ConfigStoreStatus::CORRUPTED;
+    }
+    const uint16_t version { readValue<uint16_t>(data, VERSION_OFFSET) };
+    const uint16_t count { static_cast<uint16_t>(records) };
+    if (version > VERSION) {
+        return ConfigStoreStatus::UNSUPPORTED_VERSION;
+    }
+
+    // Parametry nieobecne w zapisie (dodane później) przyjmują wartości domyślne
+    MachineConfig decoded {};
+    ConfigRegistry::loadDefaults(decoded);
+
+    size_t offset { HEADER_SIZE };
+    for (uint16_t record { 0 }; record < count; ++record, offset += RECORD_SIZE) {
+        const ConfigParamDescriptor* descriptor { ConfigRegistry::findByHash(readValue<uint32_t>(data, offset)) };
+        if (descriptor == nullptr) {
+            continue;   // Parametr usunięty ze schematu
+        }
+
+        double value { 0.0 };
+        switch (static_cast<JsonFieldType>(data[offset + 4])) {
+            case JsonFieldType::FLOAT: value = readValue<float>(data, offset + 5); break;
+            case JsonFieldType::SIGNED: value = readValue<int32_t>(data, offset + 5); break;
+            case JsonFieldType::BOOL:
+            case JsonFieldType::UNSIGNED: value = readValue<uint32_t>(data, offset + 5); break;
+            default: continue;
+        }
+
+        // Wartość spoza bieżącego zakresu (np. po zawężeniu zakresu) - pozostaje domyślna
+        if (!ConfigRegistry::setValue(decoded, *descriptor, value)) {
+            #ifdef DEBUG_CONFIG_MANAGER
+            Serial.printf("DEBUG CONFIG: NVS value out of range: %s, default used\n", descriptor->field.key);
+            #endif
+        }
+    }
+
+    config = decoded;
+    return ConfigStoreStatus::OK;
+}
+
+// ================================================================================
+//                              PROFILE MATERIAŁÓW
+// ================================================================================
+
+size_t ConfigStore::encodeProfiles(const MaterialProfileTable& profiles, uint8_t* buffer, size_t capacity) {
+    if (buffer == nullptr || capacity < PROFILES_BLOB_MAX_SIZE) {
+        return 0;
+    }
+
+    // Tylko zajęte miejsca - pusta tablica to sam nagłówek
+    size_t offset { HEADER_SIZE };
+    uint16_t count { 0 };
+    for (size_t slot { 0 }; slot < CONFIG::MATERIAL_PROFILE_SLOTS; ++slot) {
+        const MaterialProfile& profile { profiles.slots[slot] };
+        if (!MaterialProfiles::isOccupied(profile)) {
+            continue;
+        }
+        buffer[offset] = static_cast<uint8_t>(slot);
+        memcpy(buffer + offset + 1, profile.name, sizeof(profile.name));
+        memcpy(buffer + offset + 1 + sizeof(profile.name), profile.values, sizeof(profile.values));
+        offset += PROFILE_RECORD_SIZE;
+        ++count;
+    }
+
+    writeHeader(buffer, PROFILES_MAGIC, PROFILES_VERSION, count, offset);
+    return offset;
+}
+
+ConfigStoreStatus ConfigStore::decodeProfiles(const uint8_t* data, size_t length, MaterialProfileTable& profiles) {
+    const int records { checkHeader(data, length, PROFILES_MAGIC, PROFILE_RECORD_SIZE) };
+    if (records < 0) {
+        return ConfigStoreStatus::CORRUPTED;
+    }
+    if (readValue<uint16_t>(data, VERSION_OFFSET) != PROFILES_VERSION) {
+        return ConfigStoreStatus::UNSUPPORTED_VERSION;
+    }
+
+    MaterialProfileTable decoded {};
+    size_t offset { HEADER_SIZE };
+    for (int record { 0 }; record < records; ++record, offset += PROFILE_RECORD_SIZE) {
+        const uint8_t slot { data[offset] };
+        if (slot >= CONFIG::MATERIAL_PROFILE_SLOTS) {
+            continue;
+        }
+
+        MaterialProfile profile {};
+        memcpy(profile.name, data + offset + 1, sizeof(profile.name));
+        profile.name[sizeof(profile.name) - 1] = '\0';
+        memcpy(profile.values, data + offset + 1 + sizeof(profile.name), sizeof(profile.values));
+
+        // Wartość spoza bieżącego zakresu (np. po zawężeniu zakresu) - profil pominięty
+        bool valid { true };
+        for (size_t index { 0 }; index < MaterialProfile::PARAMETER_COUNT; ++index) {
+            valid = valid && ConfigRegistry::isValid(MaterialProfiles::parameter(index), profile.values[index]);
+        }
+        if (!valid) {
+            #ifdef DEBUG_CONFIG_MANAGER
+            Serial.printf("DEBUG CONFIG: NVS profile out of range: %s, skipped\n", profile.name);
+            #endif
+            continue;
+        }
+        decoded.slots[slot] = profile;
+    }
+
+    decoded.version = profiles.version;
+    profiles = decoded;
+    return ConfigStoreStatus::OK;
+}
+
+// ================================================================================
+//                                 NVS
+// ================================================================================
+
+ConfigStoreStatus ConfigStore::readBlob(const char* key, uint8_t* buffer, size_t capacity, size_t& length) {
+    Preferences preferences {};
+    if (!preferences.begin(CONFIG::CONFIG_NVS_NAMESPACE, true)) {
+        // Przestrzeń nazw jeszcze nie istnieje - brak zapisu
+        return ConfigStoreStatus::NOT_FOUND;
+    }
+
+    length = preferences.getBytesLength(key);
+    if (length == 0) {
+        preferences.end();
+        return ConfigStoreStatus::NOT_FOUND;
+    }
+    if (length > capacity) {
+        preferences.end();
+        return ConfigStoreStatus::CORRUPTED;
+    }
+
+    const size_t received { preferences.getBytes(key, buffer, length) };
+    preferences.end();
+    return received == length ? ConfigStoreStatus::OK : ConfigStoreStatus::NVS_ERROR;
+}
+
+ConfigStoreStatus ConfigStore::writeBlob(const char* key, const uint8_t* data, size_t length) {
+    Preferences preferences {};
+    if (!preferences.begin(CONFIG::CONFIG_NVS_NAMESPACE, false)) {
+        return ConfigStoreStatus::NVS_ERROR;
+    }
+    const size_t written { preferences.putBytes(key, data, length) };
+    preferences.end();
+
+    return written == length ? ConfigStoreStatus::OK : ConfigStoreStatus::NVS_ERROR;
+}
+
+ConfigStoreStatus ConfigStore::load(MachineConfig& config) {
+    uint8_t blob[CONFIG::CONFIG_BLOB_MAX_SIZE];
+    size_t length { 0 };
+    const ConfigStoreStatus status { readBlob(CONFIG::CONFIG_NVS_KEY, blob, sizeof(blob), length) };
+    return status == ConfigStoreStatus::OK ? decode(blob, length, config) : status;
+}
+
+ConfigStoreStatus ConfigStore::save(const MachineConfig& config) {
+    uint8_t blob[CONFIG::CONFIG_BLOB_MAX_SIZE];
+    const size_t length { encode(config, blob, sizeof(blob)) };
+    if (length == 0) {
+        return ConfigStoreStatus::BUFFER_TOO_SMALL;
+    }
+    return writeBlob(CONFIG::CONFIG_NVS_KEY, blob, length);
+}
+
+ConfigStoreStatus ConfigStore::loadProfiles(MaterialProfileTable& profiles) {
+    uint8_t blob[PROFILES_BLOB_MAX_SIZE];
+    size_t length { 0 };
+    const ConfigStoreStatus status { readBlob(CONFIG::PROFILES_NVS_KEY, blob, sizeof(blob), length) };
+    return status == ConfigStoreStatus::OK ? decodeProfiles(blob, length, profiles) : status;
+}
+
+ConfigStoreStatus ConfigStore::saveProfiles(const MaterialProfileTable& profiles) {
+    uint8_t blob[PROFILES_BLOB_MAX_SIZE];
+    const size_t length { encodeProfiles(profiles, blob, sizeof(blob)) };
+    if (length == 0) {
+        return ConfigStoreStatus::BUFFER_TOO_SMALL;
+    }
+    return writeBlob(CONFIG::PROFILES_NVS_KEY, blob, length);
+}
+
+const char* ConfigStore::statusName(ConfigStoreStatus status) {
+    switch (status) {
+        case ConfigStoreStatus::OK: return "OK";
+        case ConfigStoreStatus::NOT_FOUND: return "NOT_FOUND";
+        case ConfigStoreStatus::CORRUPTED: return "CORRUPTED";
+        case ConfigStoreStatus::UNSUPPORTED_VERSION: return "UNSUPPORTED_VERSION";
+        case ConfigStoreStatus::BUFFER_TOO_SMALL: return "BUFFER_TOO_SMALL";
+        case ConfigStoreStatus::NVS_ERROR: return "NVS_ERROR";
+    }
+    return "UNKNOWN";
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "ConfigManager.h"
+
+enum class ConfigStoreStatus {
+    OK,
+    NOT_FOUND,              // Brak zapisu w NVS (pierwsze uruchomienie)
+    CORRUPTED,              // Zły nagłówek, rozmiar lub suma CRC
+    UNSUPPORTED_VERSION,    // Zapis nowszego oprogramowania
+    BUFFER_TOO_SMALL,
+    NVS_ERROR
+};
+
+// Aktywna konfiguracja w NVS jako wersjonowany blok binarny z sumą CRC32.
+//
+// Układ (kolejność bajtów procesora): nagłówek { magic, version, recordCount, crc32 } i rekordy
+// { skrót nazwy parametru (ConfigRegistry::nameHash), rodzaj pola, 4 B wartości }.
+// Rekordy identyfikowane skrótem nazwy: parametry dodane w nowszej wersji przyjmują
+// wartości domyślne, usunięte są pomijane, zmiana typu pola jest przeliczana.
+// Schemat nie przekształca wartości między wersjami - zmiana znaczenia parametru (np. jednostki)
+// wymaga nowej nazwy w rejestrze (stary zapis przyjmie wtedy wartość domyślną).
+// VERSION odrzuca wyłącznie zapisy nowszego oprogramowania.
+//
+// Profile materiałów zapisywane są osobnym blokiem z tym samym nagłówkiem: tylko zajęte miejsca,
+// rekord { numer miejsca, nazwa, wartości parametrów wg MaterialProfiles::parameter() }.
+class ConfigStore {
+    public:
+    static constexpr uint32_t MAGIC { 0x47464E43 };     // "CNFG"
+    static constexpr uint16_t VERSION { 1 };
+    static constexpr size_t HEADER_SIZE { 12 };
+    static constexpr size_t RECORD_SIZE { 9 };
+
+    static constexpr uint32_t PROFILES_MAGIC { 0x4C465250 };    // "PRFL"
+    static constexpr uint16_t PROFILES_VERSION { 1 };       // Zmiana listy parametrów profilu = nowa wersja
+    static constexpr size_t PROFILE_RECORD_SIZE { 1 + CONFIG::MATERIAL_PROFILE_NAME_LENGTH + MaterialProfile::PARAMETER_COUNT * sizeof(float) };
+    static constexpr size_t PROFILES_BLOB_MAX_SIZE { HEADER_SIZE + CONFIG::MATERIAL_PROFILE_SLOTS * PROFILE_RECORD_SIZE };
+
+    ConfigStore() = delete;
+
+    // Serializacja do bufora; zwraca rozmiar bloku lub 0, gdy bufor jest za mały
+    static size_t encode(const MachineConfig& config, uint8_t* buffer, size_t capacity);
+
+    // Odczyt bloku: wartości domyślne, rekordy w zakresie, migracja ze starszej wersji
+    static ConfigStoreStatus decode(const uint8_t* data, size_t length, MachineConfig& config);
+
+    // Zapis i odczyt bloku w NVS (przestrzeń CONFIG::CONFIG_NVS_NAMESPACE)
+    static ConfigStoreStatus load(MachineConfig& config);
+    static ConfigStoreStatus save(const MachineConfig& config);
+
+    // Blok profili materiałów; rekordy z wartością spoza zakresu są pomijane (miejsce wolne)
+    static size_t encodeProfiles(const MaterialProfileTable& profiles, uint8_t* buffer, size_t capacity);
+    static ConfigStoreStatus decodeProfiles(const uint8_t* data, size_t length, MaterialProfileTable& profiles);
+    static ConfigStoreStatus loadProfiles(MaterialProfileTable& profiles);
+    static ConfigStoreStatus saveProfiles(const MaterialProfileTable& profiles);
+
+    static const char* statusName(ConfigStoreStatus status);
+
+    private:
+    // Odczyt i zapis bloku pod kluczem w przestrzeni CONFIG::CONFIG_NVS_NAMESPACE
+    static ConfigStoreStatus readBlob(const char* key, uint8_t* buffer, size_t capacity, size_t& length);
+    static ConfigStoreStatus writeBlob(const char* key, const uint8_t* data, size_t length);
+};
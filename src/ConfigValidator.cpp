@@ -0,0 +1,227 @@
+// ================================================================================
+//                          WALIDACJA KONFIGURACJI MASZYNY
+// ================================================================================
+// Reguły międzypolowe sprawdzane przed publikacją konfiguracji i przed startem zadania:
+// granice generatora kroków, rozdzielczość profilu prędkości, zakres przejazdu, geometria
+
+#include "ConfigValidator.h"
+
+#include <math.h>
+#include <stdio.h>
+
+namespace {
+    constexpr double TICK_PERIOD_S { CONFIG::STEPPER_TIMER_FREQUENCY_US / 1000000.0 };
+    constexpr double MIN_RAMP_TIME_S { CONFIG::MIN_RAMP_TICKS * TICK_PERIOD_S };
+
+    // Najdłuższe opóźnienie filtra mieszczące się w historii InputShaper (z zapasem na interpolację)
+    constexpr double SHAPER_MAX_DELAY_S { (CONFIG::SHAPER_HISTORY_SIZE - 2) * CONFIG::SHAPER_SAMPLE_TICKS * TICK_PERIOD_S };
+
+    // Nazwy parametrów osi w rejestrze
+    struct AxisParameters {
+        const char* rapidFeedRate;
+        const char* rapidAcceleration;
+        const char* workFeedRate;
+        const char* workAcceleration;
+        const char* offset;
+        const char* shaperFrequency;
+        const char* shaperDamping;
+    };
+
+    constexpr AxisParameters AXIS_PARAMETERS[] {
+        { "xAxis.rapidFeedRate", "xAxis.rapidAcceleration", "xAxis.workFeedRate", "xAxis.workAcceleration",
+          "xAxis.offset", "xAxis.shaperFrequency", "xAxis.shaperDamping" },
+        { "yAxis.rapidFeedRate", "yAxis.rapidAcceleration", "yAxis.workFeedRate", "yAxis.workAcceleration",
+          "yAxis.offset", "yAxis.shaperFrequency", "yAxis.shaperDamping" },
+    };
+
+    // Prędkość [jednostki/s] przeliczona na kroki nie może przekroczyć jednego kroku na cykl timera
+    void checkStepRate(ConfigValidationReport& report, const char* name, double speed, double stepsPerUnit) {
+        if (speed * stepsPerUnit > ConfigValidator::MAX_STEP_RATE) {
+            report.add(ConfigRegistry::find(name), ConfigRule::STEP_RATE, speed, ConfigValidator::MAX_STEP_RATE / stepsPerUnit);
+        }
+    }
+
+    // Czas rozpędzania do prędkości: krótszy od kilku cykli timera to skok prędkości,
+    // wielokrotnie dłuższy od ruchu oznacza pomyłkę w jednostkach
+    void checkRamp(ConfigValidationReport& report, const char* name, double speed, double acceleration) {
+        if (speed <= 0.0 || acceleration <= 0.0) {
+            return;     // Wartości niedodatnie zgłasza kontrola zakresu
+        }
+        const double rampTime { speed / acceleration };
+        if (rampTime < MIN_RAMP_TIME_S) {
+            report.add(ConfigRegistry::find(name), ConfigRule::RAMP_TOO_SHORT, acceleration, speed / MIN_RAMP_TIME_S);
+        }
+        else if (rampTime > CONFIG::MAX_RAMP_TIME_S) {
+            report.add(ConfigRegistry::find(name), ConfigRule::RAMP_TOO_LONG, acceleration, speed / CONFIG::MAX_RAMP_TIME_S);
+        }
+    }
+
+    // Filtr kształtujący: tłumienie poniżej 1 i najdłuższe opóźnienie w historii próbek
+    void checkShaper(ConfigValidationReport& report, const AxisParameters& names, const MachineConfig::MotorConfig& motor) {
+        if (motor.shaperType == 0) {
+            return;
+        }
+        if (motor.shaperDamping >= 1.0f) {
+            report.add(ConfigRegistry::find(names.shaperDamping), ConfigRule::SHAPER, motor.shaperDamping, 1.0);
+            return;
+        }
+
+        // Ostatni impuls: ZV - pół okresu, MZV - 3/4 okresu drgań tłumionych
+        const double delayPeriods { motor.shaperType == 1 ? 0.5 : 0.75 };
+        const double dampingFactor { sqrt(1.0 - static_cast<double>(motor.shaperDamping) * motor.shaperDamping) };
+        const double minimumFrequency { delayPeriods / (SHAPER_MAX_DELAY_S * dampingFactor) };
+        if (motor.shaperFrequency <= minimumFrequency) {
+            report.add(ConfigRegistry::find(names.shaperFrequency), ConfigRule::SHAPER, motor.shaperFrequency, minimumFrequency);
+        }
+    }
+}
+
+// ================================================================================
+//                                   RAPORT
+// ================================================================================
+
+void ConfigValidationReport::add(const ConfigParamDescriptor* parameter, ConfigRule rule, double value, double limit) {
+    if (count < CONFIG::CONFIG_VALIDATION_MAX_ERRORS) {
+        ConfigValidationError& error { errors[count++] };
+        error.parameter = parameter;
+        error.rule = rule;
+        error.value = value;
+        error.limit = limit;
+    }
+    ++total;
+}
+
+// ================================================================================
+//                                  REGUŁY
+// ================================================================================
+
+bool ConfigValidator::validate(const MachineConfig& config, ConfigValidationReport& report) {
+    const size_t errorsBefore { report.total };
+
+    // Zakresy pojedynczych pól - wszystkie naruszenia, nie tylko pierwsze
+    const ConfigParamDescriptor* descriptors { ConfigRegistry::descriptors() };
+    for (size_t index { 0 }; index < ConfigRegistry::count(); ++index) {
+        const ConfigParamDescriptor& descriptor { descriptors[index] };
+        const double value { ConfigRegistry::getValue(config, descriptor) };
+        if (!ConfigRegistry::isValid(descriptor, value)) {
+            addRangeError(report, descriptor, value);
+        }
+    }
+
+    // Osie: prędkości w krokach, profile przyspieszeń, filtry kształtujące, przesunięcie w zakresie przejazdu
+    const MachineConfig::MotorConfig* motors[] { &config.X, &config.Y };
+    for (size_t axis { 0 }; axis < 2; ++axis) {
+        const AxisParameters& names { AXIS_PARAMETERS[axis] };
+        const MachineConfig::MotorConfig& motor { *motors[axis] };
+
+        checkStepRate(report, names.rapidFeedRate, motor.rapidFeedRate, 1.0);
+        checkStepRate(report, names.workFeedRate, motor.workFeedRate, 1.0);
+        checkRamp(report, names.rapidAcceleration, motor.rapidFeedRate, motor.rapidAcceleration);
+        checkRamp(report, names.workAcceleration, motor.workFeedRate, motor.workAcceleration);
+
+        // Korekta posuwu powyżej 100% ograniczona jest prędkością szybką osi
+        if (motor.workFeedRate > motor.rapidFeedRate) {
+            report.add(ConfigRegistry::find(names.workFeedRate), ConfigRule::ABOVE_RAPID, motor.workFeedRate, motor.rapidFeedRate);
+        }
+
+        checkShaper(report, names, motor);
+
+        if (fabsf(motor.offset) > config.homing.maxTravel) {
+            report.add(ConfigRegistry::find(names.offset), ConfigRule::TRAVEL, motor.offset, config.homing.maxTravel);
+        }
+    }
+
+    // Bazowanie - prędkości w mm/s dla osi o większej rozdzielczości
+    const double homingStepsPerMM { fmaxf(config.X.stepsPerMM, config.Y.stepsPerMM) };
+    const MachineConfig::HomingConfig& homing { config.homing };
+    checkStepRate(report, "homing.seekSpeed", homing.seekSpeed, homingStepsPerMM);
+    checkRamp(report, "homing.acceleration", homing.seekSpeed, homing.acceleration);
+    if (homing.approachSpeed > homing.seekSpeed) {
+        report.add(ConfigRegistry::find("homing.approachSpeed"), ConfigRule::HOMING_SPEED, homing.approachSpeed, homing.seekSpeed);
+    }
+    if (homing.backoffDistance >= homing.maxTravel) {
+        report.add(ConfigRegistry::find("homing.backoffDistance"), ConfigRule::TRAVEL, homing.backoffDistance, homing.maxTravel);
+    }
+    if (homing.pulloffDistance >= homing.maxTravel) {
+        report.add(ConfigRegistry::find("homing.pulloffDistance"), ConfigRule::TRAVEL, homing.pulloffDistance, homing.maxTravel);
+    }
+
+    // Kinematyka - blok o niezerowej szerokości między wieżami (jak Kinematics::validate)
+    const MachineConfig::KinematicsConfig& kinematics { config.kinematics };
+    if (kinematics.enabled) {
+        const double availableWidth { kinematics.towerDistance - kinematics.blockOffset };
+        if (availableWidth <= 0.0) {
+            report.add(ConfigRegistry::find("kinematics.blockOffset"), ConfigRule::KINEMATICS, kinematics.blockOffset, kinematics.towerDistance);
+        }
+        else if (kinematics.blockWidth <= 0.0f || kinematics.blockWidth > availableWidth) {
+            report.add(ConfigRegistry::find("kinematics.blockWidth"), ConfigRule::KINEMATICS, kinematics.blockWidth, availableWidth);
+        }
+    }
+
+    return report.total == errorsBefore;
+}
+
+void ConfigValidator::addRangeError(ConfigValidationReport& report, const ConfigParamDescriptor& descriptor, double value) {
+    report.add(&descriptor, ConfigRule::RANGE, value, value < descriptor.minimum ? descriptor.minimum : descriptor.maximum);
+}
+
+// ================================================================================
+//                                   OPISY
+// ================================================================================
+
+const char* ConfigValidator::ruleName(ConfigRule rule) {
+    switch (rule) {
+        case ConfigRule::RANGE: return "range";
+        case ConfigRule::STEP_RATE: return "stepRate";
+        case ConfigRule::RAMP_TOO_SHORT: return "rampTooShort";
+        case ConfigRule::RAMP_TOO_LONG: return "rampTooLong";
+        case ConfigRule::ABOVE_RAPID: return "aboveRapid";
+        case ConfigRule::SHAPER: return "shaper";
+        case ConfigRule::TRAVEL: return "travel";
+        case ConfigRule::HOMING_SPEED: return "homingSpeed";
+        case ConfigRule::KINEMATICS: return "kinematics";
+    }
+    return "unknown";
+}
+
+const char* ConfigValidator::ruleMessage(ConfigRule rule) {
+    switch (rule) {
+        case ConfigRule::RANGE: return "Value outside allowed range";
+        case ConfigRule::STEP_RATE: return "Speed exceeds step timer rate";
+        case ConfigRule::RAMP_TOO_SHORT: return "Acceleration too high for step timer resolution";
+        case ConfigRule::RAMP_TOO_LONG: return "Acceleration too low for feed rate";
+        case ConfigRule::ABOVE_RAPID: return "Work feed rate exceeds rapid feed rate";
+        case ConfigRule::SHAPER: return "Input shaper cannot be realized";
+        case ConfigRule::TRAVEL: return "Distance exceeds axis travel";
+        case ConfigRule::HOMING_SPEED: return "Approach speed exceeds seek speed";
+        case ConfigRule::KINEMATICS: return "Block does not fit between towers";
+    }
+    return "Invalid value";
+}
+
+void ConfigValidator::writeJson(const ConfigValidationReport& report, JsonWriter& writer) {
+    writer.field("errorCount", static_cast<unsigned long>(report.total));
+    writer.beginArray("errors");
+    for (size_t index { 0 }; index < report.count; ++index) {
+        const ConfigValidationError& error { report.errors[index] };
+
+        // Pełna nazwa pola jak w ConfigRegistry::find() i atrybutach name formularza
+        char field[64] { "" };
+        if (error.parameter != nullptr) {
+            snprintf(field, sizeof(field), "%s%s%s", error.parameter->group != nullptr ? error.parameter->group : "",
+                error.parameter->group != nullptr ? "." : "", error.parameter->field.key);
+        }
+
+        writer.beginObject();
+        writer.field("field", static_cast<const char*>(field));
+        writer.field("rule", ruleName(error.rule));
+        writer.field("message", ruleMessage(error.rule));
+        writer.field("value", error.value);
+        writer.field("limit", error.limit);
+        if (error.parameter != nullptr) {
+            writer.field("unit", error.parameter->unit);
+        }
+        writer.endObject();
+    }
+    writer.endArray();
+}
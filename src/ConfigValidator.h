@@ -0,0 +1,65 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "ConfigManager.h"
+#include "ConfigRegistry.h"
+#include "JsonWriter.h"
+#include "CONFIGURATION.H"
+
+// Rodzaj naruszonej reguły
+enum class ConfigRule {
+    RANGE,              // Wartość spoza zakresu parametru w rejestrze
+    STEP_RATE,          // Prędkość wymaga więcej niż jednego kroku na cykl timera
+    RAMP_TOO_SHORT,     // Rozpędzanie krótsze niż MIN_RAMP_TICKS - skok prędkości, utrata kroków
+    RAMP_TOO_LONG,      // Rozpędzanie dłuższe niż MAX_RAMP_TIME_S
+    ABOVE_RAPID,        // Prędkość robocza powyżej szybkiej (korekta posuwu ograniczona prędkością szybką)
+    SHAPER,             // Filtr kształtujący niemożliwy do odwzorowania (opóźnienie, tłumienie)
+    TRAVEL,             // Przesunięcie lub droga poza zakresem przejazdu osi
+    HOMING_SPEED,       // Dojazd precyzyjny szybszy od wyszukiwania krańcówki
+    KINEMATICS          // Blok nie mieści się między wieżami
+};
+
+// Błąd pojedynczego pola: wartość i granica w jednostkach pola
+struct ConfigValidationError {
+    const ConfigParamDescriptor* parameter { nullptr };
+    ConfigRule rule { ConfigRule::RANGE };
+    double value { 0.0 };
+    double limit { 0.0 };
+};
+
+// Wynik walidacji - pierwsze CONFIG_VALIDATION_MAX_ERRORS błędów i łączna liczba wykrytych
+struct ConfigValidationReport {
+    ConfigValidationError errors[CONFIG::CONFIG_VALIDATION_MAX_ERRORS] {};
+    size_t count { 0 };
+    size_t total { 0 };
+
+    bool isValid() const { return total == 0; }
+    void clear() { count = 0; total = 0; }
+    void add(const ConfigParamDescriptor* parameter, ConfigRule rule, double value, double limit);
+};
+
+// Walidacja całej konfiguracji przed publikacją: zakresy pól z rejestru, możliwości generatora
+// kroków (jeden krok na cykl timera STEPPER_TIMER_FREQUENCY_US na oś), rozdzielczość profilu
+// prędkości, zakres przejazdu i zależności między parametrami.
+class ConfigValidator {
+    public:
+    // Największa prędkość osi [steps/s] - jeden krok na cykl timera
+    static constexpr double MAX_STEP_RATE { 1000000.0 / CONFIG::STEPPER_TIMER_FREQUENCY_US };
+
+    ConfigValidator() = delete;
+
+    // true = konfiguracja poprawna; błędy dopisywane do raportu
+    static bool validate(const MachineConfig& config, ConfigValidationReport& report);
+
+    // Błąd zakresu pola z granicą, którą przekroczyła wartość
+    static void addRangeError(ConfigValidationReport& report, const ConfigParamDescriptor& descriptor, double value);
+
+    // Identyfikator reguły w odpowiedzi API ("stepRate") i opis dla operatora
+    static const char* ruleName(ConfigRule rule);
+    static const char* ruleMessage(ConfigRule rule);
+
+    // Pole "errors" (tablica { field, rule, message, value, limit }) i "errorCount" w otwartym obiekcie
+    static void writeJson(const ConfigValidationReport& report, JsonWriter& writer);
+};
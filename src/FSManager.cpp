@@ -5,8 +5,13 @@
 // Używany do przechowywania plików webowych i konfiguracji lokalnej
 
 #include "FSManager.h"
+#include "ArduinoFSStorage.h"
 #include <LittleFS.h>
 
+namespace {
+    ArduinoFSStorage flashStorage { LittleFS };
+}
+
 // ================================================================================
 //                            INICJALIZACJA SYSTEMU
 // ================================================================================
@@ -18,4 +23,8 @@ FSManagerStatus FSManager::init() {
     }
 
     return FSManagerStatus::OK;
-}
\ No newline at end of file
+}
+
+Storage& FSManager::getStorage() {
+    return flashStorage;
+}
@@ -1,5 +1,7 @@
 #pragma once
 
+#include "Storage.h"
+
 // Used to track (and handle) various error conditions that may occur
 enum class FSManagerStatus {
     OK,
@@ -19,4 +21,7 @@ class FSManager {
     // This function attempts to mount the LittleFS filesystem.
     // The filesystem is crucial for storing web server files (HTML, JS, CSS).
     FSManagerStatus init();
+
+    // System plików LittleFS przez interfejs Storage (po udanym init())
+    Storage& getStorage();
 };
@@ -0,0 +1,93 @@
+// ================================================================================
+//                        ANALIZA PLIKU G-CODE (METADANE)
+// ================================================================================
+// Liczba linii i zakres ruchów liczone w jednym przebiegu bez przechowywania pliku
+
+#include "GCodeAnalyzer.h"
+
+#include <math.h>
+
+void GCodeAnalyzer::reset() {
+    *this = GCodeAnalyzer {};
+}
+
+void GCodeAnalyzer::feed(const uint8_t* data, size_t length) {
+    if (data == nullptr) {
+        return;
+    }
+
+    for (size_t index { 0 }; index < length; ++index) {
+        const char character { static_cast<char>(data[index]) };
+        if (character == '\n') {
+            ++lineCount;
+            lineBuffer[lineLength] = '\0';
+            if (!lineTruncated) {
+                processLine();
+            }
+            lineLength = 0;
+            lineTruncated = false;
+        }
+        else if (lineLength < sizeof(lineBuffer) - 1) {
+            lineBuffer[lineLength++] = character;
+        }
+        else {
+            lineTruncated = true;
+        }
+    }
+}
+
+void GCodeAnalyzer::finish() {
+    if (lineLength > 0 || lineTruncated) {
+        ++lineCount;
+        lineBuffer[lineLength] = '\0';
+        if (!lineTruncated) {
+            processLine();
+        }
+    }
+    lineLength = 0;
+    lineTruncated = false;
+}
+
+void GCodeAnalyzer::processLine() {
+    if (!parser.parseLine(lineBuffer)) {
+        return;
+    }
+
+    const float positionX { parser.getX() };
+    const float positionY { parser.getY() };
+    if (moveCount == 0) {
+        minX = maxX = positionX;
+        minY = maxY = positionY;
+    }
+    else {
+        minX = fminf(minX, positionX);
+        maxX = fmaxf(maxX, positionX);
+        minY = fminf(minY, positionY);
+        maxY = fmaxf(maxY, positionY);
+    }
+    ++moveCount;
+}
+
+uint32_t GCodeAnalyzer::getLineCount() const {
+    return lineCount;
+}
+
+uint32_t GCodeAnalyzer::getMoveCount() const {
+    return moveCount;
+}
+
+float GCodeAnalyzer::getMinX() const {
+    return minX;
+}
+
+float GCodeAnalyzer::getMinY() const {
+    return minY;
+}
+
+float GCodeAnalyzer::getMaxX() const {
+    return maxX;
+}
+
+float GCodeAnalyzer::getMaxY() const {
+    return maxY;
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <Arduino.h>
+
+#include "CONFIGURATION.h"
+#include "GCodeLineParser.h"
+
+// Statystyki pliku G-code liczone strumieniowo (dane podawane dowolnymi porcjami):
+// liczba linii oraz zakres współrzędnych XY celów ruchów G0/G1 (modalnych, z obsługą G90/G91).
+// Używane przy przesyłaniu projektu i przy analizie plików w katalogu projektów.
+class GCodeAnalyzer {
+    private:
+    char lineBuffer[CONFIG::PREVIEW_MAX_LINE_LENGTH] {};
+    size_t lineLength { 0 };
+    bool lineTruncated { false };
+
+    GCodeLineParser parser {};
+
+    uint32_t lineCount { 0 };
+    uint32_t moveCount { 0 };
+    float minX { 0.0f };
+    float minY { 0.0f };
+    float maxX { 0.0f };
+    float maxY { 0.0f };
+
+    void processLine();
+
+    public:
+    GCodeAnalyzer() = default;
+
+    void reset();
+
+    // Kolejna porcja pliku
+    void feed(const uint8_t* data, size_t length);
+
+    // Koniec pliku - ostatnia linia bez znaku końca linii
+    void finish();
+
+    uint32_t getLineCount() const;
+    uint32_t getMoveCount() const;
+
+    // Zakres celów ruchów [mm]; zera przy braku ruchów
+    float getMinX() const;
+    float getMinY() const;
+    float getMaxX() const;
+    float getMaxY() const;
+};
@@ -0,0 +1,113 @@
+// ================================================================================
+//                     INTERPRETER LINII G-CODE (ANALIZA, PODGLĄD)
+// ================================================================================
+// Modalne G0/G1 i G90/G91 interpretowane bez alokacji i bez strtof
+
+#include "GCodeLineParser.h"
+
+#include <ctype.h>
+
+void GCodeLineParser::reset() {
+    *this = GCodeLineParser {};
+}
+
+bool GCodeLineParser::parseLine(const char* line) {
+    if (line == nullptr) {
+        return false;
+    }
+
+    bool hasX { false };
+    bool hasY { false };
+    bool axisWordsUsed { false };   // Współrzędne należą do komendy innej niż ruch (G92, G28...)
+    float x { 0.0f };
+    float y { 0.0f };
+
+    const char* cursor { line };
+    while (*cursor != '\0') {
+        const char letter { static_cast<char>(toupper(static_cast<unsigned char>(*cursor))) };
+
+        // Komentarz do końca linii
+        if (letter == ';' || letter == '(') {
+            break;
+        }
+        ++cursor;
+
+        float number { 0.0f };
+        if (letter == 'G' && parseNumber(cursor, number)) {
+            const int code { static_cast<int>(number) };
+            if (code == 0 || code == 1) {
+                motion = static_cast<int8_t>(code);
+            }
+            else if (code == 2 || code == 3) {
+                // Łuki nie są wykonywane - kolejne linie bez G0/G1 nie są ruchem liniowym
+                motion = -1;
+            }
+            else if (code == 90) {
+                relativeMode = false;
+            }
+            else if (code == 91) {
+                relativeMode = true;
+            }
+            else if (code == 4 || code == 10 || code == 28 || code == 30 || code == 92) {
+                axisWordsUsed = true;
+            }
+        }
+        else if (letter == 'X' && parseNumber(cursor, number)) {
+            x = number;
+            hasX = true;
+        }
+        else if (letter == 'Y' && parseNumber(cursor, number)) {
+            y = number;
+            hasY = true;
+        }
+    }
+
+    if (motion < 0 || axisWordsUsed || (!hasX && !hasY)) {
+        return false;
+    }
+
+    positionX = hasX ? (relativeMode ? positionX + x : x) : positionX;
+    positionY = hasY ? (relativeMode ? positionY + y : y) : positionY;
+    return true;
+}
+
+float GCodeLineParser::getX() const {
+    return positionX;
+}
+
+float GCodeLineParser::getY() const {
+    return positionY;
+}
+
+bool GCodeLineParser::isRapid() const {
+    return motion == 0;
+}
+
+bool GCodeLineParser::parseNumber(const char*& cursor, float& number) {
+    bool negative { false };
+    if (*cursor == '-' || *cursor == '+') {
+        negative = *cursor == '-';
+        ++cursor;
+    }
+
+    float result { 0.0f };
+    bool digits { false };
+    while (*cursor >= '0' && *cursor <= '9') {
+        result = result * 10.0f + static_cast<float>(*cursor - '0');
+        digits = true;
+        ++cursor;
+    }
+    if (*cursor == '.') {
+        ++cursor;
+        float scale { 0.1f };
+        while (*cursor >= '0' && *cursor <= '9') {
+            result += static_cast<float>(*cursor - '0') * scale;
+            scale *= 0.1f;
+            digits = true;
+            ++cursor;
+        }
+    }
+
+    number = negative ? -result : result;
+    return digits;
+}
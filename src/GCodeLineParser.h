@@ -0,0 +1,31 @@
+#pragma once
+
+#include <stdint.h>
+
+// Interpreter ruchów G0/G1 linia po linii, wspólny dla analizy plików (GCodeAnalyzer)
+// i podglądu ścieżki (ToolpathPreview). Tryb ruchu i tryb współrzędnych (G90/G91) są modalne
+// jak w wykonaniu programu - linia z samymi współrzędnymi kontynuuje ostatni G0/G1.
+class GCodeLineParser {
+    private:
+    bool relativeMode { false };
+    int8_t motion { -1 };       // Modalny tryb ruchu: 0 = G0, 1 = G1, -1 = brak (lub nieobsługiwany G2/G3)
+    float positionX { 0.0f };   // Cel ostatniego ruchu [mm]
+    float positionY { 0.0f };
+
+    public:
+    GCodeLineParser() = default;
+
+    void reset();
+
+    // Interpretacja linii zakończonej '\0' (bez znaku końca linii); true = ruch do getX()/getY()
+    bool parseLine(const char* line);
+
+    float getX() const;
+    float getY() const;
+
+    // true = ostatni ruch szybki (G0)
+    bool isRapid() const;
+
+    // Liczba z pola G-code (znak, cyfry, część dziesiętna) bez strtof; false = brak cyfr
+    static bool parseNumber(const char*& cursor, float& number);
+};
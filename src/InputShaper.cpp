@@ -0,0 +1,141 @@
+// ================================================================================
+//                      KSZTAŁTOWANIE WEJŚCIA (INPUT SHAPING)
+// ================================================================================
+// Filtry ZV/MZV tłumiące rezonans bramy przed generowaniem kroków
+// Pozwalają zwiększyć przyspieszenia bez widocznych falowań na krawędziach cięcia
+
+#include "InputShaper.h"
+#include <Arduino.h>
+#include <math.h>
+
+// ================================================================================
+//                            KONFIGURACJA FILTRA
+// ================================================================================
+
+bool InputShaper::configure(ShaperType type, float frequency, float damping) {
+    // Domyślnie brak kształtowania - pojedynczy impuls bez opóźnienia
+    impulseCount = 1;
+    amplitudes[0] = 1.0f;
+    delayTicks[0] = 0.0f;
+
+    if (type == ShaperType::NONE) {
+        return true;
+    }
+
+    if (frequency <= 0.0f || damping < 0.0f || damping >= 1.0f) {
+        return false;
+    }
+
+    // Okres drgań tłumionych i stosunek amplitud kolejnych półokresów
+    const float dampingFactor { sqrtf(1.0f - damping * damping) };
+    const float dampedPeriod { 1.0f / (frequency * dampingFactor) }; // [s]
+    const float tickPeriod { CONFIG::STEPPER_TIMER_FREQUENCY_US / 1000000.0f }; // [s]
+
+    float newAmplitudes[MAX_IMPULSES] {};
+    float newDelays[MAX_IMPULSES] {};
+    uint8_t newCount {};
+
+    switch (type) {
+        case ShaperType::ZV: {
+            const float k { expf(-damping * PI / dampingFactor) };
+            newAmplitudes[0] = 1.0f;
+            newAmplitudes[1] = k;
+            newDelays[0] = 0.0f;
+            newDelays[1] = 0.5f * dampedPeriod;
+            newCount = 2;
+            break;
+        }
+        case ShaperType::MZV: {
+            const float k { expf(-0.75f * damping * PI / dampingFactor) };
+            const float a1 { 1.0f - 1.0f / sqrtf(2.0f) };
+            newAmplitudes[0] = a1;
+            newAmplitudes[1] = (sqrtf(2.0f) - 1.0f) * k;
+            newAmplitudes[2] = a1 * k * k;
+            newDelays[0] = 0.0f;
+            newDelays[1] = 0.375f * dampedPeriod;
+            newDelays[2] = 0.75f * dampedPeriod;
+            newCount = 3;
+            break;
+        }
+        default:
+            return false;
+    }
+
+    // Najdłuższe opóźnienie musi zmieścić się w historii (z zapasem na interpolację)
+    const float maxDelayTicks { newDelays[newCount - 1] / tickPeriod };
+    if (maxDelayTicks >= static_cast<float>((CONFIG::SHAPER_HISTORY_SIZE - 2) * CONFIG::SHAPER_SAMPLE_TICKS)) {
+        return false;
+    }
+
+    // Normalizacja amplitud - suma równa 1 zachowuje pozycję końcową
+    float sum { 0.0f };
+    for (uint8_t i { 0 }; i < newCount; ++i) {
+        sum += newAmplitudes[i];
+    }
+
+    for (uint8_t i { 0 }; i < newCount; ++i) {
+        amplitudes[i] = newAmplitudes[i] / sum;
+        delayTicks[i] = newDelays[i] / tickPeriod;
+    }
+    impulseCount = newCount;
+
+    return true;
+}
+
+void IRAM_ATTR InputShaper::reset(float position) {
+    for (size_t i { 0 }; i < CONFIG::SHAPER_HISTORY_SIZE; ++i) {
+        history[i] = position;
+    }
+    historyHead = 0;
+    phase = 0;
+}
+
+uint32_t InputShaper::settleTicks() const {
+    // Po ostatnim impulsie historia musi zostać w całości nadpisana nową pozycją
+    return static_cast<uint32_t>(delayTicks[impulseCount - 1]) + 2 * CONFIG::SHAPER_SAMPLE_TICKS;
+}
+
+// ================================================================================
+//                        SPLOT POZYCJI Z CIĄGIEM IMPULSÓW
+// ================================================================================
+
+float IRAM_ATTR InputShaper::sampleBack(size_t samplesBack) const {
+    size_t index { (historyHead + CONFIG::SHAPER_HISTORY_SIZE - samplesBack) % CONFIG::SHAPER_HISTORY_SIZE };
+    return history[index];
+}
+
+float IRAM_ATTR InputShaper::shape(float position) {
+    // Próbkowanie historii co SHAPER_SAMPLE_TICKS cykli timera
+    if (++phase >= CONFIG::SHAPER_SAMPLE_TICKS) {
+        historyHead = (historyHead + 1) % CONFIG::SHAPER_HISTORY_SIZE;
+        history[historyHead] = position;
+        phase = 0;
+    }
+
+    if (impulseCount == 1) {
+        return position;
+    }
+
+    float shaped { 0.0f };
+    for (uint8_t i { 0 }; i < impulseCount; ++i) {
+        const float delay { delayTicks[i] };
+        float value {};
+
+        if (delay <= static_cast<float>(phase)) {
+            // Punkt między najnowszą próbką a bieżącą pozycją
+            value = (phase == 0) ? position
+                : position + (history[historyHead] - position) * (delay / static_cast<float>(phase));
+        }
+        else {
+            // Interpolacja między próbkami historii
+            const float samplesBack { (delay - static_cast<float>(phase)) / CONFIG::SHAPER_SAMPLE_TICKS };
+            const size_t index { static_cast<size_t>(samplesBack) };
+            const float fraction { samplesBack - static_cast<float>(index) };
+            value = sampleBack(index) * (1.0f - fraction) + sampleBack(index + 1) * fraction;
+        }
+
+        shaped += amplitudes[i] * value;
+    }
+
+    return shaped;
+}
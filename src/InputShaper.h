@@ -0,0 +1,50 @@
+#pragma once
+
+#include <Arduino.h>
+
+#include "CONFIGURATION.h"
+
+// Typ filtra kształtującego (input shaper)
+enum class ShaperType : uint8_t {
+    NONE = 0,   // Brak kształtowania - pozycja przekazywana bez zmian
+    ZV = 1,     // Zero Vibration - 2 impulsy, najmniejsze opóźnienie
+    MZV = 2     // Modified ZV - 3 impulsy, większa odporność na błąd częstotliwości
+};
+
+// Filtr kształtujący pozycję jednej osi przed generowaniem kroków.
+// Zadana pozycja jest splatana z ciągiem impulsów dobranym do częstotliwości
+// i tłumienia rezonansu bramy, co wygasza drgania wzbudzane przyspieszaniem.
+// Historia pozycji próbkowana jest co SHAPER_SAMPLE_TICKS cykli timera,
+// a wartości pośrednie są interpolowane liniowo.
+class InputShaper {
+    private:
+    static constexpr size_t MAX_IMPULSES { 3 };
+
+    uint8_t impulseCount { 1 };
+    float amplitudes[MAX_IMPULSES] { 1.0f, 0.0f, 0.0f };
+    float delayTicks[MAX_IMPULSES] { 0.0f, 0.0f, 0.0f }; // Opóźnienia impulsów [cykle timera]
+
+    // Bufor kołowy historii pozycji zadanej [steps]
+    float history[CONFIG::SHAPER_HISTORY_SIZE] {};
+    size_t historyHead { 0 };   // Indeks najnowszej próbki
+    uint32_t phase { 0 };       // Cykle timera od ostatniej próbki
+
+    // Wartość historii sprzed podanej liczby próbek
+    float sampleBack(size_t samplesBack) const;
+
+    public:
+    InputShaper() = default;
+
+    // Wyznaczenie impulsów filtra; false = parametry poza zakresem (filtr wyłączony)
+    bool configure(ShaperType type, float frequency, float damping);
+
+    // Wypełnienie historii stałą pozycją (postój, zatrzymanie awaryjne, zerowanie)
+    void reset(float position);
+
+    // Zwraca pozycję po kształtowaniu dla bieżącej pozycji zadanej
+    // Wywoływane dokładnie raz na cykl timera
+    float shape(float position);
+
+    // Liczba cykli timera potrzebna do ustalenia wyjścia po zatrzymaniu wejścia
+    uint32_t settleTicks() const;
+};
@@ -0,0 +1,134 @@
+// ================================================================================
+//                        KOPIA PLIKU ZADANIA W PAMIĘCI RAM
+// ================================================================================
+// Wczytanie małych projektów przy starcie zadania - cięcie bez dostępu do karty SD
+
+#include "JobCache.h"
+
+#include <new>
+#include <stdlib.h>
+
+JobCache::~JobCache() {
+    clear();
+}
+
+JobCacheStatus JobCache::load(SDCardManager& manager, const std::string& filename) {
+    if (!manager.isCardInitialized()) {
+        return JobCacheStatus::CARD_NOT_INITIALIZED;
+    }
+
+    const std::string path { CONFIG::PROJECTS_DIR + filename };
+    if (!manager.takeSD(SDPriority::JOB)) {
+        return JobCacheStatus::CARD_NOT_INITIALIZED;
+    }
+
+    std::unique_ptr<StorageFile> file { manager.getStorage().open(path.c_str(), StorageMode::READ) };
+    if (!file) {
+        manager.giveSD();
+        return JobCacheStatus::FILE_OPEN_FAILED;
+    }
+
+    const size_t fileSize { file->size() };
+    const uint32_t fileModified { file->getLastWrite() };
+    ProjectFileInfo info {};
+    manager.findProjectFile(filename, info);
+
+    // Kopia z poprzedniego uruchomienia - plik nie zmienił się od wczytania
+    if (data != nullptr && name == filename && size == fileSize && modified == fileModified && revision == info.revision) {
+        lineCount = info.lineCount;
+        file.reset();
+        manager.giveSD();
+        ++hits;
+        return JobCacheStatus::HIT;
+    }
+
+    if (fileSize > CONFIG::JOB_CACHE_MAX_SIZE) {
+        file.reset();
+        manager.giveSD();
+        return JobCacheStatus::TOO_LARGE;
+    }
+
+    // Poprzednia kopia zwalniana przed sprawdzeniem dostępnej pamięci
+    clear();
+    if (ESP.getMaxAllocHeap() < fileSize || ESP.getFreeHeap() < fileSize + CONFIG::JOB_CACHE_MIN_FREE_HEAP) {
+        file.reset();
+        manager.giveSD();
+        return JobCacheStatus::INSUFFICIENT_MEMORY;
+    }
+    data = static_cast<uint8_t*>(malloc(fileSize > 0 ? fileSize : 1));
+    if (data == nullptr) {
+        file.reset();
+        manager.giveSD();
+        return JobCacheStatus::INSUFFICIENT_MEMORY;
+    }
+
+    // Odczyt blokami; między blokami karta oddawana po przekroczeniu budżetu klasy JOB
+    size_t loaded { 0 };
+    while (loaded < fileSize) {
+        size_t count { fileSize - loaded };
+        if (count > CONFIG::JOB_CACHE_READ_BLOCK_SIZE) {
+            count = CONFIG::JOB_CACHE_READ_BLOCK_SIZE;
+        }
+        const size_t received { file->read(data + loaded, count) };
+        if (received == 0) {
+            break;
+        }
+        loaded += received;
+
+        if (loaded < fileSize && !manager.yieldSD()) {
+            file.reset();
+            clear();
+            return JobCacheStatus::READ_FAILED;
+        }
+    }
+    file.reset();
+    manager.giveSD();
+
+    if (loaded != fileSize) {
+        clear();
+        return JobCacheStatus::READ_FAILED;
+    }
+
+    size = fileSize;
+    name = filename;
+    modified = fileModified;
+    revision = info.revision;
+    lineCount = info.lineCount;
+    ++loads;
+    return JobCacheStatus::OK;
+}
+
+std::unique_ptr<StorageFile> JobCache::open() const {
+    if (data == nullptr) {
+        return nullptr;
+    }
+    return std::unique_ptr<StorageFile>(new (std::nothrow) MemoryStorageFile(data, size, modified));
+}
+
+void JobCache::clear() {
+    free(data);
+    data = nullptr;
+    size = 0;
+    lineCount = 0;
+    name.clear();
+}
+
+bool JobCache::isLoaded() const {
+    return data != nullptr;
+}
+
+size_t JobCache::getSize() const {
+    return size;
+}
+
+uint32_t JobCache::getLineCount() const {
+    return lineCount;
+}
+
+uint32_t JobCache::getLoadCount() const {
+    return loads;
+}
+
+uint32_t JobCache::getHitCount() const {
+    return hits;
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <Arduino.h>
+#include <memory>
+#include <string>
+
+#include "CONFIGURATION.h"
+#include "SDManager.h"
+#include "Storage.h"
+
+enum class JobCacheStatus {
+    OK,                     // Plik wczytany do RAM
+    HIT,                    // Kopia z poprzedniego uruchomienia aktualna
+    TOO_LARGE,              // Plik większy niż JOB_CACHE_MAX_SIZE
+    INSUFFICIENT_MEMORY,    // Brak ciągłego bloku sterty przy zachowaniu JOB_CACHE_MIN_FREE_HEAP
+    CARD_NOT_INITIALIZED,
+    FILE_OPEN_FAILED,
+    READ_FAILED
+};
+
+// Kopia pliku zadania w pamięci RAM. Przy starcie zadania plik mieszczący się w budżecie
+// pamięci wczytywany jest w całości (karta zajmowana z priorytetem JOB), a wykonanie
+// odbywa się bez dostępu do karty. Kopia zostaje zachowana dla kolejnego uruchomienia
+// tego samego pliku i jest unieważniana przy zmianie rozmiaru, czasu zapisu lub numeru
+// zmiany tego pliku (ponowne przesłanie); zmiany innych projektów jej nie dotyczą.
+// Używana wyłącznie przez zadanie CNC.
+class JobCache {
+    private:
+    uint8_t* data { nullptr };
+    size_t size { 0 };
+    std::string name {};
+    uint32_t modified { 0 };
+    uint32_t revision { 0 };
+    uint32_t lineCount { 0 };
+
+    uint32_t loads { 0 };
+    uint32_t hits { 0 };
+
+    public:
+    JobCache() = default;
+    ~JobCache();
+
+    JobCache(const JobCache&) = delete;
+    JobCache& operator=(const JobCache&) = delete;
+
+    // Przygotowanie kopii pliku projektu filename (bez ścieżki); wywołanie bez zajętej karty
+    // OK / HIT = plik do odczytu przez open(), pozostałe = wykonanie z karty
+    JobCacheStatus load(SDCardManager& manager, const std::string& filename);
+
+    // Plik zadania nad kopią w RAM; kopia nie może być zmieniana do zamknięcia pliku
+    std::unique_ptr<StorageFile> open() const;
+
+    // Zwolnienie kopii
+    void clear();
+
+    bool isLoaded() const;
+    size_t getSize() const;
+    uint32_t getLineCount() const;  // Liczba linii z analizy pliku (indeks projektów), 0 = nieznana
+    uint32_t getLoadCount() const;
+    uint32_t getHitCount() const;
+};
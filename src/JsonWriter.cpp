@@ -0,0 +1,348 @@
+// ================================================================================
+//                     SERIALIZACJA JSON BEZ ALOKACJI PAMIĘCI
+// ================================================================================
+// Tekst JSON budowany jest bezpośrednio w buforze o stałym rozmiarze
+// Struktury o stałym układzie (stan maszyny, konfiguracja) zapisywane są wg tablic opisu pól
+
+#include "JsonWriter.h"
+
+#include <math.h>
+#include <string.h>
+
+namespace {
+    constexpr uint32_t POWERS_OF_TEN[] { 1, 10, 100, 1000, 10000, 100000, 1000000, 10000000 };
+
+    // Liczba cyfr części całkowitej (co najmniej 1)
+    uint8_t integerDigits(uint32_t number) {
+        uint8_t digits { 1 };
+        while (number >= 10 && digits < 10) {
+            number /= 10;
+            ++digits;
+        }
+        return digits;
+    }
+
+    // Odczyt pola całkowitego o rozmiarze 1, 2 lub 4 B
+    int32_t readSigned(const uint8_t* field, size_t size) {
+        switch (size) {
+            case sizeof(int8_t): { int8_t number; memcpy(&number, field, size); return number; }
+            case sizeof(int16_t): { int16_t number; memcpy(&number, field, size); return number; }
+            default: { int32_t number; memcpy(&number, field, sizeof(number)); return number; }
+        }
+    }
+
+    uint32_t readUnsigned(const uint8_t* field, size_t size) {
+        switch (size) {
+            case sizeof(uint8_t): { uint8_t number; memcpy(&number, field, size); return number; }
+            case sizeof(uint16_t): { uint16_t number; memcpy(&number, field, size); return number; }
+            default: { uint32_t number; memcpy(&number, field, sizeof(number)); return number; }
+        }
+    }
+}
+
+JsonWriter::JsonWriter(char* buffer, size_t capacity) : buffer(buffer), capacity(capacity) {
+    clear();
+}
+
+void JsonWriter::clear() {
+    length = 0;
+    overflowed = buffer == nullptr || capacity == 0;
+    hasElement = 0;
+    depth = 0;
+    afterKey = false;
+    if (!overflowed) {
+        buffer[0] = '\0';
+    }
+}
+
+// ================================================================================
+//                              ZAPIS DO BUFORA
+// ================================================================================
+
+void JsonWriter::write(char character) {
+    write(&character, 1);
+}
+
+void JsonWriter::write(const char* text, size_t count) {
+    if (overflowed) {
+        return;
+    }
+
+    // Jedno miejsce zawsze pozostaje na znak końca
+    if (count >= capacity - length) {
+        overflowed = true;
+        buffer[length] = '\0';
+        return;
+    }
+
+    memcpy(buffer + length, text, count);
+    length += count;
+    buffer[length] = '\0';
+}
+
+void JsonWriter::beginValue() {
+    if (afterKey) {
+        afterKey = false;
+    }
+    else if (hasElement & (1UL << depth)) {
+        write(',');
+    }
+    hasElement |= 1UL << depth;
+}
+
+// ================================================================================
+//                              KONTENERY I KLUCZE
+// ================================================================================
+
+void JsonWriter::beginObject() {
+    beginValue();
+    write('{');
+    if (depth >= MAX_DEPTH) {
+        overflowed = true;
+        return;
+    }
+    ++depth;
+    hasElement &= ~(1UL << depth);
+}
+
+void JsonWriter::beginObject(const char* name) {
+    key(name);
+    beginObject();
+}
+
+void JsonWriter::endObject() {
+    write('}');
+    if (depth > 0) {
+        --depth;
+    }
+}
+
+void JsonWriter::beginArray() {
+    beginValue();
+    write('[');
+    if (depth >= MAX_DEPTH) {
+        overflowed = true;
+        return;
+    }
+    ++depth;
+    hasElement &= ~(1UL << depth);
+}
+
+void JsonWriter::beginArray(const char* name) {
+    key(name);
+    beginArray();
+}
+
+void JsonWriter::endArray() {
+    write(']');
+    if (depth > 0) {
+        --depth;
+    }
+}
+
+void JsonWriter::key(const char* name) {
+    beginValue();
+    writeEscaped(name, SIZE_MAX);
+    write(':');
+    afterKey = true;
+}
+
+// ================================================================================
+//                                 WARTOŚCI
+// ================================================================================
+
+void JsonWriter::value(bool flag) {
+    beginValue();
+    if (flag) {
+        write("true", 4);
+    }
+    else {
+        write("false", 5);
+    }
+}
+
+void JsonWriter::value(int number) {
+    value(static_cast<long>(number));
+}
+
+void JsonWriter::value(unsigned int number) {
+    value(static_cast<unsigned long>(number));
+}
+
+void JsonWriter::value(long number) {
+    beginValue();
+    if (number < 0) {
+        write('-');
+        // Moduł liczony bez znaku - poprawny także dla wartości minimalnej
+        writeUnsigned(static_cast<uint32_t>(0UL - static_cast<unsigned long>(number)));
+    }
+    else {
+        writeUnsigned(static_cast<uint32_t>(number));
+    }
+}
+
+void JsonWriter::value(unsigned long number) {
+    beginValue();
+    writeUnsigned(static_cast<uint32_t>(number));
+}
+
+void JsonWriter::value(double number) {
+    value(static_cast<float>(number));
+}
+
+void JsonWriter::value(float number) {
+    // JSON nie ma reprezentacji NaN i nieskończoności
+    if (isnan(number) || isinf(number) || fabsf(number) >= 4.0e9f) {
+        null();
+        return;
+    }
+
+    beginValue();
+    if (number < 0.0f) {
+        write('-');
+        number = -number;
+    }
+
+    // Liczba miejsc po przecinku dobrana do precyzji float (FLOAT_SIGNIFICANT_DIGITS cyfr znaczących)
+    uint32_t integerPart { static_cast<uint32_t>(number) };
+    const uint8_t digits { integerDigits(integerPart) };
+    const uint8_t decimals { digits < FLOAT_SIGNIFICANT_DIGITS ? static_cast<uint8_t>(FLOAT_SIGNIFICANT_DIGITS - digits) : static_cast<uint8_t>(0) };
+    const uint32_t scale { POWERS_OF_TEN[decimals] };
+
+    uint32_t fraction { static_cast<uint32_t>((number - static_cast<float>(integerPart)) * static_cast<float>(scale) + 0.5f) };
+    if (fraction >= scale) {
+        ++integerPart;
+        fraction -= scale;
+    }
+
+    writeUnsigned(integerPart);
+    if (fraction == 0) {
+        return;
+    }
+
+    // Część ułamkowa z zerami wiodącymi, bez zer końcowych
+    char digitsBuffer[8];
+    uint8_t count { decimals };
+    while (fraction % 10 == 0) {
+        fraction /= 10;
+        --count;
+    }
+    for (uint8_t index { count }; index > 0; --index) {
+        digitsBuffer[index - 1] = static_cast<char>('0' + fraction % 10);
+        fraction /= 10;
+    }
+    write('.');
+    write(digitsBuffer, count);
+}
+
+void JsonWriter::value(const char* text) {
+    value(text, SIZE_MAX);
+}
+
+void JsonWriter::value(const char* text, size_t maxLength) {
+    if (text == nullptr) {
+        null();
+        return;
+    }
+    beginValue();
+    writeEscaped(text, maxLength);
+}
+
+void JsonWriter::null() {
+    beginValue();
+    write("null", 4);
+}
+
+void JsonWriter::writeUnsigned(uint32_t number) {
+    char digits[10];
+    uint8_t count { 0 };
+    do {
+        digits[sizeof(digits) - 1 - count] = static_cast<char>('0' + number % 10);
+        number /= 10;
+        ++count;
+    } while (number > 0);
+    write(digits + sizeof(digits) - count, count);
+}
+
+void JsonWriter::writeEscaped(const char* text, size_t maxLength) {
+    static constexpr char HEX_DIGITS[] { "0123456789abcdef" };
+
+    write('"');
+    for (size_t index { 0 }; index < maxLength && text[index] != '\0' && !overflowed; ++index) {
+        const char character { text[index] };
+        switch (character) {
+            case '"': write("\\\"", 2); break;
+            case '\\': write("\\\\", 2); break;
+            case '\n': write("\\n", 2); break;
+            case '\r': write("\\r", 2); break;
+            case '\t': write("\\t", 2); break;
+            default:
+                if (static_cast<uint8_t>(character) < 0x20) {
+                    const char escaped[] { '\\', 'u', '0', '0', HEX_DIGITS[character >> 4], HEX_DIGITS[character & 0x0F] };
+                    write(escaped, sizeof(escaped));
+                }
+                else {
+                    write(character);
+                }
+                break;
+        }
+    }
+    write('"');
+}
+
+// ================================================================================
+//                           POLA STRUKTUR WG OPISU
+// ================================================================================
+
+void JsonWriter::fields(const void* object, const JsonFieldDescriptor* descriptors, size_t count) {
+    if (object == nullptr || descriptors == nullptr) {
+        return;
+    }
+
+    const uint8_t* base { static_cast<const uint8_t*>(object) };
+    for (size_t index { 0 }; index < count && !overflowed; ++index) {
+        const JsonFieldDescriptor& descriptor { descriptors[index] };
+        const uint8_t* field { base + descriptor.offset };
+
+        key(descriptor.key);
+        switch (descriptor.type) {
+            case JsonFieldType::BOOL: {
+                bool flag;
+                memcpy(&flag, field, sizeof(flag));
+                value(flag);
+                break;
+            }
+            case JsonFieldType::SIGNED:
+                value(static_cast<long>(readSigned(field, descriptor.size)));
+                break;
+            case JsonFieldType::UNSIGNED:
+                value(static_cast<unsigned long>(readUnsigned(field, descriptor.size)));
+                break;
+            case JsonFieldType::FLOAT: {
+                float number;
+                memcpy(&number, field, sizeof(number));
+                value(number);
+                break;
+            }
+            case JsonFieldType::STRING:
+                value(reinterpret_cast<const char*>(field), descriptor.size);
+                break;
+        }
+    }
+}
+
+size_t JsonWriter::size() const {
+    return length;
+}
+
+bool JsonWriter::isOverflowed() const {
+    return overflowed;
+}
+
+bool JsonWriter::isComplete() const {
+    return !overflowed && depth == 0 && !afterKey;
+}
+
+const char* JsonWriter::c_str() const {
+    return buffer;
+}
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <type_traits>
+
+// Rodzaj wartości pola struktury serializowanego przez JsonWriter
+enum class JsonFieldType : uint8_t {
+    BOOL,
+    SIGNED,     // Liczba całkowita ze znakiem lub typ wyliczeniowy (1, 2 lub 4 B)
+    UNSIGNED,   // Liczba całkowita bez znaku (1, 2 lub 4 B)
+    FLOAT,
+    STRING      // Tablica char zakończona zerem lub wypełniona do końca
+};
+
+// Opis pola struktury: klucz JSON, rodzaj, położenie i rozmiar w strukturze
+struct JsonFieldDescriptor {
+    const char* key;
+    JsonFieldType type;
+    size_t offset;
+    size_t size;
+};
+
+// Rodzaj pola wyznaczany z typu składowej - tablica pól nie może rozjechać się ze strukturą
+template <typename T>
+constexpr JsonFieldType jsonFieldType() {
+    static_assert(std::is_arithmetic<T>::value || std::is_enum<T>::value ||
+        (std::is_array<T>::value && std::is_same<typename std::remove_extent<T>::type, char>::value),
+        "Nieobsługiwany typ pola JSON");
+    static_assert(std::is_array<T>::value || sizeof(T) <= sizeof(uint32_t), "Pole JSON większe niż 32 bity");
+
+    return std::is_same<T, bool>::value ? JsonFieldType::BOOL
+        : std::is_floating_point<T>::value ? JsonFieldType::FLOAT
+        : std::is_array<T>::value ? JsonFieldType::STRING
+        : (std::is_enum<T>::value || std::is_signed<T>::value) ? JsonFieldType::SIGNED
+        : JsonFieldType::UNSIGNED;
+}
+
+// Pole tablicy opisu generowane z nazwy składowej - klucz JSON = nazwa składowej
+#define JSON_FIELD(Type, member) \
+    JsonFieldDescriptor { #member, jsonFieldType<decltype(Type::member)>(), offsetof(Type, member), sizeof(Type::member) }
+
+// Serializator JSON zapisujący bezpośrednio do bufora wywołującego.
+// Nie alokuje pamięci - przecinki i zagnieżdżenie śledzone są w masce bitowej,
+// liczby formatowane są bez printf. Przepełnienie bufora ustawia flagę i kończy zapis,
+// a bufor pozostaje zakończony zerem.
+class JsonWriter {
+    public:
+    static constexpr uint8_t MAX_DEPTH { 31 };
+    static constexpr uint8_t FLOAT_SIGNIFICANT_DIGITS { 7 };
+
+    private:
+    char* buffer { nullptr };
+    size_t capacity { 0 };
+    size_t length { 0 };
+    bool overflowed { false };
+
+    // Bit poziomu = w kontenerze zapisano już element (kolejny wymaga przecinka)
+    uint32_t hasElement { 0 };
+    uint8_t depth { 0 };
+    bool afterKey { false };
+
+    void write(char character);
+    void write(const char* text, size_t count);
+
+    // Przecinek przed kolejnym elementem kontenera
+    void beginValue();
+
+    void writeEscaped(const char* text, size_t maxLength);
+    void writeUnsigned(uint32_t number);
+
+    public:
+    JsonWriter(char* buffer, size_t capacity);
+
+    void beginObject();
+    void beginObject(const char* key);
+    void endObject();
+    void beginArray();
+    void beginArray(const char* key);
+    void endArray();
+
+    void key(const char* name);
+
+    void value(bool flag);
+    void value(int number);
+    void value(unsigned int number);
+    void value(long number);
+    void value(unsigned long number);
+    void value(float number);
+    void value(double number);
+    void value(const char* text);
+    void value(const char* text, size_t maxLength);
+    void null();
+
+    template <typename T>
+    void field(const char* name, T fieldValue) {
+        key(name);
+        value(fieldValue);
+    }
+
+    // Zapis pól struktury wg tablicy opisu (bez nawiasów obiektu)
+    void fields(const void* object, const JsonFieldDescriptor* descriptors, size_t count);
+
+    template <size_t N>
+    void fields(const void* object, const JsonFieldDescriptor (&descriptors)[N]) {
+        fields(object, descriptors, N);
+    }
+
+    // Długość zapisanego tekstu bez znaku końca
+    size_t size() const;
+
+    // true = tekst nie zmieścił się w buforze (zawartość niekompletna)
+    bool isOverflowed() const;
+
+    // true = tekst kompletny: bez przepełnienia i z zamkniętymi kontenerami
+    bool isComplete() const;
+
+    const char* c_str() const;
+
+    // Rozpoczęcie nowego dokumentu w tym samym buforze
+    void clear();
+};
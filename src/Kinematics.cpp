@@ -0,0 +1,55 @@
+// ================================================================================
+//                        KINEMATYKA DRUTU (CIĘCIE STOŻKOWE)
+// ================================================================================
+// Rzutowanie współrzędnych z płaszczyzn ścian bloku na płaszczyzny wież
+// Pozwala wykonać ten sam plik G-code przy dowolnym położeniu bloku między wieżami
+
+#include "Kinematics.h"
+
+// ================================================================================
+//                              WALIDACJA GEOMETRII
+// ================================================================================
+
+KinematicsStatus Kinematics::validate(const MachineConfig::KinematicsConfig& kinematics) {
+    if (!kinematics.enabled) {
+        return KinematicsStatus::DISABLED;
+    }
+
+    // Blok musi mieć niezerową szerokość i mieścić się między wieżami
+    if (kinematics.blockWidth <= 0.0f || kinematics.towerDistance <= 0.0f || kinematics.blockOffset < 0.0f) {
+        return KinematicsStatus::INVALID_GEOMETRY;
+    }
+    if (kinematics.blockOffset + kinematics.blockWidth > kinematics.towerDistance) {
+        return KinematicsStatus::INVALID_GEOMETRY;
+    }
+
+    return KinematicsStatus::OK;
+}
+
+// ================================================================================
+//                           RZUTOWANIE NA PŁASZCZYZNY WIEŻ
+// ================================================================================
+
+KinematicsStatus Kinematics::projectToTowers(const MachineConfig::KinematicsConfig& kinematics, const WirePoint& face, WirePoint& tower) {
+    KinematicsStatus status { validate(kinematics) };
+    if (status != KinematicsStatus::OK) {
+        tower = face;
+        return status;
+    }
+
+    // Prosta drutu przechodzi przez punkt XY na ścianie z = blockOffset
+    // oraz punkt UV na ścianie z = blockOffset + blockWidth.
+    // P(z) = XY + (UV - XY) * (z - blockOffset) / blockWidth
+    const float towerXYRatio { -kinematics.blockOffset / kinematics.blockWidth };
+    const float towerUVRatio { (kinematics.towerDistance - kinematics.blockOffset) / kinematics.blockWidth };
+
+    const float deltaX { face.u - face.x };
+    const float deltaY { face.v - face.y };
+
+    tower.x = face.x + deltaX * towerXYRatio;
+    tower.y = face.y + deltaY * towerXYRatio;
+    tower.u = face.x + deltaX * towerUVRatio;
+    tower.v = face.y + deltaY * towerUVRatio;
+
+    return KinematicsStatus::OK;
+}
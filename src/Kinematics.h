@@ -0,0 +1,34 @@
+#pragma once
+
+#include "ConfigManager.h"
+
+// Punkt ścieżki drutu opisany dwiema parami współrzędnych:
+// XY - pierwsza płaszczyzna (ściana bloku lub wieża XY)
+// UV - druga płaszczyzna (przeciwległa ściana bloku lub wieża UV)
+struct WirePoint {
+    float x { 0.0f };
+    float y { 0.0f };
+    float u { 0.0f };
+    float v { 0.0f };
+};
+
+enum class KinematicsStatus {
+    OK,
+    DISABLED,
+    INVALID_GEOMETRY
+};
+
+// Etap kinematyki między parserem G-code a planowaniem ruchu.
+// CAM podaje profil na ścianach bloku pianki, a wieże stoją poza blokiem -
+// współrzędne ścian są rzutowane wzdłuż prostej drutu na płaszczyzny wież.
+// Rzutowanie jest liniowe, więc prosty odcinek między ścianami pozostaje
+// prostym odcinkiem między wieżami i może być przetwarzany segment po segmencie.
+namespace Kinematics {
+
+    // Sprawdza czy geometria bloku i wież pozwala na rzutowanie
+    KinematicsStatus validate(const MachineConfig::KinematicsConfig& kinematics);
+
+    // Rzutuje punkt z płaszczyzn ścian bloku na płaszczyzny wież
+    // Przy wyłączonej kinematyce lub błędnej geometrii zwraca punkt bez zmian
+    KinematicsStatus projectToTowers(const MachineConfig::KinematicsConfig& kinematics, const WirePoint& face, WirePoint& tower);
+}
@@ -0,0 +1,165 @@
+// ================================================================================
+//                              PROFILE MATERIAŁÓW
+// ================================================================================
+// Nazwane parametry cięcia dla gęstości materiału - zapis w NVS (ConfigStore), wybór dla zadania
+// lub komendą M700 P<n> w pliku, przełączanie na konfiguracje efektywne przygotowane z wyprzedzeniem
+
+#include "MaterialProfiles.h"
+
+#include <string.h>
+
+#include "ConfigValidator.h"
+
+namespace {
+    // Parametry rejestru nadpisywane przez profil (kolejność wartości MaterialProfile::values)
+    constexpr const char* PARAMETER_NAMES[] {
+        "xAxis.workFeedRate",
+        "xAxis.workAcceleration",
+        "yAxis.workFeedRate",
+        "yAxis.workAcceleration",
+        "hotWirePower",
+        "fanPower",
+        "delayAfterStartup",
+    };
+
+    static_assert(sizeof(PARAMETER_NAMES) / sizeof(PARAMETER_NAMES[0]) == MaterialProfile::PARAMETER_COUNT,
+        "Lista parametrów profilu niezgodna z MaterialProfile::PARAMETER_COUNT");
+
+    bool sameGroup(const char* left, const char* right) {
+        return left == right || (left != nullptr && right != nullptr && strcmp(left, right) == 0);
+    }
+}
+
+// ================================================================================
+//                                 PARAMETRY
+// ================================================================================
+
+const ConfigParamDescriptor& MaterialProfiles::parameter(size_t index) {
+    // Opisy wyszukiwane raz przy pierwszym użyciu
+    static const ConfigParamDescriptor* const DESCRIPTORS[MaterialProfile::PARAMETER_COUNT] {
+        ConfigRegistry::find(PARAMETER_NAMES[0]),
+        ConfigRegistry::find(PARAMETER_NAMES[1]),
+        ConfigRegistry::find(PARAMETER_NAMES[2]),
+        ConfigRegistry::find(PARAMETER_NAMES[3]),
+        ConfigRegistry::find(PARAMETER_NAMES[4]),
+        ConfigRegistry::find(PARAMETER_NAMES[5]),
+        ConfigRegistry::find(PARAMETER_NAMES[6]),
+    };
+    return *DESCRIPTORS[index];
+}
+
+void MaterialProfiles::capture(const MachineConfig& config, MaterialProfile& profile) {
+    for (size_t index { 0 }; index < MaterialProfile::PARAMETER_COUNT; ++index) {
+        profile.values[index] = static_cast<float>(ConfigRegistry::getValue(config, parameter(index)));
+    }
+}
+
+bool MaterialProfiles::apply(const MaterialProfile& profile, MachineConfig& config) {
+    bool applied { true };
+    for (size_t index { 0 }; index < MaterialProfile::PARAMETER_COUNT; ++index) {
+        applied = ConfigRegistry::setValue(config, parameter(index), profile.values[index]) && applied;
+    }
+    return applied;
+}
+
+// ================================================================================
+//                                   JSON
+// ================================================================================
+
+size_t MaterialProfiles::readJson(JsonObjectConst root, MaterialProfile& profile, const ConfigParamDescriptor** rejected, size_t capacity) {
+    // Zmiany na kopii - dokument z wartością spoza zakresu nie zmienia profilu
+    MaterialProfile updated { profile };
+    size_t rejectedCount { 0 };
+    for (size_t index { 0 }; index < MaterialProfile::PARAMETER_COUNT; ++index) {
+        const ConfigParamDescriptor& descriptor { parameter(index) };
+        const JsonVariantConst value { ConfigRegistry::jsonValue(root, descriptor) };
+        if (!value.is<double>()) {
+            continue;
+        }
+
+        const double number { value.as<double>() };
+        if (ConfigRegistry::isValid(descriptor, number)) {
+            updated.values[index] = static_cast<float>(number);
+        }
+        else {
+            if (rejected != nullptr && rejectedCount < capacity) {
+                rejected[rejectedCount] = &descriptor;
+            }
+            ++rejectedCount;
+        }
+    }
+
+    if (rejectedCount == 0) {
+        profile = updated;
+    }
+    return rejectedCount;
+}
+
+void MaterialProfiles::writeJson(const MaterialProfile& profile, JsonWriter& writer) {
+    // Wartości zapisywane przez pola MachineConfig - typy jak w /api/config
+    MachineConfig values {};
+    apply(profile, values);
+
+    writer.key("name");
+    writer.value(profile.name, sizeof(profile.name));
+    const char* openGroup { nullptr };
+    for (size_t index { 0 }; index < MaterialProfile::PARAMETER_COUNT; ++index) {
+        const ConfigParamDescriptor& descriptor { parameter(index) };
+        if (!sameGroup(descriptor.group, openGroup)) {
+            if (openGroup != nullptr) {
+                writer.endObject();
+            }
+            if (descriptor.group != nullptr) {
+                writer.beginObject(descriptor.group);
+            }
+            openGroup = descriptor.group;
+        }
+        writer.fields(&values, &descriptor.field, 1);
+    }
+    if (openGroup != nullptr) {
+        writer.endObject();
+    }
+}
+
+// ================================================================================
+//                        KONFIGURACJE EFEKTYWNE (ZADANIE CNC)
+// ================================================================================
+
+void MaterialProfileSet::setProfiles(const MaterialProfileTable& profiles) {
+    table = profiles;
+}
+
+void MaterialProfileSet::rebuild(const MachineConfig& base) {
+    configs[0] = base;
+    available[0] = true;
+
+    for (size_t slot { 1 }; slot < SET_SIZE; ++slot) {
+        const MaterialProfile& profile { table.slots[slot - 1] };
+        available[slot] = false;
+        if (!MaterialProfiles::isOccupied(profile)) {
+            continue;
+        }
+
+        // Profil zapisany przy innej konfiguracji bazowej może nie spełniać reguł po jej zmianie
+        configs[slot] = base;
+        ConfigValidationReport report {};
+        available[slot] = MaterialProfiles::apply(profile, configs[slot]) && ConfigValidator::validate(configs[slot], report);
+    }
+
+    if (!available[activeSlot]) {
+        #ifdef DEBUG_CNC_TASK
+        Serial.printf("DEBUG CNC: Profil %u niedostępny - konfiguracja bazowa\n", static_cast<unsigned>(activeSlot));
+        #endif
+        activeSlot = 0;
+    }
+    active = &configs[activeSlot];
+}
+
+bool MaterialProfileSet::select(uint8_t slot) {
+    if (slot >= SET_SIZE || !available[slot]) {
+        return false;
+    }
+    activeSlot = slot;
+    active = &configs[slot];
+    return true;
+}
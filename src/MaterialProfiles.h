@@ -0,0 +1,65 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <ArduinoJson.h>
+
+#include "ConfigManager.h"
+#include "ConfigRegistry.h"
+#include "JsonWriter.h"
+#include "CONFIGURATION.H"
+
+// Parametry profili materiałów: posuw i przyspieszenie robocze osi, moc drutu i wentylatora,
+// czas nagrzewania. Wartości zapisywane jak parametry rejestru (te same nazwy, zakresy i jednostki).
+class MaterialProfiles {
+    public:
+    MaterialProfiles() = delete;
+
+    // Opis parametru profilu w rejestrze (index < MaterialProfile::PARAMETER_COUNT)
+    static const ConfigParamDescriptor& parameter(size_t index);
+
+    // Wartości parametrów profilu z konfiguracji (punkt wyjścia nowego profilu)
+    static void capture(const MachineConfig& config, MaterialProfile& profile);
+
+    // Nałożenie profilu na konfigurację; false = wartość spoza zakresu (konfiguracja niekompletna)
+    static bool apply(const MaterialProfile& profile, MachineConfig& config);
+
+    // Wartości z dokumentu JSON w układzie /api/config; brakujące pola bez zmian.
+    // Wartość spoza zakresu odrzuca cały dokument. Zwraca liczbę odrzuconych pól (jak ConfigRegistry::readJson)
+    static size_t readJson(JsonObjectConst root, MaterialProfile& profile,
+        const ConfigParamDescriptor** rejected = nullptr, size_t capacity = 0);
+
+    // Pola profilu w otwartym obiekcie JSON (grupy osi jako obiekty zagnieżdżone)
+    static void writeJson(const MaterialProfile& profile, JsonWriter& writer);
+
+    static bool isOccupied(const MaterialProfile& profile) { return profile.name[0] != '\0'; }
+};
+
+// Konfiguracje efektywne (bazowa z nałożonym profilem) przeliczane przy zmianie konfiguracji
+// lub tablicy profili - przełączenie profilu w trakcie zadania to zmiana wskaźnika, bez parsowania
+// i kopiowania. Używana wyłącznie przez zadanie CNC (bez blokad).
+class MaterialProfileSet {
+    private:
+    static constexpr size_t SET_SIZE { CONFIG::MATERIAL_PROFILE_SLOTS + 1 };
+
+    MaterialProfileTable table {};
+    MachineConfig configs[SET_SIZE] {};     // [0] = konfiguracja bazowa, [n] = profil n
+    bool available[SET_SIZE] {};            // Miejsce zajęte, konfiguracja spełnia reguły walidacji
+    const MachineConfig* active { &configs[0] };
+    uint8_t activeSlot { 0 };
+
+    public:
+    // Nowa tablica profili (przeliczenie przez rebuild())
+    void setProfiles(const MaterialProfileTable& profiles);
+
+    // Przeliczenie konfiguracji efektywnych; profil aktywny, który zniknął lub przestał
+    // spełniać reguły, zastępowany jest konfiguracją bazową
+    void rebuild(const MachineConfig& base);
+
+    // Wybór profilu (0 = konfiguracja bazowa); false = puste miejsce lub konfiguracja niepoprawna
+    bool select(uint8_t slot);
+
+    const MachineConfig& config() const { return *active; }
+    uint8_t slot() const { return activeSlot; }
+    uint32_t profilesVersion() const { return table.version; }
+};
@@ -0,0 +1,174 @@
+// ================================================================================
+//                          BACKEND SYSTEMU PLIKÓW POSIX
+// ================================================================================
+// Adapter stdio/dirent na interfejs Storage (uruchamianie potoku plików na PC)
+// Kompilowany wyłącznie poza firmware (środowisko native)
+
+#ifndef ARDUINO
+
+#include "PosixStorage.h"
+
+#include <dirent.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <new>
+
+namespace {
+    class PosixFile : public StorageFile {
+        private:
+        FILE* handle;
+        std::string path;
+
+        public:
+        PosixFile(FILE* handle, const std::string& path) : handle { handle }, path { path } {}
+
+        ~PosixFile() override {
+            close();
+        }
+
+        size_t read(uint8_t* buffer, size_t length) override {
+            return handle != nullptr ? fread(buffer, 1, length, handle) : 0;
+        }
+
+        size_t write(const uint8_t* buffer, size_t length) override {
+            return handle != nullptr ? fwrite(buffer, 1, length, handle) : 0;
+        }
+
+        bool seek(size_t position) override {
+            return handle != nullptr && fseek(handle, static_cast<long>(position), SEEK_SET) == 0;
+        }
+
+        size_t position() const override {
+            if (handle == nullptr) {
+                return 0;
+            }
+            const long offset { ftell(handle) };
+            return offset > 0 ? static_cast<size_t>(offset) : 0;
+        }
+
+        size_t size() const override {
+            if (handle == nullptr) {
+                return 0;
+            }
+            // Dane w buforze stdio muszą trafić do pliku przed odczytem rozmiaru
+            fflush(handle);
+            struct stat info {};
+            return fstat(fileno(handle), &info) == 0 ? static_cast<size_t>(info.st_size) : 0;
+        }
+
+        uint32_t getLastWrite() override {
+            struct stat info {};
+            return stat(path.c_str(), &info) == 0 ? static_cast<uint32_t>(info.st_mtime) : 0;
+        }
+
+        void close() override {
+            if (handle != nullptr) {
+                fclose(handle);
+                handle = nullptr;
+            }
+        }
+
+        bool isOpen() const override {
+            return handle != nullptr;
+        }
+    };
+}
+
+PosixStorage::PosixStorage(const char* rootDirectory) : rootDirectory { rootDirectory != nullptr ? rootDirectory : "" } {
+    // Normalizacja - ścieżki urządzenia zaczynają się od '/'
+    while (!this->rootDirectory.empty() && this->rootDirectory.back() == '/') {
+        this->rootDirectory.pop_back();
+    }
+}
+
+std::string PosixStorage::resolve(const char* path) const {
+    std::string resolved { rootDirectory };
+    if (path == nullptr) {
+        return resolved;
+    }
+    if (path[0] != '/') {
+        resolved += '/';
+    }
+    resolved += path;
+    // Ścieżki katalogów z końcowym '/' (np. CONFIG::PROJECTS_DIR)
+    while (resolved.size() > 1 && resolved.back() == '/') {
+        resolved.pop_back();
+    }
+    return resolved;
+}
+
+std::unique_ptr<StorageFile> PosixStorage::open(const char* path, StorageMode mode) {
+    const std::string hostPath { resolve(path) };
+
+    struct stat info {};
+    if (stat(hostPath.c_str(), &info) == 0 && S_ISDIR(info.st_mode)) {
+        return nullptr;
+    }
+
+    const char* fileMode { "rb" };
+    if (mode == StorageMode::WRITE) {
+        fileMode = "wb";
+    }
+    else if (mode == StorageMode::APPEND) {
+        fileMode = "ab";
+    }
+
+    FILE* handle { fopen(hostPath.c_str(), fileMode) };
+    if (handle == nullptr) {
+        return nullptr;
+    }
+    std::unique_ptr<StorageFile> file { new (std::nothrow) PosixFile(handle, hostPath) };
+    if (!file) {
+        fclose(handle);
+    }
+    return file;
+}
+
+bool PosixStorage::exists(const char* path) {
+    struct stat info {};
+    return stat(resolve(path).c_str(), &info) == 0;
+}
+
+bool PosixStorage::remove(const char* path) {
+    return ::remove(resolve(path).c_str()) == 0;
+}
+
+bool PosixStorage::rename(const char* from, const char* to) {
+    return ::rename(resolve(from).c_str(), resolve(to).c_str()) == 0;
+}
+
+bool PosixStorage::mkdir(const char* path) {
+    return ::mkdir(resolve(path).c_str(), 0755) == 0;
+}
+
+bool PosixStorage::list(const char* path, const ListCallback& callback) {
+    const std::string hostPath { resolve(path) };
+    DIR* directory { opendir(hostPath.c_str()) };
+    if (directory == nullptr) {
+        return false;
+    }
+
+    struct dirent* entry { readdir(directory) };
+    while (entry != nullptr) {
+        if (strcmp(entry->d_name, ".") != 0 && strcmp(entry->d_name, "..") != 0) {
+            const std::string entryPath { hostPath + "/" + entry->d_name };
+            struct stat info {};
+            StorageEntry item {};
+            item.name = entry->d_name;
+            if (stat(entryPath.c_str(), &info) == 0) {
+                item.directory = S_ISDIR(info.st_mode);
+                item.size = static_cast<uint32_t>(info.st_size);
+                item.modified = static_cast<uint32_t>(info.st_mtime);
+            }
+            if (!callback(item)) {
+                break;
+            }
+        }
+        entry = readdir(directory);
+    }
+    closedir(directory);
+    return true;
+}
+
+#endif
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <string>
+
+#include "Storage.h"
+
+// Backend Storage na stdio/dirent (POSIX) - katalog lokalny odwzorowuje system plików
+// urządzenia, np. rootDirectory "./sd" i ścieżka "/Projects/a.gcode" -> "./sd/Projects/a.gcode".
+// Pozwala uruchamiać i mierzyć potok plików (zadanie, przesyłanie, konfiguracja) na PC.
+class PosixStorage : public Storage {
+    private:
+    std::string rootDirectory;
+
+    // Ścieżka w systemie gospodarza
+    std::string resolve(const char* path) const;
+
+    public:
+    explicit PosixStorage(const char* rootDirectory);
+
+    std::unique_ptr<StorageFile> open(const char* path, StorageMode mode) override;
+    bool exists(const char* path) override;
+    bool remove(const char* path) override;
+    bool rename(const char* from, const char* to) override;
+    bool mkdir(const char* path) override;
+    bool list(const char* path, const ListCallback& callback) override;
+};
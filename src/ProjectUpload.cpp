@@ -0,0 +1,246 @@
+// ================================================================================
+//                      PRZESYŁANIE PROJEKTÓW NA KARTĘ SD
+// ================================================================================
+// Buforowany zapis blokami sektorowymi do pliku tymczasowego i zamiana po odebraniu całości
+
+#include "ProjectUpload.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+namespace {
+    // Kolejny numer przesyłania - rozróżnia pliki tymczasowe równoległych przesyłań tego samego projektu
+    uint32_t uploadCounter { 0 };
+
+    float megabytesPerSecond(size_t bytes, uint32_t microseconds) {
+        if (microseconds == 0) {
+            return 0.0f;
+        }
+        // B/us = MB/s
+        return static_cast<float>(bytes) / static_cast<float>(microseconds);
+    }
+}
+
+static_assert(CONFIG::UPLOAD_BUFFER_SIZE % CONFIG::SD_SECTOR_SIZE == 0, "Bufor przesyłania musi być wielokrotnością sektora");
+static_assert(CONFIG::UPLOAD_WRITE_BLOCK_SIZE % CONFIG::SD_SECTOR_SIZE == 0, "Blok zapisu musi być wielokrotnością sektora");
+
+ProjectUpload::~ProjectUpload() {
+    // Przesyłanie przerwane - plik docelowy pozostaje bez zmian
+    if (!committed && sdManager != nullptr) {
+        removeTempFile();
+    }
+    free(buffer);
+}
+
+bool ProjectUpload::isTempFile(const char* name) {
+    if (name == nullptr) {
+        return false;
+    }
+    const size_t nameLength { strlen(name) };
+    const size_t suffixLength { strlen(CONFIG::UPLOAD_TEMP_SUFFIX) };
+    return nameLength >= suffixLength && strcmp(name + nameLength - suffixLength, CONFIG::UPLOAD_TEMP_SUFFIX) == 0;
+}
+
+// ================================================================================
+//                               ETAPY PRZESYŁANIA
+// ================================================================================
+
+ProjectUploadStatus ProjectUpload::begin(SDCardManager* manager, const char* filename) {
+    // Sama nazwa pliku - bez ścieżek i nazw zarezerwowanych dla plików tymczasowych
+    if (filename == nullptr || filename[0] == '\0' || strchr(filename, '/') != nullptr
+        || strchr(filename, '\\') != nullptr || strcmp(filename, "..") == 0 || isTempFile(filename)) {
+        status = ProjectUploadStatus::INVALID_FILENAME;
+        return status;
+    }
+    if (manager == nullptr || !manager->isCardInitialized()) {
+        status = ProjectUploadStatus::CARD_NOT_INITIALIZED;
+        return status;
+    }
+
+    buffer = static_cast<uint8_t*>(malloc(CONFIG::UPLOAD_BUFFER_SIZE));
+    if (buffer == nullptr) {
+        status = ProjectUploadStatus::MEMORY_ALLOCATION_FAILED;
+        return status;
+    }
+
+    sdManager = manager;
+    finalPath = String(CONFIG::PROJECTS_DIR) + filename;
+    tempPath = finalPath + "." + String(++uploadCounter) + CONFIG::UPLOAD_TEMP_SUFFIX;
+    startedAt = static_cast<uint32_t>(micros());
+
+    if (!sdManager->takeSD(SDPriority::BACKGROUND)) {
+        status = ProjectUploadStatus::CARD_NOT_INITIALIZED;
+        return status;
+    }
+    file = sdManager->getStorage().open(tempPath.c_str(), StorageMode::WRITE);
+    sdManager->giveSD();
+
+    if (!file) {
+        status = ProjectUploadStatus::FILE_OPEN_FAILED;
+    }
+    return status;
+}
+
+ProjectUploadStatus ProjectUpload::append(const uint8_t* data, size_t length) {
+    if (status != ProjectUploadStatus::OK || committed) {
+        return status;
+    }
+
+    while (length > 0) {
+        size_t count { CONFIG::UPLOAD_BUFFER_SIZE - buffered };
+        if (count > length) {
+            count = length;
+        }
+        memcpy(buffer + buffered, data, count);
+        analyzer.feed(data, count);
+        buffered += count;
+        totalBytes += count;
+        data += count;
+        length -= count;
+
+        if (buffered == CONFIG::UPLOAD_BUFFER_SIZE) {
+            if (!writeBuffer(buffered)) {
+                return status;
+            }
+            buffered = 0;
+        }
+    }
+    return status;
+}
+
+ProjectUploadStatus ProjectUpload::commit() {
+    if (status != ProjectUploadStatus::OK || committed) {
+        return status;
+    }
+    if (buffered > 0 && !writeBuffer(buffered)) {
+        return status;
+    }
+    buffered = 0;
+
+    if (!sdManager->takeSD(SDPriority::BACKGROUND)) {
+        status = ProjectUploadStatus::FILE_WRITE_FAILED;
+        return status;
+    }
+    file->close();
+
+    // Zamiana pliku docelowego dopiero po zapisaniu całości
+    Storage& storage { sdManager->getStorage() };
+    const bool renamed { storage.rename(tempPath.c_str(), finalPath.c_str()) };
+    if (renamed) {
+        std::unique_ptr<StorageFile> stored { storage.open(finalPath.c_str(), StorageMode::READ) };
+        if (stored) {
+            modified = stored->getLastWrite();
+        }
+    }
+    sdManager->giveSD();
+
+    if (!renamed) {
+        status = ProjectUploadStatus::RENAME_FAILED;
+        return status;
+    }
+
+    committed = true;
+    finishedAt = static_cast<uint32_t>(micros());
+    analyzer.finish();
+
+    #ifdef DEBUG_SD
+    Serial.printf("DEBUG SD: Upload %s: %u B, %.2f MB/s (zapis SD %.2f MB/s)\n", finalPath.c_str(),
+        static_cast<unsigned>(totalBytes), getThroughput(), getWriteThroughput());
+    #endif
+
+    return status;
+}
+
+// ================================================================================
+//                                ZAPIS NA KARTĘ
+// ================================================================================
+
+bool ProjectUpload::writeBuffer(size_t length) {
+    const uint32_t writeStart { static_cast<uint32_t>(micros()) };
+
+    if (!sdManager->takeSD(SDPriority::BACKGROUND)) {
+        status = ProjectUploadStatus::FILE_WRITE_FAILED;
+        return false;
+    }
+
+    // Bloki sektorowe; między blokami karta oddawana oczekującym o wyższym priorytecie
+    size_t offset { 0 };
+    while (offset < length) {
+        size_t count { length - offset };
+        if (count > CONFIG::UPLOAD_WRITE_BLOCK_SIZE) {
+            count = CONFIG::UPLOAD_WRITE_BLOCK_SIZE;
+        }
+        if (file->write(buffer + offset, count) != count) {
+            sdManager->giveSD();
+            status = ProjectUploadStatus::FILE_WRITE_FAILED;
+            return false;
+        }
+        offset += count;
+
+        if (offset < length && !sdManager->yieldSD()) {
+            status = ProjectUploadStatus::FILE_WRITE_FAILED;
+            return false;
+        }
+    }
+    sdManager->giveSD();
+
+    writeTimeUs += static_cast<uint32_t>(micros()) - writeStart;
+    return true;
+}
+
+void ProjectUpload::removeTempFile() {
+    // Odmowa zajęcia (pełna kolejka zgłoszeń) nie może zwolnić karty innego zadania.
+    // Uchwyt jest wtedy zamykany bez zajęcia (blokada systemu plików), a plik tymczasowy
+    // pozostaje na karcie - pomijany na liście projektów
+    if (!sdManager->takeSD(SDPriority::BACKGROUND)) {
+        file.reset();
+        #ifdef DEBUG_SD
+        Serial.printf("DEBUG SD: Karta zajęta - plik tymczasowy %s pozostawiony\n", tempPath.c_str());
+        #endif
+        return;
+    }
+    file.reset();
+    if (tempPath.length() > 0) {
+        sdManager->getStorage().remove(tempPath.c_str());
+    }
+    sdManager->giveSD();
+}
+
+// ================================================================================
+//                                 WYNIKI
+// ================================================================================
+
+ProjectUploadStatus ProjectUpload::getStatus() const {
+    return status;
+}
+
+bool ProjectUpload::isCommitted() const {
+    return committed;
+}
+
+size_t ProjectUpload::getTotalBytes() const {
+    return totalBytes;
+}
+
+ProjectFileInfo ProjectUpload::getFileInfo() const {
+    ProjectFileInfo info {};
+    info.name = finalPath.substring(strlen(CONFIG::PROJECTS_DIR)).c_str();
+    info.size = static_cast<uint32_t>(totalBytes);
+    info.modified = modified;
+    info.lineCount = analyzer.getLineCount();
+    info.moveCount = analyzer.getMoveCount();
+    info.minX = analyzer.getMinX();
+    info.minY = analyzer.getMinY();
+    info.maxX = analyzer.getMaxX();
+    info.maxY = analyzer.getMaxY();
+    return info;
+}
+
+float ProjectUpload::getThroughput() const {
+    const uint32_t end { committed ? finishedAt : static_cast<uint32_t>(micros()) };
+    return megabytesPerSecond(totalBytes, end - startedAt);
+}
+
+float ProjectUpload::getWriteThroughput() const {
+    return megabytesPerSecond(totalBytes, writeTimeUs);
+}
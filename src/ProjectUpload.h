@@ -0,0 +1,79 @@
+#pragma once
+
+#include <Arduino.h>
+#include <memory>
+
+#include "CONFIGURATION.h"
+#include "GCodeAnalyzer.h"
+#include "SDManager.h"
+#include "Storage.h"
+
+enum class ProjectUploadStatus {
+    OK,
+    INVALID_FILENAME,
+    CARD_NOT_INITIALIZED,
+    MEMORY_ALLOCATION_FAILED,
+    FILE_OPEN_FAILED,
+    FILE_WRITE_FAILED,
+    RENAME_FAILED
+};
+
+// Przesyłanie pliku projektu na kartę SD - stan jednego przesyłania (bez zmiennych statycznych).
+// Dane z kolejnych fragmentów TCP zbierane są w buforze RAM i zapisywane blokami
+// będącymi wielokrotnością sektora; karta zajmowana jest tylko na czas zapisu bloku
+// (z oddaniem zadaniu CNC między blokami). Plik zapisywany jest pod nazwą tymczasową
+// i zamieniany na docelowy dopiero po odebraniu całości - przerwane przesyłanie nie
+// niszczy istniejącego projektu.
+class ProjectUpload {
+    private:
+    SDCardManager* sdManager { nullptr };
+    std::unique_ptr<StorageFile> file {};
+    String tempPath {};
+    String finalPath {};
+
+    uint8_t* buffer { nullptr };
+    size_t buffered { 0 };
+    size_t totalBytes { 0 };
+
+    uint32_t startedAt { 0 };       // [us] Pierwszy fragment
+    uint32_t finishedAt { 0 };      // [us] Zamiana pliku docelowego
+    uint32_t writeTimeUs { 0 };     // [us] Łączny czas zapisu na kartę
+    uint32_t modified { 0 };        // Czas zapisu pliku docelowego (time_t)
+    GCodeAnalyzer analyzer {};      // Metadane liczone w trakcie odbioru danych
+    ProjectUploadStatus status { ProjectUploadStatus::OK };
+    bool committed { false };
+
+    // Zapis length bajtów bufora (wielokrotność sektora poza ostatnim blokiem)
+    bool writeBuffer(size_t length);
+    void removeTempFile();
+
+    public:
+    ProjectUpload() = default;
+    ~ProjectUpload();
+
+    ProjectUpload(const ProjectUpload&) = delete;
+    ProjectUpload& operator=(const ProjectUpload&) = delete;
+
+    // Nazwa pliku tymczasowego w katalogu projektów (pomijana na liście projektów)
+    static bool isTempFile(const char* name);
+
+    // Utworzenie pliku tymczasowego dla projektu filename (bez ścieżki)
+    ProjectUploadStatus begin(SDCardManager* manager, const char* filename);
+
+    // Dopisanie fragmentu danych; pełny bufor zapisywany jest na kartę
+    ProjectUploadStatus append(const uint8_t* data, size_t length);
+
+    // Zapis reszty danych i zamiana pliku tymczasowego na docelowy
+    ProjectUploadStatus commit();
+
+    ProjectUploadStatus getStatus() const;
+    bool isCommitted() const;
+    size_t getTotalBytes() const;
+
+    // Wpis listy projektów dla przesłanego pliku (po commit())
+    ProjectFileInfo getFileInfo() const;
+
+    // Przepustowość [MB/s]: całego przesyłania (sieć + karta) i samego zapisu na kartę
+    float getThroughput() const;
+    float getWriteThroughput() const;
+};
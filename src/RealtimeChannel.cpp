@@ -0,0 +1,91 @@
+// ================================================================================
+//                      KANAŁ KOMEND CZASU RZECZYWISTEGO
+// ================================================================================
+// STOP, wstrzymanie i korekta posuwu nie czekają w commandQueue za komendami JOG
+// ani przeładowaniem konfiguracji - trafiają wprost do generatora kroków
+
+#include "RealtimeChannel.h"
+
+// ================================================================================
+//                            INICJALIZACJA SYSTEMU
+// ================================================================================
+
+RealtimeChannelStatus RealtimeChannel::init(StepEngine* engine, TaskHandle_t task) {
+    if (engine == nullptr) {
+        return RealtimeChannelStatus::INVALID_PARAMETERS;
+    }
+    stepEngine = engine;
+    notifyTask = task;
+
+    stepEngine->setFeedHold(feedHold.load());
+    stepEngine->setFeedOverride(feedOverride.load() / 100.0f);
+
+    return RealtimeChannelStatus::OK;
+}
+
+void RealtimeChannel::post(uint32_t request) {
+    pendingRequests.fetch_or(request);
+    if (notifyTask != nullptr) {
+        xTaskNotify(notifyTask, CNCEvent::REALTIME, eSetBits);
+    }
+}
+
+// ================================================================================
+//                               ŻĄDANIA RUCHU
+// ================================================================================
+
+RealtimeChannelStatus RealtimeChannel::requestStop() {
+    if (stepEngine == nullptr) {
+        return RealtimeChannelStatus::NOT_INITIALIZED;
+    }
+
+    // Kroki zatrzymane przed wybudzeniem zadania - nie zależy od obciążenia rdzenia 1
+    stepEngine->halt();
+    post(RealtimeRequest::STOP);
+
+    return RealtimeChannelStatus::OK;
+}
+
+RealtimeChannelStatus RealtimeChannel::setFeedHold(bool hold) {
+    if (stepEngine == nullptr) {
+        return RealtimeChannelStatus::NOT_INITIALIZED;
+    }
+
+    if (feedHold.exchange(hold) != hold) {
+        stepEngine->setFeedHold(hold);
+        post(RealtimeRequest::FEED_HOLD);
+    }
+
+    return RealtimeChannelStatus::OK;
+}
+
+RealtimeChannelStatus RealtimeChannel::toggleFeedHold() {
+    return setFeedHold(!feedHold.load());
+}
+
+bool RealtimeChannel::isFeedHold() const {
+    return feedHold.load();
+}
+
+RealtimeChannelStatus RealtimeChannel::setFeedOverride(uint8_t percent) {
+    if (stepEngine == nullptr) {
+        return RealtimeChannelStatus::NOT_INITIALIZED;
+    }
+    if (percent < CONFIG::FEED_OVERRIDE_MIN || percent > CONFIG::FEED_OVERRIDE_MAX) {
+        return RealtimeChannelStatus::INVALID_PARAMETERS;
+    }
+
+    feedOverride.store(percent);
+    stepEngine->setFeedOverride(percent / 100.0f);
+    post(RealtimeRequest::FEED_OVERRIDE);
+
+    return RealtimeChannelStatus::OK;
+}
+
+uint8_t RealtimeChannel::getFeedOverride() const {
+    return feedOverride.load();
+}
+
+uint32_t RealtimeChannel::consume() {
+    return pendingRequests.exchange(0);
+}
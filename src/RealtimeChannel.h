@@ -0,0 +1,60 @@
+#pragma once
+
+#include <Arduino.h>
+#include <atomic>
+#include <freertos/FreeRTOS.h>
+
+#include "CONFIGURATION.h"
+#include "SharedTypes.h"
+#include "StepEngine.h"
+
+// Bity żądań czasu rzeczywistego oczekujących na obsługę w zadaniu CNC
+namespace RealtimeRequest {
+    constexpr uint32_t STOP { 1UL << 0 };           // Zatrzymanie ruchu i przejście do STOPPED
+    constexpr uint32_t FEED_HOLD { 1UL << 1 };      // Zmiana stanu wstrzymania posuwu
+    constexpr uint32_t FEED_OVERRIDE { 1UL << 2 };  // Nowa wartość korekty posuwu
+}
+
+enum class RealtimeChannelStatus {
+    OK,
+    NOT_INITIALIZED,
+    INVALID_PARAMETERS
+};
+
+// Kanał komend czasu rzeczywistego (STOP, wstrzymanie posuwu, korekta posuwu).
+// Omija commandQueue: skutek w generatorze kroków jest natychmiastowy już
+// w kontekście nadawcy, a zadanie CNC jest budzone zdarzeniem CNCEvent::REALTIME
+// i porządkuje maszynę stanów na podstawie słowa flag.
+class RealtimeChannel {
+    private:
+    StepEngine* stepEngine { nullptr };
+    TaskHandle_t notifyTask { nullptr };
+
+    std::atomic<uint32_t> pendingRequests { 0 };    // Bity RealtimeRequest
+    std::atomic<bool> feedHold { false };
+    std::atomic<uint8_t> feedOverride { 100 };      // [%]
+
+    // Zapis żądania i wybudzenie zadania CNC
+    void post(uint32_t request);
+
+    public:
+    RealtimeChannel() = default;
+
+    // Generator kroków sterowany bezpośrednio i zadanie budzone po każdym żądaniu
+    RealtimeChannelStatus init(StepEngine* engine, TaskHandle_t task);
+
+    // Natychmiastowe wstrzymanie generacji kroków; abort() i STOPPED wykonuje zadanie CNC
+    RealtimeChannelStatus requestStop();
+
+    // Wstrzymanie posuwu z hamowaniem na torze (kolejka ruchu zachowana) lub wznowienie
+    RealtimeChannelStatus setFeedHold(bool hold);
+    RealtimeChannelStatus toggleFeedHold();
+    bool isFeedHold() const;
+
+    // Korekta prędkości posuwu [%] w zakresie FEED_OVERRIDE_MIN..FEED_OVERRIDE_MAX
+    RealtimeChannelStatus setFeedOverride(uint8_t percent);
+    uint8_t getFeedOverride() const;
+
+    // Odczyt i skasowanie oczekujących żądań (zadanie CNC)
+    uint32_t consume();
+};
@@ -0,0 +1,360 @@
+// ================================================================================
+//                          TEST WYDAJNOŚCI KARTY SD
+// ================================================================================
+// Przepustowość, opóźnienia odczytu sektora, koszt operacji na plikach i próba zegarów SPI
+
+#include "SDBenchmark.h"
+
+#include <algorithm>
+#include <memory>
+#include <stdlib.h>
+
+namespace {
+    // Zawartość pliku testowego zależna od położenia - weryfikacja wykrywa także przesunięte bloki
+    uint8_t patternByte(size_t position, uint32_t seed) {
+        return static_cast<uint8_t>((static_cast<uint32_t>(position) * 2654435761U + seed) >> 24);
+    }
+
+    void fillPattern(uint8_t* buffer, size_t length, size_t position, uint32_t seed) {
+        for (size_t index { 0 }; index < length; ++index) {
+            buffer[index] = patternByte(position + index, seed);
+        }
+    }
+
+    bool checkPattern(const uint8_t* buffer, size_t length, size_t position, uint32_t seed) {
+        for (size_t index { 0 }; index < length; ++index) {
+            if (buffer[index] != patternByte(position + index, seed)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Generator położeń losowych odczytów (xorshift32) - bez zależności od sprzętowego RNG
+    uint32_t nextRandom(uint32_t& state) {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return state;
+    }
+
+    float megabytesPerSecond(size_t bytes, uint32_t microseconds) {
+        // B/us = MB/s
+        return microseconds > 0 ? static_cast<float>(bytes) / static_cast<float>(microseconds) : 0.0f;
+    }
+
+    uint32_t elapsedSince(uint32_t start) {
+        return static_cast<uint32_t>(micros()) - start;
+    }
+}
+
+static_assert(CONFIG::SD_BENCH_FILE_SIZE % CONFIG::SD_BENCH_BLOCK_SIZE == 0, "Plik testowy musi być wielokrotnością bloku");
+static_assert(CONFIG::SD_BENCH_SWEEP_FILE_SIZE % CONFIG::SD_BENCH_BLOCK_SIZE == 0, "Plik próby zegaru musi być wielokrotnością bloku");
+static_assert(CONFIG::SD_BENCH_FILE_SIZE >= CONFIG::SD_SECTOR_SIZE, "Plik testowy mniejszy niż sektor");
+
+SDBenchmark::~SDBenchmark() {
+    free(buffer);
+}
+
+const char* SDBenchmark::statusName(SDBenchmarkStatus status) {
+    switch (status) {
+        case SDBenchmarkStatus::OK: return "OK";
+        case SDBenchmarkStatus::CARD_NOT_INITIALIZED: return "CARD_NOT_INITIALIZED";
+        case SDBenchmarkStatus::SD_BUSY: return "SD_BUSY";
+        case SDBenchmarkStatus::MEMORY_ALLOCATION_FAILED: return "MEMORY_ALLOCATION_FAILED";
+        case SDBenchmarkStatus::FILE_OPEN_FAILED: return "FILE_OPEN_FAILED";
+        case SDBenchmarkStatus::FILE_WRITE_FAILED: return "FILE_WRITE_FAILED";
+        case SDBenchmarkStatus::FILE_READ_FAILED: return "FILE_READ_FAILED";
+        case SDBenchmarkStatus::VERIFY_FAILED: return "VERIFY_FAILED";
+    }
+    return "UNKNOWN";
+}
+
+SDBenchmarkStatus SDBenchmark::run(SDCardManager* manager, bool sweep, bool apply, SDBenchmarkResult& result) {
+    result = SDBenchmarkResult {};
+    if (manager == nullptr || !manager->isCardInitialized()) {
+        result.status = SDBenchmarkStatus::CARD_NOT_INITIALIZED;
+        return result.status;
+    }
+
+    sdManager = manager;
+    if (buffer == nullptr) {
+        buffer = static_cast<uint8_t*>(malloc(CONFIG::SD_BENCH_BLOCK_SIZE));
+    }
+    if (buffer == nullptr) {
+        result.status = SDBenchmarkStatus::MEMORY_ALLOCATION_FAILED;
+        return result.status;
+    }
+
+    const uint32_t startedAt { static_cast<uint32_t>(millis()) };
+    result.spiFrequency = sdManager->getSpiFrequency();
+
+    SDBenchmarkStatus status { measureSequential(result) };
+    if (status == SDBenchmarkStatus::OK) {
+        status = measureRandomRead(result);
+    }
+    if (status == SDBenchmarkStatus::OK) {
+        status = measureOpenClose(result);
+    }
+    if (status == SDBenchmarkStatus::OK) {
+        status = measureDirectoryScan(result);
+    }
+
+    if (sdManager->takeSD(SDPriority::BACKGROUND)) {
+        sdManager->getStorage().remove(CONFIG::SD_BENCH_FILE);
+        sdManager->giveSD();
+    }
+
+    if (status == SDBenchmarkStatus::OK && sweep) {
+        sweepFrequencies(result, apply);
+    }
+
+    result.status = status;
+    result.durationMs = static_cast<uint32_t>(millis()) - startedAt;
+
+    #ifdef DEBUG_SD
+    Serial.printf("DEBUG SD: Test karty %s: zapis %.2f MB/s, odczyt %.2f MB/s, sektor p50 %lu us p99 %lu us\n",
+        statusName(status), result.writeMBps, result.readMBps,
+        static_cast<unsigned long>(result.randomRead.p50Us), static_cast<unsigned long>(result.randomRead.p99Us));
+    #endif
+
+    return status;
+}
+
+// ================================================================================
+//                           POMIARY PRZY BIEŻĄCYM ZEGARZE
+// ================================================================================
+
+SDBenchmarkStatus SDBenchmark::measureSequential(SDBenchmarkResult& result) {
+    Storage& storage { sdManager->getStorage() };
+
+    // Zapis - liczony jest wyłącznie czas operacji na pliku (bez oczekiwania w kolejce)
+    if (!sdManager->takeSD(SDPriority::BACKGROUND)) {
+        return SDBenchmarkStatus::SD_BUSY;
+    }
+    std::unique_ptr<StorageFile> file { storage.open(CONFIG::SD_BENCH_FILE, StorageMode::WRITE) };
+    if (!file) {
+        sdManager->giveSD();
+        return SDBenchmarkStatus::FILE_OPEN_FAILED;
+    }
+
+    uint32_t writeUs { 0 };
+    for (size_t position { 0 }; position < CONFIG::SD_BENCH_FILE_SIZE; position += CONFIG::SD_BENCH_BLOCK_SIZE) {
+        fillPattern(buffer, CONFIG::SD_BENCH_BLOCK_SIZE, position, 0);
+        const uint32_t blockStart { static_cast<uint32_t>(micros()) };
+        const size_t written { file->write(buffer, CONFIG::SD_BENCH_BLOCK_SIZE) };
+        writeUs += elapsedSince(blockStart);
+        if (written != CONFIG::SD_BENCH_BLOCK_SIZE) {
+            file.reset();
+            sdManager->giveSD();
+            return SDBenchmarkStatus::FILE_WRITE_FAILED;
+        }
+        if (!sdManager->yieldSD()) {
+            return SDBenchmarkStatus::SD_BUSY;
+        }
+    }
+    // Zamknięcie zapisuje bufor pliku i tablicę FAT - część kosztu zapisu
+    const uint32_t closeStart { static_cast<uint32_t>(micros()) };
+    file->close();
+    writeUs += elapsedSince(closeStart);
+
+    // Odczyt z weryfikacją zawartości (weryfikacja poza pomiarem)
+    file = storage.open(CONFIG::SD_BENCH_FILE, StorageMode::READ);
+    if (!file) {
+        sdManager->giveSD();
+        return SDBenchmarkStatus::FILE_OPEN_FAILED;
+    }
+
+    uint32_t readUs { 0 };
+    for (size_t position { 0 }; position < CONFIG::SD_BENCH_FILE_SIZE; position += CONFIG::SD_BENCH_BLOCK_SIZE) {
+        const uint32_t blockStart { static_cast<uint32_t>(micros()) };
+        const size_t received { file->read(buffer, CONFIG::SD_BENCH_BLOCK_SIZE) };
+        readUs += elapsedSince(blockStart);
+        if (received != CONFIG::SD_BENCH_BLOCK_SIZE) {
+            file.reset();
+            sdManager->giveSD();
+            return SDBenchmarkStatus::FILE_READ_FAILED;
+        }
+        if (!checkPattern(buffer, received, position, 0)) {
+            file.reset();
+            sdManager->giveSD();
+            return SDBenchmarkStatus::VERIFY_FAILED;
+        }
+        if (!sdManager->yieldSD()) {
+            return SDBenchmarkStatus::SD_BUSY;
+        }
+    }
+    file.reset();
+    sdManager->giveSD();
+
+    result.writeMBps = megabytesPerSecond(CONFIG::SD_BENCH_FILE_SIZE, writeUs);
+    result.readMBps = megabytesPerSecond(CONFIG::SD_BENCH_FILE_SIZE, readUs);
+    return SDBenchmarkStatus::OK;
+}
+
+SDBenchmarkStatus SDBenchmark::measureRandomRead(SDBenchmarkResult& result) {
+    if (!sdManager->takeSD(SDPriority::BACKGROUND)) {
+        return SDBenchmarkStatus::SD_BUSY;
+    }
+    std::unique_ptr<StorageFile> file { sdManager->getStorage().open(CONFIG::SD_BENCH_FILE, StorageMode::READ) };
+    if (!file) {
+        sdManager->giveSD();
+        return SDBenchmarkStatus::FILE_OPEN_FAILED;
+    }
+
+    constexpr size_t SECTOR_COUNT { CONFIG::SD_BENCH_FILE_SIZE / CONFIG::SD_SECTOR_SIZE };
+    uint32_t samples[CONFIG::SD_BENCH_RANDOM_READS];
+    uint32_t randomState { static_cast<uint32_t>(micros()) | 1U };
+    uint64_t totalUs { 0 };
+
+    for (size_t index { 0 }; index < CONFIG::SD_BENCH_RANDOM_READS; ++index) {
+        const size_t position { (nextRandom(randomState) % SECTOR_COUNT) * CONFIG::SD_SECTOR_SIZE };
+        const uint32_t readStart { static_cast<uint32_t>(micros()) };
+        const bool seeked { file->seek(position) };
+        const size_t received { seeked ? file->read(buffer, CONFIG::SD_SECTOR_SIZE) : 0 };
+        samples[index] = elapsedSince(readStart);
+        totalUs += samples[index];
+
+        if (received != CONFIG::SD_SECTOR_SIZE) {
+            file.reset();
+            sdManager->giveSD();
+            return SDBenchmarkStatus::FILE_READ_FAILED;
+        }
+        if (!checkPattern(buffer, received, position, 0)) {
+            file.reset();
+            sdManager->giveSD();
+            return SDBenchmarkStatus::VERIFY_FAILED;
+        }
+        if (!sdManager->yieldSD()) {
+            return SDBenchmarkStatus::SD_BUSY;
+        }
+    }
+    file.reset();
+    sdManager->giveSD();
+
+    std::sort(samples, samples + CONFIG::SD_BENCH_RANDOM_READS);
+    constexpr size_t LAST { CONFIG::SD_BENCH_RANDOM_READS - 1 };
+    result.randomRead.minUs = samples[0];
+    result.randomRead.averageUs = static_cast<uint32_t>(totalUs / CONFIG::SD_BENCH_RANDOM_READS);
+    result.randomRead.p50Us = samples[LAST * 50 / 100];
+    result.randomRead.p95Us = samples[LAST * 95 / 100];
+    result.randomRead.p99Us = samples[LAST * 99 / 100];
+    result.randomRead.maxUs = samples[LAST];
+    return SDBenchmarkStatus::OK;
+}
+
+SDBenchmarkStatus SDBenchmark::measureOpenClose(SDBenchmarkResult& result) {
+    uint64_t totalUs { 0 };
+    for (size_t cycle { 0 }; cycle < CONFIG::SD_BENCH_OPEN_CYCLES; ++cycle) {
+        if (!sdManager->takeSD(SDPriority::BACKGROUND)) {
+            return SDBenchmarkStatus::SD_BUSY;
+        }
+        const uint32_t cycleStart { static_cast<uint32_t>(micros()) };
+        std::unique_ptr<StorageFile> file { sdManager->getStorage().open(CONFIG::SD_BENCH_FILE, StorageMode::READ) };
+        const bool opened { static_cast<bool>(file) };
+        file.reset();
+        totalUs += elapsedSince(cycleStart);
+        sdManager->giveSD();
+
+        if (!opened) {
+            return SDBenchmarkStatus::FILE_OPEN_FAILED;
+        }
+    }
+    result.openCloseUs = static_cast<uint32_t>(totalUs / CONFIG::SD_BENCH_OPEN_CYCLES);
+    return SDBenchmarkStatus::OK;
+}
+
+SDBenchmarkStatus SDBenchmark::measureDirectoryScan(SDBenchmarkResult& result) {
+    // Normalizacja ścieżki katalogu projektów
+    String path { CONFIG::PROJECTS_DIR };
+    if (path.endsWith("/")) {
+        path.remove(path.length() - 1);
+    }
+
+    if (!sdManager->takeSD(SDPriority::BACKGROUND)) {
+        return SDBenchmarkStatus::SD_BUSY;
+    }
+    uint32_t entries { 0 };
+    const uint32_t scanStart { static_cast<uint32_t>(micros()) };
+    const bool listed { sdManager->getStorage().list(path.c_str(), [&entries](const StorageEntry&) {
+        ++entries;
+        return true;
+    }) };
+    result.scanUs = elapsedSince(scanStart);
+    sdManager->giveSD();
+
+    result.scanEntries = entries;
+    return listed ? SDBenchmarkStatus::OK : SDBenchmarkStatus::FILE_OPEN_FAILED;
+}
+
+// ================================================================================
+//                              PRÓBA ZEGARÓW SPI
+// ================================================================================
+
+void SDBenchmark::sweepFrequencies(SDBenchmarkResult& result, bool apply) {
+    // Karta zajęta przez całą próbę - ponowne uruchomienie unieważnia uchwyty plików
+    if (!sdManager->takeSD(SDPriority::BACKGROUND)) {
+        return;
+    }
+
+    const uint32_t originalFrequency { sdManager->getSpiFrequency() };
+    for (const uint32_t frequency : CONFIG::SD_BENCH_FREQUENCIES) {
+        SDFrequencyResult& frequencyResult { result.frequencies[result.frequencyCount++] };
+        frequencyResult.frequency = frequency;
+        frequencyResult.stable = sdManager->beginCard(frequency, false) && verifyFrequency(frequencyResult);
+        if (frequencyResult.stable && frequency > result.fastestStableFrequency) {
+            result.fastestStableFrequency = frequency;
+        }
+    }
+    sdManager->getStorage().remove(CONFIG::SD_BENCH_FILE);
+
+    // Powrót do poprzedniego zegaru lub ustawienie najszybszego stabilnego
+    const bool applyFastest { apply && result.fastestStableFrequency != 0 };
+    const uint32_t targetFrequency { applyFastest ? result.fastestStableFrequency : originalFrequency };
+    result.frequencyApplied = sdManager->beginCard(targetFrequency, true) && applyFastest;
+    if (sdManager->getSpiFrequency() != targetFrequency || !sdManager->isCardInitialized()) {
+        sdManager->beginCard(originalFrequency, true);
+    }
+    sdManager->giveSD();
+}
+
+bool SDBenchmark::verifyFrequency(SDFrequencyResult& frequencyResult) {
+    Storage& storage { sdManager->getStorage() };
+    const uint32_t seed { frequencyResult.frequency };
+
+    std::unique_ptr<StorageFile> file { storage.open(CONFIG::SD_BENCH_FILE, StorageMode::WRITE) };
+    if (!file) {
+        return false;
+    }
+    uint32_t writeUs { 0 };
+    for (size_t position { 0 }; position < CONFIG::SD_BENCH_SWEEP_FILE_SIZE; position += CONFIG::SD_BENCH_BLOCK_SIZE) {
+        fillPattern(buffer, CONFIG::SD_BENCH_BLOCK_SIZE, position, seed);
+        const uint32_t blockStart { static_cast<uint32_t>(micros()) };
+        const size_t written { file->write(buffer, CONFIG::SD_BENCH_BLOCK_SIZE) };
+        writeUs += elapsedSince(blockStart);
+        if (written != CONFIG::SD_BENCH_BLOCK_SIZE) {
+            return false;
+        }
+    }
+    const uint32_t closeStart { static_cast<uint32_t>(micros()) };
+    file->close();
+    writeUs += elapsedSince(closeStart);
+
+    file = storage.open(CONFIG::SD_BENCH_FILE, StorageMode::READ);
+    if (!file) {
+        return false;
+    }
+    uint32_t readUs { 0 };
+    for (size_t position { 0 }; position < CONFIG::SD_BENCH_SWEEP_FILE_SIZE; position += CONFIG::SD_BENCH_BLOCK_SIZE) {
+        const uint32_t blockStart { static_cast<uint32_t>(micros()) };
+        const size_t received { file->read(buffer, CONFIG::SD_BENCH_BLOCK_SIZE) };
+        readUs += elapsedSince(blockStart);
+        if (received != CONFIG::SD_BENCH_BLOCK_SIZE || !checkPattern(buffer, received, position, seed)) {
+            return false;
+        }
+    }
+
+    frequencyResult.writeMBps = megabytesPerSecond(CONFIG::SD_BENCH_SWEEP_FILE_SIZE, writeUs);
+    frequencyResult.readMBps = megabytesPerSecond(CONFIG::SD_BENCH_SWEEP_FILE_SIZE, readUs);
+    return true;
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <Arduino.h>
+
+#include "CONFIGURATION.h"
+#include "SDManager.h"
+
+enum class SDBenchmarkStatus {
+    OK,
+    CARD_NOT_INITIALIZED,
+    SD_BUSY,
+    MEMORY_ALLOCATION_FAILED,
+    FILE_OPEN_FAILED,
+    FILE_WRITE_FAILED,
+    FILE_READ_FAILED,
+    VERIFY_FAILED
+};
+
+// Rozkład czasu pojedynczej operacji [us]
+struct SDLatencyStats {
+    uint32_t minUs { 0 };
+    uint32_t averageUs { 0 };
+    uint32_t p50Us { 0 };
+    uint32_t p95Us { 0 };
+    uint32_t p99Us { 0 };
+    uint32_t maxUs { 0 };
+};
+
+// Wynik próby jednego zegaru SPI: uruchomienie karty, zapis i weryfikacja odczytu
+struct SDFrequencyResult {
+    uint32_t frequency { 0 };       // [Hz]
+    bool stable { false };
+    float readMBps { 0.0f };
+    float writeMBps { 0.0f };
+};
+
+struct SDBenchmarkResult {
+    SDBenchmarkStatus status { SDBenchmarkStatus::OK };
+    uint32_t spiFrequency { 0 };            // [Hz] Zegar pomiarów sekwencyjnych i losowych
+    uint32_t durationMs { 0 };
+
+    // Odczyt i zapis sekwencyjny blokami SD_BENCH_BLOCK_SIZE (czas samych operacji na pliku)
+    float writeMBps { 0.0f };
+    float readMBps { 0.0f };
+
+    // Odczyt sektora (512 B) z losowego położenia w pliku testowym
+    SDLatencyStats randomRead {};
+
+    // Średni czas otwarcia i zamknięcia pliku, skanowanie katalogu projektów
+    uint32_t openCloseUs { 0 };
+    uint32_t scanUs { 0 };
+    uint32_t scanEntries { 0 };
+
+    // Próby zegarów SPI (tylko przy sweep)
+    static constexpr size_t MAX_FREQUENCIES { sizeof(CONFIG::SD_BENCH_FREQUENCIES) / sizeof(CONFIG::SD_BENCH_FREQUENCIES[0]) };
+    SDFrequencyResult frequencies[MAX_FREQUENCIES] {};
+    size_t frequencyCount { 0 };
+    uint32_t fastestStableFrequency { 0 };  // [Hz] 0 = brak próby lub żaden zegar nie był stabilny
+    bool frequencyApplied { false };        // Najszybszy stabilny zegar ustawiony na stałe
+};
+
+// Test wydajności karty SD: przepustowość sekwencyjna, rozkład opóźnień losowego odczytu
+// sektora, koszt otwarcia pliku i skanowania katalogu oraz (opcjonalnie) próba kolejnych
+// zegarów SPI z weryfikacją zapisanych danych. Pomiary sekwencyjne zajmują kartę na czas
+// jednego bloku (z oddawaniem zadaniu CNC), próba zegarów - na cały czas próby, bo kartę
+// trzeba ponownie uruchomić. Próby zegarów nie wolno wykonywać przy otwartych plikach
+// (pobieranie, podgląd, przesyłanie, wykonywane zadanie).
+class SDBenchmark {
+    private:
+    SDCardManager* sdManager { nullptr };
+    uint8_t* buffer { nullptr };
+
+    SDBenchmarkStatus measureSequential(SDBenchmarkResult& result);
+    SDBenchmarkStatus measureRandomRead(SDBenchmarkResult& result);
+    SDBenchmarkStatus measureOpenClose(SDBenchmarkResult& result);
+    SDBenchmarkStatus measureDirectoryScan(SDBenchmarkResult& result);
+    void sweepFrequencies(SDBenchmarkResult& result, bool apply);
+
+    // Zapis i weryfikacja pliku próby przy bieżącym zegarze (karta zajęta)
+    bool verifyFrequency(SDFrequencyResult& frequencyResult);
+
+    public:
+    SDBenchmark() = default;
+    ~SDBenchmark();
+
+    SDBenchmark(const SDBenchmark&) = delete;
+    SDBenchmark& operator=(const SDBenchmark&) = delete;
+
+    // Pełny test; sweep = próba zegarów SPI, apply = ustawienie najszybszego stabilnego zegaru
+    SDBenchmarkStatus run(SDCardManager* manager, bool sweep, bool apply, SDBenchmarkResult& result);
+
+    static const char* statusName(SDBenchmarkStatus status);
+};
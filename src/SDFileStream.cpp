@@ -0,0 +1,163 @@
+// ================================================================================
+//                   STRUMIENIOWY ODCZYT PLIKU Z KARTY SD (HTTP)
+// ================================================================================
+// Pobieranie plików porcjami z krótkim zajęciem karty i obsługą zakresów (Range)
+
+#include "SDFileStream.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+SDFileStream::~SDFileStream() {
+    if (file) {
+        // Odmowa zajęcia (pełna kolejka zgłoszeń) nie może zwolnić karty innego zadania - plik tylko
+        // do odczytu jest wtedy zamykany bez zajęcia (zamknięcie nie zapisuje na kartę)
+        const bool cardTaken { sdManager->takeSD(SDPriority::BACKGROUND) };
+        file.reset();
+        if (cardTaken) {
+            sdManager->giveSD();
+        }
+    }
+}
+
+SDFileStreamStatus SDFileStream::begin(SDCardManager* manager, const char* path, const char* range) {
+    if (manager == nullptr || path == nullptr) {
+        return SDFileStreamStatus::INVALID_PARAMETERS;
+    }
+    if (!manager->isCardInitialized()) {
+        return SDFileStreamStatus::CARD_NOT_INITIALIZED;
+    }
+
+    sdManager = manager;
+    if (!sdManager->takeSD(SDPriority::BACKGROUND)) {
+        return SDFileStreamStatus::CARD_NOT_INITIALIZED;
+    }
+    file = sdManager->getStorage().open(path, StorageMode::READ);
+    if (file) {
+        fileSize = file->size();
+    }
+    sdManager->giveSD();
+
+    if (!file) {
+        return SDFileStreamStatus::FILE_NOT_FOUND;
+    }
+
+    rangeStart = 0;
+    rangeLength = fileSize;
+    partial = false;
+    if (range != nullptr && !parseRange(range)) {
+        return SDFileStreamStatus::RANGE_NOT_SATISFIABLE;
+    }
+
+    if (rangeStart > 0) {
+        if (!sdManager->takeSD(SDPriority::BACKGROUND)) {
+            return SDFileStreamStatus::CARD_NOT_INITIALIZED;
+        }
+        const bool seeked { file->seek(rangeStart) };
+        sdManager->giveSD();
+        if (!seeked) {
+            return SDFileStreamStatus::RANGE_NOT_SATISFIABLE;
+        }
+    }
+
+    return SDFileStreamStatus::OK;
+}
+
+bool SDFileStream::parseRange(const char* header) {
+    // Tylko jednostka bytes i pojedynczy zakres - pozostałe nagłówki Range są ignorowane
+    while (*header == ' ') {
+        ++header;
+    }
+    if (strncmp(header, "bytes=", 6) != 0 || strchr(header, ',') != nullptr) {
+        return true;
+    }
+    const char* cursor { header + 6 };
+    while (*cursor == ' ') {
+        ++cursor;
+    }
+
+    char* end { nullptr };
+    if (*cursor == '-') {
+        // bytes=-N: ostatnie N bajtów
+        const unsigned long suffix { strtoul(cursor + 1, &end, 10) };
+        if (end == cursor + 1 || suffix == 0 || fileSize == 0) {
+            return false;
+        }
+        rangeLength = suffix < fileSize ? suffix : fileSize;
+        rangeStart = fileSize - rangeLength;
+        partial = true;
+        return true;
+    }
+
+    // bytes=A- lub bytes=A-B
+    const unsigned long first { strtoul(cursor, &end, 10) };
+    if (end == cursor || *end != '-') {
+        return true;
+    }
+    if (first >= fileSize) {
+        return false;
+    }
+
+    cursor = end + 1;
+    unsigned long last { fileSize - 1 };
+    if (*cursor >= '0' && *cursor <= '9') {
+        last = strtoul(cursor, &end, 10);
+        if (last < first) {
+            return true;
+        }
+        if (last >= fileSize) {
+            last = fileSize - 1;
+        }
+    }
+
+    rangeStart = first;
+    rangeLength = last - first + 1;
+    partial = true;
+    return true;
+}
+
+size_t SDFileStream::read(uint8_t* buffer, size_t maxLength) {
+    cardBusy = false;
+    if (buffer == nullptr || !file || sent >= rangeLength) {
+        return 0;
+    }
+
+    // Porcja ograniczona, aby karta była zajęta możliwie krótko
+    size_t length { rangeLength - sent };
+    if (length > maxLength) {
+        length = maxLength;
+    }
+    if (length > CONFIG::SD_STREAM_CHUNK_SIZE) {
+        length = CONFIG::SD_STREAM_CHUNK_SIZE;
+    }
+
+    if (!sdManager->takeSD(SDPriority::BACKGROUND)) {
+        cardBusy = true;
+        return 0;
+    }
+    const size_t count { file->read(buffer, length) };
+    sdManager->giveSD();
+
+    sent += count;
+    return count;
+}
+
+size_t SDFileStream::getFileSize() const {
+    return fileSize;
+}
+
+size_t SDFileStream::getRangeStart() const {
+    return rangeStart;
+}
+
+size_t SDFileStream::getRangeLength() const {
+    return rangeLength;
+}
+
+bool SDFileStream::isPartial() const {
+    return partial;
+}
+
+bool SDFileStream::isCardBusy() const {
+    return cardBusy;
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <Arduino.h>
+#include <memory>
+
+#include "CONFIGURATION.h"
+#include "SDManager.h"
+#include "Storage.h"
+
+enum class SDFileStreamStatus {
+    OK,
+    INVALID_PARAMETERS,
+    CARD_NOT_INITIALIZED,
+    FILE_NOT_FOUND,
+    RANGE_NOT_SATISFIABLE
+};
+
+// Odczyt pliku z karty SD porcjami na potrzeby odpowiedzi HTTP.
+// Plik pozostaje otwarty między porcjami, ale karta zajmowana jest wyłącznie na czas
+// odczytu jednej porcji (co najwyżej SD_STREAM_CHUNK_SIZE bajtów) - zadanie CNC czytające
+// plik zadania czeka najwyżej na jedną porcję, a nie na całe pobieranie.
+// Obsługiwany jest pojedynczy zakres bajtów nagłówka HTTP Range (RFC 9110).
+class SDFileStream {
+    private:
+    SDCardManager* sdManager { nullptr };
+    std::unique_ptr<StorageFile> file {};
+    size_t fileSize { 0 };
+    size_t rangeStart { 0 };
+    size_t rangeLength { 0 };
+    size_t sent { 0 };
+    bool partial { false };
+    bool cardBusy { false };
+
+    // Interpretacja nagłówka Range; false = zakres poza plikiem
+    // Nagłówki nieobsługiwane (inne jednostki, wiele zakresów) dają cały plik
+    bool parseRange(const char* header);
+
+    public:
+    SDFileStream() = default;
+    ~SDFileStream();
+
+    // Otwarcie pliku i ustalenie zakresu do wysłania; range = wartość nagłówka Range lub nullptr
+    SDFileStreamStatus begin(SDCardManager* manager, const char* path, const char* range);
+
+    // Kolejna porcja zakresu (co najwyżej maxLength bajtów); 0 = koniec zakresu, błąd odczytu
+    // lub karta chwilowo niedostępna (isCardBusy())
+    size_t read(uint8_t* buffer, size_t maxLength);
+
+    // true = ostatni read() nie uzyskał karty - porcję należy pobrać ponownie
+    bool isCardBusy() const;
+
+    size_t getFileSize() const;
+    size_t getRangeStart() const;
+    size_t getRangeLength() const;
+
+    // true = odpowiedź częściowa (206) z nagłówkiem Content-Range
+    bool isPartial() const;
+};
@@ -5,10 +5,21 @@
 // Obsługuje projekty G-code, konfigurację oraz synchronizację dostępu
 
 #include "SDManager.h"
+#include "ProjectUpload.h"
+#include "GCodeAnalyzer.h"
 #include "CONFIGURATION.H"
+#include "ArduinoFSStorage.h"
 
 #include <SD.h>
 #include <Arduino.h>
+#include <esp_crc.h>
+#include <string.h>
+#include <algorithm>
+
+namespace {
+    // Domyślny backend plików - karta SD
+    ArduinoFSStorage sdStorage { SD };
+}
 
 // ================================================================================
 //                           KONSTRUKTOR I DESTRUKTOR
@@ -16,8 +27,10 @@
 
 SDCardManager::~SDCardManager() {
     // Zwolnienie zasobów FreeRTOS
-    if (sdMutex != nullptr) {
-        vSemaphoreDelete(sdMutex);
+    for (SDWaiter& waiter : waiters) {
+        if (waiter.signal != nullptr) {
+            vSemaphoreDelete(waiter.signal);
+        }
     }
 }
 
@@ -27,34 +40,41 @@ SDCardManager::~SDCardManager() {
 
 SDManagerStatus SDCardManager::init() {
     // Inicjalizacja interfejsu SPI dla karty SD z optymalnymi parametrami
-    if (!SD.begin(PINCONFIG::SD_CS_PIN, SPI, 25000000)) {
+    if (this->storage == nullptr && !SD.begin(PINCONFIG::SD_CS_PIN, SPI, this->spiFrequency)) {
         return SDManagerStatus::INIT_FAILED;
     }
 
     // Tworzenie struktury katalogów jeśli nie istnieją
-    if (!SD.exists(CONFIG::PROJECTS_DIR)) {
+    if (!getStorage().exists(CONFIG::PROJECTS_DIR)) {
         if (!createDirectory(CONFIG::PROJECTS_DIR)) {
             return SDManagerStatus::DIRECTORY_CREATE_FAILED;
         }
     }
 
-    if (!SD.exists(CONFIG::CONFIG_DIR)) {
+    if (!getStorage().exists(CONFIG::CONFIG_DIR)) {
         if (!createDirectory(CONFIG::CONFIG_DIR)) {
             return SDManagerStatus::DIRECTORY_CREATE_FAILED;
         }
     }
 
-    // Tworzenie mutexa dla thread-safe dostępu do karty SD
-    this->sdMutex = xSemaphoreCreateMutex();
-
-    if (this->sdMutex == nullptr) {
-        return SDManagerStatus::MUTEX_CREATE_FAILED;
+    // Semafory miejsc kolejki dostępu - tworzone raz, ponowna inicjalizacja karty ich nie odtwarza
+    if (!this->schedulerReady) {
+        for (SDWaiter& waiter : this->waiters) {
+            waiter.signal = xSemaphoreCreateBinary();
+            if (waiter.signal == nullptr) {
+                return SDManagerStatus::MUTEX_CREATE_FAILED;
+            }
+        }
+        this->schedulerReady = true;
     }
 
     this->cardInitialized = true;
 
-    // Wczytanie listy dostępnych projektów
-    SDManagerStatus listStatus = this->updateProjectList();
+    // Wczytanie listy dostępnych projektów - z indeksu, a przy jego braku pełne skanowanie
+    SDManagerStatus listStatus = this->loadProjectIndex();
+    if (listStatus != SDManagerStatus::OK) {
+        listStatus = this->updateProjectList();
+    }
     #ifdef DEBUG_SD
     if (listStatus != SDManagerStatus::OK) {
         Serial.println("WARNING: Zainicjalizowano SD, ale nie wczytano listy projektow.");
@@ -74,7 +94,65 @@ bool SDCardManager::createDirectory(const std::string& path) {
     if (!localPath.empty() && localPath.back() == '/') {
         localPath.pop_back();
     }
-    return SD.mkdir(localPath.c_str());
+    return getStorage().mkdir(localPath.c_str());
+}
+
+bool SDCardManager::beginCard(uint32_t frequency, bool keep) {
+    // Inny backend niż karta SD nie ma magistrali SPI
+    bool started { true };
+    if (this->storage == nullptr) {
+        SD.end();
+        started = SD.begin(PINCONFIG::SD_CS_PIN, SPI, frequency);
+    }
+
+    this->cardInitialized = started;
+    if (started && keep) {
+        this->spiFrequency = frequency;
+    }
+    return started;
+}
+
+SDManagerStatus SDCardManager::applySpiFrequency(uint32_t frequency) {
+    if (frequency == 0) {
+        frequency = DEFAULTS::SD_SPI_FREQUENCY;
+    }
+    frequency = std::max(CONFIG::SD_SPI_MIN_FREQUENCY, std::min(frequency, CONFIG::SD_SPI_MAX_FREQUENCY));
+    if (frequency == this->spiFrequency) {
+        return SDManagerStatus::OK;
+    }
+
+    // Zegar zostanie użyty przy inicjalizacji karty
+    if (!this->isCardInitialized()) {
+        this->spiFrequency = frequency;
+        return SDManagerStatus::OK;
+    }
+
+    if (!takeSD()) {
+        return SDManagerStatus::SD_BUSY;
+    }
+    const bool started { beginCard(frequency, true) };
+    if (!started) {
+        beginCard(this->spiFrequency, false);
+    }
+    giveSD();
+
+    #ifdef DEBUG_SD
+    Serial.printf("DEBUG SD: Zegar SPI %lu Hz (%s)\n", static_cast<unsigned long>(this->spiFrequency), started ? "zmieniony" : "bez zmian");
+    #endif
+
+    return started ? SDManagerStatus::OK : SDManagerStatus::INIT_FAILED;
+}
+
+uint32_t SDCardManager::getSpiFrequency() const {
+    return this->spiFrequency;
+}
+
+void SDCardManager::setStorage(Storage* backend) {
+    this->storage = backend;
+}
+
+Storage& SDCardManager::getStorage() {
+    return this->storage != nullptr ? *this->storage : sdStorage;
 }
 
 bool SDCardManager::isCardInitialized() const {
@@ -97,37 +175,86 @@ SDManagerStatus SDCardManager::updateProjectList() {
         path.pop_back();
     }
 
-    // Thread-safe dostęp do karty SD
-    if (!takeSD()) {
+    // Skanowanie katalogu jako operacja w tle - oddaje kartę zadaniu CNC między wpisami
+    if (!takeSD(SDPriority::BACKGROUND)) {
         return SDManagerStatus::SD_BUSY;
     }
 
-    File dir = SD.open(path.c_str());
-    if (!dir || !dir.isDirectory()) {
+    // Skanowanie katalogu i budowa listy plików projektów
+    // Lista budowana lokalnie - między wpisami karta może być oddana innym zadaniom
+    std::vector<ProjectFileInfo> scannedFiles {};
+    std::vector<size_t> changedFiles {};
+    bool cardLost { false };
+
+    const bool listed { getStorage().list(path.c_str(), [&](const StorageEntry& entry) {
+        // Uwzględnianie tylko plików (pomijanie podkatalogów i trwających przesyłań)
+        if (!entry.directory && !ProjectUpload::isTempFile(entry.name)) {
+            ProjectFileInfo info {};
+            info.name = entry.name;
+            info.size = entry.size;
+            info.modified = entry.modified;
+
+            // Metadane z indeksu, jeśli plik nie zmienił się od ostatniej analizy
+            bool cached { false };
+            for (const ProjectFileInfo& known : this->projectFiles) {
+                if (known.name == info.name && known.size == info.size && known.modified == info.modified) {
+                    info = known;
+                    cached = true;
+                    break;
+                }
+            }
+            if (!cached) {
+                changedFiles.push_back(scannedFiles.size());
+            }
+            scannedFiles.push_back(info);
+        }
+        cardLost = !yieldSD();
+        return !cardLost;
+    }) };
+
+    if (cardLost) {
+        return SDManagerStatus::SD_BUSY;
+    }
+    if (!listed) {
         giveSD();
         return SDManagerStatus::DIRECTORY_OPEN_FAILED;
     }
 
-    // Skanowanie katalogu i budowa listy plików projektów
-    this->projectFiles.clear();
-
-    File entry { dir.openNextFile() };
-    while (entry) {
-        // Uwzględnianie tylko plików (pomijanie podkatalogów)
-        if (!entry.isDirectory()) {
-            projectFiles.push_back(entry.name());
+    // Analiza wyłącznie plików nowych i zmienionych
+    for (const size_t index : changedFiles) {
+        const SDManagerStatus analyzeStatus { analyzeProjectFile(scannedFiles[index]) };
+        if (analyzeStatus == SDManagerStatus::SD_BUSY) {
+            return analyzeStatus;
+        }
+        #ifdef DEBUG_SD
+        if (analyzeStatus != SDManagerStatus::OK) {
+            Serial.printf("WARNING: Nie udalo sie przeanalizowac pliku %s\n", scannedFiles[index].name.c_str());
         }
-        entry.close();
-        entry = dir.openNextFile();
+        #endif
     }
 
-    dir.close();
+    const bool changed { !changedFiles.empty() || scannedFiles.size() != this->projectFiles.size() };
+    if (changed) {
+        ++this->projectGeneration;
+    }
+    for (const size_t index : changedFiles) {
+        scannedFiles[index].revision = this->projectGeneration;
+    }
+    this->projectFiles.swap(scannedFiles);
     giveSD();
 
+    #ifdef DEBUG_SD
+    Serial.printf("DEBUG SD: Lista projektow: %u plikow, %u przeanalizowanych\n",
+        static_cast<unsigned>(this->projectFiles.size()), static_cast<unsigned>(changedFiles.size()));
+    #endif
+
+    if (changed) {
+        return saveProjectIndex();
+    }
     return SDManagerStatus::OK;
 }
 
-SDManagerStatus SDCardManager::getProjectFiles(std::vector<std::string>& projectList) {
+SDManagerStatus SDCardManager::getProjectFiles(std::vector<ProjectFileInfo>& projectList) {
     // Walidacja stanu karty SD
     if (!this->isCardInitialized()) {
         return SDManagerStatus::CARD_NOT_INITIALIZED;
@@ -143,22 +270,430 @@ SDManagerStatus SDCardManager::getProjectFiles(std::vector<std::string>& project
     return SDManagerStatus::OK;
 }
 
+SDManagerStatus SDCardManager::addProjectFile(const ProjectFileInfo& info) {
+    if (!this->isCardInitialized()) {
+        return SDManagerStatus::CARD_NOT_INITIALIZED;
+    }
+    if (!takeSD()) {
+        return SDManagerStatus::SD_BUSY;
+    }
+
+    ++this->projectGeneration;
+    bool replaced { false };
+    for (ProjectFileInfo& known : this->projectFiles) {
+        if (known.name == info.name) {
+            known = info;
+            known.revision = this->projectGeneration;
+            replaced = true;
+            break;
+        }
+    }
+    if (!replaced) {
+        this->projectFiles.push_back(info);
+        this->projectFiles.back().revision = this->projectGeneration;
+    }
+    giveSD();
+
+    return saveProjectIndex();
+}
+
+bool SDCardManager::findProjectFile(const std::string& filename, ProjectFileInfo& info) const {
+    for (const ProjectFileInfo& known : this->projectFiles) {
+        if (known.name == filename) {
+            info = known;
+            return true;
+        }
+    }
+    return false;
+}
+
+SDManagerStatus SDCardManager::removeProjectFile(const std::string& filename) {
+    if (!this->isCardInitialized()) {
+        return SDManagerStatus::CARD_NOT_INITIALIZED;
+    }
+    if (!takeSD()) {
+        return SDManagerStatus::SD_BUSY;
+    }
+
+    bool removed { false };
+    for (size_t index { 0 }; index < this->projectFiles.size(); ++index) {
+        if (this->projectFiles[index].name == filename) {
+            this->projectFiles.erase(this->projectFiles.begin() + index);
+            removed = true;
+            break;
+        }
+    }
+    ++this->projectGeneration;
+    giveSD();
+
+    if (!removed) {
+        return SDManagerStatus::FILE_NOT_FOUND;
+    }
+    return saveProjectIndex();
+}
+
+SDManagerStatus SDCardManager::analyzeProjectFile(ProjectFileInfo& info) {
+    const std::string filePath { CONFIG::PROJECTS_DIR + info.name };
+    std::unique_ptr<StorageFile> file { getStorage().open(filePath.c_str(), StorageMode::READ) };
+    if (!file) {
+        return SDManagerStatus::FILE_OPEN_FAILED;
+    }
+
+    GCodeAnalyzer analyzer {};
+    uint8_t chunk[CONFIG::PROJECT_ANALYZE_CHUNK_SIZE];
+    size_t count { file->read(chunk, sizeof(chunk)) };
+    while (count > 0) {
+        analyzer.feed(chunk, count);
+        if (!yieldSD()) {
+            return SDManagerStatus::SD_BUSY;
+        }
+        count = file->read(chunk, sizeof(chunk));
+    }
+    file->close();
+    analyzer.finish();
+
+    info.lineCount = analyzer.getLineCount();
+    info.moveCount = analyzer.getMoveCount();
+    info.minX = analyzer.getMinX();
+    info.minY = analyzer.getMinY();
+    info.maxX = analyzer.getMaxX();
+    info.maxY = analyzer.getMaxY();
+    return SDManagerStatus::OK;
+}
+
+// ================================================================================
+//                          INDEKS LISTY PROJEKTÓW
+// ================================================================================
+// Format (little-endian): 'P' 'I' 'D' 'X', wersja, liczba wpisów (uint32), wpisy:
+// długość nazwy (uint8), nazwa, rozmiar, czas zapisu, linie, ruchy (4 x uint32),
+// minX, minY, maxX, maxY (4 x float32); na końcu CRC32 całości
+
+namespace {
+    constexpr uint8_t PROJECT_INDEX_MAGIC[] { 'P', 'I', 'D', 'X' };
+    constexpr uint8_t PROJECT_INDEX_VERSION { 1 };
+    constexpr size_t PROJECT_INDEX_HEADER_SIZE { sizeof(PROJECT_INDEX_MAGIC) + 1 + sizeof(uint32_t) };
+    constexpr size_t PROJECT_INDEX_ENTRY_SIZE { 1 + 4 * sizeof(uint32_t) + 4 * sizeof(float) };
+
+    template <typename T>
+    void appendValue(std::vector<uint8_t>& output, const T& value) {
+        const uint8_t* bytes { reinterpret_cast<const uint8_t*>(&value) };
+        output.insert(output.end(), bytes, bytes + sizeof(T));
+    }
+
+    template <typename T>
+    bool readValue(const std::vector<uint8_t>& input, size_t& offset, T& value) {
+        if (input.size() - offset < sizeof(T)) {
+            return false;
+        }
+        memcpy(&value, input.data() + offset, sizeof(T));
+        offset += sizeof(T);
+        return true;
+    }
+}
+
+SDManagerStatus SDCardManager::saveProjectIndex() {
+    const std::string indexPath { std::string(CONFIG::CONFIG_DIR) + CONFIG::PROJECT_INDEX_FILE };
+    const std::string tempPath { indexPath + CONFIG::UPLOAD_TEMP_SUFFIX };
+
+    // Serializacja do pamięci przy zajętej karcie (spójna kopia listy), zapis z oddawaniem karty
+    if (!takeSD(SDPriority::BACKGROUND)) {
+        return SDManagerStatus::SD_BUSY;
+    }
+
+    std::vector<uint8_t> output {};
+    output.reserve(PROJECT_INDEX_HEADER_SIZE + this->projectFiles.size() * (PROJECT_INDEX_ENTRY_SIZE + 32) + sizeof(uint32_t));
+    output.insert(output.end(), PROJECT_INDEX_MAGIC, PROJECT_INDEX_MAGIC + sizeof(PROJECT_INDEX_MAGIC));
+    output.push_back(PROJECT_INDEX_VERSION);
+    appendValue(output, static_cast<uint32_t>(this->projectFiles.size()));
+    for (const ProjectFileInfo& info : this->projectFiles) {
+        const uint8_t nameLength { static_cast<uint8_t>(info.name.size() < UINT8_MAX ? info.name.size() : UINT8_MAX) };
+        output.push_back(nameLength);
+        output.insert(output.end(), info.name.begin(), info.name.begin() + nameLength);
+        appendValue(output, info.size);
+        appendValue(output, info.modified);
+        appendValue(output, info.lineCount);
+        appendValue(output, info.moveCount);
+        appendValue(output, info.minX);
+        appendValue(output, info.minY);
+        appendValue(output, info.maxX);
+        appendValue(output, info.maxY);
+    }
+    appendValue(output, esp_crc32_le(0, output.data(), output.size()));
+
+    // Zapis do pliku tymczasowego i zamiana - przerwany zapis nie niszczy poprzedniego indeksu
+    std::unique_ptr<StorageFile> file { getStorage().open(tempPath.c_str(), StorageMode::WRITE) };
+    if (!file) {
+        giveSD();
+        return SDManagerStatus::FILE_OPEN_FAILED;
+    }
+    size_t written { 0 };
+    while (written < output.size()) {
+        size_t count { output.size() - written };
+        if (count > CONFIG::UPLOAD_WRITE_BLOCK_SIZE) {
+            count = CONFIG::UPLOAD_WRITE_BLOCK_SIZE;
+        }
+        if (file->write(output.data() + written, count) != count) {
+            break;
+        }
+        written += count;
+        if (written < output.size() && !yieldSD()) {
+            return SDManagerStatus::SD_BUSY;
+        }
+    }
+    file->close();
+
+    bool saved { written == output.size() };
+    if (saved) {
+        saved = getStorage().rename(tempPath.c_str(), indexPath.c_str());
+    }
+    else {
+        getStorage().remove(tempPath.c_str());
+    }
+    giveSD();
+
+    return saved ? SDManagerStatus::OK : SDManagerStatus::UNKNOWN_ERROR;
+}
+
+SDManagerStatus SDCardManager::loadProjectIndex() {
+    const std::string indexPath { std::string(CONFIG::CONFIG_DIR) + CONFIG::PROJECT_INDEX_FILE };
+
+    if (!takeSD(SDPriority::BACKGROUND)) {
+        return SDManagerStatus::SD_BUSY;
+    }
+    std::unique_ptr<StorageFile> file { getStorage().open(indexPath.c_str(), StorageMode::READ) };
+    if (!file) {
+        giveSD();
+        return SDManagerStatus::FILE_NOT_FOUND;
+    }
+    std::vector<uint8_t> input(file->size());
+    const size_t count { input.empty() ? 0 : file->read(input.data(), input.size()) };
+    file->close();
+    giveSD();
+
+    // Walidacja nagłówka i sumy kontrolnej - uszkodzony indeks wymusza pełne skanowanie
+    if (count != input.size() || input.size() < PROJECT_INDEX_HEADER_SIZE + sizeof(uint32_t)
+        || memcmp(input.data(), PROJECT_INDEX_MAGIC, sizeof(PROJECT_INDEX_MAGIC)) != 0
+        || input[sizeof(PROJECT_INDEX_MAGIC)] != PROJECT_INDEX_VERSION) {
+        return SDManagerStatus::UNKNOWN_ERROR;
+    }
+    uint32_t storedCrc { 0 };
+    memcpy(&storedCrc, input.data() + input.size() - sizeof(storedCrc), sizeof(storedCrc));
+    input.resize(input.size() - sizeof(storedCrc));
+    if (esp_crc32_le(0, input.data(), input.size()) != storedCrc) {
+        return SDManagerStatus::UNKNOWN_ERROR;
+    }
+
+    size_t offset { sizeof(PROJECT_INDEX_MAGIC) + 1 };
+    uint32_t entries { 0 };
+    readValue(input, offset, entries);
+
+    std::vector<ProjectFileInfo> loadedFiles {};
+    loadedFiles.reserve(entries);
+    for (uint32_t index { 0 }; index < entries; ++index) {
+        uint8_t nameLength { 0 };
+        ProjectFileInfo info {};
+        if (!readValue(input, offset, nameLength) || input.size() - offset < nameLength) {
+            return SDManagerStatus::UNKNOWN_ERROR;
+        }
+        info.name.assign(reinterpret_cast<const char*>(input.data() + offset), nameLength);
+        offset += nameLength;
+        if (!readValue(input, offset, info.size) || !readValue(input, offset, info.modified)
+            || !readValue(input, offset, info.lineCount) || !readValue(input, offset, info.moveCount)
+            || !readValue(input, offset, info.minX) || !readValue(input, offset, info.minY)
+            || !readValue(input, offset, info.maxX) || !readValue(input, offset, info.maxY)) {
+            return SDManagerStatus::UNKNOWN_ERROR;
+        }
+        loadedFiles.push_back(info);
+    }
+
+    if (!takeSD()) {
+        return SDManagerStatus::SD_BUSY;
+    }
+    this->projectFiles.swap(loadedFiles);
+    giveSD();
+    return SDManagerStatus::OK;
+}
+
 // ================================================================================
-//                          SYNCHRONIZACJA DOSTĘPU (MUTEX)
+//                     SYNCHRONIZACJA DOSTĘPU (KOLEJKA PRIORYTETOWA)
 // ================================================================================
 
-bool SDCardManager::takeSD() {
-    // Blokada mutexa do czasu zwolnienia przez giveSD()
-    if (this->sdMutex != nullptr) {
-        return xSemaphoreTake(this->sdMutex, portMAX_DELAY) == pdTRUE;
+int SDCardManager::findNextWaiter() const {
+    int next { -1 };
+    for (size_t index { 0 }; index < CONFIG::SD_MAX_WAITERS; ++index) {
+        const SDWaiter& waiter { this->waiters[index] };
+        if (waiter.state != SDWaiter::State::WAITING) {
+            continue;
+        }
+        if (next < 0) {
+            next = static_cast<int>(index);
+            continue;
+        }
+        const SDWaiter& best { this->waiters[next] };
+        // Wyższy priorytet, a w obrębie klasy wcześniejsze zgłoszenie (różnica odporna na przepełnienie licznika)
+        if (waiter.priority < best.priority
+            || (waiter.priority == best.priority && static_cast<int32_t>(waiter.sequence - best.sequence) < 0)) {
+            next = static_cast<int>(index);
+        }
+    }
+    return next;
+}
+
+void SDCardManager::recordHold(uint32_t now) {
+    const uint8_t priorityIndex { static_cast<uint8_t>(this->ownerPriority) };
+    SDPriorityStats& classStats { this->stats[priorityIndex] };
+    const uint32_t held { now - this->ownedSince };
+    if (held > classStats.maxHoldUs) {
+        classStats.maxHoldUs = held;
+    }
+    if (held > CONFIG::SD_HOLD_BUDGET_US[priorityIndex]) {
+        ++classStats.holdOverruns;
     }
-    return false;
+}
+
+bool SDCardManager::takeSD(SDPriority priority) {
+    if (!this->schedulerReady) {
+        return false;
+    }
+
+    const uint8_t priorityIndex { static_cast<uint8_t>(priority) };
+    const uint32_t now { static_cast<uint32_t>(micros()) };
+
+    // Wolna karta - zajęcie bez kolejki
+    portENTER_CRITICAL(&this->schedulerMux);
+    if (!this->owned) {
+        this->owned = true;
+        this->ownerPriority = priority;
+        this->ownedSince = now;
+        ++this->stats[priorityIndex].requests;
+        portEXIT_CRITICAL(&this->schedulerMux);
+        return true;
+    }
+
+    // Zajęta karta - zgłoszenie w kolejce
+    SDWaiter* slot { nullptr };
+    for (SDWaiter& waiter : this->waiters) {
+        if (waiter.state == SDWaiter::State::FREE) {
+            slot = &waiter;
+            break;
+        }
+    }
+    if (slot == nullptr) {
+        portEXIT_CRITICAL(&this->schedulerMux);
+        #ifdef DEBUG_SD
+        Serial.println("ERROR: Kolejka dostepu do karty SD pelna");
+        #endif
+        return false;
+    }
+    slot->state = SDWaiter::State::WAITING;
+    slot->priority = priority;
+    slot->sequence = this->nextSequence++;
+    slot->enqueuedAt = now;
+    portEXIT_CRITICAL(&this->schedulerMux);
+
+    // Karta przekazywana przez giveSD() - po wybudzeniu zadanie jest już właścicielem
+    xSemaphoreTake(slot->signal, portMAX_DELAY);
+
+    const uint32_t waited { static_cast<uint32_t>(micros()) - now };
+    portENTER_CRITICAL(&this->schedulerMux);
+    slot->state = SDWaiter::State::FREE;
+    SDPriorityStats& classStats { this->stats[priorityIndex] };
+    ++classStats.requests;
+    ++classStats.contended;
+    classStats.totalWaitUs += waited;
+    if (waited > classStats.maxWaitUs) {
+        classStats.maxWaitUs = waited;
+    }
+    portEXIT_CRITICAL(&this->schedulerMux);
+
+    return true;
 }
 
 void SDCardManager::giveSD() {
-    // Zwolnienie mutexa - umożliwienie dostępu innym wątkom
-    if (this->sdMutex != nullptr) {
-        xSemaphoreGive(this->sdMutex);
+    if (!this->schedulerReady) {
+        return;
+    }
+
+    const uint32_t now { static_cast<uint32_t>(micros()) };
+    SemaphoreHandle_t signal { nullptr };
+
+    portENTER_CRITICAL(&this->schedulerMux);
+    if (!this->owned) {
+        portEXIT_CRITICAL(&this->schedulerMux);
+        return;
+    }
+    recordHold(now);
+
+    // Przekazanie karty następnemu oczekującemu bez zwalniania (brak wyścigu z nowymi zgłoszeniami)
+    const int next { findNextWaiter() };
+    if (next >= 0) {
+        SDWaiter& waiter { this->waiters[next] };
+        waiter.state = SDWaiter::State::GRANTED;
+        this->ownerPriority = waiter.priority;
+        this->ownedSince = now;
+        signal = waiter.signal;
+    }
+    else {
+        this->owned = false;
+    }
+    portEXIT_CRITICAL(&this->schedulerMux);
+
+    if (signal != nullptr) {
+        xSemaphoreGive(signal);
+    }
+}
+
+bool SDCardManager::yieldSD() {
+    if (!this->schedulerReady) {
+        return false;
+    }
+
+    const uint32_t now { static_cast<uint32_t>(micros()) };
+    bool shouldYield { false };
+    SDPriority priority { SDPriority::INTERACTIVE };
+
+    portENTER_CRITICAL(&this->schedulerMux);
+    priority = this->ownerPriority;
+    const int next { findNextWaiter() };
+    if (next >= 0) {
+        const bool overBudget { now - this->ownedSince > CONFIG::SD_HOLD_BUDGET_US[static_cast<uint8_t>(priority)] };
+        shouldYield = this->waiters[next].priority < priority || overBudget;
+    }
+    portEXIT_CRITICAL(&this->schedulerMux);
+
+    if (!shouldYield) {
+        return true;
+    }
+
+    giveSD();
+    return takeSD(priority);
+}
+
+void SDCardManager::getSchedulerStats(SDPriorityStats* output) const {
+    if (output == nullptr) {
+        return;
+    }
+    portENTER_CRITICAL(&this->schedulerMux);
+    for (size_t index { 0 }; index < static_cast<size_t>(SDPriority::COUNT); ++index) {
+        output[index] = this->stats[index];
+    }
+    portEXIT_CRITICAL(&this->schedulerMux);
+}
+
+void SDCardManager::resetSchedulerStats() {
+    portENTER_CRITICAL(&this->schedulerMux);
+    for (SDPriorityStats& classStats : this->stats) {
+        classStats = SDPriorityStats {};
+    }
+    portEXIT_CRITICAL(&this->schedulerMux);
+}
+
+const char* SDCardManager::priorityName(SDPriority priority) {
+    switch (priority) {
+        case SDPriority::JOB: return "job";
+        case SDPriority::INTERACTIVE: return "interactive";
+        case SDPriority::BACKGROUND: return "background";
+        default: return "unknown";
     }
 }
 
@@ -192,7 +727,7 @@ SDManagerStatus  SDCardManager::setSelectedProject(const std::string& filename)
     }
 
     std::string fullPath { CONFIG::PROJECTS_DIR + filename };
-    if (!SD.exists(fullPath.c_str())) {
+    if (!getStorage().exists(fullPath.c_str())) {
         giveSD();
         return SDManagerStatus::FILE_NOT_FOUND;
     }
@@ -1,9 +1,13 @@
 #pragma once
 #include <vector>
 #include <string>
+#include <stdint.h>
 #include <freertos/FreeRTOS.h>
 #include <freertos/semphr.h>
 
+#include "CONFIGURATION.h"
+#include "Storage.h"
+
 enum class SDManagerStatus {
     OK,
     INIT_FAILED,
@@ -17,21 +21,93 @@ enum class SDManagerStatus {
     UNKNOWN_ERROR
 };
 
+// Klasy priorytetu dostępu do karty SD - niższa wartość = wyższy priorytet
+enum class SDPriority : uint8_t {
+    JOB,            // Odczyt wykonywanego zadania G-code (zadanie CNC)
+    INTERACTIVE,    // Żądania użytkownika: lista plików, wybór, usuwanie, konfiguracja
+    BACKGROUND,     // Operacje masowe: pobieranie i przesyłanie plików, podgląd
+    COUNT
+};
+
+// Statystyki kolejki dostępu do karty SD dla jednej klasy priorytetu
+struct SDPriorityStats {
+    uint32_t requests { 0 };        // Liczba zajęć karty
+    uint32_t contended { 0 };       // Zajęcia wymagające oczekiwania w kolejce
+    uint64_t totalWaitUs { 0 };     // [us] Łączny czas oczekiwania
+    uint32_t maxWaitUs { 0 };       // [us] Najdłuższe oczekiwanie
+    uint32_t maxHoldUs { 0 };       // [us] Najdłuższe zajęcie karty
+    uint32_t holdOverruns { 0 };    // Zajęcia dłuższe niż budżet klasy (SD_HOLD_BUDGET_US)
+};
+
+// Metadane pliku projektu w pamięci podręcznej listy projektów (zapisywanej w PROJECT_INDEX_FILE)
+struct ProjectFileInfo {
+    std::string name {};
+    uint32_t size { 0 };        // [B]
+    uint32_t modified { 0 };    // Czas ostatniego zapisu (time_t systemu plików)
+    uint32_t lineCount { 0 };
+    uint32_t moveCount { 0 };   // Ruchy G0/G1 z celem XY
+    float minX { 0.0f };        // [mm] Zakres celów ruchów
+    float minY { 0.0f };
+    float maxX { 0.0f };
+    float maxY { 0.0f };
+    uint32_t revision { 0 };    // Numer zmiany pliku (przesłanie, analiza) - tylko w pamięci, poza indeksem
+};
+
 // Klasa zarządza kartą SD, która służy jako miejsce przechowywania dla plików projektów i konfiguracji.
 class SDCardManager {
     private:
     // Śledzi stan inicjalizacji karty
     bool cardInitialized { false };
 
+    // Backend plików ustawiony przez setStorage(); nullptr = karta SD (ArduinoFSStorage)
+    Storage* storage { nullptr };
+
+    // Zegar SPI karty [Hz] - używany przy init() i beginCard()
+    uint32_t spiFrequency { DEFAULTS::SD_SPI_FREQUENCY };
+
     // Tworzy katalog na karcie SD
     // true = tworzenie katalogu powiodło się
     bool createDirectory(const std::string& path);
 
-    // Przechowuje nazwy plików projektów
-    std::vector<std::string> projectFiles {};
-
-    // Mutex dla dostępu do karty SD
-    SemaphoreHandle_t sdMutex {};
+    // Lista projektów z metadanymi - aktualizowana przyrostowo (przesłanie, usunięcie),
+    // pełne skanowanie tylko przy braku indeksu lub na żądanie odświeżenia
+    std::vector<ProjectFileInfo> projectFiles {};
+
+    // Licznik zmian plików projektów (przesłanie, usunięcie, skanowanie) - zmieniany przy zajętej karcie,
+    // źródło numerów ProjectFileInfo::revision
+    uint32_t projectGeneration { 0 };
+
+    // Liczba linii i zakres ruchów pliku projektu (odczyt porcjami z oddawaniem karty)
+    // Wywołanie przy zajętej karcie (SDPriority::BACKGROUND); SD_BUSY = karta utracona
+    SDManagerStatus analyzeProjectFile(ProjectFileInfo& info);
+
+    // Indeks listy projektów na karcie - wczytanie przy starcie zamiast skanowania katalogu
+    SDManagerStatus loadProjectIndex();
+    SDManagerStatus saveProjectIndex();
+
+    // Kolejka dostępu do karty SD: zwalniana karta przekazywana jest bezpośrednio
+    // oczekującemu o najwyższym priorytecie (w obrębie klasy - kolejność zgłoszeń)
+    struct SDWaiter {
+        enum class State : uint8_t { FREE, WAITING, GRANTED };
+        State state { State::FREE };
+        SDPriority priority { SDPriority::INTERACTIVE };
+        uint32_t sequence { 0 };
+        uint32_t enqueuedAt { 0 };          // [us]
+        SemaphoreHandle_t signal { nullptr };
+    };
+
+    mutable portMUX_TYPE schedulerMux = portMUX_INITIALIZER_UNLOCKED;
+    SDWaiter waiters[CONFIG::SD_MAX_WAITERS] {};
+    bool schedulerReady { false };
+    bool owned { false };
+    SDPriority ownerPriority { SDPriority::INTERACTIVE };
+    uint32_t ownedSince { 0 };              // [us]
+    uint32_t nextSequence { 0 };
+    SDPriorityStats stats[static_cast<size_t>(SDPriority::COUNT)] {};
+
+    // Oczekujący o najwyższym priorytecie; -1 = kolejka pusta (wywołanie w sekcji krytycznej)
+    int findNextWaiter() const;
+    void recordHold(uint32_t now);
 
     // Śledzi, czy projekt jest wybrany
     bool projectIsSelected { false };
@@ -48,21 +124,59 @@ class SDCardManager {
     // Inicjalizacja menadżera karty SD
     SDManagerStatus init();
 
+    // Ponowne uruchomienie karty z zegarem SPI frequency; keep = zegar zapamiętany dla kolejnych
+    // inicjalizacji. Wywołanie przy zajętej karcie i bez otwartych plików - uchwyty sprzed
+    // restartu są nieważne. false = karta nie odpowiada przy tym zegarze (karta niezainicjalizowana)
+    bool beginCard(uint32_t frequency, bool keep);
+
+    // Zmiana zegaru SPI karty (0 = domyślny, ograniczenie do SD_SPI_MIN/MAX_FREQUENCY);
+    // przy braku odpowiedzi karty powrót do poprzedniego zegaru. Wywołanie bez otwartych plików.
+    SDManagerStatus applySpiFrequency(uint32_t frequency);
+    uint32_t getSpiFrequency() const;
+
+    // Zastąpienie karty SD innym backendem (np. PosixStorage przy uruchamianiu na PC)
+    // Wywołanie przed init(); przy własnym backendzie karta SD nie jest montowana
+    void setStorage(Storage* backend);
+
+    // System plików karty - operacje na plikach wyłącznie przy zajętej karcie (takeSD)
+    Storage& getStorage();
+
     // Zajmuje kartę SD dla wyłącznego dostępu
-    bool takeSD();
+    // Przy zajętej karcie oczekiwanie w kolejce wg priorytetu; false = brak wolnego miejsca w kolejce
+    bool takeSD(SDPriority priority = SDPriority::INTERACTIVE);
 
     // Zwalnia kartę SD, aby inne zadania mogły z niej korzystać
     void giveSD();
 
+    // Długie operacje: oddanie karty oczekującemu o wyższym priorytecie (lub dowolnemu
+    // po przekroczeniu budżetu klasy) i ponowne zajęcie; false = ponowne zajęcie nie powiodło się
+    bool yieldSD();
+
+    // Kopia statystyk kolejki dla wszystkich klas (SDPriority::COUNT elementów)
+    void getSchedulerStats(SDPriorityStats* output) const;
+    void resetSchedulerStats();
+
+    // Nazwa klasy priorytetu (JSON, diagnostyka)
+    static const char* priorityName(SDPriority priority);
+
     // Sprawdzenie czy menadżer jest zainicjalizowany
     // true = karta SD jest zainicjalizowana
     bool isCardInitialized() const;
 
-    // Wczytanie listy plików projektów
+    // Pełne skanowanie katalogu projektów z uzgodnieniem indeksu - metadane
+    // wyznaczane tylko dla plików nowych lub zmienionych (rozmiar, czas zapisu)
     SDManagerStatus updateProjectList();
 
-    // Get the Project Files vector
-    SDManagerStatus getProjectFiles(std::vector<std::string>& projectList);
+    // Kopia listy projektów z metadanymi
+    SDManagerStatus getProjectFiles(std::vector<ProjectFileInfo>& projectList);
+
+    // Przyrostowa aktualizacja listy: dodanie lub zastąpienie wpisu, usunięcie wpisu
+    SDManagerStatus addProjectFile(const ProjectFileInfo& info);
+    SDManagerStatus removeProjectFile(const std::string& filename);
+
+    // Wpis listy projektów dla pliku filename (bez ścieżki) - wywołanie przy zajętej karcie
+    // (unieważnianie kopii w RAM, liczba linii zadania); false = plik spoza listy
+    bool findProjectFile(const std::string& filename, ProjectFileInfo& info) const;
 
     // Sprawdzenie czy projekt jest wybrany
     // true = projekt jest wybrany
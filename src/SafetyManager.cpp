@@ -0,0 +1,256 @@
+// ================================================================================
+//                      WEJŚCIA BEZPIECZEŃSTWA (KRAŃCÓWKI, ESTOP)
+// ================================================================================
+// Zbocza GPIO zatrzymują generator kroków po czasie stabilności sprawdzanym z timera kroków
+// Czas reakcji nie zależy od obciążenia zadania CNC (odczyt SD, opóźnienia pętli)
+// Zatrzaśnięte wejście blokuje nowe ruchy do stabilnego zwolnienia - abort() jej nie zdejmuje
+
+#include "SafetyManager.h"
+#include <Arduino.h>
+
+// ================================================================================
+//                            INICJALIZACJA SYSTEMU
+// ================================================================================
+
+SafetyManagerStatus SafetyManager::init(StepEngine* engine, const MachineConfig& config) {
+    if (engine == nullptr) {
+        return SafetyManagerStatus::INVALID_PARAMETERS;
+    }
+    stepEngine = engine;
+
+    channels[static_cast<uint8_t>(SafetyInput::LIMIT_X)].pin = PINCONFIG::LIMIT_X_PIN;
+    channels[static_cast<uint8_t>(SafetyInput::LIMIT_Y)].pin = PINCONFIG::LIMIT_Y_PIN;
+    channels[static_cast<uint8_t>(SafetyInput::ESTOP)].pin = PINCONFIG::ESTOP_PIN;
+    channels[static_cast<uint8_t>(SafetyInput::LIMIT_X)].axis = AXIS_X;
+    channels[static_cast<uint8_t>(SafetyInput::LIMIT_Y)].axis = AXIS_Y;
+
+    configure(config);
+
+    // Przerwanie na obu zboczach - poziom aktywny zależy od typu styku w konfiguracji
+    for (SafetyChannel& channel : channels) {
+        channel.owner = this;
+        pinMode(channel.pin, INPUT_PULLUP);
+        attachInterruptArg(digitalPinToInterrupt(channel.pin), onInputEdge, &channel, CHANGE);
+    }
+
+    initialized = true;
+
+    // Wejścia aktywne już przy starcie są zatrzaskiwane bez czekania na zbocze
+    update();
+
+    return SafetyManagerStatus::OK;
+}
+
+void SafetyManager::configure(const MachineConfig& config) {
+    // NO (0) - zadziałanie przy HIGH, NC (1) - zadziałanie przy LOW
+    const uint8_t limitActiveLevel { config.limitSwitchType == 0 ? static_cast<uint8_t>(HIGH) : static_cast<uint8_t>(LOW) };
+
+    portENTER_CRITICAL(&safetyMux);
+
+    for (uint8_t input : { static_cast<uint8_t>(SafetyInput::LIMIT_X), static_cast<uint8_t>(SafetyInput::LIMIT_Y) }) {
+        channels[input].activeLevel = limitActiveLevel;
+        channels[input].enabled = !config.deactivateLimitSwitches;
+    }
+
+    SafetyChannel& estop { channels[static_cast<uint8_t>(SafetyInput::ESTOP)] };
+    estop.activeLevel = HIGH;
+    estop.enabled = !config.deactivateESTOP;
+
+    // Wyłączone wejścia nie mogą pozostać zatrzaśnięte
+    for (SafetyChannel& channel : channels) {
+        if (!channel.enabled) {
+            channel.latched = false;
+            channel.releasePending = false;
+            channel.debouncePending = false;
+        }
+    }
+    if (stepEngine != nullptr) {
+        updateInterlock();
+    }
+
+    portEXIT_CRITICAL(&safetyMux);
+}
+
+void SafetyManager::setNotifyTask(TaskHandle_t task) {
+    notifyTask = task;
+}
+
+void SafetyManager::setHomingMode(bool enabled) {
+    if (homingMode == enabled) {
+        return;
+    }
+
+    portENTER_CRITICAL(&safetyMux);
+    homingMode = enabled;
+    updateInterlock();
+    portEXIT_CRITICAL(&safetyMux);
+}
+
+// ================================================================================
+//                          PRZERWANIA WEJŚĆ (ISR)
+// ================================================================================
+
+void IRAM_ATTR SafetyManager::onInputEdge(void* arg) {
+    SafetyChannel* channel { static_cast<SafetyChannel*>(arg) };
+    if (channel == nullptr || channel->owner == nullptr || !channel->enabled || channel->latched) {
+        return;
+    }
+
+    // Każde zbocze rozpoczyna odliczanie od nowa - zadziałanie dopiero po stabilnym poziomie aktywnym,
+    // powrót do poziomu nieaktywnego (zakłócenie, drgania styku) przerywa odliczanie
+    SafetyManager* manager { channel->owner };
+    const bool active { digitalRead(channel->pin) == channel->activeLevel };
+    portENTER_CRITICAL_ISR(&manager->safetyMux);
+    channel->debouncePending = active;
+    channel->debounceStartTime = micros();
+    portEXIT_CRITICAL_ISR(&manager->safetyMux);
+}
+
+void IRAM_ATTR SafetyManager::poll() {
+    if (!initialized) {
+        return;
+    }
+
+    bool tripped { false };
+    const unsigned long now { micros() };
+
+    for (SafetyChannel& channel : channels) {
+        if (!channel.debouncePending || now - channel.debounceStartTime < CONFIG::SAFETY_TRIP_DEBOUNCE_US) {
+            continue;
+        }
+
+        const bool active { digitalRead(channel.pin) == channel.activeLevel };
+
+        portENTER_CRITICAL_ISR(&safetyMux);
+        // Zbocze w trakcie odczytu rozpoczęło nowe odliczanie - decyzja w kolejnym wywołaniu
+        if (channel.debouncePending && now - channel.debounceStartTime >= CONFIG::SAFETY_TRIP_DEBOUNCE_US) {
+            channel.debouncePending = false;
+            if (active && channel.enabled && !channel.latched) {
+                trip(channel);
+                tripped = true;
+            }
+        }
+        portEXIT_CRITICAL_ISR(&safetyMux);
+    }
+
+    if (tripped) {
+        notifyTrip();
+    }
+}
+
+void IRAM_ATTR SafetyManager::notifyTrip() {
+    if (notifyTask == nullptr) {
+        return;
+    }
+
+    // Wybudzenie zadania CNC do obsługi skutków zadziałania
+    // Ticker wywołuje poll() z zadania esp_timer - obsługa kontekstu przerwania na wypadek timera sprzętowego
+    if (xPortInIsrContext()) {
+        BaseType_t higherPriorityTaskWoken { pdFALSE };
+        xTaskNotifyFromISR(notifyTask, CNCEvent::SAFETY, eSetBits, &higherPriorityTaskWoken);
+        if (higherPriorityTaskWoken == pdTRUE) {
+            portYIELD_FROM_ISR();
+        }
+    }
+    else {
+        xTaskNotify(notifyTask, CNCEvent::SAFETY, eSetBits);
+    }
+}
+
+void IRAM_ATTR SafetyManager::trip(SafetyChannel& channel) {
+    // Zatrzymanie generacji kroków przed zapamiętaniem pozycji - pozycja już się nie zmieni
+    // Podczas bazowania krańcówka zatrzymuje tylko swoją oś, druga kontynuuje wyszukiwanie
+    if (homingMode && channel.axis >= 0) {
+        stepEngine->haltAxis(static_cast<uint8_t>(channel.axis));
+    }
+    else {
+        stepEngine->halt();
+    }
+
+    for (uint8_t axis { 0 }; axis < AXIS_COUNT; ++axis) {
+        channel.tripPosition[axis] = stepEngine->getPosition(axis);
+    }
+    channel.latched = true;
+    channel.releasePending = false;
+    channel.debouncePending = false;
+    tripPending = true;
+    updateInterlock();
+}
+
+void IRAM_ATTR SafetyManager::updateInterlock() {
+    stepEngine->setInterlock(isInterlocked());
+}
+
+// ================================================================================
+//                        OBSŁUGA SKUTKÓW (ZADANIE CNC)
+// ================================================================================
+
+void SafetyManager::update() {
+    if (!initialized) {
+        return;
+    }
+
+    const unsigned long now { millis() };
+
+    for (SafetyChannel& channel : channels) {
+        if (!channel.enabled) {
+            continue;
+        }
+
+        const bool active { digitalRead(channel.pin) == channel.activeLevel };
+
+        portENTER_CRITICAL(&safetyMux);
+
+        if (active) {
+            // Zabezpieczenie przed pominiętym zboczem (np. wejście aktywne przy starcie)
+            if (!channel.latched) {
+                trip(channel);
+            }
+            channel.releasePending = false;
+        }
+        else if (channel.latched) {
+            // Zwolnienie dopiero po stabilnym stanie nieaktywnym - drgania styku są ignorowane
+            if (!channel.releasePending) {
+                channel.releasePending = true;
+                channel.releaseStartTime = now;
+            }
+            else if (now - channel.releaseStartTime >= CONFIG::SAFETY_RELEASE_DEBOUNCE_MS) {
+                channel.latched = false;
+                channel.releasePending = false;
+                updateInterlock();
+            }
+        }
+
+        portEXIT_CRITICAL(&safetyMux);
+    }
+}
+
+bool IRAM_ATTR SafetyManager::isInterlocked() const {
+    for (const SafetyChannel& channel : channels) {
+        // Podczas bazowania krańcówki są celem ruchu - wycofanie z zatrzaśniętej krańcówki jest dozwolone
+        if (channel.enabled && channel.latched && !(homingMode && channel.axis >= 0)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool SafetyManager::isTripped(SafetyInput input) const {
+    return input < SafetyInput::COUNT ? channels[static_cast<uint8_t>(input)].latched : false;
+}
+
+long SafetyManager::getTripPosition(SafetyInput input, uint8_t axis) const {
+    if (input >= SafetyInput::COUNT || axis >= AXIS_COUNT) {
+        return 0;
+    }
+    return channels[static_cast<uint8_t>(input)].tripPosition[axis];
+}
+
+bool SafetyManager::consumeTrip() {
+    portENTER_CRITICAL(&safetyMux);
+    const bool pending { tripPending };
+    tripPending = false;
+    portEXIT_CRITICAL(&safetyMux);
+
+    return pending;
+}
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+
+#include "CONFIGURATION.h"
+#include "ConfigManager.h"
+#include "StepEngine.h"
+
+// Wejścia bezpieczeństwa obsługiwane przerwaniami
+enum class SafetyInput : uint8_t {
+    LIMIT_X = 0,
+    LIMIT_Y = 1,
+    ESTOP = 2,
+    COUNT = 3
+};
+
+enum class SafetyManagerStatus {
+    OK,
+    NOT_INITIALIZED,
+    INVALID_PARAMETERS
+};
+
+class SafetyManager;
+
+// Stan pojedynczego wejścia - współdzielony między przerwaniem GPIO a zadaniem CNC
+struct SafetyChannel {
+    SafetyManager* owner { nullptr };
+    uint8_t pin { 0 };
+    int8_t axis { -1 };                     // Oś krańcówki (-1 = wejście ogólne, np. ESTOP)
+    volatile uint8_t activeLevel { HIGH };  // Poziom oznaczający zadziałanie
+    volatile bool enabled { false };        // Wejście wyłączone w konfiguracji nie zatrzymuje ruchu
+    volatile bool latched { false };        // Zadziałanie zatrzaśnięte do potwierdzonego zwolnienia
+    volatile long tripPosition[AXIS_COUNT] {}; // Pozycja osi w chwili zadziałania [steps]
+    volatile bool debouncePending { false }; // Poziom aktywny po zboczu, odliczanie czasu stabilności
+    volatile unsigned long debounceStartTime { 0 }; // Chwila ostatniego zbocza [µs]
+    bool releasePending { false };          // Odliczanie czasu stabilnego zwolnienia (zadanie CNC)
+    unsigned long releaseStartTime { 0 };   // [ms]
+};
+
+// Krańcówki i ESTOP obsługiwane zboczami GPIO.
+// Przerwanie zbocza rozpoczyna odliczanie czasu stabilności, a poll() z timera kroków
+// po SAFETY_TRIP_DEBOUNCE_US stabilnego poziomu aktywnego zatrzymuje generator kroków
+// i zapamiętuje pozycję osi. Zatrzaśnięte wejście blokuje nowe ruchy generatora
+// (poza krańcówkami podczas bazowania). Zadanie CNC obsługuje wyłącznie skutki:
+// odczytuje zatrzaśnięte stany i zwalnia je po stabilnym powrocie wejścia.
+class SafetyManager {
+    private:
+    SafetyChannel channels[static_cast<uint8_t>(SafetyInput::COUNT)] {};
+    StepEngine* stepEngine { nullptr };
+
+    // Blokada zatrzaśnięcia między przerwaniem a zadaniem CNC
+    portMUX_TYPE safetyMux = portMUX_INITIALIZER_UNLOCKED;
+
+    // Nowe zadziałanie oczekujące na obsługę skutków w zadaniu CNC
+    volatile bool tripPending { false };
+
+    // Bazowanie - krańcówka zatrzymuje wyłącznie swoją oś
+    volatile bool homingMode { false };
+
+    // Zadanie budzone zdarzeniem CNCEvent::SAFETY z przerwania
+    TaskHandle_t notifyTask { nullptr };
+
+    bool initialized { false };
+
+    // Procedura obsługi przerwania zbocza na wejściu
+    static void onInputEdge(void* arg);
+
+    // Zatrzymanie ruchu i zatrzaśnięcie stanu wejścia (wywoływane w sekcji krytycznej)
+    void trip(SafetyChannel& channel);
+
+    // Blokada ruchu generatora wg zatrzaśniętych wejść (wywoływane w sekcji krytycznej)
+    void updateInterlock();
+
+    // Wybudzenie zadania CNC po zadziałaniu (z przerwania lub zadania timera)
+    void notifyTrip();
+
+    public:
+    SafetyManager() = default;
+
+    // Konfiguracja pinów i rejestracja przerwań; ruch jest zatrzymywany przez podany generator
+    SafetyManagerStatus init(StepEngine* engine, const MachineConfig& config);
+
+    // Aktywne poziomy i wyłączenia wejść z konfiguracji maszyny
+    void configure(const MachineConfig& config);
+
+    // Zadanie powiadamiane o zadziałaniu wejścia
+    void setNotifyTask(TaskHandle_t task);
+
+    // Tryb bazowania: zadziałanie krańcówki zatrzymuje tylko jej oś (ESTOP zawsze wszystkie)
+    void setHomingMode(bool enabled);
+
+    // Zakończenie odliczania czasu stabilności wejść - wywoływane z timera kroków
+    void poll();
+
+    // Obsługa po stronie zadania: zwalnianie zatrzaśnięć i wykrycie pominiętych zboczy
+    void update();
+
+    // true = zatrzaśnięte wejście blokuje ruch (krańcówki podczas bazowania nie blokują)
+    bool isInterlocked() const;
+
+    // true = wejście zadziałało i nie zostało jeszcze stabilnie zwolnione
+    bool isTripped(SafetyInput input) const;
+
+    // Pozycja osi [steps] zapamiętana w chwili zadziałania wejścia
+    long getTripPosition(SafetyInput input, uint8_t axis) const;
+
+    // Odczyt i skasowanie informacji o nowym zadziałaniu
+    bool consumeTrip();
+};
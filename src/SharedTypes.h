@@ -2,8 +2,13 @@
 
 #include <freertos/FreeRTOS.h>
 #include <freertos/queue.h>
+#include <memory>
 #include <string>
 
+#include "JsonWriter.h"
+#include "StateSnapshot.h"
+#include "Storage.h"
+
 enum class CommandType {
     START,
     STOP,
@@ -17,6 +22,16 @@ enum class CommandType {
     SET_FAN,          // Sterowanie wentylatorem
 };
 
+// Zdarzenia budzące zadanie CNC - bity powiadomienia zadania FreeRTOS
+namespace CNCEvent {
+    constexpr uint32_t COMMAND { 1UL << 0 };            // Nowa komenda w commandQueue
+    constexpr uint32_t JOG { 1UL << 1 };                // Nowa wartość w skrzynce jogQueue
+    constexpr uint32_t MOTION_LOW_WATER { 1UL << 2 };   // Kolejka ruchu opróżniona do MOTION_QUEUE_LOW_WATER
+    constexpr uint32_t MOTION_IDLE { 1UL << 3 };        // Generator kroków przeszedł w spoczynek
+    constexpr uint32_t SAFETY { 1UL << 4 };             // Zadziałanie krańcówki lub ESTOP
+    constexpr uint32_t REALTIME { 1UL << 5 };           // Żądanie w kanale czasu rzeczywistego (STOP, wstrzymanie, korekta)
+}
+
 struct WebserverCommand {
     CommandType type;
     float param1 { 0 };
@@ -25,6 +40,14 @@ struct WebserverCommand {
     float param4 { 0 };
 };
 
+// Ruch ciągły JOG z interfejsu web - ostatnia wartość w skrzynce nadpisuje poprzednią
+// Każda wiadomość jest jednocześnie sygnałem podtrzymania (dead-man)
+struct JogVelocityCommand {
+    float xDirection { 0.0f }; // Kierunek i udział prędkości osi X [-1..1]
+    float yDirection { 0.0f }; // Kierunek i udział prędkości osi Y [-1..1]
+    bool rapid { false };      // false = prędkość pracy (G1), true = szybka (G0)
+};
+
 enum class CNCState {
     IDLE,           // Bezczynność, oczekiwanie na polecenia
     RUNNING,        // Wykonywanie programu G-code
@@ -43,6 +66,7 @@ struct MachineState {
     // Stan operacyjny
     CNCState state { CNCState::IDLE };
     bool isPaused { false };
+    uint8_t feedOverride { 100 }; // Korekta posuwu [%]
     uint8_t errorID { false };
 
     // Stan IO
@@ -55,10 +79,11 @@ struct MachineState {
 
     uint8_t hotWirePower { 0 };  // Moc drutu (0-255)
     uint8_t fanPower { 0 };      // Moc wentylatora (0-255)
+    uint8_t activeProfile { 0 }; // Profil materiału (0 = konfiguracja bazowa)
 
     // Informacje o zadaniu
     char currentProject[20] ;  // Nazwa aktualnego projektu
-    uint32_t currentLine { 0 };       // Aktualnie przetwarzana linia G-code
+    uint32_t currentLine { 0 };       // Linia G-code wykonywanego ruchu (odczyt z wyprzedzeniem jej nie zmienia)
     uint32_t totalLines { 0 };        // Łączna liczba linii G-code
     TickType_t jobStartTime { 0 };  // Czas rozpoczęcia zadania (millis)
 
@@ -67,10 +92,40 @@ struct MachineState {
     float jobProgress { 0.0f }; // Procent ukończenia zadania (0-100%)
 };
 
+// Pola stanu maszyny w zdarzeniu SSE machine-status - klucze i typy wyznaczane ze składowych
+constexpr JsonFieldDescriptor MACHINE_STATE_FIELDS[] {
+    JSON_FIELD(MachineState, state),
+    JSON_FIELD(MachineState, isPaused),
+    JSON_FIELD(MachineState, feedOverride),
+    JSON_FIELD(MachineState, errorID),
+    JSON_FIELD(MachineState, currentX),
+    JSON_FIELD(MachineState, currentY),
+    JSON_FIELD(MachineState, relativeMode),
+    JSON_FIELD(MachineState, hotWireOn),
+    JSON_FIELD(MachineState, fanOn),
+    JSON_FIELD(MachineState, hotWirePower),
+    JSON_FIELD(MachineState, fanPower),
+    JSON_FIELD(MachineState, activeProfile),
+    JSON_FIELD(MachineState, currentProject),
+    JSON_FIELD(MachineState, jobProgress),
+    JSON_FIELD(MachineState, currentLine),
+    JSON_FIELD(MachineState, totalLines),
+    JSON_FIELD(MachineState, jobStartTime),
+    JSON_FIELD(MachineState, jobRunTime),
+    JSON_FIELD(MachineState, estopOn),
+    JSON_FIELD(MachineState, limitXOn),
+    JSON_FIELD(MachineState, limitYOn),
+};
+
+// Stan maszyny publikowany przez zadanie CNC i czytany bez blokad przez zadanie Control
+using MachineStateSnapshot = StateSnapshot<MachineState>;
+
 struct GCodeProcessingState {
     // Plik i status
-    File currentFile {};
+    std::unique_ptr<StorageFile> currentFile {};
+    StorageLineReader lineReader {};
     bool fileOpen { false };
+    bool fileCached { false };  // Plik z kopii w RAM (JobCache) - odczyt bez zajmowania karty SD
     String currentLine { "" };
 
     // Statystyki 
@@ -90,17 +145,24 @@ struct GCodeProcessingState {
         READING_FILE,
         PROCESSING_LINE,
         EXECUTING_MOVEMENT,
-        FINISHED,
+        FINISHED,       // Koniec programu - ruch powrotny, wyłączenie drutu i wentylatora
+        COMPLETED,      // Sekwencja końcowa wykonana - zadanie może przejść do IDLE
         ERROR
     };
 
     ProcessingStage stage { ProcessingStage::IDLE };
 
     // Dane o ruchu
+    // Ostatnie zaprogramowane współrzędne ścian bloku (XY - pierwsza, UV - druga)
     float targetX { 0.0f };
     float targetY { 0.0f };
+    float targetU { 0.0f };
+    float targetV { 0.0f };
+    bool parallelFaces { false };   // Cięcie równoległe wybrane dla zadania - ściana UV podąża za XY
+    int8_t motionMode { -1 };       // Modalny tryb ruchu: 0 = G0, 1 = G1, -1 = brak
     float currentFeedRate { 0.0f };
     bool movementInProgress { false };
+    bool lineDeferred { false };    // Kolejka ruchu pełna lub M3/M5/M700 przed opróżnieniem kolejki - bieżąca linia przetwarzana ponownie
     
     // Dane o podgrzewaniu
     unsigned long heatingStartTime { 0 };
@@ -114,23 +176,21 @@ struct HomingState {
     // Stan bazowania
     enum class HomingStage {
         IDLE,           // Oczekiwanie na rozpoczęcie bazowania
-        HOMING_X,       // Bazowanie osi X
-        HOMING_Y,       // Bazowanie osi Y
+        SEEK,           // Szybkie wyszukiwanie krańcówek obu osi jednocześnie
+        BACKOFF,        // Wycofanie z krańcówek przed precyzyjnym dojazdem
+        APPROACH,       // Powolny dojazd do krańcówek - precyzyjne zatrzaśnięcie pozycji
+        PULLOFF,        // Odjazd od krańcówek do punktu zerowego
         FINISHED,       // Bazowanie zakończone
         ERROR           // Błąd podczas bazowania
     };
     
     HomingStage stage { HomingStage::IDLE };
     
-    // Parametry bazowania
-    float homingSpeed { 10.0f };       // Prędkość bazowania w mm/s
-    float homingAcceleration { 10.0f }; // Akceleracja bazowania w mm/s²
-    float backoffDistance { 2.0f };    // Odległość wycofania po dotknięciu krańcówki w mm
-    
     // Stan procesu
     bool movementInProgress { false };
-    bool limitReached { false };
-    bool backoffComplete { false };
+    bool axisLatched[2] { false, false };   // Krańcówka osi zatrzaśnięta w bieżącym etapie
+    long startPosition[2] { 0, 0 };         // Pozycja osi na początku etapu [steps]
+    unsigned long stageStartTime { 0 };     // [ms]
     
     // Informacje o błędzie
     String errorMessage { "" };
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <atomic>
+#include <type_traits>
+#include <stdint.h>
+
+// Migawka stanu jeden pisarz / wielu czytelników bez blokad (seqlock na podwójnym buforze).
+// Licznik sekwencji jest nieparzysty w trakcie zapisu i parzysty po publikacji.
+// Pisarz zapisuje zawsze bufor nieaktywny i nigdy nie czeka na czytelników.
+// Czytelnik kopiuje ostatni kompletny bufor i ponawia odczyt tylko wtedy, gdy pisarz
+// zdążył w międzyczasie rozpocząć nadpisywanie właśnie tego bufora.
+template <typename T>
+class StateSnapshot {
+    static_assert(std::is_trivially_copyable<T>::value, "StateSnapshot wymaga typu kopiowalnego bajtowo");
+
+    private:
+    static constexpr uint8_t MAX_READ_ATTEMPTS { 4 };
+
+    T buffers[2] {};
+    std::atomic<uint32_t> sequence { 0 }; // 2 x liczba publikacji (+1 w trakcie zapisu)
+
+    // Bufor publikacji o parzystym numerze sekwencji
+    static constexpr uint32_t bufferIndex(uint32_t evenSequence) {
+        return (evenSequence / 2) & 1;
+    }
+
+    public:
+    StateSnapshot() = default;
+
+    // Publikacja nowego stanu (wyłącznie jeden pisarz - zadanie CNC)
+    void publish(const T& state) {
+        const uint32_t current { sequence.load(std::memory_order_relaxed) };
+
+        // Oznaczenie zapisu przed modyfikacją bufora
+        sequence.store(current + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        buffers[bufferIndex(current + 2)] = state;
+
+        sequence.store(current + 2, std::memory_order_release);
+    }
+
+    // Spójna kopia ostatnio opublikowanego stanu (dowolne zadanie, bez blokowania pisarza)
+    // false = brak publikacji lub pisarz nadpisywał bufor przy każdej próbie
+    bool read(T& state) const {
+        for (uint8_t attempt { 0 }; attempt < MAX_READ_ATTEMPTS; ++attempt) {
+            // Ostatnia zakończona publikacja (zapis w toku dotyczy drugiego bufora)
+            const uint32_t published { sequence.load(std::memory_order_acquire) & ~1U };
+            if (published == 0) {
+                return false;
+            }
+
+            state = buffers[bufferIndex(published)];
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+            const uint32_t current { sequence.load(std::memory_order_relaxed) };
+
+            // Pisarz rozpoczyna nadpisywanie odczytanego bufora dopiero przy published + 3
+            if (current - published <= 2) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Numer ostatniej zakończonej publikacji - pozwala czytelnikowi pominąć niezmieniony stan
+    uint32_t getSequence() const {
+        return sequence.load(std::memory_order_acquire) / 2;
+    }
+};
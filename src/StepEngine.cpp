@@ -0,0 +1,738 @@
+// ================================================================================
+//                          GENERATOR KROKÓW SILNIKÓW
+// ================================================================================
+// Kolejka odcinków ruchu z profilem trapezowym i łączeniem prędkości na złączach
+// Kształtowanie wejścia (ZV/MZV) osobno dla każdej osi przed generowaniem kroków
+// Producent: zadanie CNC, konsument: przerwanie timera stepperów
+
+#include "StepEngine.h"
+#include <Arduino.h>
+#include <math.h>
+
+namespace {
+    // Okres wywołań tick() [s]
+    constexpr float TICK_PERIOD_S { CONFIG::STEPPER_TIMER_FREQUENCY_US / 1000000.0f };
+
+    // Limit czasu sygnału podtrzymania JOG wyrażony w cyklach timera
+    constexpr uint32_t JOG_TIMEOUT_TICKS { CONFIG::JOG_HEARTBEAT_TIMEOUT_MS * 1000 / CONFIG::STEPPER_TIMER_FREQUENCY_US };
+
+    // Okres próbkowania śladu ścieżki w cyklach timera (0 = tylko końce odcinków)
+    constexpr uint32_t TRACE_SAMPLE_TICKS { CONFIG::TRACE_SAMPLE_INTERVAL_MS * 1000 / CONFIG::STEPPER_TIMER_FREQUENCY_US };
+}
+
+// ================================================================================
+//                            INICJALIZACJA SYSTEMU
+// ================================================================================
+
+StepEngineStatus StepEngine::init() {
+    stepPins[AXIS_X] = PINCONFIG::STEP_X_PIN;
+    stepPins[AXIS_Y] = PINCONFIG::STEP_Y_PIN;
+    dirPins[AXIS_X] = PINCONFIG::DIR_X_PIN;
+    dirPins[AXIS_Y] = PINCONFIG::DIR_Y_PIN;
+
+    // Konfiguracja wyjść sterowników (stan spoczynkowy: STEP LOW, DIR LOW)
+    for (uint8_t axis { 0 }; axis < AXIS_COUNT; ++axis) {
+        pinMode(stepPins[axis], OUTPUT);
+        pinMode(dirPins[axis], OUTPUT);
+        digitalWrite(stepPins[axis], LOW);
+        digitalWrite(dirPins[axis], LOW);
+        directionPositive[axis] = false;
+
+        motorPosition[axis] = 0;
+        commandedPosition[axis] = 0.0f;
+        plannedPosition[axis] = 0;
+        plannedBacklash[axis] = 0.0f;
+        appliedBacklash[axis] = 0.0f;
+        shapers[axis].reset(0.0f);
+    }
+
+    queueHead = 0;
+    queueTail = 0;
+    initialized = true;
+
+    return StepEngineStatus::OK;
+}
+
+void StepEngine::setNotifyTask(TaskHandle_t task) {
+    notifyTask = task;
+}
+
+void StepEngine::setTraceBuffer(TraceBuffer* buffer) {
+    traceBuffer = buffer;
+}
+
+StepEngineStatus StepEngine::configure(const MachineConfig& config) {
+    if (config.X.stepsPerMM <= 0.0f || config.Y.stepsPerMM <= 0.0f) {
+        return StepEngineStatus::INVALID_PARAMETERS;
+    }
+
+    // Skalowanie osi używane przy planowaniu kolejnych odcinków
+    stepsPerMM[AXIS_X] = config.X.stepsPerMM;
+    stepsPerMM[AXIS_Y] = config.Y.stepsPerMM;
+    backlashSteps[AXIS_X] = fmaxf(config.X.backlash, 0.0f) * config.X.stepsPerMM;
+    backlashSteps[AXIS_Y] = fmaxf(config.Y.backlash, 0.0f) * config.Y.stepsPerMM;
+    rapidSpeed[AXIS_X] = config.X.rapidFeedRate;
+    rapidSpeed[AXIS_Y] = config.Y.rapidFeedRate;
+
+    // Filtry kształtujące przełączane są w postoju, aby nie szarpnąć osią w trakcie ruchu
+    portENTER_CRITICAL(&engineMux);
+    pendingShaperConfig[AXIS_X] = config.X;
+    pendingShaperConfig[AXIS_Y] = config.Y;
+    shaperUpdatePending = true;
+    portEXIT_CRITICAL(&engineMux);
+
+    return StepEngineStatus::OK;
+}
+
+void StepEngine::applyShaperConfig() {
+    uint32_t maxSettleTicks { 0 };
+
+    for (uint8_t axis { 0 }; axis < AXIS_COUNT; ++axis) {
+        const MachineConfig::MotorConfig& motor { pendingShaperConfig[axis] };
+        ShaperType type { static_cast<ShaperType>(motor.shaperType) };
+
+        // Nieprawidłowe parametry wyłączają kształtowanie dla danej osi
+        if (!shapers[axis].configure(type, motor.shaperFrequency, motor.shaperDamping)) {
+            shapers[axis].configure(ShaperType::NONE, 0.0f, 0.0f);
+        }
+        shapers[axis].reset(commandedPosition[axis]);
+
+        if (shapers[axis].settleTicks() > maxSettleTicks) {
+            maxSettleTicks = shapers[axis].settleTicks();
+        }
+    }
+
+    settleTicks = maxSettleTicks;
+    ticksSinceMotion = settleTicks;
+    shaperUpdatePending = false;
+}
+
+StepEngineStatus StepEngine::setAxisLimits(uint8_t axis, float speed, float acceleration) {
+    if (axis >= AXIS_COUNT || speed <= 0.0f || acceleration <= 0.0f) {
+        return StepEngineStatus::INVALID_PARAMETERS;
+    }
+
+    maxSpeed[axis] = speed;
+    maxAcceleration[axis] = acceleration;
+    return StepEngineStatus::OK;
+}
+
+// ================================================================================
+//                          PLANOWANIE ODCINKÓW RUCHU
+// ================================================================================
+
+uint32_t StepEngine::queueCount() const {
+    uint32_t head { queueHead.load(std::memory_order_acquire) };
+    uint32_t tail { queueTail.load(std::memory_order_acquire) };
+    return (head + CONFIG::MOTION_QUEUE_SIZE - tail) % CONFIG::MOTION_QUEUE_SIZE;
+}
+
+uint32_t StepEngine::getExecutingLine() const {
+    // Wykonywany odcinek pozostaje na końcu kolejki (tail) do jego zakończenia w tick()
+    const uint32_t tail { queueTail.load(std::memory_order_acquire) };
+    if (queueHead.load(std::memory_order_acquire) == tail) {
+        return 0;
+    }
+    return segments[tail].line;
+}
+
+bool StepEngine::isQueueFull() const {
+    return queueCount() >= CONFIG::MOTION_QUEUE_SIZE - 1;
+}
+
+float StepEngine::junctionSpeed(const MotionSegment& previous, const MotionSegment& next) const {
+    const float cruiseLimit { fminf(previous.cruiseSpeed, next.cruiseSpeed) };
+
+    // Kąt między odwróconym kierunkiem poprzedniego odcinka a kierunkiem następnego
+    float cosTheta { 0.0f };
+    for (uint8_t axis { 0 }; axis < AXIS_COUNT; ++axis) {
+        cosTheta -= previous.unit[axis] * next.unit[axis];
+    }
+
+    // Kontynuacja w tym samym kierunku - bez ograniczenia z geometrii
+    if (cosTheta < -0.999f) {
+        return cruiseLimit;
+    }
+    // Zawrócenie - zatrzymanie na złączu
+    if (cosTheta > 0.999f) {
+        return 0.0f;
+    }
+
+    // Model odchylenia od toru: łuk styczny do obu odcinków o zadanym odchyleniu
+    const float sinHalfTheta { sqrtf(0.5f * (1.0f - cosTheta)) };
+    const float acceleration { fminf(previous.acceleration, next.acceleration) };
+    const float speed { sqrtf(acceleration * CONFIG::JUNCTION_DEVIATION * sinHalfTheta / (1.0f - sinHalfTheta)) };
+
+    return fminf(speed, cruiseLimit);
+}
+
+void StepEngine::recalculateQueue() {
+    // Przejście wstecz od przedostatniego odcinka do pierwszego oczekującego
+    // Wykonywany odcinek (tail) nie jest zmieniany - jego prędkość wejściowa już minęła
+    const uint32_t count { queueCount() };
+    const uint32_t tail { queueTail.load(std::memory_order_acquire) };
+
+    for (int32_t offset { static_cast<int32_t>(count) - 2 }; offset >= 1; --offset) {
+        MotionSegment& segment { segments[(tail + offset) % CONFIG::MOTION_QUEUE_SIZE] };
+        const MotionSegment& next { segments[(tail + offset + 1) % CONFIG::MOTION_QUEUE_SIZE] };
+
+        const float reachable { sqrtf(next.plannedEntrySpeed * next.plannedEntrySpeed + 2.0f * segment.acceleration * segment.length) };
+        const float entry { fminf(segment.maxEntrySpeed, reachable) };
+
+        // Dołożenie odcinka na końcu może tylko podnieść prędkości - brak zmiany kończy przejście
+        if (entry == segment.plannedEntrySpeed) {
+            break;
+        }
+        segment.plannedEntrySpeed = entry;
+    }
+}
+
+StepEngineStatus StepEngine::queueMove(const long target[AXIS_COUNT], uint32_t line) {
+    if (!initialized) {
+        return StepEngineStatus::NOT_INITIALIZED;
+    }
+
+    MotionSegment segment {};
+    segment.line = line;
+    float lengthSquared { 0.0f };
+
+    for (uint8_t axis { 0 }; axis < AXIS_COUNT; ++axis) {
+        segment.start[axis] = static_cast<float>(plannedPosition[axis]);
+        segment.delta[axis] = static_cast<float>(target[axis] - plannedPosition[axis]);
+        segment.unit[axis] = segment.delta[axis] / stepsPerMM[axis];
+        lengthSquared += segment.unit[axis] * segment.unit[axis];
+    }
+
+    // Pominięcie odcinków zerowej długości
+    if (lengthSquared <= 0.0f) {
+        return StepEngineStatus::OK;
+    }
+
+    segment.length = sqrtf(lengthSquared);
+    segment.cruiseSpeed = INFINITY;
+    segment.overrideLimit = INFINITY;
+    segment.acceleration = INFINITY;
+    segment.backlashBlend = fminf(segment.length, CONFIG::BACKLASH_BLEND_DISTANCE);
+
+    for (uint8_t axis { 0 }; axis < AXIS_COUNT; ++axis) {
+        segment.unit[axis] /= segment.length;
+
+        // Kompensacja luzu wynika z kierunku ruchu osi - zmienia się tylko przy jego odwróceniu
+        float backlashTarget { plannedBacklash[axis] };
+        if (segment.delta[axis] > 0.0f) {
+            backlashTarget = backlashSteps[axis];
+        }
+        else if (segment.delta[axis] < 0.0f) {
+            backlashTarget = 0.0f;
+        }
+        segment.backlashStart[axis] = plannedBacklash[axis];
+        segment.backlashDelta[axis] = backlashTarget - plannedBacklash[axis];
+    }
+
+    // Prędkość i przyspieszenie na ścieżce ograniczone przez najwolniejszą z poruszanych osi
+    // Kasowanie luzu dokłada kroki na początku odcinka, więc zwiększa obciążenie osi
+    for (uint8_t axis { 0 }; axis < AXIS_COUNT; ++axis) {
+        const float stepsPerPathMM { fabsf(segment.delta[axis]) / segment.length
+            + fabsf(segment.backlashDelta[axis]) / segment.backlashBlend };
+        if (stepsPerPathMM <= 0.0f) {
+            continue;
+        }
+        if (maxSpeed[axis] <= 0.0f || maxAcceleration[axis] <= 0.0f) {
+            return StepEngineStatus::INVALID_PARAMETERS;
+        }
+
+        segment.cruiseSpeed = fminf(segment.cruiseSpeed, maxSpeed[axis] / stepsPerPathMM);
+        segment.overrideLimit = fminf(segment.overrideLimit, fmaxf(rapidSpeed[axis], maxSpeed[axis]) / stepsPerPathMM);
+        segment.acceleration = fminf(segment.acceleration, maxAcceleration[axis] / stepsPerPathMM);
+    }
+
+    portENTER_CRITICAL(&engineMux);
+
+    // Zatrzymanie z wejścia bezpieczeństwa - bez nowych odcinków do zwolnienia wejścia
+    if (halted || interlocked) {
+        portEXIT_CRITICAL(&engineMux);
+        return StepEngineStatus::INTERLOCKED;
+    }
+
+    if (jogActive) {
+        portEXIT_CRITICAL(&engineMux);
+        return StepEngineStatus::BUSY;
+    }
+
+    if (isQueueFull()) {
+        portEXIT_CRITICAL(&engineMux);
+        return StepEngineStatus::QUEUE_FULL;
+    }
+
+    // Prędkość na złączu z ostatnim odcinkiem w kolejce (start z postoju gdy kolejka pusta)
+    const uint32_t head { queueHead.load(std::memory_order_relaxed) };
+    if (queueCount() > 0) {
+        const MotionSegment& previous { segments[(head + CONFIG::MOTION_QUEUE_SIZE - 1) % CONFIG::MOTION_QUEUE_SIZE] };
+        segment.maxEntrySpeed = junctionSpeed(previous, segment);
+    }
+    else {
+        segment.maxEntrySpeed = 0.0f;
+    }
+
+    // Ostatni odcinek musi dać się zakończyć zatrzymaniem
+    segment.plannedEntrySpeed = fminf(segment.maxEntrySpeed, sqrtf(2.0f * segment.acceleration * segment.length));
+
+    segments[head] = segment;
+    queueHead.store((head + 1) % CONFIG::MOTION_QUEUE_SIZE, std::memory_order_release);
+
+    recalculateQueue();
+
+    for (uint8_t axis { 0 }; axis < AXIS_COUNT; ++axis) {
+        plannedPosition[axis] = target[axis];
+        plannedBacklash[axis] = segment.backlashStart[axis] + segment.backlashDelta[axis];
+    }
+
+    portEXIT_CRITICAL(&engineMux);
+
+    return StepEngineStatus::OK;
+}
+
+// ================================================================================
+//                          RUCH CIĄGŁY (JOG)
+// ================================================================================
+
+StepEngineStatus StepEngine::setJogVelocity(const float velocity[AXIS_COUNT], const float acceleration[AXIS_COUNT]) {
+    if (!initialized) {
+        return StepEngineStatus::NOT_INITIALIZED;
+    }
+
+    bool anyMotion { false };
+    for (uint8_t axis { 0 }; axis < AXIS_COUNT; ++axis) {
+        if (velocity[axis] != 0.0f && acceleration[axis] <= 0.0f) {
+            return StepEngineStatus::INVALID_PARAMETERS;
+        }
+        anyMotion = anyMotion || velocity[axis] != 0.0f;
+    }
+
+    portENTER_CRITICAL(&engineMux);
+
+    // Zerowa prędkość (zatrzymanie) jest zawsze przyjmowana
+    if (anyMotion && (halted || interlocked)) {
+        portEXIT_CRITICAL(&engineMux);
+        return StepEngineStatus::INTERLOCKED;
+    }
+
+    // Ruch ciągły nie może przeplatać się z odcinkami z kolejki
+    if (queueCount() > 0) {
+        portEXIT_CRITICAL(&engineMux);
+        return StepEngineStatus::BUSY;
+    }
+
+    for (uint8_t axis { 0 }; axis < AXIS_COUNT; ++axis) {
+        // Oś zatrzymana przez haltAxis() czeka na zakończenie bieżącego ruchu JOG
+        if (jogAxisLocked[axis]) {
+            continue;
+        }
+        jogTargetVelocity[axis] = velocity[axis];
+        if (acceleration[axis] > 0.0f) {
+            jogAcceleration[axis] = acceleration[axis];
+        }
+    }
+    ticksSinceHeartbeat = 0;
+
+    if (anyMotion) {
+        jogActive = true;
+    }
+
+    portEXIT_CRITICAL(&engineMux);
+
+    return StepEngineStatus::OK;
+}
+
+bool StepEngine::isJogging() const {
+    return jogActive;
+}
+
+void IRAM_ATTR StepEngine::updateJog() {
+    // Utrata sygnału podtrzymania (zerwane połączenie, zawieszony klient) - hamowanie
+    if (ticksSinceHeartbeat < JOG_TIMEOUT_TICKS) {
+        ++ticksSinceHeartbeat;
+    }
+    else {
+        for (uint8_t axis { 0 }; axis < AXIS_COUNT; ++axis) {
+            jogTargetVelocity[axis] = 0.0f;
+        }
+    }
+
+    bool moving { false };
+    for (uint8_t axis { 0 }; axis < AXIS_COUNT; ++axis) {
+        const float speedStep { jogAcceleration[axis] * TICK_PERIOD_S };
+        float velocity { jogVelocity[axis] };
+
+        if (velocity < jogTargetVelocity[axis]) {
+            velocity = fminf(velocity + speedStep, jogTargetVelocity[axis]);
+        }
+        else {
+            velocity = fmaxf(velocity - speedStep, jogTargetVelocity[axis]);
+        }
+        jogVelocity[axis] = velocity;
+
+        if (velocity == 0.0f) {
+            continue;
+        }
+        moving = true;
+
+        // Luz kasowany przy odwróceniu kierunku w tempie ruchu osi
+        const float distance { velocity * TICK_PERIOD_S };
+        const float backlashError { (velocity > 0.0f ? backlashSteps[axis] : 0.0f) - appliedBacklash[axis] };
+        const float takeUp { copysignf(fminf(fabsf(backlashError), fabsf(distance)), backlashError) };
+
+        appliedBacklash[axis] += takeUp;
+        commandedPosition[axis] += distance + takeUp;
+    }
+
+    if (moving) {
+        return;
+    }
+
+    // Osie zatrzymane - wyrównanie do pełnego kroku i powrót do trybu kolejki
+    for (uint8_t axis { 0 }; axis < AXIS_COUNT; ++axis) {
+        if (jogTargetVelocity[axis] != 0.0f) {
+            return;
+        }
+    }
+    for (uint8_t axis { 0 }; axis < AXIS_COUNT; ++axis) {
+        const long position { lroundf(commandedPosition[axis] - appliedBacklash[axis]) };
+        commandedPosition[axis] = static_cast<float>(position) + appliedBacklash[axis];
+        plannedPosition[axis] = position;
+        plannedBacklash[axis] = appliedBacklash[axis];
+        jogAxisLocked[axis] = false;
+    }
+    jogActive = false;
+}
+
+// ================================================================================
+//                          STEROWANIE I STAN RUCHU
+// ================================================================================
+
+void StepEngine::abort() {
+    portENTER_CRITICAL(&engineMux);
+
+    // Porzucenie kolejki i zatrzymanie w miejscu ostatniego wygenerowanego kroku
+    // Częściowo skasowany luz pozostaje jako punkt wyjścia dla kolejnego odcinka
+    queueTail.store(queueHead.load(std::memory_order_relaxed), std::memory_order_release);
+    segmentProgress = 0.0f;
+    currentSpeed = 0.0f;
+    jogActive = false;
+    halted = false;
+
+    for (uint8_t axis { 0 }; axis < AXIS_COUNT; ++axis) {
+        commandedPosition[axis] = static_cast<float>(motorPosition[axis]);
+        plannedPosition[axis] = lroundf(commandedPosition[axis] - appliedBacklash[axis]);
+        plannedBacklash[axis] = appliedBacklash[axis];
+        jogTargetVelocity[axis] = 0.0f;
+        jogVelocity[axis] = 0.0f;
+        jogAxisLocked[axis] = false;
+        shapers[axis].reset(commandedPosition[axis]);
+    }
+    ticksSinceMotion = settleTicks;
+
+    portEXIT_CRITICAL(&engineMux);
+}
+
+void IRAM_ATTR StepEngine::halt() {
+    portENTER_CRITICAL_ISR(&engineMux);
+    halted = true;
+    portEXIT_CRITICAL_ISR(&engineMux);
+}
+
+void StepEngine::setFeedHold(bool hold) {
+    feedHold = hold;
+}
+
+void StepEngine::setFeedOverride(float factor) {
+    feedOverride = factor;
+}
+
+void IRAM_ATTR StepEngine::haltAxis(uint8_t axis) {
+    if (axis >= AXIS_COUNT) {
+        return;
+    }
+
+    portENTER_CRITICAL_ISR(&engineMux);
+
+    if (!jogActive) {
+        // Ruch z kolejki nie może zatrzymać jednej osi bez zmiany toru
+        halted = true;
+    }
+    else {
+        // Zatrzymanie w miejscu ostatniego kroku - filtr nie dogania już pozycji zadanej
+        jogTargetVelocity[axis] = 0.0f;
+        jogVelocity[axis] = 0.0f;
+        jogAxisLocked[axis] = true;
+        commandedPosition[axis] = static_cast<float>(motorPosition[axis]);
+        shapers[axis].reset(commandedPosition[axis]);
+    }
+
+    portEXIT_CRITICAL_ISR(&engineMux);
+}
+
+bool StepEngine::isHalted() const {
+    return halted;
+}
+
+void IRAM_ATTR StepEngine::setInterlock(bool engaged) {
+    interlocked = engaged;
+}
+
+bool StepEngine::isInterlocked() const {
+    return interlocked;
+}
+
+StepEngineStatus StepEngine::setPosition(uint8_t axis, long position) {
+    if (axis >= AXIS_COUNT) {
+        return StepEngineStatus::INVALID_PARAMETERS;
+    }
+
+    portENTER_CRITICAL(&engineMux);
+
+    if (queueCount() > 0 || jogActive) {
+        portEXIT_CRITICAL(&engineMux);
+        return StepEngineStatus::BUSY;
+    }
+
+    // Pozycja logiczna - bieżąca kompensacja luzu zostaje zachowana
+    motorPosition[axis] = position + lroundf(appliedBacklash[axis]);
+    commandedPosition[axis] = static_cast<float>(position) + appliedBacklash[axis];
+    plannedPosition[axis] = position;
+    shapers[axis].reset(commandedPosition[axis]);
+    ticksSinceMotion = settleTicks;
+    lastTracePosition[axis] = position; // Zmiana układu współrzędnych nie jest ruchem w śladzie
+
+    portEXIT_CRITICAL(&engineMux);
+
+    return StepEngineStatus::OK;
+}
+
+long IRAM_ATTR StepEngine::getPosition(uint8_t axis) const {
+    return axis < AXIS_COUNT ? motorPosition[axis] - lroundf(appliedBacklash[axis]) : 0;
+}
+
+long StepEngine::getPlannedPosition(uint8_t axis) const {
+    return axis < AXIS_COUNT ? plannedPosition[axis] : 0;
+}
+
+bool StepEngine::isIdle() const {
+    if (halted || queueCount() > 0 || jogActive || ticksSinceMotion < settleTicks) {
+        return false;
+    }
+
+    // Wszystkie kroki pozycji zadanej muszą zostać wygenerowane
+    for (uint8_t axis { 0 }; axis < AXIS_COUNT; ++axis) {
+        if (motorPosition[axis] != lroundf(commandedPosition[axis])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// ================================================================================
+//                        GENERACJA KROKÓW (PRZERWANIE TIMERA)
+// ================================================================================
+
+bool IRAM_ATTR StepEngine::stepTowards(uint8_t axis, long target) {
+    const long position { motorPosition[axis] };
+    if (target == position) {
+        return false;
+    }
+
+    // Zmiana kierunku - krok dopiero w następnym cyklu (czas ustalenia sygnału DIR)
+    const bool positive { target > position };
+    if (positive != directionPositive[axis]) {
+        digitalWrite(dirPins[axis], positive ? HIGH : LOW);
+        directionPositive[axis] = positive;
+        return false;
+    }
+
+    return true;
+}
+
+void IRAM_ATTR StepEngine::tick() {
+    if (!initialized) {
+        return;
+    }
+
+    portENTER_CRITICAL_ISR(&engineMux);
+
+    // Zadziałanie wejścia bezpieczeństwa - żadnych kroków do czasu abort()
+    if (halted) {
+        portEXIT_CRITICAL_ISR(&engineMux);
+        return;
+    }
+
+    const uint32_t count { queueCount() };
+    uint32_t events { 0 };
+    bool segmentEnded { false };
+
+    if (count == 0 && !jogActive && shaperUpdatePending && ticksSinceMotion >= settleTicks) {
+        applyShaperConfig();
+    }
+
+    if (count > 0) {
+        const uint32_t tail { queueTail.load(std::memory_order_relaxed) };
+        const MotionSegment& segment { segments[tail] };
+
+        // Prędkość wyjściowa = zaplanowana prędkość wejściowa następnego odcinka (lub postój)
+        const float exitSpeed { count > 1 ? segments[(tail + 1) % CONFIG::MOTION_QUEUE_SIZE].plannedEntrySpeed : 0.0f };
+        const float remaining { fmaxf(segment.length - segmentProgress, 0.0f) };
+        const float speedStep { segment.acceleration * TICK_PERIOD_S };
+
+        // Prędkość docelowa po korekcie posuwu; wstrzymanie hamuje do zera na torze
+        const float targetSpeed { feedHold ? 0.0f : fminf(segment.cruiseSpeed * feedOverride, segment.overrideLimit) };
+
+        // Dążenie do prędkości docelowej z ograniczeniem przyspieszenia
+        if (currentSpeed < targetSpeed) {
+            currentSpeed = fminf(currentSpeed + speedStep, targetSpeed);
+        }
+        else {
+            currentSpeed = fmaxf(currentSpeed - speedStep, targetSpeed);
+        }
+
+        // Ograniczenie drogą hamowania do prędkości wyjściowej
+        const float stoppingSpeed { sqrtf(exitSpeed * exitSpeed + 2.0f * segment.acceleration * remaining) };
+        currentSpeed = fminf(currentSpeed, stoppingSpeed);
+        if (!feedHold) {
+            currentSpeed = fmaxf(currentSpeed, speedStep); // Minimalna prędkość zapobiega utknięciu przed końcem
+        }
+
+        segmentProgress += currentSpeed * TICK_PERIOD_S;
+
+        if (segmentProgress >= segment.length) {
+            // Koniec odcinka - pozycja dokładnie w punkcie docelowym
+            for (uint8_t axis { 0 }; axis < AXIS_COUNT; ++axis) {
+                appliedBacklash[axis] = segment.backlashStart[axis] + segment.backlashDelta[axis];
+                commandedPosition[axis] = segment.start[axis] + segment.delta[axis] + appliedBacklash[axis];
+            }
+
+            const float overshoot { segmentProgress - segment.length };
+            queueTail.store((tail + 1) % CONFIG::MOTION_QUEUE_SIZE, std::memory_order_release);
+            segmentEnded = true;
+
+            // Zwolnienie miejsca do progu - zadanie CNC uzupełnia kolejkę porcją odcinków
+            if (count - 1 == CONFIG::MOTION_QUEUE_LOW_WATER) {
+                events |= CNCEvent::MOTION_LOW_WATER;
+            }
+
+            if (count > 1) {
+                segmentProgress = overshoot;
+            }
+            else {
+                segmentProgress = 0.0f;
+                currentSpeed = 0.0f;
+            }
+        }
+        else {
+            // Luz kasowany na początkowej drodze odcinka, bez zatrzymania na złączu
+            const float fraction { segmentProgress / segment.length };
+            const float blendFraction { fminf(segmentProgress / segment.backlashBlend, 1.0f) };
+            for (uint8_t axis { 0 }; axis < AXIS_COUNT; ++axis) {
+                appliedBacklash[axis] = segment.backlashStart[axis] + segment.backlashDelta[axis] * blendFraction;
+                commandedPosition[axis] = segment.start[axis] + segment.delta[axis] * fraction + appliedBacklash[axis];
+            }
+        }
+
+        ticksSinceMotion = 0;
+    }
+    else if (jogActive) {
+        updateJog();
+        ticksSinceMotion = 0;
+    }
+    else if (ticksSinceMotion < settleTicks) {
+        ++ticksSinceMotion;
+    }
+
+    // Kształtowanie pozycji i wybór osi wymagających kroku
+    bool stepRequired[AXIS_COUNT] {};
+    bool anyStep { false };
+    for (uint8_t axis { 0 }; axis < AXIS_COUNT; ++axis) {
+        const long target { lroundf(shapers[axis].shape(commandedPosition[axis])) };
+        stepRequired[axis] = stepTowards(axis, target);
+        anyStep = anyStep || stepRequired[axis];
+    }
+
+    // Impuls STEP - wszystkie osie równocześnie
+    if (anyStep) {
+        for (uint8_t axis { 0 }; axis < AXIS_COUNT; ++axis) {
+            if (stepRequired[axis]) {
+                digitalWrite(stepPins[axis], HIGH);
+                motorPosition[axis] += directionPositive[axis] ? 1 : -1;
+            }
+        }
+        delayMicroseconds(CONFIG::STEP_PULSE_WIDTH_US);
+        for (uint8_t axis { 0 }; axis < AXIS_COUNT; ++axis) {
+            if (stepRequired[axis]) {
+                digitalWrite(stepPins[axis], LOW);
+            }
+        }
+    }
+
+    recordTrace(segmentEnded);
+
+    // Przejście w spoczynek zgłaszane jednokrotnie
+    const bool idle { queueCount() == 0 && !jogActive && ticksSinceMotion >= settleTicks };
+    if (idle && !idleReported) {
+        events |= CNCEvent::MOTION_IDLE;
+    }
+    idleReported = idle;
+
+    portEXIT_CRITICAL_ISR(&engineMux);
+
+    if (events != 0) {
+        notify(events);
+    }
+}
+
+void IRAM_ATTR StepEngine::recordTrace(bool segmentEnded) {
+    if (traceBuffer == nullptr || stepsPerMM[AXIS_X] <= 0.0f || stepsPerMM[AXIS_Y] <= 0.0f) {
+        return;
+    }
+
+    if (ticksSinceTrace < UINT32_MAX) {
+        ++ticksSinceTrace;
+    }
+
+    const bool sampleDue { (TRACE_SAMPLE_TICKS > 0 && ticksSinceTrace >= TRACE_SAMPLE_TICKS) || (CONFIG::TRACE_SEGMENT_ENDS && segmentEnded) };
+    if (!sampleDue) {
+        return;
+    }
+
+    // Postój nie zapełnia bufora - punkt tylko po zmianie pozycji
+    long position[AXIS_COUNT] {};
+    bool moved { false };
+    for (uint8_t axis { 0 }; axis < AXIS_COUNT; ++axis) {
+        position[axis] = getPosition(axis);
+        moved = moved || position[axis] != lastTracePosition[axis];
+    }
+    if (!moved) {
+        return;
+    }
+
+    traceBuffer->record(millis(), position[AXIS_X] / stepsPerMM[AXIS_X], position[AXIS_Y] / stepsPerMM[AXIS_Y]);
+    for (uint8_t axis { 0 }; axis < AXIS_COUNT; ++axis) {
+        lastTracePosition[axis] = position[axis];
+    }
+    ticksSinceTrace = 0;
+}
+
+void IRAM_ATTR StepEngine::notify(uint32_t events) {
+    if (notifyTask == nullptr) {
+        return;
+    }
+
+    // Ticker wywołuje tick() z zadania esp_timer - obsługa kontekstu przerwania na wypadek timera sprzętowego
+    if (xPortInIsrContext()) {
+        BaseType_t higherPriorityTaskWoken { pdFALSE };
+        xTaskNotifyFromISR(notifyTask, events, eSetBits, &higherPriorityTaskWoken);
+        if (higherPriorityTaskWoken == pdTRUE) {
+            portYIELD_FROM_ISR();
+        }
+    }
+    else {
+        xTaskNotify(notifyTask, events, eSetBits);
+    }
+}
@@ -0,0 +1,227 @@
+#pragma once
+
+#include <atomic>
+#include <freertos/FreeRTOS.h>
+
+#include "CONFIGURATION.h"
+#include "ConfigManager.h"
+#include "InputShaper.h"
+#include "SharedTypes.h"
+#include "TraceBuffer.h"
+
+// Indeksy osi w tablicach pozycji
+enum Axis : uint8_t {
+    AXIS_X = 0,
+    AXIS_Y = 1,
+    AXIS_COUNT = 2
+};
+
+enum class StepEngineStatus {
+    OK,
+    QUEUE_FULL,
+    INVALID_PARAMETERS,
+    NOT_INITIALIZED,
+    BUSY,
+    INTERLOCKED
+};
+
+// Odcinek ruchu zaplanowany do wykonania przez generator kroków
+struct MotionSegment {
+    float start[AXIS_COUNT] {};     // Pozycja początkowa [steps]
+    float delta[AXIS_COUNT] {};     // Przemieszczenie [steps]
+    float unit[AXIS_COUNT] {};      // Wektor kierunku w przestrzeni [mm]
+    float length { 0.0f };          // Długość odcinka [mm]
+    float cruiseSpeed { 0.0f };     // Prędkość docelowa [mm/s]
+    float overrideLimit { 0.0f };   // Górna granica prędkości przy korekcie posuwu (prędkości szybkie osi) [mm/s]
+    float acceleration { 0.0f };    // Przyspieszenie [mm/s^2]
+    float maxEntrySpeed { 0.0f };   // Ograniczenie prędkości na złączu z poprzednim odcinkiem [mm/s]
+    float plannedEntrySpeed { 0.0f }; // Prędkość wejściowa po przeliczeniu wstecz kolejki [mm/s]
+    float backlashStart[AXIS_COUNT] {}; // Kompensacja luzu na początku odcinka [steps]
+    float backlashDelta[AXIS_COUNT] {}; // Zmiana kompensacji luzu na odcinku [steps]
+    float backlashBlend { 0.0f };   // Droga, na której kasowany jest luz [mm]
+    uint32_t line { 0 };            // Linia programu G-code (0 = ruch spoza programu)
+};
+
+// Generator kroków z kolejką odcinków, profilem trapezowym i kształtowaniem wejścia.
+// Zadanie CNC (producent) dodaje odcinki, a tick() wywoływany z timera (konsument)
+// wylicza pozycję zadaną, przepuszcza ją przez filtr InputShaper każdej osi
+// i generuje impulsy STEP/DIR bezpośrednio na pinach sterowników.
+// Luz mechaniczny jest kasowany na początku odcinka zmieniającego kierunek osi:
+// pozycja silnika = pozycja logiczna + kompensacja (0 po ruchu ujemnym, luz po dodatnim).
+class StepEngine {
+    private:
+    // Kolejka odcinków SPSC: head - zapis (zadanie CNC), tail - odczyt (timer)
+    MotionSegment segments[CONFIG::MOTION_QUEUE_SIZE] {};
+    std::atomic<uint32_t> queueHead { 0 };
+    std::atomic<uint32_t> queueTail { 0 };
+
+    // Blokada sekcji krytycznej między zadaniem CNC a timerem
+    portMUX_TYPE engineMux = portMUX_INITIALIZER_UNLOCKED;
+
+    // Stan wykonywanego odcinka (modyfikowany tylko w tick())
+    float segmentProgress { 0.0f }; // Przebyta droga na odcinku [mm]
+    float currentSpeed { 0.0f };    // Bieżąca prędkość na ścieżce [mm/s]
+
+    // Pozycje osi
+    float commandedPosition[AXIS_COUNT] {};     // Pozycja zadana przed kształtowaniem [steps]
+    volatile long motorPosition[AXIS_COUNT] {}; // Pozycja wygenerowanych kroków [steps]
+    long plannedPosition[AXIS_COUNT] {};        // Koniec ostatniego zaplanowanego odcinka [steps]
+    bool directionPositive[AXIS_COUNT] {};      // Aktualny stan pinów DIR
+
+    // Kompensacja luzu (pozycje logiczne nie zawierają kompensacji)
+    float backlashSteps[AXIS_COUNT] {};     // Luz osi [steps]
+    float plannedBacklash[AXIS_COUNT] {};   // Kompensacja na końcu ostatniego zaplanowanego odcinka [steps]
+    float appliedBacklash[AXIS_COUNT] {};   // Kompensacja bieżącej pozycji zadanej [steps]
+
+    // Ruch ciągły JOG - tryb prędkościowy wykonywany poza kolejką odcinków
+    volatile bool jogActive { false };
+    float jogTargetVelocity[AXIS_COUNT] {}; // Prędkość zadana przez klienta [steps/s]
+    float jogVelocity[AXIS_COUNT] {};       // Bieżąca prędkość osi [steps/s]
+    float jogAcceleration[AXIS_COUNT] {};   // Przyspieszenie rampy [steps/s^2]
+    uint32_t ticksSinceHeartbeat { 0 };     // Cykle timera od ostatniego sygnału podtrzymania
+    volatile bool jogAxisLocked[AXIS_COUNT] {}; // Oś zatrzymana przez haltAxis() do końca ruchu JOG
+
+    // Filtry kształtujące i liczniki ustalania wyjścia po zakończeniu ruchu
+    InputShaper shapers[AXIS_COUNT] {};
+    uint32_t ticksSinceMotion { 0 };
+    uint32_t settleTicks { 0 };
+
+    // Konfiguracja osi
+    float stepsPerMM[AXIS_COUNT] {};
+    float maxSpeed[AXIS_COUNT] {};      // Bieżące ograniczenie prędkości [steps/s]
+    float maxAcceleration[AXIS_COUNT] {}; // Bieżące ograniczenie przyspieszenia [steps/s^2]
+    float rapidSpeed[AXIS_COUNT] {};    // Prędkość szybka osi - granica korekty posuwu [steps/s]
+
+    // Wstrzymanie i korekta posuwu z kanału czasu rzeczywistego (odczytywane w tick())
+    volatile bool feedHold { false };
+    volatile float feedOverride { 1.0f };
+
+    // Nowe parametry filtrów czekające na postój maszyny
+    MachineConfig::MotorConfig pendingShaperConfig[AXIS_COUNT] {};
+    volatile bool shaperUpdatePending { false };
+
+    // Zatrzymanie z przerwania wejść bezpieczeństwa - tick() nie generuje kroków do abort()
+    volatile bool halted { false };
+
+    // Blokada ruchu przez zatrzaśnięte wejście bezpieczeństwa - abort() jej nie zdejmuje
+    volatile bool interlocked { false };
+
+    bool initialized { false };
+
+    // Zadanie budzone po opróżnieniu kolejki do progu i po przejściu w spoczynek
+    TaskHandle_t notifyTask { nullptr };
+    bool idleReported { true };
+
+    // Ślad wykonanej ścieżki - punkty okresowo i na końcach odcinków, tylko przy zmianie pozycji
+    TraceBuffer* traceBuffer { nullptr };
+    uint32_t ticksSinceTrace { 0 };
+    long lastTracePosition[AXIS_COUNT] {}; // [steps]
+
+    // Numery pinów sterowników
+    uint8_t stepPins[AXIS_COUNT] {};
+    uint8_t dirPins[AXIS_COUNT] {};
+
+    // Liczba odcinków w kolejce (łącznie z wykonywanym)
+    uint32_t queueCount() const;
+
+    // Przeliczenie wstecz dopuszczalnych prędkości wejściowych odcinków w kolejce
+    void recalculateQueue();
+
+    // Maksymalna prędkość na złączu dwóch odcinków wg odchylenia od toru
+    float junctionSpeed(const MotionSegment& previous, const MotionSegment& next) const;
+
+    // Zastosowanie oczekującej konfiguracji filtrów (tylko w postoju)
+    void applyShaperConfig();
+
+    // Rampa prędkości i całkowanie pozycji w trybie JOG (wywoływane z tick())
+    void updateJog();
+
+    // Powiadomienie zadania o zdarzeniach CNCEvent (z timera lub przerwania)
+    void notify(uint32_t events);
+
+    // Zapis punktu śladu po wygenerowaniu kroków (wywoływane z tick())
+    void recordTrace(bool segmentEnded);
+
+    // Wygenerowanie co najwyżej jednego kroku w stronę pozycji docelowej osi
+    bool stepTowards(uint8_t axis, long target);
+
+    public:
+    StepEngine() = default;
+
+    // Konfiguracja pinów sterowników i wyzerowanie pozycji
+    StepEngineStatus init();
+
+    // Zadanie powiadamiane o zdarzeniach MOTION_LOW_WATER i MOTION_IDLE
+    void setNotifyTask(TaskHandle_t task);
+
+    // Bufor śladu wykonanej ścieżki zapisywany z tick() (nullptr = bez śladu)
+    void setTraceBuffer(TraceBuffer* buffer);
+
+    // Przepisanie parametrów osi i filtrów kształtujących z konfiguracji maszyny
+    // Filtry są przełączane dopiero po zatrzymaniu ruchu
+    StepEngineStatus configure(const MachineConfig& config);
+
+    // Ograniczenia prędkości [steps/s] i przyspieszenia [steps/s^2] dla kolejnych odcinków
+    StepEngineStatus setAxisLimits(uint8_t axis, float speed, float acceleration);
+
+    // Dodanie odcinka do pozycji bezwzględnej [steps] z bieżącymi ograniczeniami osi
+    // line - numer linii programu, z której pochodzi odcinek (postęp zadania)
+    StepEngineStatus queueMove(const long target[AXIS_COUNT], uint32_t line = 0);
+
+    // Linia programu wykonywanego odcinka (0 = kolejka pusta lub ruch spoza programu)
+    // Wywołanie z zadania dodającego odcinki - miejsce w kolejce nie jest nadpisywane w trakcie odczytu
+    uint32_t getExecutingLine() const;
+
+    // Ruch ciągły z prędkością osi [steps/s] i rampą [steps/s^2] - tylko przy pustej kolejce
+    // Każde wywołanie jest sygnałem podtrzymania; jego brak przez JOG_HEARTBEAT_TIMEOUT_MS
+    // wyhamowuje osie do zera. Zerowa prędkość obu osi kończy ruch z hamowaniem.
+    StepEngineStatus setJogVelocity(const float velocity[AXIS_COUNT], const float acceleration[AXIS_COUNT]);
+
+    // true = trwa ruch ciągły JOG (łącznie z hamowaniem)
+    bool isJogging() const;
+
+    // Natychmiastowe zatrzymanie - czyści kolejkę i zachowuje bieżącą pozycję
+    void abort();
+
+    // Wstrzymanie generacji kroków bez porządkowania kolejki (bezpieczne w ISR)
+    // Stan ruchu porządkuje późniejsze abort() wywołane z zadania
+    void halt();
+
+    // Zatrzymanie jednej osi w trybie JOG bez hamowania (bezpieczne w ISR)
+    // Pozostałe osie kontynuują ruch; poza trybem JOG działa jak halt()
+    void haltAxis(uint8_t axis);
+
+    // Wstrzymanie posuwu - hamowanie na torze do zera z zachowaniem kolejki (bezpieczne z innego rdzenia)
+    void setFeedHold(bool hold);
+
+    // Współczynnik prędkości posuwu odcinków z kolejki (1.0 = 100%)
+    void setFeedOverride(float factor);
+
+    // true = generacja kroków wstrzymana przez halt()
+    bool isHalted() const;
+
+    // Blokada nowych ruchów (queueMove, setJogVelocity zwracają INTERLOCKED) do zwolnienia wejść
+    // bezpieczeństwa - ustawiana przez SafetyManager (bezpieczne w ISR)
+    void setInterlock(bool engaged);
+
+    // true = ruch zablokowany przez wejście bezpieczeństwa
+    bool isInterlocked() const;
+
+    // Ustawienie pozycji osi [steps] (np. zerowanie) - tylko przy pustej kolejce
+    StepEngineStatus setPosition(uint8_t axis, long position);
+
+    // Pozycja wygenerowanych kroków bez kompensacji luzu [steps]
+    long getPosition(uint8_t axis) const;
+
+    // Pozycja końca ostatniego zaplanowanego odcinka [steps]
+    long getPlannedPosition(uint8_t axis) const;
+
+    // true = brak odcinków w kolejce i ustalone wyjście filtrów
+    bool isIdle() const;
+
+    // true = brak miejsca na kolejny odcinek
+    bool isQueueFull() const;
+
+    // Wywoływane z przerwania timera co STEPPER_TIMER_FREQUENCY_US
+    void tick();
+};
@@ -0,0 +1,124 @@
+// ================================================================================
+//                         WARSTWA ABSTRAKCJI SYSTEMU PLIKÓW
+// ================================================================================
+// Wspólne elementy backendów: plik w pamięci RAM i odczyt liniami z blokowym buforowaniem
+
+#include "Storage.h"
+
+#include <string.h>
+
+// ================================================================================
+//                              PLIK W PAMIĘCI RAM
+// ================================================================================
+
+MemoryStorageFile::MemoryStorageFile(const uint8_t* data, size_t length, uint32_t modified)
+    : data { data }, length { data != nullptr ? length : 0 }, modified { modified } {}
+
+size_t MemoryStorageFile::read(uint8_t* buffer, size_t count) {
+    if (!open || buffer == nullptr || offset >= length) {
+        return 0;
+    }
+    if (count > length - offset) {
+        count = length - offset;
+    }
+    memcpy(buffer, data + offset, count);
+    offset += count;
+    return count;
+}
+
+size_t MemoryStorageFile::write(const uint8_t*, size_t) {
+    // Plik tylko do odczytu
+    return 0;
+}
+
+bool MemoryStorageFile::seek(size_t position) {
+    if (!open || position > length) {
+        return false;
+    }
+    offset = position;
+    return true;
+}
+
+size_t MemoryStorageFile::position() const {
+    return offset;
+}
+
+size_t MemoryStorageFile::size() const {
+    return length;
+}
+
+uint32_t MemoryStorageFile::getLastWrite() {
+    return modified;
+}
+
+void MemoryStorageFile::close() {
+    open = false;
+}
+
+bool MemoryStorageFile::isOpen() const {
+    return open;
+}
+
+// ================================================================================
+//                              ODCZYT LINIAMI
+// ================================================================================
+
+void StorageLineReader::reset() {
+    blockLength = 0;
+    blockPosition = 0;
+    endOfFile = false;
+}
+
+bool StorageLineReader::hasBufferedLine() const {
+    return memchr(block + blockPosition, '\n', blockLength - blockPosition) != nullptr;
+}
+
+bool StorageLineReader::readLine(StorageFile& file, char* line, size_t capacity) {
+    if (line == nullptr || capacity == 0) {
+        return false;
+    }
+
+    size_t length { 0 };
+    bool anyData { false };
+    while (true) {
+        if (blockPosition == blockLength) {
+            if (endOfFile) {
+                break;
+            }
+            blockLength = file.read(block, sizeof(block));
+            blockPosition = 0;
+            if (blockLength == 0) {
+                endOfFile = true;
+                break;
+            }
+        }
+
+        // Przepisanie fragmentu do końca linii lub końca bloku
+        const uint8_t* start { block + blockPosition };
+        const size_t available { blockLength - blockPosition };
+        const uint8_t* newline { static_cast<const uint8_t*>(memchr(start, '\n', available)) };
+        const size_t count { newline != nullptr ? static_cast<size_t>(newline - start) : available };
+
+        anyData = true;
+        const size_t copied { count < capacity - 1 - length ? count : capacity - 1 - length };
+        memcpy(line + length, start, copied);
+        length += copied;
+        blockPosition += count;
+
+        if (newline != nullptr) {
+            ++blockPosition;
+            break;
+        }
+    }
+
+    if (!anyData) {
+        line[0] = '\0';
+        return false;
+    }
+
+    if (length > 0 && line[length - 1] == '\r') {
+        --length;
+    }
+    line[length] = '\0';
+    return true;
+}
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <functional>
+#include <memory>
+
+// Tryb otwarcia pliku
+enum class StorageMode {
+    READ,       // Odczyt istniejącego pliku
+    WRITE,      // Utworzenie lub nadpisanie pliku
+    APPEND      // Dopisywanie na końcu (utworzenie, jeśli nie istnieje)
+};
+
+// Wpis katalogu zwracany przez Storage::list()
+struct StorageEntry {
+    const char* name { nullptr };   // Sama nazwa (bez ścieżki katalogu)
+    bool directory { false };
+    uint32_t size { 0 };            // [B]
+    uint32_t modified { 0 };        // Czas ostatniego zapisu (time_t systemu plików)
+};
+
+// Otwarty plik niezależny od systemu plików. Obiekty tworzy wyłącznie Storage::open(),
+// zamknięcie następuje w close() lub w destruktorze. Interfejs nie synchronizuje dostępu -
+// plik karty SD wolno używać tylko przy zajętej karcie (SDCardManager::takeSD()).
+class StorageFile {
+    public:
+    virtual ~StorageFile() = default;
+
+    // Odczyt bloku do length bajtów; zwraca liczbę odczytanych bajtów (0 = koniec pliku lub błąd)
+    virtual size_t read(uint8_t* buffer, size_t length) = 0;
+
+    // Zapis bloku; zwraca liczbę zapisanych bajtów (mniej niż length = błąd zapisu)
+    virtual size_t write(const uint8_t* buffer, size_t length) = 0;
+
+    // Ustawienie pozycji odczytu/zapisu od początku pliku
+    virtual bool seek(size_t position) = 0;
+
+    virtual size_t position() const = 0;
+    virtual size_t size() const = 0;
+
+    // Czas ostatniego zapisu (time_t systemu plików; 0 = nieznany)
+    virtual uint32_t getLastWrite() = 0;
+
+    // Wypchnięcie danych i zwolnienie uchwytu; kolejne wywołania nie mają efektu
+    virtual void close() = 0;
+    virtual bool isOpen() const = 0;
+};
+
+// Plik tylko do odczytu nad buforem w pamięci (np. zadanie wczytane do RAM przez JobCache).
+// Nie przejmuje bufora - dane muszą istnieć do zamknięcia pliku; dostęp nie wymaga blokady karty.
+class MemoryStorageFile : public StorageFile {
+    private:
+    const uint8_t* data { nullptr };
+    size_t length { 0 };
+    size_t offset { 0 };
+    uint32_t modified { 0 };
+    bool open { true };
+
+    public:
+    MemoryStorageFile(const uint8_t* data, size_t length, uint32_t modified);
+
+    size_t read(uint8_t* buffer, size_t count) override;
+    size_t write(const uint8_t* buffer, size_t count) override;
+    bool seek(size_t position) override;
+    size_t position() const override;
+    size_t size() const override;
+    uint32_t getLastWrite() override;
+    void close() override;
+    bool isOpen() const override;
+};
+
+// Odczyt pliku liniami z blokowym buforowaniem - jeden odczyt z nośnika przypada na
+// BLOCK_SIZE bajtów, a nie na pojedynczy znak jak w Stream::readStringUntil().
+// Linie dłuższe niż bufor wywołującego są przycinane (reszta linii pomijana).
+class StorageLineReader {
+    public:
+    static constexpr size_t BLOCK_SIZE { 512 };     // [B] Jeden sektor karty SD
+
+    private:
+    uint8_t block[BLOCK_SIZE] {};
+    size_t blockLength { 0 };
+    size_t blockPosition { 0 };
+    bool endOfFile { false };
+
+    public:
+    StorageLineReader() = default;
+
+    // Porzucenie buforowanych danych (nowy plik lub zmiana pozycji pliku)
+    void reset();
+
+    // Czy kolejna linia jest w całości w buforze (odczyt bez dostępu do nośnika)
+    bool hasBufferedLine() const;
+
+    // Kolejna linia bez znaków końca linii ("\n", "\r\n"), zakończona zerem
+    // false = koniec pliku (brak kolejnej linii)
+    bool readLine(StorageFile& file, char* line, size_t capacity);
+};
+
+// Interfejs systemu plików: karta SD i LittleFS na urządzeniu (ArduinoFSStorage),
+// katalog lokalny przy uruchamianiu potoku danych na PC (PosixStorage).
+// Ścieżki bezwzględne w obrębie systemu plików, np. "/Projects/plik.gcode".
+class Storage {
+    public:
+    // Wywoływana dla każdego wpisu katalogu; false = przerwanie listowania
+    using ListCallback = std::function<bool(const StorageEntry&)>;
+
+    virtual ~Storage() = default;
+
+    // Otwarcie pliku; nullptr = brak pliku, katalog (READ) lub błąd otwarcia
+    virtual std::unique_ptr<StorageFile> open(const char* path, StorageMode mode) = 0;
+
+    virtual bool exists(const char* path) = 0;
+    virtual bool remove(const char* path) = 0;
+
+    // Zmiana nazwy; istniejący plik docelowy jest zastępowany
+    virtual bool rename(const char* from, const char* to) = 0;
+
+    virtual bool mkdir(const char* path) = 0;
+
+    // Wpisy katalogu path (bez "." i ".."); false = katalog nie istnieje lub błąd otwarcia
+    virtual bool list(const char* path, const ListCallback& callback) = 0;
+};
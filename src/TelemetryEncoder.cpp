@@ -0,0 +1,105 @@
+// ================================================================================
+//                    BINARNE RAMKI TELEMETRII (RÓŻNICOWE)
+// ================================================================================
+
+#include "TelemetryEncoder.h"
+
+#include <string.h>
+
+namespace {
+    // Zapis wartości w porządku little-endian (natywnym dla ESP32)
+    template <typename T>
+    uint8_t* put(uint8_t* out, const T& value) {
+        memcpy(out, &value, sizeof(T));
+        return out + sizeof(T);
+    }
+
+    constexpr uint16_t fieldBit(TelemetryField field) {
+        return static_cast<uint16_t>(1U << static_cast<uint8_t>(field));
+    }
+}
+
+uint8_t TelemetryEncoder::packFlags(const MachineState& state) {
+    uint8_t flags { 0 };
+    if (state.isPaused) flags |= TelemetryFlag::PAUSED;
+    if (state.estopOn) flags |= TelemetryFlag::ESTOP;
+    if (state.limitXOn) flags |= TelemetryFlag::LIMIT_X;
+    if (state.limitYOn) flags |= TelemetryFlag::LIMIT_Y;
+    if (state.hotWireOn) flags |= TelemetryFlag::HOT_WIRE;
+    if (state.fanOn) flags |= TelemetryFlag::FAN;
+    if (state.relativeMode) flags |= TelemetryFlag::RELATIVE;
+    return flags;
+}
+
+uint16_t TelemetryEncoder::changedFields(const MachineState& previous, const MachineState& current) {
+    uint16_t mask { 0 };
+    if (previous.state != current.state) mask |= fieldBit(TelemetryField::STATE);
+    if (packFlags(previous) != packFlags(current)) mask |= fieldBit(TelemetryField::FLAGS);
+    if (previous.feedOverride != current.feedOverride) mask |= fieldBit(TelemetryField::FEED_OVERRIDE);
+    if (previous.errorID != current.errorID) mask |= fieldBit(TelemetryField::ERROR_ID);
+    if (previous.hotWirePower != current.hotWirePower) mask |= fieldBit(TelemetryField::HOT_WIRE_POWER);
+    if (previous.fanPower != current.fanPower) mask |= fieldBit(TelemetryField::FAN_POWER);
+    if (previous.currentX != current.currentX) mask |= fieldBit(TelemetryField::CURRENT_X);
+    if (previous.currentY != current.currentY) mask |= fieldBit(TelemetryField::CURRENT_Y);
+    if (previous.currentLine != current.currentLine) mask |= fieldBit(TelemetryField::CURRENT_LINE);
+    if (previous.totalLines != current.totalLines) mask |= fieldBit(TelemetryField::TOTAL_LINES);
+    if (previous.jobProgress != current.jobProgress) mask |= fieldBit(TelemetryField::JOB_PROGRESS);
+    if (previous.jobRunTime != current.jobRunTime) mask |= fieldBit(TelemetryField::JOB_RUN_TIME);
+    if (strncmp(previous.currentProject, current.currentProject, sizeof(current.currentProject)) != 0) {
+        mask |= fieldBit(TelemetryField::PROJECT);
+    }
+    if (previous.activeProfile != current.activeProfile) mask |= fieldBit(TelemetryField::ACTIVE_PROFILE);
+    return mask;
+}
+
+size_t TelemetryEncoder::encode(const MachineState& state, bool keyFrame, uint8_t* buffer, size_t capacity) {
+    if (buffer == nullptr || capacity < MAX_FRAME_SIZE) {
+        return 0;
+    }
+
+    keyFrame = keyFrame || !hasReference;
+    const uint16_t mask { keyFrame ? static_cast<uint16_t>((1U << static_cast<uint8_t>(TelemetryField::COUNT)) - 1)
+        : changedFields(lastSent, state) };
+    if (mask == 0) {
+        return 0;
+    }
+
+    uint8_t* out { buffer };
+    *out++ = keyFrame ? FRAME_KEY : FRAME_DELTA;
+    out = put(out, frameCounter);
+    out = put(out, mask);
+
+    // Wartości w kolejności numerów pól
+    if (mask & fieldBit(TelemetryField::STATE)) *out++ = static_cast<uint8_t>(state.state);
+    if (mask & fieldBit(TelemetryField::FLAGS)) *out++ = packFlags(state);
+    if (mask & fieldBit(TelemetryField::FEED_OVERRIDE)) *out++ = state.feedOverride;
+    if (mask & fieldBit(TelemetryField::ERROR_ID)) *out++ = state.errorID;
+    if (mask & fieldBit(TelemetryField::HOT_WIRE_POWER)) *out++ = state.hotWirePower;
+    if (mask & fieldBit(TelemetryField::FAN_POWER)) *out++ = state.fanPower;
+    if (mask & fieldBit(TelemetryField::CURRENT_X)) out = put(out, state.currentX);
+    if (mask & fieldBit(TelemetryField::CURRENT_Y)) out = put(out, state.currentY);
+    if (mask & fieldBit(TelemetryField::CURRENT_LINE)) out = put(out, state.currentLine);
+    if (mask & fieldBit(TelemetryField::TOTAL_LINES)) out = put(out, state.totalLines);
+    if (mask & fieldBit(TelemetryField::JOB_PROGRESS)) out = put(out, state.jobProgress);
+    if (mask & fieldBit(TelemetryField::JOB_RUN_TIME)) out = put(out, static_cast<uint32_t>(state.jobRunTime));
+    if (mask & fieldBit(TelemetryField::PROJECT)) {
+        const uint8_t length { static_cast<uint8_t>(strnlen(state.currentProject, sizeof(state.currentProject))) };
+        *out++ = length;
+        memcpy(out, state.currentProject, length);
+        out += length;
+    }
+    if (mask & fieldBit(TelemetryField::ACTIVE_PROFILE)) *out++ = state.activeProfile;
+
+    pending = state;
+    return static_cast<size_t>(out - buffer);
+}
+
+void TelemetryEncoder::markSent() {
+    lastSent = pending;
+    hasReference = true;
+    ++frameCounter;
+}
+
+void TelemetryEncoder::reset() {
+    hasReference = false;
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <Arduino.h>
+
+#include "SharedTypes.h"
+
+// Pola ramki telemetrii - numer pola = numer bitu w masce ramki
+enum class TelemetryField : uint8_t {
+    STATE = 0,          // uint8  CNCState
+    FLAGS = 1,          // uint8  bity TelemetryFlag
+    FEED_OVERRIDE = 2,  // uint8  [%]
+    ERROR_ID = 3,       // uint8
+    HOT_WIRE_POWER = 4, // uint8  (0-255)
+    FAN_POWER = 5,      // uint8  (0-255)
+    CURRENT_X = 6,      // float32 [mm]
+    CURRENT_Y = 7,      // float32 [mm]
+    CURRENT_LINE = 8,   // uint32
+    TOTAL_LINES = 9,    // uint32
+    JOB_PROGRESS = 10,  // float32 [%]
+    JOB_RUN_TIME = 11,  // uint32 [ms]
+    PROJECT = 12,       // uint8 długość + znaki nazwy projektu
+    ACTIVE_PROFILE = 13,    // uint8 profil materiału (0 = konfiguracja bazowa)
+    COUNT = 14
+};
+
+// Bity pola FLAGS
+namespace TelemetryFlag {
+    constexpr uint8_t PAUSED { 1 << 0 };
+    constexpr uint8_t ESTOP { 1 << 1 };
+    constexpr uint8_t LIMIT_X { 1 << 2 };
+    constexpr uint8_t LIMIT_Y { 1 << 3 };
+    constexpr uint8_t HOT_WIRE { 1 << 4 };
+    constexpr uint8_t FAN { 1 << 5 };
+    constexpr uint8_t RELATIVE { 1 << 6 };
+}
+
+// Koder binarnych ramek stanu maszyny dla WebSocket /ws/status.
+// Ramka: typ (1 B), numer ramki (uint16), maska pól (uint16), wartości pól
+// w kolejności bitów maski, little-endian. Ramka różnicowa zawiera tylko pola
+// zmienione względem ostatniej wysłanej ramki, ramka kluczowa - wszystkie pola.
+// Koder nie alokuje pamięci - ramka budowana jest w buforze wywołującego.
+class TelemetryEncoder {
+    public:
+    static constexpr uint8_t FRAME_DELTA { 0x01 };
+    static constexpr uint8_t FRAME_KEY { 0x02 };
+    static constexpr size_t HEADER_SIZE { 5 };
+    static constexpr size_t MAX_FRAME_SIZE { HEADER_SIZE + 7 * sizeof(uint8_t) + 7 * sizeof(uint32_t) + 1 + sizeof(MachineState::currentProject) };
+
+    private:
+    MachineState lastSent {};       // Stan odniesienia dla ramek różnicowych
+    MachineState pending {};        // Stan zakodowany w ostatniej ramce, czeka na potwierdzenie wysłania
+    bool hasReference { false };    // false = pierwsza ramka musi być kluczowa
+    uint16_t frameCounter { 0 };
+
+    // Maska pól różniących się między stanami
+    static uint16_t changedFields(const MachineState& previous, const MachineState& current);
+
+    static uint8_t packFlags(const MachineState& state);
+
+    public:
+    TelemetryEncoder() = default;
+
+    // Zakodowanie ramki do bufora; zwraca długość ramki lub 0 gdy brak zmian
+    // Ramka staje się odniesieniem dopiero po markSent()
+    size_t encode(const MachineState& state, bool keyFrame, uint8_t* buffer, size_t capacity);
+
+    // Potwierdzenie wysłania ostatnio zakodowanej ramki do wszystkich klientów
+    void markSent();
+
+    // Wymuszenie ramki kluczowej (nowy klient, utracona ramka)
+    void reset();
+};
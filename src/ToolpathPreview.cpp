@@ -0,0 +1,325 @@
+// ================================================================================
+//                   UPROSZCZONY PODGLĄD ŚCIEŻKI (DOUGLAS-PEUCKER)
+// ================================================================================
+// Podgląd generowany strumieniowo z pliku na karcie SD w trakcie wysyłania odpowiedzi
+// Przeglądarka otrzymuje kilka-kilkanaście kB zamiast całego pliku G-code
+
+#include "ToolpathPreview.h"
+
+#include <algorithm>
+#include <math.h>
+#include <string.h>
+
+namespace {
+    // Odległość punktu od odcinka AB
+    float segmentDistance(float px, float py, float ax, float ay, float bx, float by) {
+        const float dx { bx - ax };
+        const float dy { by - ay };
+        const float lengthSquared { dx * dx + dy * dy };
+        float t { 0.0f };
+        if (lengthSquared > 0.0f) {
+            t = fminf(fmaxf(((px - ax) * dx + (py - ay) * dy) / lengthSquared, 0.0f), 1.0f);
+        }
+        return hypotf(px - (ax + t * dx), py - (ay + t * dy));
+    }
+
+    int32_t quantize(float coordinate) {
+        return static_cast<int32_t>(lroundf(coordinate * CONFIG::PREVIEW_COORDINATE_SCALE));
+    }
+}
+
+ToolpathPreview::~ToolpathPreview() {
+    closeFile();
+}
+
+// ================================================================================
+//                              OTWARCIE I ODCZYT
+// ================================================================================
+
+ToolpathPreviewStatus ToolpathPreview::begin(SDCardManager* manager, const char* path, float tolerance, uint16_t width, uint16_t height) {
+    if (manager == nullptr || path == nullptr || tolerance <= 0.0f || width == 0 || height == 0) {
+        return ToolpathPreviewStatus::INVALID_PARAMETERS;
+    }
+    if (!manager->isCardInitialized()) {
+        return ToolpathPreviewStatus::CARD_NOT_INITIALIZED;
+    }
+
+    sdManager = manager;
+    tolerancePixels = tolerance;
+    widthPixels = static_cast<float>(width);
+    heightPixels = static_cast<float>(height);
+
+    if (!sdManager->takeSD(SDPriority::BACKGROUND)) {
+        return ToolpathPreviewStatus::CARD_NOT_INITIALIZED;
+    }
+    file = sdManager->getStorage().open(path, StorageMode::READ);
+    sdManager->giveSD();
+
+    if (!file) {
+        return ToolpathPreviewStatus::FILE_OPEN_FAILED;
+    }
+
+    // Nagłówek formatu
+    output[0] = 'T';
+    output[1] = 'P';
+    output[2] = FORMAT_VERSION;
+    outputLength = HEADER_SIZE;
+
+    // Ruchy zaczynają się od punktu zerowego - zakres obejmuje punkt startowy
+    window[0] = { 0.0f, 0.0f };
+    windowCount = 1;
+
+    return ToolpathPreviewStatus::OK;
+}
+
+size_t ToolpathPreview::read(uint8_t* buffer, size_t maxLength) {
+    uint8_t chunksLeft { CONFIG::PREVIEW_READ_BUDGET };
+
+    // Parsowanie do zgromadzenia pełnej porcji odpowiedzi lub wyczerpania limitu odczytów
+    while (!finished && outputLength < maxLength
+        && sizeof(output) - outputLength >= MAX_FLUSH_SIZE + END_RECORD_SIZE) {
+        if (readPosition >= readLength) {
+            if (chunksLeft == 0) {
+                break;
+            }
+            --chunksLeft;
+            // Karta niedostępna - kolejna próba w następnym wywołaniu (odpowiedź RESPONSE_TRY_AGAIN)
+            if (!refill()) {
+                break;
+            }
+            if (readLength == 0) {
+                finish();
+                break;
+            }
+        }
+
+        // Kompletowanie linii - znaki ponad PREVIEW_MAX_LINE_LENGTH odrzucają linię
+        const char character { readBuffer[readPosition++] };
+        if (character == '\n') {
+            lineBuffer[lineLength] = '\0';
+            if (!lineTruncated) {
+                processLine();
+            }
+            lineLength = 0;
+            lineTruncated = false;
+        }
+        else if (lineLength < sizeof(lineBuffer) - 1) {
+            lineBuffer[lineLength++] = character;
+        }
+        else {
+            lineTruncated = true;
+        }
+    }
+
+    const size_t length { outputLength < maxLength ? outputLength : maxLength };
+    if (buffer != nullptr && length > 0) {
+        memcpy(buffer, output, length);
+        memmove(output, output + length, outputLength - length);
+        outputLength -= length;
+    }
+    return length;
+}
+
+bool ToolpathPreview::isFinished() const {
+    return finished && outputLength == 0;
+}
+
+bool ToolpathPreview::refill() {
+    // Karta zajmowana wyłącznie na czas odczytu porcji - zadanie CNC czyta plik zadania między porcjami
+    readPosition = 0;
+    if (!file) {
+        readLength = 0;
+        return true;
+    }
+    if (!sdManager->takeSD(SDPriority::BACKGROUND)) {
+        readLength = 0;
+        return false;
+    }
+    readLength = file->read(reinterpret_cast<uint8_t*>(readBuffer), sizeof(readBuffer));
+    sdManager->giveSD();
+    return true;
+}
+
+void ToolpathPreview::closeFile() {
+    if (!file) {
+        return;
+    }
+
+    // Odmowa zajęcia (pełna kolejka zgłoszeń) nie może zwolnić karty innego zadania - plik tylko
+    // do odczytu jest wtedy zamykany bez zajęcia (zamknięcie nie zapisuje na kartę)
+    const bool cardTaken { sdManager->takeSD(SDPriority::BACKGROUND) };
+    file.reset();
+    if (cardTaken) {
+        sdManager->giveSD();
+    }
+}
+
+void ToolpathPreview::finish() {
+    // Ostatnia linia bez znaku końca linii
+    if (lineLength > 0 && !lineTruncated) {
+        lineBuffer[lineLength] = '\0';
+        processLine();
+    }
+    lineLength = 0;
+
+    flushWindow();
+    writeEndRecord();
+    finished = true;
+
+    closeFile();
+}
+
+// ================================================================================
+//                              INTERPRETER G-CODE
+// ================================================================================
+
+void ToolpathPreview::processLine() {
+    if (!parser.parseLine(lineBuffer)) {
+        return;
+    }
+    ++moveCount;
+    addPoint(parser.getX(), parser.getY(), parser.isRapid());
+}
+
+// ================================================================================
+//                        UPRASZCZANIE I KODOWANIE ŁAMANYCH
+// ================================================================================
+
+void ToolpathPreview::includeInBounds(float x, float y) {
+    minX = fminf(minX, x);
+    maxX = fmaxf(maxX, x);
+    minY = fminf(minY, y);
+    maxY = fmaxf(maxY, y);
+}
+
+void ToolpathPreview::addPoint(float x, float y, bool rapid) {
+    includeInBounds(x, y);
+
+    // Zmiana typu ruchu zamyka łamaną - nowa zaczyna się w bieżącej pozycji
+    if (windowCount > 1 && rapid != windowRapid) {
+        flushWindow();
+    }
+    if (windowCount >= CONFIG::PREVIEW_WINDOW_SIZE) {
+        flushWindow();
+    }
+
+    windowRapid = rapid;
+    window[windowCount++] = { x, y };
+}
+
+void ToolpathPreview::simplifyWindow(float tolerance) {
+    for (size_t index { 0 }; index < windowCount; ++index) {
+        keep[index] = false;
+    }
+    keep[0] = true;
+    keep[windowCount - 1] = true;
+
+    // Douglas-Peucker iteracyjnie na stosie przedziałów (bez rekurencji)
+    size_t stackSize { 0 };
+    rangeStack[stackSize++] = 0;
+    rangeStack[stackSize++] = static_cast<uint16_t>(windowCount - 1);
+
+    while (stackSize > 0) {
+        const uint16_t last { rangeStack[--stackSize] };
+        const uint16_t first { rangeStack[--stackSize] };
+
+        float maxDistance { 0.0f };
+        uint16_t farthest { first };
+        for (uint16_t index = first + 1; index < last; ++index) {
+            const float distance { segmentDistance(window[index].x, window[index].y,
+                window[first].x, window[first].y, window[last].x, window[last].y) };
+            if (distance > maxDistance) {
+                maxDistance = distance;
+                farthest = index;
+            }
+        }
+
+        if (maxDistance > tolerance) {
+            keep[farthest] = true;
+            rangeStack[stackSize++] = first;
+            rangeStack[stackSize++] = farthest;
+            rangeStack[stackSize++] = farthest;
+            rangeStack[stackSize++] = last;
+        }
+    }
+}
+
+void ToolpathPreview::flushWindow() {
+    if (windowCount < 2) {
+        return;
+    }
+
+    // Tolerancja [mm] z bieżącego zakresu - skala obrazu może już tylko maleć
+    const float millimetersPerPixel { fmaxf((maxX - minX) / widthPixels, (maxY - minY) / heightPixels) };
+    simplifyWindow(tolerancePixels * millimetersPerPixel);
+
+    const size_t recordStart { outputLength };
+    put(windowRapid ? PreviewRecord::RAPID : PreviewRecord::CUT);
+    put(static_cast<uint16_t>(0));
+
+    uint16_t recordCount { 0 };
+    int32_t previousX { 0 };
+    int32_t previousY { 0 };
+
+    for (size_t index { 0 }; index < windowCount; ++index) {
+        if (!keep[index]) {
+            continue;
+        }
+
+        const int32_t pointX { quantize(window[index].x) };
+        const int32_t pointY { quantize(window[index].y) };
+
+        if (recordCount == 0) {
+            put(pointX);
+            put(pointY);
+            recordCount = 1;
+        }
+        else {
+            // Długi ruch dzielony na przyrosty mieszczące się w int16
+            const int32_t deltaX { pointX - previousX };
+            const int32_t deltaY { pointY - previousY };
+            const int32_t span { std::max(abs(deltaX), abs(deltaY)) };
+            const int32_t steps { std::min(span / INT16_MAX + 1, static_cast<int32_t>(CONFIG::PREVIEW_MAX_DELTA_STEPS)) };
+
+            int32_t writtenX { previousX };
+            int32_t writtenY { previousY };
+            for (int32_t step { 1 }; step <= steps; ++step) {
+                const int32_t stepX { previousX + static_cast<int32_t>(static_cast<int64_t>(deltaX) * step / steps) };
+                const int32_t stepY { previousY + static_cast<int32_t>(static_cast<int64_t>(deltaY) * step / steps) };
+                put(static_cast<int16_t>(std::max<int32_t>(INT16_MIN, std::min<int32_t>(INT16_MAX, stepX - writtenX))));
+                put(static_cast<int16_t>(std::max<int32_t>(INT16_MIN, std::min<int32_t>(INT16_MAX, stepY - writtenY))));
+                writtenX = stepX;
+                writtenY = stepY;
+            }
+            recordCount += static_cast<uint16_t>(steps);
+        }
+
+        previousX = pointX;
+        previousY = pointY;
+        ++emittedPoints;
+    }
+    memcpy(output + recordStart + 1, &recordCount, sizeof(recordCount));
+
+    // Kolejne okno zaczyna się w ostatnim punkcie
+    window[0] = window[windowCount - 1];
+    windowCount = 1;
+}
+
+void ToolpathPreview::writeEndRecord() {
+    put(PreviewRecord::END);
+    put(minX);
+    put(minY);
+    put(maxX);
+    put(maxY);
+    put(moveCount);
+    put(emittedPoints);
+}
+
+template <typename T>
+void ToolpathPreview::put(const T& value) {
+    if (outputLength + sizeof(T) > sizeof(output)) {
+        return;
+    }
+    memcpy(output + outputLength, &value, sizeof(T));
+    outputLength += sizeof(T);
+}
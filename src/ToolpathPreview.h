@@ -0,0 +1,131 @@
+#pragma once
+
+#include <Arduino.h>
+#include <memory>
+
+#include "CONFIGURATION.h"
+#include "GCodeLineParser.h"
+#include "SDManager.h"
+#include "Storage.h"
+
+enum class ToolpathPreviewStatus {
+    OK,
+    INVALID_PARAMETERS,
+    CARD_NOT_INITIALIZED,
+    FILE_OPEN_FAILED
+};
+
+// Typy rekordów binarnego podglądu ścieżki
+namespace PreviewRecord {
+    constexpr uint8_t CUT { 0x01 };     // Łamana ruchów roboczych (G1)
+    constexpr uint8_t RAPID { 0x02 };   // Łamana ruchów szybkich (G0)
+    constexpr uint8_t END { 0xFF };     // Zakres współrzędnych i statystyki - ostatni rekord
+}
+
+// Uproszczony podgląd ścieżki G-code generowany strumieniowo po stronie kontrolera.
+// Plik czytany jest porcjami (karta SD zajmowana tylko na czas odczytu porcji),
+// kolejne ruchy tego samego typu zbierane są w okno i upraszczane algorytmem
+// Douglasa-Peuckera z tolerancją wyrażoną w pikselach docelowego obrazu.
+// Tolerancja w mm wyznaczana jest z bieżącego zakresu współrzędnych - zakres
+// tylko rośnie, więc wcześniejsze okna upraszczane są co najwyżej dokładniej.
+//
+// Format (little-endian): nagłówek 'T' 'P' wersja, następnie rekordy:
+//   CUT/RAPID: typ (1 B), liczba punktów (uint16), punkt początkowy (2 x int32),
+//              kolejne punkty jako przyrosty (2 x int16); jednostka 1 / PREVIEW_COORDINATE_SCALE mm,
+//              ruchy dłuższe niż zakres int16 dzielone na kilka przyrostów
+//   END: typ (1 B), minX, minY, maxX, maxY (4 x float32 [mm]),
+//        liczba ruchów w pliku (uint32), liczba punktów podglądu (uint32)
+class ToolpathPreview {
+    public:
+    static constexpr uint8_t FORMAT_VERSION { 1 };
+    static constexpr size_t HEADER_SIZE { 3 };
+    static constexpr size_t END_RECORD_SIZE { 1 + 4 * sizeof(float) + 2 * sizeof(uint32_t) };
+
+    private:
+    struct PreviewPoint {
+        float x;
+        float y;
+    };
+
+    // Nagłówek rekordu łamanej: typ, liczba punktów, punkt początkowy
+    static constexpr size_t RECORD_HEADER_SIZE { 1 + sizeof(uint16_t) + 2 * sizeof(int32_t) };
+    // Najgorszy przypadek opróżnienia okna - każdy ruch podzielony na PREVIEW_MAX_DELTA_STEPS przyrostów
+    static constexpr size_t MAX_FLUSH_SIZE { RECORD_HEADER_SIZE + CONFIG::PREVIEW_WINDOW_SIZE * CONFIG::PREVIEW_MAX_DELTA_STEPS * 2 * sizeof(int16_t) };
+
+    static_assert(CONFIG::PREVIEW_OUTPUT_BUFFER_SIZE >= HEADER_SIZE + MAX_FLUSH_SIZE + END_RECORD_SIZE,
+        "Bufor wyjściowy podglądu mniejszy niż opróżnienie jednego okna");
+
+    SDCardManager* sdManager { nullptr };
+    std::unique_ptr<StorageFile> file {};
+    bool finished { false };
+
+    // Parametry obrazu docelowego
+    float tolerancePixels { 0.0f };
+    float widthPixels { 0.0f };
+    float heightPixels { 0.0f };
+
+    // Porcja pliku i bieżąca linia
+    char readBuffer[CONFIG::PREVIEW_READ_CHUNK_SIZE] {};
+    size_t readLength { 0 };
+    size_t readPosition { 0 };
+    char lineBuffer[CONFIG::PREVIEW_MAX_LINE_LENGTH] {};
+    size_t lineLength { 0 };
+    bool lineTruncated { false };
+
+    // Stan interpretera G-code
+    GCodeLineParser parser {};
+    uint32_t moveCount { 0 };
+
+    // Zakres współrzędnych [mm]
+    float minX { 0.0f };
+    float minY { 0.0f };
+    float maxX { 0.0f };
+    float maxY { 0.0f };
+
+    // Okno upraszczania - ruchy jednego typu, pierwszy punkt = koniec poprzedniego okna
+    PreviewPoint window[CONFIG::PREVIEW_WINDOW_SIZE] {};
+    bool keep[CONFIG::PREVIEW_WINDOW_SIZE] {};
+    uint16_t rangeStack[2 * CONFIG::PREVIEW_WINDOW_SIZE] {};
+    size_t windowCount { 0 };
+    bool windowRapid { false };
+    uint32_t emittedPoints { 0 };
+
+    // Zakodowane rekordy czekające na wysłanie
+    uint8_t output[CONFIG::PREVIEW_OUTPUT_BUFFER_SIZE] {};
+    size_t outputLength { 0 };
+
+    // Odczyt kolejnej porcji pliku (readLength = 0 na końcu pliku); false = karta chwilowo niedostępna
+    bool refill();
+
+    // Zamknięcie pliku przy zajętej karcie
+    void closeFile();
+
+    void processLine();
+    void addPoint(float x, float y, bool rapid);
+    void includeInBounds(float x, float y);
+
+    // Uproszczenie i zakodowanie okna; okno zostaje z ostatnim punktem
+    void flushWindow();
+    void simplifyWindow(float tolerance);
+
+    void writeEndRecord();
+    void finish();
+
+    template <typename T>
+    void put(const T& value);
+
+    public:
+    ToolpathPreview() = default;
+    ~ToolpathPreview();
+
+    // Otwarcie pliku projektu; tolerancja [px] dla obrazu width x height [px]
+    ToolpathPreviewStatus begin(SDCardManager* manager, const char* path, float tolerance, uint16_t width, uint16_t height);
+
+    // Kolejna porcja danych podglądu (co najwyżej maxLength bajtów)
+    // Czyta co najwyżej PREVIEW_READ_BUDGET porcji pliku na wywołanie; 0 bajtów przy
+    // nieskończonym podglądzie oznacza jedynie brak gotowych danych w tym wywołaniu
+    size_t read(uint8_t* buffer, size_t maxLength);
+
+    // true = wszystkie dane podglądu zostały odczytane
+    bool isFinished() const;
+};
@@ -0,0 +1,60 @@
+// ================================================================================
+//                    ŚLAD WYKONANEJ ŚCIEŻKI (BUFOR KOŁOWY)
+// ================================================================================
+// Punkty zapisywane przez generator kroków, odczytywane przyrostowo przez serwer web
+
+#include "TraceBuffer.h"
+
+#include <Arduino.h>
+#include <string.h>
+
+uint32_t TraceBuffer::oldestValid(uint32_t currentHead) {
+    // Slot punktu currentHead - SIZE może być właśnie nadpisywany kolejnym punktem
+    return currentHead >= CONFIG::TRACE_BUFFER_SIZE ? currentHead - CONFIG::TRACE_BUFFER_SIZE + 1 : 0;
+}
+
+void IRAM_ATTR TraceBuffer::record(uint32_t time, float x, float y) {
+    const uint32_t sequence { head.load(std::memory_order_relaxed) };
+    TracePoint& point { points[sequence % CONFIG::TRACE_BUFFER_SIZE] };
+    point.time = time;
+    point.x = x;
+    point.y = y;
+    head.store(sequence + 1, std::memory_order_release);
+}
+
+uint32_t TraceBuffer::getSequence() const {
+    return head.load(std::memory_order_acquire);
+}
+
+size_t TraceBuffer::read(uint32_t since, TracePoint* output, size_t maxPoints, uint32_t& first) const {
+    const uint32_t currentHead { head.load(std::memory_order_acquire) };
+    const uint32_t oldest { oldestValid(currentHead) };
+
+    // Punkty już nadpisane lub numer spoza bufora (np. klient sprzed restartu) - od najstarszego dostępnego
+    if (currentHead - since > currentHead - oldest) {
+        since = oldest;
+    }
+
+    size_t count { currentHead - since };
+    if (output == nullptr || count > maxPoints) {
+        count = output == nullptr ? 0 : maxPoints;
+    }
+
+    for (size_t index { 0 }; index < count; ++index) {
+        output[index] = points[(since + index) % CONFIG::TRACE_BUFFER_SIZE];
+    }
+
+    // Odrzucenie początkowych punktów nadpisanych w trakcie kopiowania
+    std::atomic_thread_fence(std::memory_order_acquire);
+    const uint32_t oldestAfter { oldestValid(head.load(std::memory_order_relaxed)) };
+    const uint32_t overwritten { oldestAfter - since };
+    if (static_cast<int32_t>(overwritten) > 0) {
+        const size_t skipped { overwritten < count ? overwritten : count };
+        memmove(output, output + skipped, (count - skipped) * sizeof(TracePoint));
+        count -= skipped;
+        since = oldestAfter;
+    }
+
+    first = since;
+    return count;
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <Arduino.h>
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "CONFIGURATION.h"
+
+// Punkt wykonanej ścieżki - pozycja wygenerowanych kroków bez kompensacji luzu
+struct TracePoint {
+    uint32_t time { 0 };    // [ms] od uruchomienia
+    float x { 0.0f };       // [mm]
+    float y { 0.0f };       // [mm]
+};
+
+// Bufor kołowy wykonanej ścieżki: jeden pisarz (generator kroków), wielu czytelników.
+// Każdy punkt ma kolejny numer sekwencji; czytelnik pobiera punkty od podanego numeru
+// i po skopiowaniu sprawdza, czy pisarz nie nadpisał ich w międzyczasie.
+// Zapis to wyłącznie kopia punktu i publikacja licznika - bez blokad i alokacji.
+class TraceBuffer {
+    private:
+    TracePoint points[CONFIG::TRACE_BUFFER_SIZE] {};
+    std::atomic<uint32_t> head { 0 }; // Numer sekwencji następnego zapisywanego punktu
+
+    // Najstarszy numer sekwencji, którego slot nie może być właśnie nadpisywany
+    static uint32_t oldestValid(uint32_t currentHead);
+
+    public:
+    TraceBuffer() = default;
+
+    // Dopisanie punktu (wyłącznie jeden pisarz - tick() generatora kroków)
+    void record(uint32_t time, float x, float y);
+
+    // Numer sekwencji następnego punktu (= liczba zapisanych punktów)
+    uint32_t getSequence() const;
+
+    // Kopia co najwyżej maxPoints punktów od numeru since
+    // first = numer pierwszego skopiowanego punktu; first > since oznacza utracone punkty
+    // (nadpisane przed odczytem). Zwraca liczbę skopiowanych punktów.
+    size_t read(uint32_t since, TracePoint* output, size_t maxPoints, uint32_t& first) const;
+};
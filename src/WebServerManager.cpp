@@ -9,17 +9,103 @@
 #include <freertos/semphr.h>
 #include <AsyncTCP.h>
 #include <ESPAsyncWebServer.h>
-#include <SD.h>
 #include <LittleFS.h>
+#include <algorithm>
+#include <new>
+#include <stddef.h>
+#include <string.h>
 #include "WebServerManager.h"
+#include "JsonWriter.h"
+#include "ConfigValidator.h"
+#include "ToolpathPreview.h"
+#include "SDFileStream.h"
+#include "ProjectUpload.h"
+#include "SDBenchmark.h"
 #include "CONFIGURATION.H"
 
+namespace {
+    // Alokator ArduinoJson z bufora na stosie - dokument krótkiej ramki bez alokacji na stercie.
+    // Bloki przydzielane kolejno (pojemność w nagłówku bloku); zwolniony lub zmieniony w miejscu
+    // może być tylko ostatni blok, pozostałe zwalniane są razem z buforem
+    template <size_t Capacity>
+    class StackJsonAllocator : public ArduinoJson::Allocator {
+        private:
+        static constexpr size_t ALIGNMENT { alignof(max_align_t) };
+        static constexpr size_t HEADER_SIZE { (sizeof(size_t) + ALIGNMENT - 1) & ~(ALIGNMENT - 1) };
+
+        alignas(max_align_t) uint8_t buffer[Capacity];
+        size_t used { 0 };
+
+        static size_t alignSize(size_t size) { return (size + ALIGNMENT - 1) & ~(ALIGNMENT - 1); }
+
+        size_t offsetOf(const void* ptr) const { return static_cast<size_t>(static_cast<const uint8_t*>(ptr) - buffer); }
+
+        size_t capacityOf(const void* ptr) const {
+            size_t capacity { 0 };
+            memcpy(&capacity, static_cast<const uint8_t*>(ptr) - HEADER_SIZE, sizeof(capacity));
+            return capacity;
+        }
+
+        void setCapacity(void* ptr, size_t capacity) {
+            memcpy(static_cast<uint8_t*>(ptr) - HEADER_SIZE, &capacity, sizeof(capacity));
+        }
+
+        bool isLast(const void* ptr) const { return offsetOf(ptr) + capacityOf(ptr) == used; }
+
+        public:
+        void* allocate(size_t size) override {
+            const size_t capacity { alignSize(size) };
+            if (capacity < size || HEADER_SIZE + capacity > Capacity - used) {
+                return nullptr;
+            }
+            uint8_t* block { buffer + used + HEADER_SIZE };
+            setCapacity(block, capacity);
+            used += HEADER_SIZE + capacity;
+            return block;
+        }
+
+        void deallocate(void* ptr) override {
+            if (ptr != nullptr && isLast(ptr)) {
+                used = offsetOf(ptr) - HEADER_SIZE;
+            }
+        }
+
+        void* reallocate(void* ptr, size_t newSize) override {
+            if (ptr == nullptr) {
+                return allocate(newSize);
+            }
+
+            // Ostatni blok - zmiana rozmiaru w miejscu
+            const size_t capacity { alignSize(newSize) };
+            if (isLast(ptr)) {
+                if (capacity < newSize || offsetOf(ptr) + capacity > Capacity) {
+                    return nullptr;
+                }
+                setCapacity(ptr, capacity);
+                used = offsetOf(ptr) + capacity;
+                return ptr;
+            }
+
+            // Zmniejszenie bloku wewnątrz bufora - bez zmian, powiększenie - kopia na końcu
+            const size_t oldCapacity { capacityOf(ptr) };
+            if (newSize <= oldCapacity) {
+                return ptr;
+            }
+            void* moved { allocate(newSize) };
+            if (moved != nullptr) {
+                memcpy(moved, ptr, oldCapacity);
+            }
+            return moved;
+        }
+    };
+}
+
 // ================================================================================
 //                           KONSTRUKTOR I DESTRUKTOR
 // ================================================================================
 
-WebServerManager::WebServerManager(SDCardManager* sdManager, ConfigManager* configManager, QueueHandle_t extCommandQueue, QueueHandle_t extStateQueue)
-    : sdManager(sdManager), configManager(configManager), commandQueue(extCommandQueue), stateQueue(extStateQueue) {
+WebServerManager::WebServerManager(SDCardManager* sdManager, ConfigManager* configManager, QueueHandle_t extCommandQueue, MachineStateSnapshot* extStateSnapshot, QueueHandle_t extJogQueue, TaskHandle_t extCncTask, RealtimeChannel* extRealtimeChannel, TraceBuffer* extTraceBuffer)
+    : sdManager(sdManager), configManager(configManager), commandQueue(extCommandQueue), stateSnapshot(extStateSnapshot), jogQueue(extJogQueue), cncTask(extCncTask), realtimeChannel(extRealtimeChannel), traceBuffer(extTraceBuffer) {
 }
 
 WebServerManager::~WebServerManager() {
@@ -30,6 +116,16 @@ WebServerManager::~WebServerManager() {
         events = nullptr;
     }
 
+    // Zwolnienie zasobów WebSocket ruchu ciągłego i telemetrii
+    if (jogSocket) {
+        delete jogSocket;
+        jogSocket = nullptr;
+    }
+    if (statusSocket) {
+        delete statusSocket;
+        statusSocket = nullptr;
+    }
+
     // Zwolnienie zasobów serwera HTTP
     if (server) {
         serverInitialized = false;
@@ -77,6 +173,28 @@ WebServerStatus WebServerManager::init() {
         client->send("Connected to ESP32 CNC EventSource", NULL, millis(), 1000);
         });
 
+    // WebSocket ruchu ciągłego JOG - prędkość i sygnał podtrzymania bez narzutu HTTP
+    if (!jogSocket) {
+        jogSocket = new AsyncWebSocket("/ws/jog");
+        if (jogSocket) {
+            jogSocket->onEvent([this](AsyncWebSocket* server, AsyncWebSocketClient* client, AwsEventType type, void* arg, uint8_t* data, size_t len) {
+                this->handleJogSocketEvent(client, type, arg, data, len);
+                });
+        }
+    }
+
+    // WebSocket telemetrii - nowy klient otrzymuje pełny stan w najbliższej ramce kluczowej
+    if (!statusSocket) {
+        statusSocket = new AsyncWebSocket("/ws/status");
+        if (statusSocket) {
+            statusSocket->onEvent([this](AsyncWebSocket* server, AsyncWebSocketClient* client, AwsEventType type, void* arg, uint8_t* data, size_t len) {
+                if (type == WS_EVT_CONNECT) {
+                    this->telemetryKeyFramePending = true;
+                }
+                });
+        }
+    }
+
     return WebServerStatus::OK;
 }
 
@@ -88,6 +206,16 @@ WebServerStatus WebServerManager::begin() {
 
     // Rejestracja handlera dla Server-Sent Events
     server->addHandler(events);
+
+    // Rejestracja handlera WebSocket ruchu ciągłego JOG
+    if (jogSocket) {
+        server->addHandler(jogSocket);
+    }
+
+    // Rejestracja handlera WebSocket telemetrii
+    if (statusSocket) {
+        server->addHandler(statusSocket);
+    }
     
     // Konfiguracja wszystkich endpointów API i plików statycznych
     setupRoutes();
@@ -152,6 +280,134 @@ void WebServerManager::setupCommonRoutes() {
         request->send(200, "application/json", json);
         });
 
+    // Statystyki kolejki dostępu do karty SD wg klas priorytetu; ?reset=1 zeruje liczniki po odczycie
+    server->on("/api/sd-stats", HTTP_GET, [this](AsyncWebServerRequest* request) {
+        SDPriorityStats stats[static_cast<size_t>(SDPriority::COUNT)] {};
+        this->sdManager->getSchedulerStats(stats);
+        if (request->hasParam("reset")) {
+            this->sdManager->resetSchedulerStats();
+        }
+
+        JsonWriter writer { this->responseBuffer, sizeof(this->responseBuffer) };
+        writer.beginObject();
+        writer.field("success", true);
+        writer.beginObject("classes");
+        for (size_t index { 0 }; index < static_cast<size_t>(SDPriority::COUNT); ++index) {
+            const SDPriorityStats& classStats { stats[index] };
+            writer.beginObject(SDCardManager::priorityName(static_cast<SDPriority>(index)));
+            writer.field("requests", classStats.requests);
+            writer.field("contended", classStats.contended);
+            writer.field("avgWaitUs", classStats.contended > 0 ? static_cast<uint32_t>(classStats.totalWaitUs / classStats.contended) : 0);
+            writer.field("maxWaitUs", classStats.maxWaitUs);
+            writer.field("maxHoldUs", classStats.maxHoldUs);
+            writer.field("holdBudgetUs", CONFIG::SD_HOLD_BUDGET_US[index]);
+            writer.field("holdOverruns", classStats.holdOverruns);
+            writer.endObject();
+        }
+        writer.endObject();
+        writer.endObject();
+
+        request->send(200, "application/json", this->responseBuffer);
+        });
+
+    // Test wydajności karty SD; ?sweep=1 - próba zegarów SPI, ?apply=1 - ustawienie i zapis
+    // w konfiguracji najszybszego stabilnego zegaru. Test trwa kilka sekund - wykonywany
+    // w osobnym zadaniu, wynik odczytywany przez GET /api/sd-benchmark
+    server->on("/api/sd-benchmark", HTTP_POST, [this](AsyncWebServerRequest* request) {
+        if (!this->sdManager->isCardInitialized()) {
+            request->send(503, "application/json", "{\"success\":false,\"message\":\"SD Card not initialized\"}");
+            return;
+        }
+        if (this->benchmarkActive) {
+            request->send(409, "application/json", "{\"success\":false,\"message\":\"SD benchmark already running\"}");
+            return;
+        }
+
+        // Ponowne uruchomienie karty unieważnia otwarte pliki - test tylko przy bezczynnej karcie
+        MachineState machineState {};
+        const bool jobActive { this->stateSnapshot != nullptr && this->stateSnapshot->read(machineState)
+            && machineState.state == CNCState::RUNNING };
+        if (jobActive || this->activeDownloads > 0 || this->activeUploads > 0 || this->previewActive) {
+            request->send(409, "application/json", "{\"success\":false,\"message\":\"SD card in use\"}");
+            return;
+        }
+
+        this->benchmarkSweep = request->hasParam("sweep") && request->getParam("sweep")->value() == "1";
+        this->benchmarkApply = this->benchmarkSweep && request->hasParam("apply") && request->getParam("apply")->value() == "1";
+        this->benchmarkDone = false;
+        this->benchmarkActive = true;
+
+        if (xTaskCreatePinnedToCore(benchmarkTask, "SDBench", CONFIG::SD_BENCH_TASK_STACK_SIZE, this,
+            CONFIG::SD_BENCH_TASK_PRIORITY, NULL, CONFIG::CORE_0) != pdPASS) {
+            this->benchmarkActive = false;
+            request->send(500, "application/json", "{\"success\":false,\"message\":\"Failed to start SD benchmark\"}");
+            return;
+        }
+
+        request->send(202, "application/json", "{\"success\":true,\"running\":true}");
+        });
+
+    server->on("/api/sd-benchmark", HTTP_GET, [this](AsyncWebServerRequest* request) {
+        if (this->benchmarkActive || !this->benchmarkDone) {
+            JsonWriter writer { this->responseBuffer, sizeof(this->responseBuffer) };
+            writer.beginObject();
+            writer.field("success", this->benchmarkActive);
+            writer.field("running", this->benchmarkActive);
+            if (!this->benchmarkActive) {
+                writer.field("message", "No benchmark results");
+            }
+            writer.endObject();
+            request->send(this->benchmarkActive ? 200 : 404, "application/json", this->responseBuffer);
+            return;
+        }
+
+        const SDBenchmarkResult& result { this->benchmarkResult };
+        JsonWriter writer { this->responseBuffer, sizeof(this->responseBuffer) };
+        writer.beginObject();
+        writer.field("success", result.status == SDBenchmarkStatus::OK);
+        writer.field("running", false);
+        writer.field("status", SDBenchmark::statusName(result.status));
+        writer.field("spiFrequency", result.spiFrequency);
+        writer.field("durationMs", result.durationMs);
+        writer.field("writeMBps", result.writeMBps);
+        writer.field("readMBps", result.readMBps);
+        writer.beginObject("randomRead");
+        writer.field("bytes", static_cast<unsigned long>(CONFIG::SD_SECTOR_SIZE));
+        writer.field("minUs", result.randomRead.minUs);
+        writer.field("avgUs", result.randomRead.averageUs);
+        writer.field("p50Us", result.randomRead.p50Us);
+        writer.field("p95Us", result.randomRead.p95Us);
+        writer.field("p99Us", result.randomRead.p99Us);
+        writer.field("maxUs", result.randomRead.maxUs);
+        writer.endObject();
+        writer.field("openCloseUs", result.openCloseUs);
+        writer.field("scanUs", result.scanUs);
+        writer.field("scanEntries", result.scanEntries);
+        if (result.frequencyCount > 0) {
+            writer.beginArray("frequencies");
+            for (size_t index { 0 }; index < result.frequencyCount; ++index) {
+                const SDFrequencyResult& frequencyResult { result.frequencies[index] };
+                writer.beginObject();
+                writer.field("frequency", frequencyResult.frequency);
+                writer.field("stable", frequencyResult.stable);
+                writer.field("writeMBps", frequencyResult.writeMBps);
+                writer.field("readMBps", frequencyResult.readMBps);
+                writer.endObject();
+            }
+            writer.endArray();
+            writer.field("fastestStableFrequency", result.fastestStableFrequency);
+            writer.field("applied", result.frequencyApplied);
+            writer.field("saved", this->benchmarkSaved);
+        }
+        writer.field("currentSpiFrequency", this->sdManager->getSpiFrequency());
+        writer.endObject();
+
+        if (!writer.isComplete()) {
+            request->send(500, "application/json", "{\"success\":false,\"message\":\"Benchmark result too large\"}");
+            return;
+        }
+        request->send(200, "application/json", this->responseBuffer);
+        });
 
     // Reinicjalizacja karty SD i ConfigManagera - procedura odzyskiwania
     server->on("/api/reinitialize-sd", HTTP_POST, [this](AsyncWebServerRequest* request) {
@@ -159,6 +415,11 @@ void WebServerManager::setupCommonRoutes() {
         Serial.println("DEBUG SERVER STATUS: SD card reinitialization requested");
         #endif
 
+        if (this->benchmarkActive) {
+            request->send(503, "application/json", "{\"success\":false,\"message\":\"SD benchmark running\"}");
+            return;
+        }
+
         // Inicjalizacja karty SD z walidacją wyniku
         SDManagerStatus sdResult = this->sdManager->init();
         bool sdSuccess = (sdResult == SDManagerStatus::OK);
@@ -237,8 +498,27 @@ void WebServerManager::setupIndexRoutes() {
         Serial.println("DEBUG SERVER STATUS: Komenda START");
         #endif
 
+        // Test karty SD może ponownie uruchomić kartę - plik zadania otwierany po jego zakończeniu
+        if (this->benchmarkActive) {
+            request->send(503, "application/json", "{\"success\":false,\"message\":\"SD benchmark running\"}");
+            return;
+        }
+
+        // Profil materiału dla zadania (0 = konfiguracja bazowa)
+        long profile { 0 };
+        if (request->hasParam("profile")) {
+            profile = strtol(request->getParam("profile")->value().c_str(), nullptr, 10);
+            if (profile < 0 || profile > static_cast<long>(CONFIG::MATERIAL_PROFILE_SLOTS)) {
+                request->send(400, "application/json", "{\"success\":false,\"message\":\"Invalid material profile\"}");
+                return;
+            }
+        }
+
+        // Cięcie równoległe (plik tylko XY przy włączonej kinematyce) - UV podąża za XY w całym zadaniu
+        const bool parallel { request->hasParam("parallel") && request->getParam("parallel")->value() == "1" };
+
         // Wysłanie komendy START przez kolejkę FreeRTOS
-        this->sendCommand(CommandType::START);
+        this->sendCommand(CommandType::START, static_cast<float>(profile), parallel ? 1.0f : 0.0f);
 
         request->send(200, "application/json", "{\"success\":true}");
         });
@@ -249,9 +529,13 @@ void WebServerManager::setupIndexRoutes() {
         Serial.println("DEBUG SERVER STATUS: Komenda PAUSE");
         #endif
 
-        this->sendCommand(CommandType::PAUSE);
-
-        request->send(200, "application/json", "{\"success\":true}");
+        // Wstrzymanie posuwu w kanale czasu rzeczywistego - hamowanie na torze bez kolejki komend
+        if (realtimeChannel && realtimeChannel->toggleFeedHold() == RealtimeChannelStatus::OK) {
+            request->send(200, "application/json", "{\"success\":true}");
+        }
+        else {
+            request->send(503, "application/json", "{\"success\":false,\"message\":\"Realtime channel not ready\"}");
+        }
         });
 
     // Przycisk STOP - zatrzymanie wykonywania programu
@@ -260,11 +544,86 @@ void WebServerManager::setupIndexRoutes() {
         Serial.println("DEBUG SERVER STATUS: Komenda STOP");
         #endif
 
-        this->sendCommand(CommandType::STOP);
+        // STOP w kanale czasu rzeczywistego - kroki zatrzymane natychmiast, niezależnie od commandQueue
+        // (kolejka komend tylko przed inicjalizacją kanału)
+        if (!realtimeChannel || realtimeChannel->requestStop() != RealtimeChannelStatus::OK) {
+            this->sendCommand(CommandType::STOP);
+        }
 
         request->send(200, "application/json", "{\"success\":true}");
         });
 
+    // Korekta prędkości posuwu [%] w trakcie pracy
+    server->on("/api/override", HTTP_POST,
+        [](AsyncWebServerRequest* request) {},
+        NULL,
+        [this](AsyncWebServerRequest* request, uint8_t* data, size_t len, size_t index, size_t total) {
+            processJsonRequest(request, data, len, index, total, SMALL_JSON_BUFFER_SIZE, [this, request](const String& jsonStr) {
+                JsonDocument doc;
+                DeserializationError error = deserializeJson(doc, jsonStr);
+
+                if (error || !doc["feed"].is<int>()) {
+                    request->send(400, "application/json", "{\"success\":false,\"message\":\"Missing parameters\"}");
+                    return;
+                }
+
+                const int feed { doc["feed"].as<int>() };
+                if (!realtimeChannel || feed < CONFIG::FEED_OVERRIDE_MIN || feed > CONFIG::FEED_OVERRIDE_MAX
+                    || realtimeChannel->setFeedOverride(static_cast<uint8_t>(feed)) != RealtimeChannelStatus::OK) {
+                    request->send(400, "application/json", "{\"success\":false,\"message\":\"Feed override out of range\"}");
+                    return;
+                }
+
+                #ifdef DEBUG_SERVER_ROUTES
+                Serial.printf("DEBUG SERVER STATUS: Korekta posuwu %d%%\n", feed);
+                #endif
+
+                request->send(200, "application/json", "{\"success\":true}");
+                });
+        }
+    );
+
+    // Ślad wykonanej ścieżki - punkty od numeru sekwencji podanego przez klienta
+    // Odpowiedź: first - numer pierwszego punktu (first > since = punkty utracone), next - numer
+    // dla kolejnego zapytania, more - w buforze czekają kolejne punkty, points - [czas ms, x, y]
+    server->on("/api/trace", HTTP_GET, [this](AsyncWebServerRequest* request) {
+        if (!traceBuffer) {
+            request->send(503, "application/json", "{\"success\":false,\"message\":\"Trace not available\"}");
+            return;
+        }
+
+        const uint32_t since { request->hasParam("since") ? static_cast<uint32_t>(strtoul(request->getParam("since")->value().c_str(), nullptr, 10)) : 0 };
+
+        uint32_t first { since };
+        const size_t count { traceBuffer->read(since, traceChunk, CONFIG::TRACE_MAX_POINTS_PER_RESPONSE, first) };
+        const uint32_t next { first + static_cast<uint32_t>(count) };
+
+        JsonWriter writer { this->responseBuffer, sizeof(this->responseBuffer) };
+        writer.beginObject();
+        writer.field("success", true);
+        writer.field("first", first);
+        writer.field("next", next);
+        writer.field("lost", first != since);
+        writer.field("more", traceBuffer->getSequence() != next);
+        writer.beginArray("points");
+        for (size_t index { 0 }; index < count; ++index) {
+            writer.beginArray();
+            writer.value(traceChunk[index].time);
+            writer.value(traceChunk[index].x);
+            writer.value(traceChunk[index].y);
+            writer.endArray();
+        }
+        writer.endArray();
+        writer.endObject();
+
+        if (!writer.isComplete()) {
+            request->send(500, "application/json", "{\"success\":false,\"message\":\"Trace chunk too large\"}");
+            return;
+        }
+
+        request->send(200, "application/json", this->responseBuffer);
+        });
+
     // Przycisk RESET - powrót do stanu IDLE z błędów i zatrzymania
     server->on("/api/reset", HTTP_POST, [this](AsyncWebServerRequest* request) {
         #ifdef DEBUG_SERVER_ROUTES
@@ -294,25 +653,19 @@ void WebServerManager::setupConfigRoutes() {
             return;
         }
 
-        // Force reload from SD if available
-        if (this->sdManager->isCardInitialized()) {
-            ConfigManagerStatus status = this->configManager->readConfigFromSD();
-            if (status != ConfigManagerStatus::OK) {
-                #ifdef DEBUG_SERVER_ROUTES
-                Serial.println("DEBUG SERVER WARNING: Failed to read config from SD, using current config");
-                #endif
-            }
+        // Aktywna konfiguracja z pamięci (trwały zapis w NVS) - plik na karcie SD tylko przez import
+        if (this->configManager->configToJson(this->responseBuffer, sizeof(this->responseBuffer)) == 0) {
+            request->send(500, "application/json", "{\"success\":false,\"message\":\"Failed to serialize config\"}");
+            return;
         }
 
-        String jsonConfig = this->configManager->configToJson();
-
         #ifdef DEBUG_SERVER_ROUTES        
         Serial.println("DEBUG: Generated JSON config:");
-        Serial.println(jsonConfig);
+        Serial.println(this->responseBuffer);
         #endif
 
         // Add proper headers
-        request->send(200, "application/json", jsonConfig);
+        request->send(200, "application/json", this->responseBuffer);
         });
 
     // Aktualizacja całej konfiguracji
@@ -333,45 +686,195 @@ void WebServerManager::setupConfigRoutes() {
                     return;
                 }
 
-                ConfigManagerStatus status = this->configManager->configFromJson(jsonStr);
-                String message;
-
+                ConfigValidationReport report {};
+                ConfigManagerStatus status = this->configManager->configFromJson(jsonStr, &report);
                 if (status == ConfigManagerStatus::OK) {
-                    status = this->configManager->writeConfigToSD();
+                    status = this->configManager->saveConfig();
                 }
+                this->sendConfigStatus(request, status, "Configuration saved successfully", &report);
+                });
+        });
+
+    // Import konfiguracji z pliku JSON na karcie SD do NVS
+    server->on("/api/config-import", HTTP_POST, [this](AsyncWebServerRequest* request) {
+        if (!this->configManager) {
+            request->send(500, "application/json", "{\"success\":false,\"message\":\"Config Manager not initialized\"}");
+            return;
+        }
+        if (!this->sdManager->isCardInitialized()) {
+            request->send(503, "application/json", "{\"success\":false,\"message\":\"SD card not available\"}");
+            return;
+        }
+
+        ConfigValidationReport report {};
+        ConfigManagerStatus status = this->configManager->readConfigFromSD(&report);
+        if (status == ConfigManagerStatus::OK) {
+            status = this->configManager->saveConfig();
+        }
+        this->sendConfigStatus(request, status, "Configuration imported from SD card", &report);
+        });
+
+    // Eksport aktywnej konfiguracji do pliku JSON na karcie SD
+    server->on("/api/config-export", HTTP_POST, [this](AsyncWebServerRequest* request) {
+        if (!this->configManager) {
+            request->send(500, "application/json", "{\"success\":false,\"message\":\"Config Manager not initialized\"}");
+            return;
+        }
+        if (!this->sdManager->isCardInitialized()) {
+            request->send(503, "application/json", "{\"success\":false,\"message\":\"SD card not available\"}");
+            return;
+        }
+
+        this->sendConfigStatus(request, this->configManager->writeConfigToSD(), "Configuration exported to SD card");
+        });
+
+    // Lista profili materiałów (zajęte miejsca 1..MATERIAL_PROFILE_SLOTS)
+    server->on("/api/profiles", HTTP_GET, [this](AsyncWebServerRequest* request) {
+        if (!this->configManager) {
+            request->send(500, "application/json", "{\"success\":false,\"message\":\"Config Manager not initialized\"}");
+            return;
+        }
+        if (this->configManager->profilesToJson(this->responseBuffer, sizeof(this->responseBuffer)) == 0) {
+            request->send(500, "application/json", "{\"success\":false,\"message\":\"Profile list too large\"}");
+            return;
+        }
+        request->send(200, "application/json", this->responseBuffer);
+        });
 
-                switch (status) {
-                    case ConfigManagerStatus::OK:
-                        message = "Configuration saved successfully";
-                        break;
-                    case ConfigManagerStatus::SD_ACCESS_ERROR:
-                        message = "SD access error";
-                        break;
-                    case ConfigManagerStatus::FILE_OPEN_FAILED:
-                        message = "Failed to open config file";
-                        break;
-                    case ConfigManagerStatus::FILE_WRITE_FAILED:
-                        message = "Failed to write to config file";
-                        break;
-                    case ConfigManagerStatus::JSON_PARSE_ERROR:
-                        message = "Invalid JSON format";
-                        break;
-                    default:
-                        message = "Unknown error";
-                        break;
+    // Zapis profilu materiału: {"slot", "name", parametry cięcia w układzie /api/config}
+    server->on("/api/profiles", HTTP_POST,
+        [](AsyncWebServerRequest* request) {
+            // Odpowiedź wysyła obsługa treści żądania
+        },
+        NULL,
+        [this](AsyncWebServerRequest* request, uint8_t* data, size_t len, size_t index, size_t total) {
+            processJsonRequest(request, data, len, index, total, 1024, [this, request](const String& jsonStr) {
+                if (!this->configManager) {
+                    request->send(500, "application/json", "{\"success\":false,\"message\":\"Config Manager not initialized\"}");
+                    return;
                 }
 
-                String response = "{\"success\":" + String(status == ConfigManagerStatus::OK ? "true" : "false") +
-                    ",\"message\":\"" + message + "\"}";
-                request->send(status == ConfigManagerStatus::OK ? 200 : 400, "application/json", response);
+                ConfigValidationReport report {};
+                const ConfigManagerStatus status { this->configManager->profileFromJson(jsonStr, &report) };
+                this->sendConfigStatus(request, status, "Material profile saved", &report);
                 });
         });
+
+    // Usunięcie profilu materiału z miejsca ?slot=<n>
+    server->on("/api/profile-delete", HTTP_POST, [this](AsyncWebServerRequest* request) {
+        if (!this->configManager) {
+            request->send(500, "application/json", "{\"success\":false,\"message\":\"Config Manager not initialized\"}");
+            return;
+        }
+        const long slot { request->hasParam("slot") ? strtol(request->getParam("slot")->value().c_str(), nullptr, 10) : 0 };
+        const ConfigManagerStatus status { slot > 0 && slot <= static_cast<long>(CONFIG::MATERIAL_PROFILE_SLOTS)
+            ? this->configManager->deleteProfile(static_cast<uint8_t>(slot)) : ConfigManagerStatus::INVALID_PROFILE };
+        this->sendConfigStatus(request, status, "Material profile deleted");
+        });
+}
+
+void WebServerManager::sendConfigStatus(AsyncWebServerRequest* request, ConfigManagerStatus status, const char* successMessage,
+    const ConfigValidationReport* report) {
+    // Odrzucenie przez walidację - lista błędów z nazwami pól formularza
+    if (status == ConfigManagerStatus::VALIDATION_FAILED && report != nullptr) {
+        JsonWriter writer { this->responseBuffer, sizeof(this->responseBuffer) };
+        writer.beginObject();
+        writer.field("success", false);
+        writer.field("message", "Configuration rejected by validation");
+        ConfigValidator::writeJson(*report, writer);
+        writer.endObject();
+        request->send(400, "application/json", this->responseBuffer);
+        return;
+    }
+
+    String message;
+    switch (status) {
+        case ConfigManagerStatus::OK:
+            message = successMessage;
+            break;
+        case ConfigManagerStatus::SD_ACCESS_ERROR:
+            message = "SD access error";
+            break;
+        case ConfigManagerStatus::FILE_OPEN_FAILED:
+            message = "Failed to open config file";
+            break;
+        case ConfigManagerStatus::FILE_WRITE_FAILED:
+            message = "Failed to write to config file";
+            break;
+        case ConfigManagerStatus::JSON_PARSE_ERROR:
+            message = "Invalid JSON format";
+            break;
+        case ConfigManagerStatus::VALUE_OUT_OF_RANGE:
+            message = "Value out of range";
+            break;
+        case ConfigManagerStatus::NVS_WRITE_FAILED:
+            message = "Failed to save configuration";
+            break;
+        case ConfigManagerStatus::SNAPSHOT_UNAVAILABLE:
+            message = "Configuration busy, try again";
+            break;
+        case ConfigManagerStatus::VALIDATION_FAILED:
+            message = "Configuration rejected by validation";
+            break;
+        case ConfigManagerStatus::INVALID_PROFILE:
+            message = "Invalid material profile slot or name";
+            break;
+        default:
+            message = "Unknown error";
+            break;
+    }
+
+    String response = "{\"success\":" + String(status == ConfigManagerStatus::OK ? "true" : "false") +
+        ",\"message\":\"" + message + "\"}";
+    request->send(status == ConfigManagerStatus::OK ? 200 : 400, "application/json", response);
 }
 
 // ================================================================================
 //                         ENDPOINTY STEROWANIA JOG
 // ================================================================================
 
+void WebServerManager::handleJogSocketEvent(AsyncWebSocketClient* client, AwsEventType type, void* arg, uint8_t* data, size_t len) {
+    switch (type) {
+        case WS_EVT_DISCONNECT:
+            // Zerwane połączenie klienta sterującego ruchem - natychmiastowe hamowanie zamiast oczekiwania
+            // na limit czasu; zamknięcie innej karty nie zatrzymuje cudzego ruchu
+            if (client != nullptr && client->id() == this->jogClientId) {
+                this->jogClientId = 0;
+                this->sendJogVelocity(0.0f, 0.0f, false);
+            }
+            break;
+
+        case WS_EVT_DATA: {
+            // Obsługiwane tylko kompletne ramki tekstowe (komunikaty JOG są krótkie)
+            AwsFrameInfo* info = static_cast<AwsFrameInfo*>(arg);
+            if (!info || !info->final || info->index != 0 || info->len != len || info->opcode != WS_TEXT) {
+                return;
+            }
+
+            // Dokument w buforze na stosie - ramki co ok. 50 ms bez alokacji na stercie
+            StackJsonAllocator<CONFIG::JOG_FRAME_JSON_BUFFER_SIZE> allocator;
+            JsonDocument doc(&allocator);
+            DeserializationError error = deserializeJson(doc, reinterpret_cast<const char*>(data), len);
+            if (error || !doc["x"].is<float>() || !doc["y"].is<float>() || client == nullptr) {
+                #ifdef DEBUG_SERVER_ROUTES
+                Serial.println("DEBUG SERVER WARNING: Invalid continuous JOG frame");
+                #endif
+                return;
+            }
+
+            // Ruchem steruje klient, który ostatnio zadał prędkość (limit czasu podtrzymania w zadaniu CNC)
+            const char* speedMode { doc["speedMode"].as<const char*>() };
+            const bool rapid { speedMode != nullptr && strcmp(speedMode, "rapid") == 0 };
+            this->jogClientId = client->id();
+            this->sendJogVelocity(doc["x"].as<float>(), doc["y"].as<float>(), rapid);
+            break;
+        }
+
+        default:
+            break;
+    }
+}
+
 void WebServerManager::setupJogRoutes() {
     // Sterowanie ruchem ręcznym (JOG) z kontrolą prędkości
     server->on("/api/jog", HTTP_POST,
@@ -546,26 +1049,129 @@ void WebServerManager::setupProjectsRoutes() {
         Serial.printf("DEBUG SERVER: Requested SD file content: %s\n", filename.c_str());
         #endif
 
-        // Synchronizacja dostępu do karty SD przez mutex
-        if (!this->sdManager->takeSD()) {
-            request->send(503, "application/json", "{\"error\":\"SD busy\"}");
+        if (this->benchmarkActive) {
+            request->send(503, "application/json", "{\"error\":\"SD benchmark running\"}");
             return;
         }
 
-        if (!SD.exists(filePath)) {
-            this->sdManager->giveSD();
-            request->send(404, "application/json", "{\"error\":\"File not found\"}");
+        SDFileStream* stream { new (std::nothrow) SDFileStream() };
+        if (stream == nullptr) {
+            request->send(500, "application/json", "{\"error\":\"Memory allocation failed\"}");
+            return;
+        }
+
+        const char* range { request->hasHeader("Range") ? request->getHeader("Range")->value().c_str() : nullptr };
+        const SDFileStreamStatus status { stream->begin(this->sdManager, filePath.c_str(), range) };
+        if (status != SDFileStreamStatus::OK) {
+            const size_t fileSize { stream->getFileSize() };
+            delete stream;
+            if (status == SDFileStreamStatus::FILE_NOT_FOUND) {
+                request->send(404, "application/json", "{\"error\":\"File not found\"}");
+            }
+            else if (status == SDFileStreamStatus::RANGE_NOT_SATISFIABLE) {
+                AsyncWebServerResponse* response = request->beginResponse(416, "application/json", "{\"error\":\"Range not satisfiable\"}");
+                response->addHeader("Content-Range", String("bytes */") + fileSize);
+                request->send(response);
+            }
+            else {
+                request->send(503, "application/json", "{\"error\":\"SD not available\"}");
+            }
             return;
         }
 
-        this->busy = true;
-        AsyncWebServerResponse* response = request->beginResponse(SD, filePath, "text/plain");
+        #ifdef DEBUG_SERVER_ROUTES
+        Serial.printf("DEBUG SERVER: Streaming %u B from offset %u (file %u B)\n",
+            static_cast<unsigned>(stream->getRangeLength()), static_cast<unsigned>(stream->getRangeStart()),
+            static_cast<unsigned>(stream->getFileSize()));
+        #endif
+
+        // Karta zajmowana tylko na czas odczytu porcji - pobieranie nie blokuje zadania CNC
+        ++this->activeDownloads;
+        AsyncWebServerResponse* response = request->beginResponse("text/plain", stream->getRangeLength(),
+            [stream](uint8_t* buffer, size_t maxLen, size_t index) -> size_t {
+                // Karta chwilowo niedostępna - porcja pobierana ponownie, bez skracania odpowiedzi
+                const size_t length { stream->read(buffer, maxLen) };
+                return length == 0 && stream->isCardBusy() ? RESPONSE_TRY_AGAIN : length;
+            });
         response->addHeader("Cache-Control", "no-cache");
+        response->addHeader("Accept-Ranges", "bytes");
+        if (stream->isPartial()) {
+            response->setCode(206);
+            response->addHeader("Content-Range", String("bytes ") + stream->getRangeStart() + "-"
+                + (stream->getRangeStart() + stream->getRangeLength() - 1) + "/" + stream->getFileSize());
+        }
 
         // Cleanup po zakończeniu transmisji pliku
-        request->onDisconnect([this]() {
-            this->busy = false;
-            this->sdManager->giveSD();
+        request->onDisconnect([this, stream]() {
+            delete stream;
+            --this->activeDownloads;
+            });
+
+        request->send(response);
+        });
+
+    // Uproszczony podgląd ścieżki - binarne łamane G0/G1 generowane strumieniowo z pliku
+    // Parametry: file, tolerance [px], width i height obszaru rysowania [px]
+    server->on("/api/preview", HTTP_GET, [this](AsyncWebServerRequest* request) {
+        if (!request->hasParam("file")) {
+            request->send(400, "application/json", "{\"success\":false,\"message\":\"Missing file parameter\"}");
+            return;
+        }
+
+        // Jeden podgląd naraz - ogranicza pamięć i obciążenie karty SD
+        if (this->previewActive || this->benchmarkActive) {
+            request->send(503, "application/json", "{\"success\":false,\"message\":\"Preview busy\"}");
+            return;
+        }
+
+        const String filePath { String(CONFIG::PROJECTS_DIR) + request->getParam("file")->value() };
+        const float tolerance { request->hasParam("tolerance") ? request->getParam("tolerance")->value().toFloat() : CONFIG::PREVIEW_DEFAULT_TOLERANCE };
+        const long width { request->hasParam("width") ? request->getParam("width")->value().toInt() : 0 };
+        const long height { request->hasParam("height") ? request->getParam("height")->value().toInt() : 0 };
+
+        if (width <= 0 || width > UINT16_MAX || height <= 0 || height > UINT16_MAX) {
+            request->send(400, "application/json", "{\"success\":false,\"message\":\"Invalid preview size\"}");
+            return;
+        }
+
+        ToolpathPreview* preview { new (std::nothrow) ToolpathPreview() };
+        if (preview == nullptr) {
+            request->send(500, "application/json", "{\"success\":false,\"message\":\"Memory allocation failed\"}");
+            return;
+        }
+
+        const ToolpathPreviewStatus status { preview->begin(this->sdManager, filePath.c_str(), tolerance,
+            static_cast<uint16_t>(width), static_cast<uint16_t>(height)) };
+        if (status != ToolpathPreviewStatus::OK) {
+            delete preview;
+            if (status == ToolpathPreviewStatus::FILE_OPEN_FAILED) {
+                request->send(404, "application/json", "{\"success\":false,\"message\":\"File not found\"}");
+            }
+            else {
+                request->send(400, "application/json", "{\"success\":false,\"message\":\"Invalid preview parameters\"}");
+            }
+            return;
+        }
+
+        #ifdef DEBUG_SERVER_ROUTES
+        Serial.printf("DEBUG SERVER: Preview %s (%.2f px, %ldx%ld)\n", filePath.c_str(), tolerance, width, height);
+        #endif
+
+        // Dane wysyłane w miarę parsowania; brak gotowych danych = ponowne wywołanie później
+        this->previewActive = true;
+        AsyncWebServerResponse* response = request->beginChunkedResponse("application/octet-stream",
+            [preview](uint8_t* buffer, size_t maxLen, size_t index) -> size_t {
+                if (preview->isFinished()) {
+                    return 0;
+                }
+                const size_t length { preview->read(buffer, maxLen) };
+                return length > 0 ? length : RESPONSE_TRY_AGAIN;
+            });
+        response->addHeader("Cache-Control", "no-cache");
+
+        request->onDisconnect([this, preview]() {
+            delete preview;
+            this->previewActive = false;
             });
 
         request->send(response);
@@ -594,7 +1200,7 @@ void WebServerManager::setupProjectsRoutes() {
             return;
         }
 
-        std::vector<std::string> files;
+        std::vector<ProjectFileInfo> files;
         SDManagerStatus status = this->sdManager->getProjectFiles(files);
 
         if (status != SDManagerStatus::OK) {
@@ -602,54 +1208,148 @@ void WebServerManager::setupProjectsRoutes() {
             return;
         }
 
-        // Budowanie odpowiedzi JSON z listą plików
-        String json = "[";
-        for (size_t i { 0 }; i < files.size(); ++i) {
-            if (i > 0) json += ",";
-            json += "\"" + String(files[i].c_str()) + "\"";
+        // Stronicowanie i sortowanie: offset, limit, sort = name|size|modified|lines, order = asc|desc
+        const size_t offset { request->hasParam("offset") ? static_cast<size_t>(request->getParam("offset")->value().toInt()) : 0 };
+        size_t limit { request->hasParam("limit") ? static_cast<size_t>(request->getParam("limit")->value().toInt()) : CONFIG::PROJECT_LIST_PAGE_SIZE };
+        if (limit == 0 || limit > CONFIG::PROJECT_LIST_MAX_PAGE_SIZE) {
+            limit = CONFIG::PROJECT_LIST_MAX_PAGE_SIZE;
+        }
+        const String sortKey { request->hasParam("sort") ? request->getParam("sort")->value() : String("name") };
+        const bool descending { request->hasParam("order") && request->getParam("order")->value() == "desc" };
+
+        std::vector<uint16_t> order(files.size());
+        for (size_t index { 0 }; index < order.size(); ++index) {
+            order[index] = static_cast<uint16_t>(index);
+        }
+        std::sort(order.begin(), order.end(), [&files, &sortKey, descending](uint16_t left, uint16_t right) {
+            const ProjectFileInfo& a { files[descending ? right : left] };
+            const ProjectFileInfo& b { files[descending ? left : right] };
+            if (sortKey == "size" && a.size != b.size) {
+                return a.size < b.size;
+            }
+            if (sortKey == "modified" && a.modified != b.modified) {
+                return a.modified < b.modified;
+            }
+            if (sortKey == "lines" && a.lineCount != b.lineCount) {
+                return a.lineCount < b.lineCount;
+            }
+            return strcasecmp(a.name.c_str(), b.name.c_str()) < 0;
+            });
+
+        // Budowanie odpowiedzi JSON ze stroną listy (nazwy z escapowaniem znaków specjalnych)
+        JsonWriter writer { this->responseBuffer, sizeof(this->responseBuffer) };
+        writer.beginObject();
+        writer.field("success", true);
+        writer.field("message", "Files retrieved successfully");
+        writer.field("total", static_cast<unsigned long>(files.size()));
+        writer.field("offset", static_cast<unsigned long>(offset));
+        writer.beginArray("files");
+        for (size_t index { offset }; index < files.size() && index < offset + limit; ++index) {
+            const ProjectFileInfo& file { files[order[index]] };
+            writer.beginObject();
+            writer.field("name", file.name.c_str());
+            writer.field("size", file.size);
+            writer.field("modified", file.modified);
+            writer.field("lines", file.lineCount);
+            writer.field("moves", file.moveCount);
+            writer.beginArray("bounds");
+            writer.value(file.minX);
+            writer.value(file.minY);
+            writer.value(file.maxX);
+            writer.value(file.maxY);
+            writer.endArray();
+            writer.endObject();
+        }
+        writer.endArray();
+        writer.endObject();
+
+        if (!writer.isComplete()) {
+            request->send(500, "application/json", "{\"success\":false,\"message\":\"File list too large\"}");
+            return;
         }
-        json += "]";
 
-        request->send(200, "application/json", "{\"success\":true,\"message\":\"Files retrieved successfully\",\"files\":" + json + "}");
+        request->send(200, "application/json", this->responseBuffer);
         });
 
     // Upload pliku G-code na kartę SD
+    // Stan przesyłania w request->_tempObject (ProjectUpload), zwalniany przy rozłączeniu;
+    // przerwane przesyłanie usuwa plik tymczasowy i nie zmienia istniejącego projektu
     server->on("/api/upload-file", HTTP_POST,
-        [](AsyncWebServerRequest* request) {
-            request->send(200, "application/json", "{\"success\":true,\"message\":\"Upload complete\"}");
+        [this](AsyncWebServerRequest* request) {
+            const ProjectUpload* upload { static_cast<const ProjectUpload*>(request->_tempObject) };
+            if (upload == nullptr && this->benchmarkActive) {
+                request->send(503, "application/json", "{\"success\":false,\"message\":\"SD benchmark running\"}");
+                return;
+            }
+            if (upload == nullptr) {
+                request->send(400, "application/json", "{\"success\":false,\"message\":\"No file received\"}");
+                return;
+            }
+
+            if (!upload->isCommitted()) {
+                const char* message { "Upload failed" };
+                int code { 500 };
+                switch (upload->getStatus()) {
+                    case ProjectUploadStatus::INVALID_FILENAME: message = "Invalid file name"; code = 400; break;
+                    case ProjectUploadStatus::CARD_NOT_INITIALIZED: message = "Failed to access SD card"; break;
+                    case ProjectUploadStatus::MEMORY_ALLOCATION_FAILED: message = "Memory allocation failed"; break;
+                    case ProjectUploadStatus::FILE_OPEN_FAILED: message = "Failed to open file"; break;
+                    case ProjectUploadStatus::FILE_WRITE_FAILED: message = "Failed to write file"; break;
+                    case ProjectUploadStatus::RENAME_FAILED: message = "Failed to replace file"; break;
+                    default: break;
+                }
+                JsonWriter writer { this->responseBuffer, sizeof(this->responseBuffer) };
+                writer.beginObject();
+                writer.field("success", false);
+                writer.field("message", message);
+                writer.endObject();
+                request->send(code, "application/json", this->responseBuffer);
+                return;
+            }
+
+            // Przyrostowa aktualizacja listy - metadane policzone w trakcie odbioru
+            this->sdManager->addProjectFile(upload->getFileInfo());
+
+            JsonWriter writer { this->responseBuffer, sizeof(this->responseBuffer) };
+            writer.beginObject();
+            writer.field("success", true);
+            writer.field("message", "Upload complete");
+            writer.field("bytes", static_cast<unsigned long>(upload->getTotalBytes()));
+            writer.field("throughputMBps", upload->getThroughput());
+            writer.field("writeThroughputMBps", upload->getWriteThroughput());
+            writer.endObject();
+            request->send(200, "application/json", this->responseBuffer);
         },
         [this](AsyncWebServerRequest* request, const String& filename, size_t index, uint8_t* data, size_t len, bool final) {
-            static File uploadFile;
-            if (index == 0) {
-                String filePath = String(CONFIG::PROJECTS_DIR) + filename;
+            ProjectUpload* upload { static_cast<ProjectUpload*>(request->_tempObject) };
+
+            if (index == 0 && upload == nullptr && !this->benchmarkActive) {
                 #ifdef DEBUG_SERVER_ROUTES
                 Serial.println("DEBUG SERVER STATUS: Starting upload of " + String(filename.c_str()));
                 #endif
 
-                // Bezpieczny dostęp do karty SD przez mutex
-                if (!this->sdManager->takeSD()) {
-                    request->send(500, "application/json", "{\"success\":false,\"message\":\"Failed to access SD card\"}");
-                    return;
-                }
-
-                uploadFile = SD.open(filePath.c_str(), FILE_WRITE);
-                if (!uploadFile) {
-                    this->sdManager->giveSD();
-                    request->send(500, "application/json", "{\"success\":false,\"message\":\"Failed to open file\"}");
+                upload = new (std::nothrow) ProjectUpload();
+                if (upload == nullptr) {
                     return;
                 }
+                request->_tempObject = upload;
+                ++this->activeUploads;
+                request->onDisconnect([this, request]() {
+                    delete static_cast<ProjectUpload*>(request->_tempObject);
+                    request->_tempObject = nullptr;
+                    --this->activeUploads;
+                    });
+                upload->begin(this->sdManager, filename.c_str());
             }
 
-            if (uploadFile) {
-                if (len > 0) {
-                    uploadFile.write(data, len);
-                }
-                if (final) {
-                    uploadFile.close();
-                    this->sdManager->giveSD();
-                    // Aktualizacja listy po pomyślnym uploadzie
-                    this->sdManager->updateProjectList();
-                }
+            if (upload == nullptr) {
+                return;
+            }
+            if (len > 0) {
+                upload->append(data, len);
+            }
+            if (final) {
+                upload->commit();
             }
         }
     );
@@ -724,12 +1424,12 @@ void WebServerManager::setupProjectsRoutes() {
 
         // Bezpieczne usuwanie z synchronizacją dostępu do SD
         if (this->sdManager->takeSD()) {
-            bool success = SD.remove(filePath.c_str());
+            bool success = this->sdManager->getStorage().remove(filePath.c_str());
             this->sdManager->giveSD();
 
             if (success) {
-                // Aktualizacja listy po pomyślnym usunięciu
-                this->sdManager->updateProjectList();
+                // Przyrostowa aktualizacja listy po pomyślnym usunięciu
+                this->sdManager->removeProjectFile(filename);
                 request->send(200, "application/json", "{\"success\":true}");
             }
             else {
@@ -768,8 +1468,10 @@ void WebServerManager::sendCommand(CommandType type, float param1, float param2,
         cmd.param2 = param2;
         cmd.param3 = param3;
 
-        // Nieblokujące wysłanie komendy (czas oczekiwania = 0)
-        xQueueSend(commandQueue, &cmd, 0);
+        // Nieblokujące wysłanie komendy (czas oczekiwania = 0) i wybudzenie zadania CNC
+        if (xQueueSend(commandQueue, &cmd, 0) == pdTRUE && cncTask) {
+            xTaskNotify(cncTask, CNCEvent::COMMAND, eSetBits);
+        }
 
         #ifdef DEBUG_SERVER_ROUTES
         Serial.printf("DEBUG SERVER: Wysłano komendę typu %d z parametrami: %.2f, %.2f, %.2f\n",
@@ -778,6 +1480,55 @@ void WebServerManager::sendCommand(CommandType type, float param1, float param2,
     }
 }
 
+// Przekazanie prędkości ruchu ciągłego JOG - nadpisanie skrzynki, ważna jest tylko ostatnia wartość
+void WebServerManager::sendJogVelocity(float xDirection, float yDirection, bool rapid) {
+    if (jogQueue) {
+        JogVelocityCommand cmd {};
+        cmd.xDirection = xDirection;
+        cmd.yDirection = yDirection;
+        cmd.rapid = rapid;
+
+        xQueueOverwrite(jogQueue, &cmd);
+        if (cncTask) {
+            xTaskNotify(cncTask, CNCEvent::JOG, eSetBits);
+        }
+    }
+}
+
+// Wysyłanie binarnej ramki różnicowej do klientów WebSocket /ws/status
+void WebServerManager::broadcastTelemetry(const MachineState& currentState) {
+    if (!statusSocket) {
+        return;
+    }
+
+    statusSocket->cleanupClients();
+    if (statusSocket->count() == 0) {
+        return;
+    }
+
+    // Wszyscy klienci współdzielą strumień różnic - ramka wysyłana tylko gdy każdy ma miejsce
+    // w kolejce, w przeciwnym razie odniesienie pozostaje bez zmian do następnej próby
+    if (!statusSocket->availableForWriteAll()) {
+        return;
+    }
+
+    const unsigned long now { millis() };
+    const bool keyFrame { telemetryKeyFramePending || now - lastTelemetryKeyFrame >= CONFIG::TELEMETRY_KEYFRAME_INTERVAL_MS };
+
+    const size_t frameLength { telemetryEncoder.encode(currentState, keyFrame, telemetryFrame, sizeof(telemetryFrame)) };
+    if (frameLength == 0) {
+        return;
+    }
+
+    statusSocket->binaryAll(telemetryFrame, frameLength);
+    telemetryEncoder.markSent();
+
+    if (keyFrame) {
+        telemetryKeyFramePending = false;
+        lastTelemetryKeyFrame = now;
+    }
+}
+
 // Wysyłanie statusu maszyny do klientów przez Server-Sent Events
 void WebServerManager::broadcastMachineStatus(MachineState currentState) {
 
@@ -788,8 +1539,6 @@ void WebServerManager::broadcastMachineStatus(MachineState currentState) {
         return;
     }
 
-    char jsonBuffer[1024];
-
     static MachineState lastSentState {};
     static bool firstSend = true;
 
@@ -797,6 +1546,7 @@ void WebServerManager::broadcastMachineStatus(MachineState currentState) {
     bool stateChanged = firstSend ||
         lastSentState.state != currentState.state ||
         lastSentState.isPaused != currentState.isPaused ||
+        lastSentState.feedOverride != currentState.feedOverride ||
         abs(lastSentState.currentX - currentState.currentX) > 0.01f ||
         abs(lastSentState.currentY - currentState.currentY) > 0.01f ||
         lastSentState.hotWireOn != currentState.hotWireOn ||
@@ -808,37 +1558,95 @@ void WebServerManager::broadcastMachineStatus(MachineState currentState) {
         return; // Nie wysyłaj jeśli stan się nie zmienił
     }
 
-    // Budowanie JSON odpowiedzi ze stanem maszyny
-    JsonDocument doc;
-    doc["state"] = static_cast<int>(currentState.state);
-    doc["isPaused"] = currentState.isPaused;
-    doc["errorID"] = currentState.errorID;
-    doc["currentX"] = currentState.currentX;
-    doc["currentY"] = currentState.currentY;
-    doc["relativeMode"] = currentState.relativeMode;
-    doc["hotWireOn"] = currentState.hotWireOn;
-    doc["fanOn"] = currentState.fanOn;
-    doc["hotWirePower"] = currentState.hotWirePower;
-    doc["fanPower"] = currentState.fanPower;
-    doc["currentProject"] = String(currentState.currentProject);
-    doc["jobProgress"] = currentState.jobProgress;
-    doc["currentLine"] = currentState.currentLine;
-    doc["totalLines"] = currentState.totalLines;
-    doc["jobStartTime"] = currentState.jobStartTime;
-    doc["jobRunTime"] = currentState.jobRunTime;
-    doc["estopOn"] = currentState.estopOn;
-    doc["limitXOn"] = currentState.limitXOn;
-    doc["limitYOn"] = currentState.limitYOn;
-
-    // Serializacja do bufora o stałym rozmiarze z kontrolą przepełnienia
-    size_t len = serializeJson(doc, jsonBuffer, sizeof(jsonBuffer));
-    if (len < sizeof(jsonBuffer)) {
+    // Serializacja pól stanu wg MACHINE_STATE_FIELDS do bufora na stosie - bez alokacji
+    char jsonBuffer[CONFIG::STATUS_JSON_BUFFER_SIZE];
+    JsonWriter writer { jsonBuffer, sizeof(jsonBuffer) };
+    writer.beginObject();
+    writer.fields(&currentState, MACHINE_STATE_FIELDS);
+    writer.endObject();
+
+    if (writer.isComplete()) {
         sendEvent("machine-status", jsonBuffer);
     }
     lastSentState = currentState;
     firstSend = false;
 }
 
+#ifdef BENCHMARK_JSON
+void WebServerManager::benchmarkStatusSerialization() {
+    constexpr uint32_t ITERATIONS { 1000 };
+
+    MachineState sample {};
+    sample.state = CNCState::RUNNING;
+    sample.currentX = 123.456f;
+    sample.currentY = -78.9f;
+    sample.hotWireOn = true;
+    sample.hotWirePower = 180;
+    sample.feedOverride = 100;
+    strncpy(sample.currentProject, "benchmark.gcode", sizeof(sample.currentProject) - 1);
+    sample.currentLine = 12345;
+    sample.totalLines = 67890;
+    sample.jobRunTime = 3600000;
+    sample.jobProgress = 18.18f;
+
+    char jsonBuffer[CONFIG::STATUS_JSON_BUFFER_SIZE];
+    size_t documentLength { 0 };
+    size_t writerLength { 0 };
+
+    // Poprzednia ścieżka: JsonDocument (alokacja na stercie przy każdej serializacji)
+    const uint32_t freeHeapBefore { ESP.getFreeHeap() };
+    uint32_t minFreeHeap { freeHeapBefore };
+    const unsigned long documentStart { micros() };
+    for (uint32_t iteration { 0 }; iteration < ITERATIONS; ++iteration) {
+        JsonDocument doc;
+        doc["state"] = static_cast<int>(sample.state);
+        doc["isPaused"] = sample.isPaused;
+        doc["feedOverride"] = sample.feedOverride;
+        doc["errorID"] = sample.errorID;
+        doc["currentX"] = sample.currentX;
+        doc["currentY"] = sample.currentY;
+        doc["relativeMode"] = sample.relativeMode;
+        doc["hotWireOn"] = sample.hotWireOn;
+        doc["fanOn"] = sample.fanOn;
+        doc["hotWirePower"] = sample.hotWirePower;
+        doc["fanPower"] = sample.fanPower;
+        doc["currentProject"] = String(sample.currentProject);
+        doc["jobProgress"] = sample.jobProgress;
+        doc["currentLine"] = sample.currentLine;
+        doc["totalLines"] = sample.totalLines;
+        doc["jobStartTime"] = sample.jobStartTime;
+        doc["jobRunTime"] = sample.jobRunTime;
+        doc["estopOn"] = sample.estopOn;
+        doc["limitXOn"] = sample.limitXOn;
+        doc["limitYOn"] = sample.limitYOn;
+        documentLength = serializeJson(doc, jsonBuffer, sizeof(jsonBuffer));
+        minFreeHeap = std::min(minFreeHeap, static_cast<uint32_t>(ESP.getFreeHeap()));
+    }
+    const unsigned long documentTime { micros() - documentStart };
+    const uint32_t documentHeap { freeHeapBefore - minFreeHeap };
+
+    // Nowa ścieżka: JsonWriter wg tablicy pól
+    minFreeHeap = ESP.getFreeHeap();
+    const uint32_t writerHeapBefore { minFreeHeap };
+    const unsigned long writerStart { micros() };
+    for (uint32_t iteration { 0 }; iteration < ITERATIONS; ++iteration) {
+        JsonWriter writer { jsonBuffer, sizeof(jsonBuffer) };
+        writer.beginObject();
+        writer.fields(&sample, MACHINE_STATE_FIELDS);
+        writer.endObject();
+        writerLength = writer.size();
+        minFreeHeap = std::min(minFreeHeap, static_cast<uint32_t>(ESP.getFreeHeap()));
+    }
+    const unsigned long writerTime { micros() - writerStart };
+    const uint32_t writerHeap { writerHeapBefore - minFreeHeap };
+
+    Serial.printf("BENCHMARK JSON: JsonDocument %lu us / %u (%u B, heap peak %u B)\n",
+        documentTime, static_cast<unsigned>(ITERATIONS), static_cast<unsigned>(documentLength), static_cast<unsigned>(documentHeap));
+    Serial.printf("BENCHMARK JSON: JsonWriter   %lu us / %u (%u B, heap peak %u B)\n",
+        writerTime, static_cast<unsigned>(ITERATIONS), static_cast<unsigned>(writerLength), static_cast<unsigned>(writerHeap));
+}
+#endif
+
 // Wysyłanie eventów Server-Sent Events do wszystkich połączonych klientów
 void WebServerManager::sendEvent(const char* event, const char* data) {
     if (events && eventsInitialized && event && data) {
@@ -846,8 +1654,29 @@ void WebServerManager::sendEvent(const char* event, const char* data) {
     }
 }
 
+// Zadanie testu karty SD - wynik w benchmarkResult, zastosowany zegar SPI zapisywany w konfiguracji
+void WebServerManager::benchmarkTask(void* parameter) {
+    WebServerManager* manager { static_cast<WebServerManager*>(parameter) };
+
+    // Osobny zakres - bufor testu zwalniany przed vTaskDelete()
+    {
+        SDBenchmark benchmark {};
+        benchmark.run(manager->sdManager, manager->benchmarkSweep, manager->benchmarkApply, manager->benchmarkResult);
+    }
+
+    manager->benchmarkSaved = false;
+    if (manager->benchmarkResult.frequencyApplied && manager->configManager != nullptr) {
+        manager->benchmarkSaved = manager->configManager->updateParameter("sdSpiFrequency",
+            manager->sdManager->getSpiFrequency()) == ConfigManagerStatus::OK;
+    }
+
+    manager->benchmarkDone = true;
+    manager->benchmarkActive = false;
+    vTaskDelete(NULL);
+}
+
 bool WebServerManager::isBusy() {
-    return this->busy;
+    return this->activeDownloads > 0;
 }
 
 // Przetwarzanie dużych żądań JSON z buforowaniem w pamięci
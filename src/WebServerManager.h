@@ -8,6 +8,10 @@
 #include "SharedTypes.h"
 #include "SDManager.h"
 #include "ConfigManager.h"
+#include "RealtimeChannel.h"
+#include "TelemetryEncoder.h"
+#include "TraceBuffer.h"
+#include "SDBenchmark.h"
 
 enum class WebServerStatus {
     OK,
@@ -23,12 +27,30 @@ class WebServerManager {
 
     AsyncWebServer* server { nullptr };
     AsyncEventSource* events { nullptr };
+    AsyncWebSocket* jogSocket { nullptr }; // Trwałe połączenie ruchu ciągłego JOG
+    uint32_t jogClientId { 0 };            // Klient /ws/jog, który ostatnio zadał prędkość (0 = brak) - tylko zadanie AsyncTCP
+    AsyncWebSocket* statusSocket { nullptr }; // Binarna telemetria stanu maszyny
+
+    // Ramki telemetrii różnicowej wspólne dla wszystkich klientów /ws/status
+    TelemetryEncoder telemetryEncoder {};
+    uint8_t telemetryFrame[TelemetryEncoder::MAX_FRAME_SIZE] {};
+    volatile bool telemetryKeyFramePending { true }; // Nowy klient - następna ramka kluczowa
+    unsigned long lastTelemetryKeyFrame { 0 };       // [ms]
+
+    // Bufor odpowiedzi JSON (konfiguracja, lista plików) - procedury żądań wykonywane są
+    // kolejno w zadaniu AsyncTCP, a treść jest kopiowana przy wysyłaniu odpowiedzi
+    char responseBuffer[CONFIG::RESPONSE_JSON_BUFFER_SIZE] {};
+    TracePoint traceChunk[CONFIG::TRACE_MAX_POINTS_PER_RESPONSE] {}; // Punkty śladu kopiowane do odpowiedzi
 
     SDCardManager* sdManager { nullptr };
     ConfigManager* configManager { nullptr };
 
     QueueHandle_t commandQueue; // Zasada Inversion of Control
-    QueueHandle_t stateQueue;
+    MachineStateSnapshot* stateSnapshot;
+    QueueHandle_t jogQueue;
+    TaskHandle_t cncTask;       // Zadanie CNC budzone po wysłaniu komendy lub prędkości JOG
+    RealtimeChannel* realtimeChannel; // STOP, wstrzymanie i korekta posuwu z pominięciem commandQueue
+    TraceBuffer* traceBuffer;   // Ślad wykonanej ścieżki zapisywany przez generator kroków
 
     // Track initialization status
     bool serverInitialized { false };
@@ -39,8 +61,25 @@ class WebServerManager {
     // Track server startup status
     bool serverStarted { false };
 
-    // Flag to indicate if the server is busy processing requests
-    volatile bool busy { false };
+    // Liczba trwających pobrań plików (/api/sd_content) - serwer zajęty, gdy > 0
+    volatile uint8_t activeDownloads { 0 };
+
+    // Trwa generowanie podglądu ścieżki (/api/preview)
+    volatile bool previewActive { false };
+
+    // Liczba trwających przesyłań projektów (/api/upload-file)
+    volatile uint8_t activeUploads { 0 };
+
+    // Test karty SD (/api/sd-benchmark) w osobnym zadaniu - pobieranie, podgląd, przesyłanie
+    // i start zadania odrzucane do jego zakończenia (próba zegarów uruchamia kartę ponownie)
+    volatile bool benchmarkActive { false };
+    bool benchmarkSweep { false };
+    bool benchmarkApply { false };
+    bool benchmarkDone { false };
+    bool benchmarkSaved { false };      // Zastosowany zegar zapisany w konfiguracji
+    SDBenchmarkResult benchmarkResult {};
+
+    static void benchmarkTask(void* parameter);
 
     // Sets up all server routes and handlers
     void setupRoutes();
@@ -50,6 +89,13 @@ class WebServerManager {
     void setupJogRoutes();
     void setupProjectsRoutes();
 
+    // Odpowiedź JSON z wynikiem operacji na konfiguracji
+    void sendConfigStatus(AsyncWebServerRequest* request, ConfigManagerStatus status, const char* successMessage,
+        const ConfigValidationReport* report = nullptr);
+
+    // Obsługa ramek WebSocket ruchu ciągłego JOG
+    void handleJogSocketEvent(AsyncWebSocketClient* client, AwsEventType type, void* arg, uint8_t* data, size_t len);
+
     static constexpr size_t JSON_BUFFER_SIZE = 1024;
     static constexpr size_t SMALL_JSON_BUFFER_SIZE = 256;
     
@@ -60,7 +106,7 @@ class WebServerManager {
     public:
 
     // Construct a new Web Server Manager Pointer to initialized SD card manager
-    WebServerManager(SDCardManager* sdManager, ConfigManager* configManager, QueueHandle_t extCommandQueue, QueueHandle_t extStateQueue);
+    WebServerManager(SDCardManager* sdManager, ConfigManager* configManager, QueueHandle_t extCommandQueue, MachineStateSnapshot* extStateSnapshot, QueueHandle_t extJogQueue, TaskHandle_t extCncTask, RealtimeChannel* extRealtimeChannel, TraceBuffer* extTraceBuffer);
 
     // Destroy and clean up allocated resources of the Web Server Manager
     ~WebServerManager();
@@ -86,9 +132,20 @@ class WebServerManager {
     // Send a command to the CNC task
     void sendCommand(CommandType type, float param1 = 0.0f, float param2 = 0.0f, float param3 = 0.0f);
 
+    // Send a continuous jog velocity (also acts as the dead-man heartbeat)
+    void sendJogVelocity(float xDirection, float yDirection, bool rapid);
+
     void sendEvent(const char* event, const char* data);
 
+    // Binarna ramka różnicowa stanu do klientów /ws/status (wywoływane z zadania Control)
+    void broadcastTelemetry(const MachineState& currentState);
+
     void broadcastMachineStatus(MachineState currentState);
 
+    #ifdef BENCHMARK_JSON
+    // Porównanie czasu serializacji stanu maszyny: JsonDocument i JsonWriter (wynik na Serial)
+    void benchmarkStatusSerialization();
+    #endif
+
     bool isBusy();
 };
@@ -1,11 +1,8 @@
 #include <Arduino.h>
 #include <LittleFS.h>
 #include <SPI.h>
-#include <SD.h>
 #include <ESPAsyncWebServer.h>
 #include <AsyncTCP.h>
-#include <AccelStepper.h>
-#include <MultiStepper.h>
 #include <Ticker.h>
 
 #include <vector>
@@ -19,6 +16,14 @@
 #include "SDManager.h"
 #include "WiFiManager.h"
 #include "WebServerManager.h"
+#include "Kinematics.h"
+#include "ConfigValidator.h"
+#include "MaterialProfiles.h"
+#include "StepEngine.h"
+#include "SafetyManager.h"
+#include "RealtimeChannel.h"
+#include "TraceBuffer.h"
+#include "JobCache.h"
 
 /*
 * ------------------------------------------------------------------------------------------------------------
@@ -31,18 +36,40 @@ SDCardManager* sdManager {};
 ConfigManager* configManager {};
 
 // Kolejki FreeRTOS do komunikacji między zadaniami
-QueueHandle_t stateQueue {};   // Przekazywanie stanu maszyny z zadania CNC do Control
 QueueHandle_t commandQueue {}; // Przekazywanie komend z zadania Control do CNC
+QueueHandle_t jogQueue {};     // Skrzynka ruchu ciągłego JOG (WebSocket → CNC)
+
+// Stan maszyny z zadania CNC do Control - migawka bez blokad (seqlock)
+MachineStateSnapshot machineStateSnapshot;
 
 bool systemInitialized { false }; // Synchronizacja inicjalizacji między zadaniami
 
+// Zadanie CNC budzone powiadomieniami CNCEvent (komendy, JOG, generator kroków, wejścia bezpieczeństwa)
+TaskHandle_t cncTaskHandle {};
+
 // Obsługa silników krokowych w przerwaniach
 Ticker stepperTicker;
-MultiStepper multiStepper;
+StepEngine stepEngine;
+
+// Krańcówki i ESTOP w przerwaniach GPIO - zatrzymują generator kroków bez udziału zadań
+SafetyManager safetyManager;
+
+// STOP, wstrzymanie i korekta posuwu z pominięciem commandQueue
+RealtimeChannel realtimeChannel;
+
+// Ślad wykonanej ścieżki - zapisywany przez generator kroków, udostępniany przez /api/trace
+TraceBuffer traceBuffer;
+
+// Kopia pliku zadania w RAM - używana wyłącznie przez zadanie CNC
+JobCache jobCache;
+
+// Konfiguracje efektywne profili materiałów - używane wyłącznie przez zadanie CNC
+MaterialProfileSet materialProfiles;
 
 // Procedura obsługi przerwania timera - wykonuje kroki silników
 void IRAM_ATTR onStepperTimer() {
-    multiStepper.run();
+    stepEngine.tick();
+    safetyManager.poll();
 }
 
 /*
@@ -59,14 +86,23 @@ void updateIO(MachineState& cncState, const MachineConfig& config);
 bool loadConfig(MachineConfig& config);
 
 float getParameter(const String& line, char param);
-bool updateMotorSpeed(const char axis, const bool useRapid, MultiStepper& multiStepper, AccelStepper& stepperX, AccelStepper& stepperY, const MachineConfig& config);
-bool updateMotorSpeed(const char axis, const float feedRate, const float accelMultiplier, MultiStepper& multiStepper, AccelStepper& stepperX, AccelStepper& stepperY, const MachineConfig& config);
-bool initializeGCodeProcessing(MachineState& cncState, GCodeProcessingState& gCodeState, MachineConfig& config);
-void processGCode(MachineState& cncState, GCodeProcessingState& gCodeState, MultiStepper& multiStepper, AccelStepper& stepperX, AccelStepper& stepperY, MachineConfig& config);
-bool processGCodeLine(String line, MultiStepper& multiStepper, AccelStepper& stepperX, AccelStepper& stepperY, MachineState& cncState, GCodeProcessingState& gCodeState, MachineConfig& config);
-bool processLinearMove(const String& line, MultiStepper& multiStepper, AccelStepper& stepperX, AccelStepper& stepperY, MachineState& cncState, GCodeProcessingState& gCodeState, MachineConfig& config, bool isRapid);
-
-void processHoming(MachineState& cncState, HomingState& homingState, MultiStepper& multiStepper, AccelStepper& stepperX, AccelStepper& stepperY, MachineConfig& config);
+uint32_t expectedLineCount(uint32_t analyzedLines, size_t fileSize);
+bool toProfileSlot(float value, uint8_t& slot);
+bool updateMotorSpeed(const char axis, const bool useRapid, StepEngine& stepEngine, const MachineConfig& config);
+bool updateMotorSpeed(const char axis, const float feedRate, StepEngine& stepEngine, const MachineConfig& config);
+bool updateJogVelocity(const JogVelocityCommand& jogCommand, StepEngine& stepEngine, const MachineConfig& config);
+bool adoptConfig(ConfigSnapshotRef& activeConfig, MachineState& cncState, const GCodeProcessingState& gCodeState, StepEngine& stepEngine);
+bool requiresIdleReload(const MachineConfig& active, const MachineConfig& next);
+void applyRuntimeConfig(MachineState& cncState, const GCodeProcessingState& gCodeState, StepEngine& stepEngine, const MachineConfig& config);
+bool initializeGCodeProcessing(MachineState& cncState, GCodeProcessingState& gCodeState, const MachineConfig& config);
+bool closeGCodeFile(GCodeProcessingState& gCodeState);
+void processGCode(MachineState& cncState, GCodeProcessingState& gCodeState, StepEngine& stepEngine, const MachineConfig& config);
+bool processGCodeLine(String line, StepEngine& stepEngine, MachineState& cncState, GCodeProcessingState& gCodeState, const MachineConfig& config);
+bool processLinearMove(const String& line, StepEngine& stepEngine, MachineState& cncState, GCodeProcessingState& gCodeState, const MachineConfig& config, bool isRapid);
+bool queueProgramMove(const long positions[AXIS_COUNT], StepEngine& stepEngine, GCodeProcessingState& gCodeState);
+bool deferUntilIdle(const StepEngine& stepEngine, GCodeProcessingState& gCodeState);
+
+void processHoming(MachineState& cncState, HomingState& homingState, StepEngine& stepEngine, const MachineConfig& config);
 
 void taskCNC(void* parameter);
 void taskControl(void* parameter);
@@ -93,10 +129,7 @@ void setup() {
 
     // ============================================================================
     // KONFIGURACJA PINÓW WEJŚĆ/WYJŚĆ
-    pinMode(PINCONFIG::LIMIT_X_PIN, INPUT_PULLUP);
-    pinMode(PINCONFIG::LIMIT_Y_PIN, INPUT_PULLUP);
-    pinMode(PINCONFIG::ESTOP_PIN, INPUT_PULLUP);
-
+    // Wejścia krańcówek i ESTOP konfiguruje SafetyManager razem z przerwaniami
     pinMode(PINCONFIG::WIRE_RELAY_PIN, OUTPUT);
     digitalWrite(PINCONFIG::WIRE_RELAY_PIN, LOW);
 
@@ -118,17 +151,31 @@ void setup() {
     configManager = new ConfigManager(sdManager);
 
     // Utworzenie kolejek FreeRTOS do komunikacji między zadaniami
-    stateQueue = xQueueCreate(1, sizeof(MachineState));
     commandQueue = xQueueCreate(5, sizeof(WebserverCommand));
+    jogQueue = xQueueCreate(1, sizeof(JogVelocityCommand));
 
-    if (!stateQueue) {
-        Serial.println("SYSTEM ERROR: stateQueue not created!");
-    }
     if (!commandQueue) {
         Serial.println("SYSTEM ERROR: commandQueue not created!");
     }
+    if (!jogQueue) {
+        Serial.println("SYSTEM ERROR: jogQueue not created!");
+    }
 
     // Utworzenie zadań FreeRTOS na odpowiednich rdzeniach procesora
+    // Zadanie CNC powstaje pierwsze - jego uchwyt przekazywany jest do serwera WWW
+    // (zadanie czeka na systemInitialized, więc kolejność nie zmienia inicjalizacji)
+    Serial.println("Creating CNC task...");
+    xTaskCreatePinnedToCore(taskCNC,        
+        "CNC",                              
+        CONFIG::CNCTASK_STACK_SIZE,         
+        NULL,                               
+        CONFIG::CNCTASK_PRIORITY,           
+        &cncTaskHandle,                     
+        CONFIG::CORE_1                      
+    );
+
+    delay(200); // Oczekiwanie na stabilizację pierwszego zadania
+
     Serial.println("Creating Control task...");
     xTaskCreatePinnedToCore(taskControl,    
         "Control",                          
@@ -139,18 +186,6 @@ void setup() {
         CONFIG::CORE_0                      
     );
 
-    delay(200); // Oczekiwanie na stabilizację pierwszego zadania
-
-    Serial.println("Creating CNC task...");
-    xTaskCreatePinnedToCore(taskCNC,        
-        "CNC",                              
-        CONFIG::CNCTASK_STACK_SIZE,         
-        NULL,                               
-        CONFIG::CNCTASK_PRIORITY,           
-        NULL,                               
-        CONFIG::CORE_1                      
-    );
-
     delay(200); // Oczekiwanie na stabilizację drugiego zadania
 }
 
@@ -179,20 +214,19 @@ void taskCNC(void* parameter) {
     // Bufor na komendy odbierane z interfejsu web
     WebserverCommand commandData {};
     bool commandPending { false };
+    JogVelocityCommand jogCommand {};
 
     // Zarządzanie czasem wykonywania operacji w zadaniu
-    TickType_t lastCommandProcessTime { 0 };
-    TickType_t lastStatusUpdateTime { 0 };
-    const TickType_t commandProcessInterval { pdMS_TO_TICKS(500) };
-    const TickType_t statusUpdateInterval { pdMS_TO_TICKS(100) };
-
-    // Inicjalizacja obiektów stepper motor
-    AccelStepper stepperX(AccelStepper::DRIVER, PINCONFIG::STEP_X_PIN, PINCONFIG::DIR_X_PIN);
-    AccelStepper stepperY(AccelStepper::DRIVER, PINCONFIG::STEP_Y_PIN, PINCONFIG::DIR_Y_PIN);
+    const TickType_t wakeTimeout { pdMS_TO_TICKS(CONFIG::CNCTASK_WAKE_TIMEOUT_MS) };
+    uint32_t busyCycles { 0 }; // Kolejne cykle bez oczekiwania na zdarzenie
 
-    // Rejestracja silników w globalnym koordynatorze ruchu
-    multiStepper.addStepper(stepperX);
-    multiStepper.addStepper(stepperY);
+    // Inicjalizacja generatora kroków (piny STEP/DIR, wyzerowanie pozycji)
+    // Zadanie jest budzone po opróżnieniu kolejki ruchu do progu i po przejściu w spoczynek
+    stepEngine.init();
+    stepEngine.setNotifyTask(xTaskGetCurrentTaskHandle());
+    stepEngine.setTraceBuffer(&traceBuffer);
+    safetyManager.setNotifyTask(xTaskGetCurrentTaskHandle());
+    realtimeChannel.init(&stepEngine, xTaskGetCurrentTaskHandle());
 
     // Oczekiwanie na zakończenie inicjalizacji systemu przez zadanie Control
     while (!systemInitialized) {
@@ -202,28 +236,40 @@ void taskCNC(void* parameter) {
         vTaskDelay(pdMS_TO_TICKS(1000));
     }
 
-    // Wczytanie parametrów konfiguracyjnych maszyny z karty SD
-    MachineConfig config {};
-    ConfigManagerStatus configStatus {};
-    do {
+    // Bieżąca wersja konfiguracji - odwołanie bez kopiowania, kolejne wersje przejmowane przez adoptConfig()
+    ConfigSnapshotRef activeConfig {};
+    while (!activeConfig) {
         #ifdef DEBUG_CNC_TASK
         Serial.println("DEBUG CNC: Próba wczytania konfiguracji...");
         #endif
         if (configManager != nullptr) {
-            configStatus = configManager->getConfig(config);
+            activeConfig = configManager->snapshot();
         }
         else {
             #ifdef DEBUG_CNC_TASK
             Serial.println("ERROR CNC: Nie wczytano managera konfiguracji.");
             #endif
-            configStatus = ConfigManagerStatus::MANAGER_NOT_INITIALIZED;
+        }
+        if (!activeConfig) {
             vTaskDelay(pdMS_TO_TICKS(1000));
         }
-    } while (configStatus != ConfigManagerStatus::OK);
+    }
 
-    // Wyzerowanie pozycji silników przy starcie systemu
-    stepperX.setCurrentPosition(0);
-    stepperY.setCurrentPosition(0);
+    // Konfiguracje efektywne profili materiałów przeliczane przed pierwszym zadaniem
+    MaterialProfileTable profileTable {};
+    configManager->getProfiles(profileTable);
+    materialProfiles.setProfiles(profileTable);
+    materialProfiles.rebuild(*activeConfig);
+
+    // Przekazanie skalowania osi i filtrów kształtujących do generatora kroków
+    if (stepEngine.configure(*activeConfig) != StepEngineStatus::OK) {
+        #ifdef DEBUG_CNC_TASK
+        Serial.println("ERROR CNC: Nieprawidłowe skalowanie osi w konfiguracji.");
+        #endif
+    }
+
+    // Rejestracja przerwań krańcówek i ESTOP (aktywne poziomy zależne od konfiguracji)
+    safetyManager.init(&stepEngine, *activeConfig);
 
     // Uruchomienie timera generującego impulsy krokowe w przerwaniach
     float timerIntervalSeconds = CONFIG::STEPPER_TIMER_FREQUENCY_US / 1000000.0f;
@@ -235,74 +281,69 @@ void taskCNC(void* parameter) {
     #endif
 
     while (true) {
-        TickType_t currentTime { xTaskGetTickCount() };
+        // Stan na początku cyklu - zmiana etapu oznacza pracę do wykonania bez czekania
+        const CNCState previousState { cncState.state };
+        const GCodeProcessingState::ProcessingStage previousGCodeStage { gCodeState.stage };
+        const HomingState::HomingStage previousHomingStage { homingState.stage };
+
+        // Nowa wersja konfiguracji lub profili przejmowana na początku cyklu - granica odcinków ruchu:
+        // odcinki w kolejce zachowują parametry z planowania, kolejne planowane są wg nowej wersji
+        if (configManager->configVersion() != activeConfig.version()
+            || configManager->profilesVersion() != materialProfiles.profilesVersion()) {
+            adoptConfig(activeConfig, cncState, gCodeState, stepEngine);
+        }
 
-        // UWAGA: multiStepper.run() wykonywane jest w przerwaniu timera!
-        // Przy zatrzymaniu maszyny należy wyczyścić cele ruchu silników
+        // Konfiguracja bazowa z nałożonym profilem materiału (M700 zmienia ją w trakcie programu)
+        const MachineConfig& config { materialProfiles.config() };
+        cncState.activeProfile = materialProfiles.slot();
+
+        // UWAGA: stepEngine.tick() wykonywane jest w przerwaniu timera!
+        // Przy zatrzymaniu maszyny należy wyczyścić kolejkę ruchu
         if (cncState.state == CNCState::STOPPED || cncState.state == CNCState::ERROR) {
-            stepperX.stop();
-            stepperY.stop();
-            stepperX.setCurrentPosition(stepperX.currentPosition());
-            stepperY.setCurrentPosition(stepperY.currentPosition());
+            stepEngine.abort();
         }
 
-        // Odbieranie komend z interfejsu web (z ograniczeniem częstotliwości)
-        if ((currentTime - lastCommandProcessTime) >= commandProcessInterval) {
-            if (xQueueReceive(commandQueue, &commandData, 0) == pdTRUE) {
-                #ifdef DEBUG_CNC_TASK
-                Serial.printf("DEBUG CNC: Otrzymano komendę typu %d\n", static_cast<int>(commandData.type));
-                #endif
-                commandPending = true;
-            }
-            lastCommandProcessTime = currentTime;
+        // Odbieranie komend z interfejsu web - zadanie budzone jest zdarzeniem CNCEvent::COMMAND
+        if (xQueueReceive(commandQueue, &commandData, 0) == pdTRUE) {
+            #ifdef DEBUG_CNC_TASK
+            Serial.printf("DEBUG CNC: Otrzymano komendę typu %d\n", static_cast<int>(commandData.type));
+            #endif
+            commandPending = true;
         }
 
-        // Wysyłanie aktualnego stanu maszyny do interfejsu web
-        if ((currentTime - lastStatusUpdateTime) >= statusUpdateInterval) {
-            if (xQueueOverwrite(stateQueue, &cncState) != pdPASS) {
-                #ifdef DEBUG_CNC_TASK
-                Serial.println("DEBUG CNC: Nie można wysłać statusu maszyny.");
-                #endif
+        // Żądania kanału czasu rzeczywistego - skutek w generatorze kroków już wystąpił,
+        // tutaj porządkowana jest maszyna stanów
+        const uint32_t realtimeRequests { realtimeChannel.consume() };
+
+        // Ruch ciągły JOG - skrzynka odczytywana po zdarzeniu CNCEvent::JOG (niskie opóźnienie)
+        // Dozwolony tylko w spoczynku lub podczas ręcznego sterowania
+        if (xQueueReceive(jogQueue, &jogCommand, 0) == pdTRUE) {
+            if (cncState.state == CNCState::IDLE || cncState.state == CNCState::JOG) {
+                if (updateJogVelocity(jogCommand, stepEngine, config) && stepEngine.isJogging()) {
+                    cncState.state = CNCState::JOG;
+                }
             }
-            lastStatusUpdateTime = currentTime;
         }
 
-        // Obsługa komendy przeładowania konfiguracji
+        // Komenda przeładowania konfiguracji - nowe wersje przejmowane są automatycznie na początku cyklu
         if (commandPending && commandData.type == CommandType::RELOAD_CONFIG) {
-            ConfigManagerStatus reloadStatus = configManager->getConfig(config);
-            if (reloadStatus == ConfigManagerStatus::OK) {
-                #ifdef DEBUG_CNC_TASK
-                Serial.println("DEBUG CNC: Konfiguracja przeładowana pomyślnie.");
-                #endif
-            }
-            else {
-                #ifdef DEBUG_CNC_TASK
-                Serial.println("DEBUG CNC: Błąd podczas przeładowania konfiguracji.");
-                #endif
-            }
             commandPending = false;
         }
 
         // Obsługa awaryjnego zatrzymania - ma priorytet nad wszystkimi innymi operacjami
-        if (commandPending && commandData.type == CommandType::STOP) {
+        // STOP z kanału czasu rzeczywistego nie czeka za komendami w commandQueue
+        const bool stopCommand { commandPending && commandData.type == CommandType::STOP };
+        if (stopCommand || (realtimeRequests & RealtimeRequest::STOP)) {
             // Natychmiastowe wyłączenie wszystkich urządzeń
             cncState.hotWireOn = false;
             cncState.fanOn = false;
 
             // Zatrzymanie ruchu i wyczyszczenie celów
-            stepperX.stop();
-            stepperY.stop();
-            stepperX.setCurrentPosition(stepperX.currentPosition());
-            stepperY.setCurrentPosition(stepperY.currentPosition());
+            stepEngine.abort();
+            realtimeChannel.setFeedHold(false);
 
             // Zamknięcie plików G-code przy awaryjnym zatrzymaniu
-            if (gCodeState.fileOpen && gCodeState.currentFile) {
-                if (sdManager->takeSD()) {
-                    gCodeState.currentFile.close();
-                    gCodeState.fileOpen = false;
-                    sdManager->giveSD();
-                }
-            }
+            closeGCodeFile(gCodeState);
 
             // Resetowanie stanu przetwarzania G-code
             gCodeState.stopRequested = true;
@@ -325,8 +366,17 @@ void taskCNC(void* parameter) {
                 #endif
             }
 
-            commandPending = false;
+            if (stopCommand) {
+                commandPending = false;
+            }
+        }
+
+        // Wstrzymanie posuwu dotyczy wyłącznie wykonywania programu
+        if (cncState.state != CNCState::RUNNING && realtimeChannel.isFeedHold()) {
+            realtimeChannel.setFeedHold(false);
         }
+        cncState.isPaused = realtimeChannel.isFeedHold();
+        cncState.feedOverride = realtimeChannel.getFeedOverride();
 
         // Obsługa komend sterowania urządzeniami wykonawczymi
         if (commandPending && commandData.type == CommandType::SET_HOTWIRE) {
@@ -356,20 +406,41 @@ void taskCNC(void* parameter) {
                 if (commandPending) {
                     commandPending = false;
                     switch (commandData.type) {
-                        case CommandType::START:
+                        case CommandType::START: {
+                            // Zatrzaśnięty ESTOP lub krańcówka blokuje start do stabilnego zwolnienia wejścia
+                            if (safetyManager.isInterlocked()) {
+                                #ifdef DEBUG_CNC_TASK
+                                Serial.println("DEBUG CNC ERROR: Start zablokowany - aktywne wejście bezpieczeństwa");
+                                #endif
+                                break;
+                            }
+
+                            // Profil materiału wybrany dla zadania (0 = konfiguracja bazowa), plik może go zmienić komendą M700
+                            uint8_t profileSlot { 0 };
+                            if (!toProfileSlot(commandData.param1, profileSlot) || !materialProfiles.select(profileSlot)) {
+                                #ifdef DEBUG_CNC_TASK
+                                Serial.printf("DEBUG CNC ERROR: Profil materiału %.1f niedostępny\n", commandData.param1);
+                                #endif
+                                break;
+                            }
+                            cncState.activeProfile = materialProfiles.slot();
+
                             // Inicjalizacja i rozpoczęcie wykonania programu G-code
-                            if (initializeGCodeProcessing(cncState, gCodeState, config)) {
+                            // Tryb równoległy (plik tylko XY przy włączonej kinematyce) wybierany dla zadania
+                            if (initializeGCodeProcessing(cncState, gCodeState, materialProfiles.config())) {
+                                gCodeState.parallelFaces = commandData.param2 > 0.5f;
                                 cncState.state = CNCState::RUNNING;
                             }
                             break;
+                        }
 
                         case CommandType::HOME:
                             // Rozpoczęcie sekwencji bazowania maszyny
                             cncState.state = CNCState::HOMING;
-                            homingState.stage = HomingState::HomingStage::HOMING_X;
+                            homingState.stage = HomingState::HomingStage::SEEK;
                             homingState.movementInProgress = false;
-                            homingState.limitReached = false;
-                            homingState.backoffComplete = false;
+                            homingState.axisLatched[AXIS_X] = false;
+                            homingState.axisLatched[AXIS_Y] = false;
                             homingState.errorMessage = "";
                             #ifdef DEBUG_CNC_TASK
                             Serial.println("DEBUG HOME: Rozpoczęcie procedury bazowania");
@@ -387,15 +458,20 @@ void taskCNC(void* parameter) {
                                 xOffset, yOffset, speedMode);
                             #endif
 
+                            // Zatrzaśnięty ESTOP lub krańcówka blokuje ruch ręczny (wyjście z krańcówki przez bazowanie)
+                            if (safetyManager.isInterlocked()) {
+                                #ifdef DEBUG_CNC_TASK
+                                Serial.println("DEBUG JOG: Ruch zablokowany - aktywne wejście bezpieczeństwa");
+                                #endif
+                                break;
+                            }
+
                             // Sprawdzenie czy ruch jest możliwy (nie zero)
                             if (abs(xOffset) > 0.001f || abs(yOffset) > 0.001f) {
-                                // Przejście do stanu JOG i zaplanowanie ruchu
-                                cncState.state = CNCState::JOG;
-
                                 // Wybór profilu prędkości na podstawie trybu
                                 bool useRapid = (speedMode > 0.5f);
-                                updateMotorSpeed('X', useRapid, multiStepper, stepperX, stepperY, config);
-                                updateMotorSpeed('Y', useRapid, multiStepper, stepperX, stepperY, config);
+                                updateMotorSpeed('X', useRapid, stepEngine, config);
+                                updateMotorSpeed('Y', useRapid, stepEngine, config);
 
                                 // Konwersja przesunięć z mm na kroki
                                 long stepsX = static_cast<long>(xOffset * config.X.stepsPerMM);
@@ -403,10 +479,20 @@ void taskCNC(void* parameter) {
 
                                 // Przygotowanie synchronizowanego ruchu obu osi
                                 long positions[2];
-                                positions[0] = stepperX.currentPosition() + stepsX;
-                                positions[1] = stepperY.currentPosition() + stepsY;
-
-                                multiStepper.moveTo(positions);
+                                positions[0] = stepEngine.getPlannedPosition(AXIS_X) + stepsX;
+                                positions[1] = stepEngine.getPlannedPosition(AXIS_Y) + stepsY;
+
+                                // Odrzucony ruch nie zmienia stanu ani pozycji logicznej
+                                const StepEngineStatus status { stepEngine.queueMove(positions) };
+                                if (status != StepEngineStatus::OK) {
+                                    #ifdef DEBUG_CNC_TASK
+                                    Serial.printf("DEBUG JOG: Ruch odrzucony przez generator (status %d)\n", static_cast<int>(status));
+                                    #endif
+                                    break;
+                                }
+
+                                // Przejście do stanu JOG po zaplanowaniu ruchu
+                                cncState.state = CNCState::JOG;
 
                                 // Aktualizacja logicznej pozycji w układzie współrzędnych
                                 cncState.currentX += xOffset;
@@ -422,8 +508,8 @@ void taskCNC(void* parameter) {
 
                         case CommandType::ZERO:
                             // Ustawienie aktualnej pozycji jako punkt zerowy
-                            stepperX.setCurrentPosition(0);
-                            stepperY.setCurrentPosition(0);
+                            stepEngine.setPosition(AXIS_X, 0);
+                            stepEngine.setPosition(AXIS_Y, 0);
                             cncState.currentX = 0.0f;
                             cncState.currentY = 0.0f;
                             #ifdef DEBUG_CNC_TASK
@@ -439,15 +525,16 @@ void taskCNC(void* parameter) {
 
             case CNCState::RUNNING:
                 // Aktualizacja pozycji na podstawie rzeczywistego położenia silników
-                cncState.currentX = stepperX.currentPosition() / config.X.stepsPerMM;
-                cncState.currentY = stepperY.currentPosition() / config.Y.stepsPerMM;
+                cncState.currentX = stepEngine.getPosition(AXIS_X) / config.X.stepsPerMM;
+                cncState.currentY = stepEngine.getPosition(AXIS_Y) / config.Y.stepsPerMM;
                 
                 // Obsługa komend podczas wykonywania programu
                 if (commandPending) {
                     commandPending = false;
                     switch (commandData.type) {
                         case CommandType::PAUSE:
-                            cncState.isPaused = !cncState.isPaused;
+                            // Wstrzymanie posuwu przez kanał czasu rzeczywistego (hamowanie na torze)
+                            realtimeChannel.toggleFeedHold();
                             break;
                             // CommandType::STOP obsługiwane jest globalnie
                         default:
@@ -456,21 +543,20 @@ void taskCNC(void* parameter) {
                 }
 
                 if (!cncState.isPaused) {
-                    processGCode(cncState, gCodeState, multiStepper, stepperX, stepperY, config);
+                    processGCode(cncState, gCodeState, stepEngine, config);
 
-                    // Kalkulacja postępu wykonania zadania
-                    cncState.currentLine = gCodeState.lineNumber;
+                    // Kalkulacja postępu wykonania zadania - linia wykonywanego odcinka, nie odczytu z wyprzedzeniem;
+                    // bez odcinka programu w kolejce wszystkie linie do odczytanej są wykonane
+                    const uint32_t executingLine { stepEngine.getExecutingLine() };
+                    cncState.currentLine = executingLine > 0 ? executingLine : gCodeState.lineNumber;
                     cncState.jobProgress = gCodeState.totalLines > 0
-                        ? (100.0f * gCodeState.lineNumber / gCodeState.totalLines)
+                        ? (100.0f * cncState.currentLine / gCodeState.totalLines)
                         : 0.0f;
                     cncState.jobRunTime = millis() - cncState.jobStartTime;
 
-                    // Sprawdzenie zakończenia wykonania programu
-                    if (gCodeState.stage == GCodeProcessingState::ProcessingStage::FINISHED) {
-                        if (gCodeState.fileOpen && gCodeState.currentFile) {
-                            gCodeState.currentFile.close();
-                            gCodeState.fileOpen = false;
-                        }
+                    // Sprawdzenie zakończenia wykonania programu (po ruchu powrotnym i wyłączeniu drutu)
+                    if (gCodeState.stage == GCodeProcessingState::ProcessingStage::COMPLETED) {
+                        closeGCodeFile(gCodeState);
                         cncState.state = CNCState::IDLE;
                         #ifdef DEBUG_CNC_TASK
                         Serial.println("DEBUG CNC: Przetwarzanie pliku zakończone");
@@ -484,20 +570,17 @@ void taskCNC(void* parameter) {
                         #endif
                     }
                 }
-                else {
-                    vTaskDelay(pdMS_TO_TICKS(100));
-                }
 
                 break;
 
             case CNCState::JOG:
                 // Stan ruchu ręcznego - sprawdzanie zakończenia ruchu
                 // Aktualizacja pozycji na podstawie rzeczywistego położenia silników
-                cncState.currentX = stepperX.currentPosition() / config.X.stepsPerMM;
-                cncState.currentY = stepperY.currentPosition() / config.Y.stepsPerMM;
+                cncState.currentX = stepEngine.getPosition(AXIS_X) / config.X.stepsPerMM;
+                cncState.currentY = stepEngine.getPosition(AXIS_Y) / config.Y.stepsPerMM;
 
                 // Sprawdzenie czy ruch się zakończył
-                if (stepperX.distanceToGo() == 0 && stepperY.distanceToGo() == 0) {
+                if (stepEngine.isIdle()) {
                     cncState.state = CNCState::IDLE;
                     #ifdef DEBUG_CNC_TASK
                     Serial.printf("DEBUG JOG: Ruch zakończony, powrót do IDLE. Pozycja: X=%.2f, Y=%.2f\n",
@@ -517,12 +600,12 @@ void taskCNC(void* parameter) {
                     Serial.printf("DEBUG JOG: Dodatkowy ruch podczas JOG: X=%.2f, Y=%.2f\n", xOffset, yOffset);
                     #endif
 
-                    // Sprawdzenie czy nowy ruch jest możliwy
-                    if (abs(xOffset) > 0.001f || abs(yOffset) > 0.001f) {
+                    // Sprawdzenie czy nowy ruch jest możliwy i nie jest zablokowany przez wejście bezpieczeństwa
+                    if ((abs(xOffset) > 0.001f || abs(yOffset) > 0.001f) && !safetyManager.isInterlocked()) {
                         // Wybór profilu prędkości
                         bool useRapid = (speedMode > 0.5f);
-                        updateMotorSpeed('X', useRapid, multiStepper, stepperX, stepperY, config);
-                        updateMotorSpeed('Y', useRapid, multiStepper, stepperX, stepperY, config);
+                        updateMotorSpeed('X', useRapid, stepEngine, config);
+                        updateMotorSpeed('Y', useRapid, stepEngine, config);
 
                         // Konwersja przesunięć z mm na kroki
                         long stepsX = static_cast<long>(xOffset * config.X.stepsPerMM);
@@ -530,21 +613,27 @@ void taskCNC(void* parameter) {
 
                         // Dodanie do aktualnej pozycji docelowej
                         long positions[2];
-                        positions[0] = stepperX.currentPosition() + stepsX;
-                        positions[1] = stepperY.currentPosition() + stepsY;
-
-                        multiStepper.moveTo(positions);
-
-                        // Aktualizacja logicznej pozycji
-                        cncState.currentX += xOffset;
-                        cncState.currentY += yOffset;
+                        positions[0] = stepEngine.getPlannedPosition(AXIS_X) + stepsX;
+                        positions[1] = stepEngine.getPlannedPosition(AXIS_Y) + stepsY;
+
+                        // Odrzucony ruch (np. pełna kolejka) nie zmienia pozycji logicznej
+                        const StepEngineStatus status { stepEngine.queueMove(positions) };
+                        if (status == StepEngineStatus::OK) {
+                            cncState.currentX += xOffset;
+                            cncState.currentY += yOffset;
+                        }
+                        #ifdef DEBUG_CNC_TASK
+                        else {
+                            Serial.printf("DEBUG JOG: Ruch odrzucony przez generator (status %d)\n", static_cast<int>(status));
+                        }
+                        #endif
                     }
                 }
                 break;
 
             case CNCState::HOMING:
                 // Wykonanie procedury bazowania maszyny
-                processHoming(cncState, homingState, multiStepper, stepperX, stepperY, config);
+                processHoming(cncState, homingState, stepEngine, config);
 
                 // Sprawdzenie zakończenia sekwencji bazowania
                 if (homingState.stage == HomingState::HomingStage::FINISHED) {
@@ -566,17 +655,57 @@ void taskCNC(void* parameter) {
             case CNCState::ERROR:
                 // Wyłączenie wszystkich urządzeń i zatrzymanie ruchu w stanach błędu
                 cncState.hotWireOn = false;
-                stepperX.stop();
-                stepperY.stop();
-                stepperX.setCurrentPosition(stepperX.currentPosition());
-                stepperY.setCurrentPosition(stepperY.currentPosition());
+                stepEngine.abort();
 
                 break;
         }
 
         // Aktualizacja fizycznych wyjść na podstawie stanu maszyny
         updateIO(cncState, config);
-        vTaskDelay(pdMS_TO_TICKS(1));
+
+        // Podczas bazowania krańcówka zatrzymuje tylko swoją oś
+        safetyManager.setHomingMode(cncState.state == CNCState::HOMING);
+
+        // Skutki zadziałania krańcówki lub ESTOP - kroki zatrzymało już przerwanie,
+        // tutaj porządkowany jest stan generatora i maszyny stanów
+        // (zadziałania podczas bazowania obsługuje processHoming)
+        // Zatrzaśnięte wejście blokuje w generatorze kolejne ruchy do stabilnego zwolnienia
+        if (safetyManager.consumeTrip() && cncState.state != CNCState::HOMING) {
+            stepEngine.abort();
+            if (cncState.state == CNCState::JOG) {
+                cncState.state = CNCState::IDLE;
+            }
+            #ifdef DEBUG_CNC_TASK
+            Serial.printf("DEBUG SAFETY: Zadziałanie wejścia (ESTOP=%d, X=%d, Y=%d)\n",
+                cncState.estopOn, cncState.limitXOn, cncState.limitYOn);
+            #endif
+        }
+
+        // Publikacja stanu w każdym cyklu - migawka nie blokuje zadania i nie czeka na czytelników
+        machineStateSnapshot.publish(cncState);
+
+        // Praca możliwa do wykonania od razu: oczekujące komendy, przejście etapu,
+        // uzupełnianie kolejki ruchu z pliku. Pozostałe etapy czekają na zdarzenia CNCEvent.
+        const bool workPending {
+            uxQueueMessagesWaiting(commandQueue) > 0
+            || cncState.state != previousState
+            || gCodeState.stage != previousGCodeStage
+            || homingState.stage != previousHomingStage
+            || (cncState.state == CNCState::RUNNING && !cncState.isPaused
+                && gCodeState.stage == GCodeProcessingState::ProcessingStage::READING_FILE
+                && !stepEngine.isQueueFull())
+        };
+
+        if (!workPending) {
+            // Uśpienie do zdarzenia lub okresowego wybudzenia (status, nagrzewanie, podtrzymanie JOG)
+            busyCycles = 0;
+            xTaskNotifyWait(0, UINT32_MAX, nullptr, wakeTimeout);
+        }
+        else if (++busyCycles >= CONFIG::CNCTASK_MAX_BUSY_CYCLES) {
+            // Ciągła praca (np. plik bez ruchów) - oddanie procesora dla watchdoga i zadania IDLE
+            busyCycles = 0;
+            vTaskDelay(1);
+        }
     }
 }
 
@@ -587,7 +716,7 @@ void taskControl(void* parameter) {
     // Tworzenie instancji menadżerów dla zadania Control
     FSManager* fsManager = new FSManager();
     WiFiManager* wifiManager = new WiFiManager();
-    WebServerManager* webServerManager = new WebServerManager(sdManager, configManager, commandQueue, stateQueue);
+    WebServerManager* webServerManager = new WebServerManager(sdManager, configManager, commandQueue, &machineStateSnapshot, jogQueue, cncTaskHandle, &realtimeChannel, &traceBuffer);
 
     // Inicjalizacja wszystkich podsystemów
     bool managersInitialized { initializeManagers(fsManager, sdManager, wifiManager, webServerManager, configManager) };
@@ -597,12 +726,20 @@ void taskControl(void* parameter) {
     // Sygnalizacja zakończenia inicjalizacji do innych zadań
     systemInitialized = managersInitialized && connectedToWifi && startedWebServer;
 
+    #ifdef BENCHMARK_JSON
+    webServerManager->benchmarkStatusSerialization();
+    #endif
+
     // Zmienne robocze zadania Control
     MachineState receivedState {};
+    uint32_t lastStateSequence { 0 };
+    MachineState telemetryState {};
     TickType_t lastStatusUpdateTime { 0 };
+    TickType_t lastTelemetryTime { 0 };
     TickType_t lastDebugTime { 0 };
     TickType_t lastWiFiCheckTime { 0 };
-    const TickType_t statusUpdateInterval { pdMS_TO_TICKS(500) };
+    const TickType_t statusUpdateInterval { pdMS_TO_TICKS(100) };
+    const TickType_t telemetryInterval { pdMS_TO_TICKS(CONFIG::TELEMETRY_INTERVAL_MS) };
     const TickType_t debugUpdateInterval { pdMS_TO_TICKS(1000) };
     const TickType_t wifiCheckInterval { pdMS_TO_TICKS(20000) };
 
@@ -656,11 +793,23 @@ void taskControl(void* parameter) {
             lastWiFiCheckTime = currentTime;
         }
 
+        // TELEMETRIA BINARNA - ramki różnicowe WebSocket z migawki stanu (bez udziału rdzenia CNC)
+        if ((currentTime - lastTelemetryTime) >= telemetryInterval) {
+            if (WiFi.status() == WL_CONNECTED && !wifiReconnectInProgress && machineStateSnapshot.read(telemetryState)) {
+                webServerManager->broadcastTelemetry(telemetryState);
+            }
+            lastTelemetryTime = currentTime;
+        }
+
         // AKTUALIZACJA STATUSU MASZYNY (tylko jeśli WiFi działa)
         if ((currentTime - lastStatusUpdateTime) >= statusUpdateInterval) {
             if (!webServerManager->isBusy() && WiFi.status() == WL_CONNECTED && !wifiReconnectInProgress) {
-                if (xQueuePeek(stateQueue, &receivedState, 0) == pdTRUE)
+                // Spójna kopia stanu bez blokowania zadania CNC; pominięcie gdy brak nowej publikacji
+                const uint32_t stateSequence { machineStateSnapshot.getSequence() };
+                if (stateSequence != lastStateSequence && machineStateSnapshot.read(receivedState)) {
+                    lastStateSequence = stateSequence;
                     webServerManager->broadcastMachineStatus(receivedState);
+                }
                 // #ifdef DEBUG_CONTROL_TASK
                 // Serial.printf("DEBUG CONTROL: Wysłano status maszyny: X=%.2f, Y=%.2f, State=%d\n",
                 //     receivedState.currentX, receivedState.currentY, static_cast<int>(receivedState.state));
@@ -716,12 +865,12 @@ bool initializeManagers(FSManager* fsManager, SDCardManager* sdManager, WiFiMana
         #ifdef DEBUG_CONTROL_TASK
         Serial.printf("SYSTEM STATUS: Próba inicjalizacji SDCardManager...\n");
         #endif
+        // Brak karty nie blokuje startu - konfiguracja w NVS, kartę można zainicjalizować później
         SDManagerStatus sdManagerStatus { sdManager->init() };
         if (sdManagerStatus != SDManagerStatus::OK) {
             #ifdef DEBUG_CONTROL_TASK
-            Serial.printf("SYSTEM ERROR: Nie można zainicjalizować SDCardManager: %d\n", static_cast<int>(sdManagerStatus));
+            Serial.printf("SYSTEM WARNING: Nie można zainicjalizować SDCardManager: %d\n", static_cast<int>(sdManagerStatus));
             #endif
-            return false;
         }
     }
     else {
@@ -742,6 +891,18 @@ bool initializeManagers(FSManager* fsManager, SDCardManager* sdManager, WiFiMana
             #endif
             return false;
         }
+
+        // Zegar SPI karty z konfiguracji (import konfiguracji z karty odbywa się przy zegarze domyślnym)
+        const ConfigSnapshotRef storedConfig { configManager->snapshot() };
+        if (storedConfig) {
+            const SDManagerStatus spiStatus { sdManager->applySpiFrequency(storedConfig->sdSpiFrequency) };
+            if (spiStatus != SDManagerStatus::OK) {
+                #ifdef DEBUG_CONTROL_TASK
+                Serial.printf("SYSTEM WARNING: Zegar SPI karty SD %lu Hz odrzucony: %d\n",
+                    static_cast<unsigned long>(storedConfig->sdSpiFrequency), static_cast<int>(spiStatus));
+                #endif
+            }
+        }
     }
     else {
         #ifdef DEBUG_CONTROL_TASK
@@ -837,31 +998,12 @@ void updateIO(MachineState& CNCState, const MachineConfig& config) {
     ledcWrite(PINCONFIG::WIRE_PWM_CHANNEL, CNCState.hotWirePower);
     ledcWrite(PINCONFIG::FAN_PWM_CHANNEL, CNCState.fanPower);
 
-    // Odczyt stanu krańcówek (z możliwością programowego wyłączenia)
-    if (config.deactivateLimitSwitches) {
-        CNCState.limitXOn = false;
-        CNCState.limitYOn = false;
-    }
-    else {
-        // Interpretacja stanu w zależności od typu krańcówki (NO/NC)
-        if (config.limitSwitchType == 0) { 
-            // NO (Normally Open) - krańcówka aktywna gdy pin HIGH
-            CNCState.limitXOn = digitalRead(PINCONFIG::LIMIT_X_PIN) == HIGH;
-            CNCState.limitYOn = digitalRead(PINCONFIG::LIMIT_Y_PIN) == HIGH;
-        } else { 
-            // NC (Normally Closed) - krańcówka aktywna gdy pin LOW
-            CNCState.limitXOn = digitalRead(PINCONFIG::LIMIT_X_PIN) == LOW;
-            CNCState.limitYOn = digitalRead(PINCONFIG::LIMIT_Y_PIN) == LOW;
-        }
-    }
-
-    // Odczyt przycisku ESTOP (z możliwością programowego wyłączenia)
-    if (config.deactivateESTOP) {
-        CNCState.estopOn = false;
-    }
-    else {
-        CNCState.estopOn = digitalRead(PINCONFIG::ESTOP_PIN);
-    }
+    // Stan krańcówek i ESTOP zatrzaśnięty w przerwaniach GPIO
+    // Typ styku (NO/NC) i programowe wyłączenie wejść obsługuje SafetyManager
+    safetyManager.update();
+    CNCState.limitXOn = safetyManager.isTripped(SafetyInput::LIMIT_X);
+    CNCState.limitYOn = safetyManager.isTripped(SafetyInput::LIMIT_Y);
+    CNCState.estopOn = safetyManager.isTripped(SafetyInput::ESTOP);
 
 }
 
@@ -873,12 +1015,12 @@ void updateIO(MachineState& CNCState, const MachineConfig& config) {
  * @param axis 'X' lub 'Y'
  * @param useRapid true = szybkie pozycjonowanie (G0), false = praca (G1)
  */
-bool updateMotorSpeed(const char axis, const bool useRapid, MultiStepper& multiStepper, AccelStepper& stepperX, AccelStepper& stepperY, const MachineConfig& config) {
+bool updateMotorSpeed(const char axis, const bool useRapid, StepEngine& stepEngine, const MachineConfig& config) {
 
     float stepsPerMM {};
-    float feedRate {};      // mm/s
-    float acceleration {};  // mm/s²
-    AccelStepper* stepper = nullptr;
+    float feedRate {};      // steps/s
+    float acceleration {};  // steps/s²
+    uint8_t axisIndex {};
 
     // Wybór parametrów dla konkretnej osi
     switch (axis) {
@@ -886,13 +1028,13 @@ bool updateMotorSpeed(const char axis, const bool useRapid, MultiStepper& multiS
             stepsPerMM = config.X.stepsPerMM;
             feedRate = useRapid ? config.X.rapidFeedRate : config.X.workFeedRate;
             acceleration = useRapid ? config.X.rapidAcceleration : config.X.workAcceleration;
-            stepper = &stepperX;
+            axisIndex = AXIS_X;
             break;
         case 'Y':
             stepsPerMM = config.Y.stepsPerMM;
             feedRate = useRapid ? config.Y.rapidFeedRate : config.Y.workFeedRate;
             acceleration = useRapid ? config.Y.rapidAcceleration : config.Y.workAcceleration;
-            stepper = &stepperY;
+            axisIndex = AXIS_Y;
             break;
         default:
             return false; // Nieprawidłowa oś
@@ -910,8 +1052,8 @@ bool updateMotorSpeed(const char axis, const bool useRapid, MultiStepper& multiS
     float speedStepsPerSec = feedRate;
     float accelStepsPerSecSq = acceleration;
 
-    stepper->setMaxSpeed(speedStepsPerSec);
-    stepper->setAcceleration(accelStepsPerSecSq);
+    // Ograniczenia obowiązują dla kolejnych odcinków dodanych do kolejki ruchu
+    stepEngine.setAxisLimits(axisIndex, speedStepsPerSec, accelStepsPerSecSq);
 
     #ifdef DEBUG_CNC_TASK
     Serial.printf("DEBUG MOTOR: Oś %c - Prędkość: %.3f mm/s (%.1f steps/s), Akceleracja: %.3f mm/s² (%.1f steps/s²)\n",
@@ -921,45 +1063,183 @@ bool updateMotorSpeed(const char axis, const bool useRapid, MultiStepper& multiS
     return true;
 }
 
+/**
+ * Przekazuje prędkość ruchu ciągłego JOG do generatora kroków
+ * Wywołanie odświeża sygnał podtrzymania - bez kolejnych komend osie wyhamują
+ * @param jogCommand Kierunki osi [-1..1] i wybór profilu prędkości (G0/G1)
+ */
+bool updateJogVelocity(const JogVelocityCommand& jogCommand, StepEngine& stepEngine, const MachineConfig& config) {
+    const MachineConfig::MotorConfig* motors[AXIS_COUNT] { &config.X, &config.Y };
+    const float directions[AXIS_COUNT] { jogCommand.xDirection, jogCommand.yDirection };
+
+    float velocity[AXIS_COUNT] {};      // steps/s
+    float acceleration[AXIS_COUNT] {};  // steps/s²
+
+    for (uint8_t axis { 0 }; axis < AXIS_COUNT; ++axis) {
+        const float direction { constrain(directions[axis], -1.0f, 1.0f) };
+        velocity[axis] = direction * (jogCommand.rapid ? motors[axis]->rapidFeedRate : motors[axis]->workFeedRate);
+        acceleration[axis] = jogCommand.rapid ? motors[axis]->rapidAcceleration : motors[axis]->workAcceleration;
+    }
+
+    StepEngineStatus status { stepEngine.setJogVelocity(velocity, acceleration) };
+
+    #ifdef DEBUG_CNC_TASK
+    if (status != StepEngineStatus::OK) {
+        Serial.printf("DEBUG JOG: Odrzucono prędkość ruchu ciągłego (status %d)\n", static_cast<int>(status));
+    }
+    #endif
+
+    return status == StepEngineStatus::OK;
+}
+
+/**
+ * Przejmuje nową wersję konfiguracji lub tablicy profili materiałów w zadaniu CNC
+ * (wywołanie na początku cyklu, między odcinkami ruchu)
+ * Parametry strojenia (prędkości, przyspieszenia, moc drutu i wentylatora, filtry kształtujące)
+ * obowiązują od następnego planowanego odcinka, także w trakcie programu. Zmiany skalowania,
+ * kinematyki i zabezpieczeń czekają na spoczynek maszyny.
+ * @return true - nowa wersja przejęta
+ */
+bool adoptConfig(ConfigSnapshotRef& activeConfig, MachineState& cncState, const GCodeProcessingState& gCodeState, StepEngine& stepEngine) {
+    bool baseAdopted { false };
+    ConfigSnapshotRef next { configManager->snapshot() };
+    if (next && next.version() != activeConfig.version()) {
+        const bool idle { cncState.state != CNCState::RUNNING && cncState.state != CNCState::HOMING
+            && cncState.state != CNCState::JOG && stepEngine.isIdle() };
+        if (idle || !requiresIdleReload(*activeConfig, *next)) {
+            activeConfig = std::move(next);
+            baseAdopted = true;
+
+            // Filtry kształtujące przełączane są przez generator kroków w postoju
+            stepEngine.configure(*activeConfig);
+            if (idle) {
+                safetyManager.configure(*activeConfig);
+            }
+        }
+    }
+
+    // Tablica profili kopiowana bez czekania na zapisującego - przy zajętej blokadzie w kolejnym cyklu
+    bool profilesAdopted { false };
+    if (configManager->profilesVersion() != materialProfiles.profilesVersion()) {
+        MaterialProfileTable profileTable {};
+        if (configManager->getProfiles(profileTable, 0) == ConfigManagerStatus::OK) {
+            materialProfiles.setProfiles(profileTable);
+            profilesAdopted = true;
+        }
+    }
+    if (!baseAdopted && !profilesAdopted) {
+        return false;
+    }
+
+    // Konfiguracje efektywne profili przeliczane poza przełączaniem (M700 zmienia tylko wskaźnik)
+    materialProfiles.rebuild(*activeConfig);
+    applyRuntimeConfig(cncState, gCodeState, stepEngine, materialProfiles.config());
+
+    #ifdef DEBUG_CNC_TASK
+    Serial.printf("DEBUG CNC: Przejęto wersję konfiguracji %lu, profili %lu\n", static_cast<unsigned long>(activeConfig.version()),
+        static_cast<unsigned long>(materialProfiles.profilesVersion()));
+    #endif
+    return true;
+}
+
+/**
+ * Stosuje parametry strojenia konfiguracji efektywnej w trakcie pracy: ograniczenia osi
+ * dla kolejnych odcinków programu oraz moc włączonego drutu i wentylatora
+ */
+void applyRuntimeConfig(MachineState& cncState, const GCodeProcessingState& gCodeState, StepEngine& stepEngine, const MachineConfig& config) {
+    // Program w toku - ograniczenia osi dla kolejnych odcinków wg nowej wersji
+    const GCodeProcessingState::ProcessingStage stage { gCodeState.stage };
+    const bool programMotion { stage == GCodeProcessingState::ProcessingStage::READING_FILE
+        || stage == GCodeProcessingState::ProcessingStage::PROCESSING_LINE
+        || stage == GCodeProcessingState::ProcessingStage::EXECUTING_MOVEMENT };
+    if (cncState.state == CNCState::RUNNING && programMotion) {
+        if (!config.useGCodeFeedRate) {
+            updateMotorSpeed('X', false, stepEngine, config); // false = work speed
+            updateMotorSpeed('Y', false, stepEngine, config);
+        }
+        else if (gCodeState.currentFeedRate > 0.0f) {
+            updateMotorSpeed('X', gCodeState.currentFeedRate, stepEngine, config);
+            updateMotorSpeed('Y', gCodeState.currentFeedRate, stepEngine, config);
+        }
+    }
+
+    if (cncState.hotWireOn) {
+        cncState.hotWirePower = config.hotWirePower;
+    }
+    if (cncState.fanOn) {
+        cncState.fanPower = config.fanPower;
+    }
+}
+
+/**
+ * Sprawdza, czy zmiana konfiguracji dotyczy parametrów, których nie można zmienić w trakcie ruchu
+ * (skalowanie i położenie osi, luz, kinematyka, wejścia zabezpieczeń)
+ */
+bool requiresIdleReload(const MachineConfig& active, const MachineConfig& next) {
+    const MachineConfig::MotorConfig* activeMotors[AXIS_COUNT] { &active.X, &active.Y };
+    const MachineConfig::MotorConfig* nextMotors[AXIS_COUNT] { &next.X, &next.Y };
+    for (uint8_t axis { 0 }; axis < AXIS_COUNT; ++axis) {
+        if (activeMotors[axis]->stepsPerMM != nextMotors[axis]->stepsPerMM
+            || activeMotors[axis]->offset != nextMotors[axis]->offset
+            || activeMotors[axis]->backlash != nextMotors[axis]->backlash) {
+            return true;
+        }
+    }
+
+    const MachineConfig::KinematicsConfig& activeKinematics { active.kinematics };
+    const MachineConfig::KinematicsConfig& nextKinematics { next.kinematics };
+    if (activeKinematics.enabled != nextKinematics.enabled
+        || activeKinematics.towerDistance != nextKinematics.towerDistance
+        || activeKinematics.blockOffset != nextKinematics.blockOffset
+        || activeKinematics.blockWidth != nextKinematics.blockWidth) {
+        return true;
+    }
+
+    return active.deactivateESTOP != next.deactivateESTOP
+        || active.deactivateLimitSwitches != next.deactivateLimitSwitches
+        || active.limitSwitchType != next.limitSwitchType;
+}
+
 /**
  * Konfiguruje parametry kinematyczne silnika na podstawie komend G-code
  * @param axis 'X' lub 'Y'
  * @param feedRate Prędkość w mm/s (z poleceń F w G-code)
- * @param accelMultiplier Mnożnik bazowej akceleracji (0.5 = połowa prędkości pracy)
+ * Akceleracja pochodzi z konfiguracji ruchu roboczego (G1) danej osi
  */
-bool updateMotorSpeed(const char axis, const float feedRate, const float accelMultiplier, MultiStepper& multiStepper, AccelStepper& stepperX, AccelStepper& stepperY, const MachineConfig& config) {
+bool updateMotorSpeed(const char axis, const float feedRate, StepEngine& stepEngine, const MachineConfig& config) {
     float stepsPerMM {};
-    AccelStepper* stepper = nullptr;
+    float acceleration {};  // steps/s²
+    uint8_t axisIndex {};
 
     // Wybór parametrów dla konkretnej osi
     switch (axis) {
         case 'X':
             stepsPerMM = config.X.stepsPerMM;
-            stepper = &stepperX;
+            acceleration = config.X.workAcceleration;
+            axisIndex = AXIS_X;
             break;
         case 'Y':
             stepsPerMM = config.Y.stepsPerMM;
-            stepper = &stepperY;
+            acceleration = config.Y.workAcceleration;
+            axisIndex = AXIS_Y;
             break;
         default:
             return false; // Nieprawidłowa oś
     }
 
     // Walidacja parametrów wejściowych z G-code
-    if (stepsPerMM <= 0 || feedRate <= 0 || accelMultiplier <= 0) {
+    if (stepsPerMM <= 0 || feedRate <= 0 || acceleration <= 0) {
         #ifdef DEBUG_CNC_TASK
-        Serial.printf("DEBUG MOTOR ERROR: Nieprawidłowe parametry dla osi %c (feedRate: %.3f, accelMult: %.2f)\n",
-            axis, feedRate, accelMultiplier);
+        Serial.printf("DEBUG MOTOR ERROR: Nieprawidłowe parametry dla osi %c (feedRate: %.3f, accel: %.2f)\n",
+            axis, feedRate, acceleration);
         #endif
         return false;
     }
 
-    // Konwersja jednostek: mm/s → steps/s, obliczenie akceleracji
+    // Konwersja jednostek: mm/s → steps/s
     float speedStepsPerSec = feedRate * stepsPerMM;
-    float accelStepsPerSecSq = (feedRate * accelMultiplier) * stepsPerMM;
 
-    stepper->setMaxSpeed(speedStepsPerSec);
-    stepper->setAcceleration(accelStepsPerSecSq);
+    stepEngine.setAxisLimits(axisIndex, speedStepsPerSec, acceleration);
 
     return true;
 }
@@ -997,8 +1277,45 @@ float getParameter(const String& line, char param) {
     return valueStr.toFloat();
 }
 
+// Numer profilu materiału z wartości parametru (M700 P, /api/start); false = wartość niecałkowita
+// lub spoza 0..MATERIAL_PROFILE_SLOTS - sprawdzane przed rzutowaniem
+bool toProfileSlot(float value, uint8_t& slot) {
+    if (isnan(value) || value < 0.0f || value > static_cast<float>(CONFIG::MATERIAL_PROFILE_SLOTS) || value != floorf(value)) {
+        return false;
+    }
+    slot = static_cast<uint8_t>(value);
+    return true;
+}
+
+// Liczba linii zadania do wskaźnika postępu - wynik analizy pliku, a bez niego oszacowanie
+// 24 bajtów na linię (plik 139 648 B ma 5727 linii, plik 289 824 B ma 11854 linie -> ~24.4)
+uint32_t expectedLineCount(uint32_t analyzedLines, size_t fileSize) {
+    return analyzedLines > 0 ? analyzedLines : static_cast<uint32_t>(fileSize / 24);
+}
+
+// Zamyka plik zadania; plik z karty zamykany przy zajętej karcie, kopia w RAM bez blokady
+// false = nie udało się zająć karty (plik pozostaje otwarty)
+bool closeGCodeFile(GCodeProcessingState& gCodeState) {
+    if (!gCodeState.currentFile) {
+        gCodeState.fileOpen = false;
+        gCodeState.fileCached = false;
+        return true;
+    }
+    if (!gCodeState.fileCached) {
+        if (!sdManager->takeSD(SDPriority::JOB)) {
+            return false;
+        }
+        gCodeState.currentFile.reset();
+        sdManager->giveSD();
+    }
+    gCodeState.currentFile.reset();
+    gCodeState.fileOpen = false;
+    gCodeState.fileCached = false;
+    return true;
+}
+
 // Przygotowuje system do wykonania programu G-code (otwiera plik, resetuje stan)
-bool initializeGCodeProcessing(MachineState& cncState, GCodeProcessingState& gCodeState, MachineConfig& config) {
+bool initializeGCodeProcessing(MachineState& cncState, GCodeProcessingState& gCodeState, const MachineConfig& config) {
     // Pobierz nazwę wybranego projektu z SDManagera
     std::string filename {};
     SDManagerStatus status = sdManager->getSelectedProject(filename);
@@ -1019,16 +1336,11 @@ bool initializeGCodeProcessing(MachineState& cncState, GCodeProcessingState& gCo
     }
     
     // Bezpieczne zamknięcie poprzedniego pliku jeśli był otwarty
-    if (gCodeState.fileOpen && gCodeState.currentFile) {
-        if (!sdManager->takeSD()) {
-            #ifdef DEBUG_CNC_TASK
-            Serial.println("DEBUG CNC ERROR: Nie można zablokować SD do zamknięcia pliku");
-            #endif
-            return false;
-        }
-        gCodeState.currentFile.close();
-        sdManager->giveSD();
-        gCodeState.fileOpen = false;
+    if (!closeGCodeFile(gCodeState)) {
+        #ifdef DEBUG_CNC_TASK
+        Serial.println("DEBUG CNC ERROR: Nie można zablokować SD do zamknięcia pliku");
+        #endif
+        return false;
     }
 
     // Resetowanie stanu przetwarzania do wartości początkowych
@@ -1042,28 +1354,64 @@ bool initializeGCodeProcessing(MachineState& cncState, GCodeProcessingState& gCo
     gCodeState.currentLine = "";
     gCodeState.heatingStartTime = 0;
     gCodeState.heatingDuration = config.delayAfterStartup;
+    gCodeState.targetX = 0.0f;
+    gCodeState.targetY = 0.0f;
+    gCodeState.targetU = 0.0f;
+    gCodeState.targetV = 0.0f;
+    gCodeState.parallelFaces = false;
+    gCodeState.motionMode = -1;
+
+    // Odrzucenie zadania przy konfiguracji niespełniającej reguł walidacji (np. zapis NVS sprzed
+    // zaostrzenia reguł) - prędkości ponad możliwości timera kroków, błędna geometria kinematyki
+    ConfigValidationReport validation {};
+    if (!ConfigValidator::validate(config, validation)) {
+        #ifdef DEBUG_CNC_TASK
+        const ConfigValidationError& error { validation.errors[0] };
+        Serial.printf("DEBUG CNC ERROR: Konfiguracja odrzucona (%u błędów), %s: %s\n", static_cast<unsigned>(validation.total),
+            error.parameter != nullptr ? error.parameter->field.key : "?", ConfigValidator::ruleMessage(error.rule));
+        #endif
+        return false;
+    }
+
+    // Plik mieszczący się w budżecie pamięci wykonywany z kopii w RAM - karta wolna w trakcie cięcia
+    const JobCacheStatus cacheStatus { jobCache.load(*sdManager, filename) };
+    gCodeState.fileCached = false;
+    if (cacheStatus == JobCacheStatus::OK || cacheStatus == JobCacheStatus::HIT) {
+        gCodeState.currentFile = jobCache.open();
+        gCodeState.fileCached = static_cast<bool>(gCodeState.currentFile);
+    }
+    if (gCodeState.fileCached) {
+        gCodeState.totalLines = expectedLineCount(jobCache.getLineCount(), gCodeState.currentFile->size());
+        gCodeState.lineReader.reset();
+        gCodeState.fileOpen = true;
+    }
+
+    #ifdef DEBUG_CNC_TASK
+    Serial.printf("DEBUG CNC: Kopia zadania w RAM: %s (status %d, %u B, wczytania %lu, trafienia %lu)\n",
+        gCodeState.fileCached ? "tak" : "nie", static_cast<int>(cacheStatus), static_cast<unsigned>(jobCache.getSize()),
+        jobCache.getLoadCount(), jobCache.getHitCount());
+    #endif
 
     // Wielokrotne próby otwarcia pliku z karty SD
     constexpr int MAX_NUM_OF_TRIES = 3;
-    for (int i { 0 }; i < MAX_NUM_OF_TRIES; ++i) {
-        if (!sdManager->takeSD()) {
+    for (int i { 0 }; i < MAX_NUM_OF_TRIES && !gCodeState.fileOpen; ++i) {
+        if (!sdManager->takeSD(SDPriority::JOB)) {
             vTaskDelay(pdMS_TO_TICKS(100)); // Odczekaj przed ponowną próbą
             continue;
         }
 
         std::string filePath = CONFIG::PROJECTS_DIR + filename;
-        gCodeState.currentFile = SD.open(filePath.c_str());
+        gCodeState.currentFile = sdManager->getStorage().open(filePath.c_str(), StorageMode::READ);
 
         if (gCodeState.currentFile) {
-
-            // Oszaconowano 24 bajtów na linię
-            // plik 139 648 bajtów ma 5727 linii -> 139648 / 5727 = 24.4
-            // plik 289 824 bajtów ma 11854 linii -> 289824 / 11854 = 24.4
-            // Uproszczono ze względu na niepotrzebne komplikowanie obliczeń
-            gCodeState.totalLines = gCodeState.currentFile.size() / 24;
+            // Liczba linii z indeksu projektów (lista odczytywana przy zajętej karcie)
+            ProjectFileInfo projectInfo {};
+            sdManager->findProjectFile(filename, projectInfo);
+            gCodeState.totalLines = expectedLineCount(projectInfo.lineCount, gCodeState.currentFile->size());
 
             // Przewiń na początek pliku
-            gCodeState.currentFile.seek(0);
+            gCodeState.currentFile->seek(0);
+            gCodeState.lineReader.reset();
 
             gCodeState.fileOpen = true;
 
@@ -1089,9 +1437,10 @@ bool initializeGCodeProcessing(MachineState& cncState, GCodeProcessingState& gCo
         }
     }
 
-
-    gCodeState.fileOpen = true;
-    sdManager->giveSD();
+    // Karta zajęta przez wszystkie próby
+    if (!gCodeState.fileOpen) {
+        return false;
+    }
 
     // Inicjalizacja stanu maszyny
     strncpy(cncState.currentProject, filename.c_str(), sizeof(cncState.currentProject) - 1);
@@ -1104,28 +1453,19 @@ bool initializeGCodeProcessing(MachineState& cncState, GCodeProcessingState& gCo
     return true;
 }
 
-void processGCode(MachineState& cncState, GCodeProcessingState& gCodeState, MultiStepper& multiStepper, AccelStepper& stepperX, AccelStepper& stepperY, MachineConfig& config) {
+void processGCode(MachineState& cncState, GCodeProcessingState& gCodeState, StepEngine& stepEngine, const MachineConfig& config) {
 
     // SPRAWDZENIE BEZPIECZEŃSTWA - krańcówki i ESTOP
     if (cncState.estopOn || cncState.limitXOn || cncState.limitYOn) {
         // Natychmiastowe zatrzymanie
-        stepperX.stop();
-        stepperY.stop();
-        stepperX.setCurrentPosition(stepperX.currentPosition());
-        stepperY.setCurrentPosition(stepperY.currentPosition());
+        stepEngine.abort();
         cncState.hotWireOn = false;
         cncState.fanOn = false;
         gCodeState.stage = GCodeProcessingState::ProcessingStage::ERROR;
         gCodeState.errorMessage = cncState.estopOn ? "ESTOP" : "Limit";
 
         // Zamknij plik
-        if (gCodeState.fileOpen && gCodeState.currentFile) {
-            if (sdManager->takeSD()) {
-                gCodeState.currentFile.close();
-                gCodeState.fileOpen = false;
-                sdManager->giveSD();
-            }
-        }
+        closeGCodeFile(gCodeState);
         return;
     }
 
@@ -1165,7 +1505,7 @@ void processGCode(MachineState& cncState, GCodeProcessingState& gCodeState, Mult
 
                 // Jeśli ruch już trwa, czekaj na zakończenie
                 if (gCodeState.movementInProgress) {
-                    if (stepperX.distanceToGo() != 0 || stepperY.distanceToGo() != 0) {
+                    if (!stepEngine.isIdle()) {
                         return; // Czekaj na zakończenie ruchu
                     }
                     // Ruch zakończony
@@ -1174,8 +1514,8 @@ void processGCode(MachineState& cncState, GCodeProcessingState& gCodeState, Mult
 
                     // Ustaw domyślną prędkość roboczą jeśli nie używamy F z G-code
                     if (!config.useGCodeFeedRate) {
-                        updateMotorSpeed('X', false, multiStepper, stepperX, stepperY, config); // false = work speed
-                        updateMotorSpeed('Y', false, multiStepper, stepperX, stepperY, config);
+                        updateMotorSpeed('X', false, stepEngine, config); // false = work speed
+                        updateMotorSpeed('Y', false, stepEngine, config);
                     }
 
                     #ifdef DEBUG_CNC_TASK
@@ -1185,13 +1525,13 @@ void processGCode(MachineState& cncState, GCodeProcessingState& gCodeState, Mult
                 }
 
                 // Jeśli już jesteśmy w pozycji offsetu, przejdź od razu dalej
-                if (stepperX.currentPosition() == targetXSteps && stepperY.currentPosition() == targetYSteps) {
+                if (stepEngine.getPosition(AXIS_X) == targetXSteps && stepEngine.getPosition(AXIS_Y) == targetYSteps) {
                     gCodeState.stage = GCodeProcessingState::ProcessingStage::READING_FILE;
 
                     // Ustaw domyślną prędkość roboczą jeśli nie używamy F z G-code
                     if (!config.useGCodeFeedRate) {
-                        updateMotorSpeed('X', false, multiStepper, stepperX, stepperY, config); // false = work speed
-                        updateMotorSpeed('Y', false, multiStepper, stepperX, stepperY, config);
+                        updateMotorSpeed('X', false, stepEngine, config); // false = work speed
+                        updateMotorSpeed('Y', false, stepEngine, config);
                         #ifdef DEBUG_CNC_TASK
                         Serial.println("DEBUG G-CODE: Ustawiono domyślną prędkość roboczą");
                         #endif
@@ -1204,14 +1544,16 @@ void processGCode(MachineState& cncState, GCodeProcessingState& gCodeState, Mult
                 }
 
                 // Rozpocznij ruch do offsetu
-                updateMotorSpeed('X', true, multiStepper, stepperX, stepperY, config); // rapid dla offsetu
-                updateMotorSpeed('Y', true, multiStepper, stepperX, stepperY, config);
+                updateMotorSpeed('X', true, stepEngine, config); // rapid dla offsetu
+                updateMotorSpeed('Y', true, stepEngine, config);
 
-                // Przygotuj pozycje docelowe dla MultiStepper
+                // Przygotuj pozycje docelowe
                 long positions[2];
                 positions[0] = targetXSteps;
                 positions[1] = targetYSteps;
-                multiStepper.moveTo(positions);
+                if (!queueProgramMove(positions, stepEngine, gCodeState)) {
+                    return; // Błąd lub ponowna próba w kolejnym cyklu
+                }
                 gCodeState.movementInProgress = true;
 
                 return;
@@ -1225,46 +1567,66 @@ void processGCode(MachineState& cncState, GCodeProcessingState& gCodeState, Mult
                 return;
             }
 
-            // Sprawdź czy poprzedni ruch się skończył
+            // Kolejne linie są czytane dopóki w kolejce ruchu jest miejsce,
+            // dzięki czemu generator kroków planuje przejścia między odcinkami
             if (gCodeState.movementInProgress) {
-                if (stepperX.distanceToGo() != 0 || stepperY.distanceToGo() != 0) {
-                    return; // Czekaj na zakończenie ruchu
+                if (stepEngine.isQueueFull()) {
+                    return; // Czekaj na zwolnienie miejsca w kolejce
                 }
                 gCodeState.movementInProgress = false;
             }
 
-            // Pobierz SD i czytaj linię
-            if (!sdManager->takeSD()) {
-                return; // Spróbuj ponownie w następnym cyklu
-            }
+            {
+                // Karta zajmowana tylko, gdy linia wymaga odczytu kolejnego bloku pliku z karty
+                const bool buffered { gCodeState.fileCached || gCodeState.lineReader.hasBufferedLine() };
+                if (!buffered && !sdManager->takeSD(SDPriority::JOB)) {
+                    return; // Spróbuj ponownie w następnym cyklu
+                }
 
-            if (gCodeState.currentFile.available()) {
-                gCodeState.currentLine = gCodeState.currentFile.readStringUntil('\n');
-                gCodeState.lineNumber++;
-                sdManager->giveSD();
-                #ifdef DEBUG_CNC_TASK
-                Serial.printf("DEBUG G-CODE: Odczytano linię %lu: %s\n", gCodeState.lineNumber, gCodeState.currentLine.c_str());
-                #endif
+                char line[CONFIG::GCODE_MAX_LINE_LENGTH];
+                const bool lineRead { gCodeState.lineReader.readLine(*gCodeState.currentFile, line, sizeof(line)) };
+                if (!buffered) {
+                    sdManager->giveSD();
+                }
 
-                gCodeState.stage = GCodeProcessingState::ProcessingStage::PROCESSING_LINE;
-            }
-            else {
-                // Koniec pliku
-                sdManager->giveSD();
-                gCodeState.stage = GCodeProcessingState::ProcessingStage::FINISHED;
+                if (lineRead) {
+                    gCodeState.currentLine = line;
+                    gCodeState.lineNumber++;
+                    #ifdef DEBUG_CNC_TASK
+                    Serial.printf("DEBUG G-CODE: Odczytano linię %lu: %s\n", gCodeState.lineNumber, gCodeState.currentLine.c_str());
+                    #endif
+
+                    gCodeState.stage = GCodeProcessingState::ProcessingStage::PROCESSING_LINE;
+                }
+                else {
+                    // Koniec pliku
+                    gCodeState.stage = GCodeProcessingState::ProcessingStage::FINISHED;
+                }
             }
             break;
 
-        case GCodeProcessingState::ProcessingStage::PROCESSING_LINE:
-            // Parsuj i przygotuj ruch
-            if (processGCodeLine(gCodeState.currentLine, multiStepper, stepperX, stepperY, cncState, gCodeState, config)) {
-                gCodeState.stage = GCodeProcessingState::ProcessingStage::EXECUTING_MOVEMENT;
+        case GCodeProcessingState::ProcessingStage::PROCESSING_LINE: {
+            // Parsuj i przygotuj ruch (znacznik ponowienia wyłącznie z bieżącego przetwarzania)
+            gCodeState.lineDeferred = false;
+            const bool moveQueued { processGCodeLine(gCodeState.currentLine, stepEngine, cncState, gCodeState, config) };
+
+            // Linia zmieniła etap (M30, błąd) - bez nadpisywania
+            if (gCodeState.stage != GCodeProcessingState::ProcessingStage::PROCESSING_LINE) {
+                break;
             }
-            else {
-                // Przejdź do następnej linii (komentarz, pusta linia, etc.)
-                gCodeState.stage = GCodeProcessingState::ProcessingStage::READING_FILE;
+
+            // Kolejka ruchu pełna lub M3/M5/M700 czeka na opróżnienie kolejki - ta sama linia ponownie
+            // po zdarzeniu ruchu (CNCEvent::MOTION_LOW_WATER, CNCEvent::MOTION_IDLE)
+            if (gCodeState.lineDeferred) {
+                return;
             }
+
+            // Ruch dodany do kolejki lub przejście do następnej linii (komentarz, pusta linia, etc.)
+            gCodeState.stage = moveQueued
+                ? GCodeProcessingState::ProcessingStage::EXECUTING_MOVEMENT
+                : GCodeProcessingState::ProcessingStage::READING_FILE;
             break;
+        }
 
         case GCodeProcessingState::ProcessingStage::EXECUTING_MOVEMENT:
             // Ruch został już przygotowany w PROCESSING_LINE
@@ -1275,7 +1637,7 @@ void processGCode(MachineState& cncState, GCodeProcessingState& gCodeState, Mult
         case GCodeProcessingState::ProcessingStage::FINISHED:
             // Sprawdź czy ruch powrotny się skończył
             if (gCodeState.movementInProgress) {
-                if (stepperX.distanceToGo() != 0 || stepperY.distanceToGo() != 0) {
+                if (!stepEngine.isIdle()) {
                     return; // Czekaj na zakończenie ruchu powrotnego
                 }
                 gCodeState.movementInProgress = false;
@@ -1285,13 +1647,8 @@ void processGCode(MachineState& cncState, GCodeProcessingState& gCodeState, Mult
                 cncState.fanOn = false;
 
                 // Zamknij plik
-                if (gCodeState.fileOpen && gCodeState.currentFile) {
-                    if (sdManager->takeSD()) {
-                        gCodeState.currentFile.close();
-                        gCodeState.fileOpen = false;
-                        sdManager->giveSD();
-                    }
-                }
+                closeGCodeFile(gCodeState);
+                gCodeState.stage = GCodeProcessingState::ProcessingStage::COMPLETED;
 
                 #ifdef DEBUG_CNC_TASK
                 Serial.println("DEBUG G-CODE: Przetwarzanie G-code zakończone");
@@ -1300,18 +1657,24 @@ void processGCode(MachineState& cncState, GCodeProcessingState& gCodeState, Mult
             }
 
             // Rozpocznij ruch powrotny do pozycji przed offsetem (0,0)
-            updateMotorSpeed('X', true, multiStepper, stepperX, stepperY, config); // true = rapid
-            updateMotorSpeed('Y', true, multiStepper, stepperX, stepperY, config);
+            updateMotorSpeed('X', true, stepEngine, config); // true = rapid
+            updateMotorSpeed('Y', true, stepEngine, config);
 
-            // Przygotuj pozycje docelowe dla MultiStepper (powrót do 0,0)
+            // Przygotuj pozycje docelowe (powrót do 0,0)
             long positions[2];
             positions[0] = 0;
             positions[1] = 0;
-            multiStepper.moveTo(positions);
+            if (!queueProgramMove(positions, stepEngine, gCodeState)) {
+                break; // Błąd lub ponowna próba w kolejnym cyklu
+            }
             gCodeState.movementInProgress = true;
 
             break;
 
+        case GCodeProcessingState::ProcessingStage::COMPLETED:
+            // Zakończenie obsługiwane przez główną maszynę stanów w taskCNC
+            return;
+
         case GCodeProcessingState::ProcessingStage::ERROR:
             // Stan błędu - nie rób nic, czekaj na interwencję operatora
             return;
@@ -1323,7 +1686,7 @@ void processGCode(MachineState& cncState, GCodeProcessingState& gCodeState, Mult
 
     }
 }
-bool processGCodeLine(String line, MultiStepper& multiStepper, AccelStepper& stepperX, AccelStepper& stepperY, MachineState& cncState, GCodeProcessingState& gCodeState, MachineConfig& config) {
+bool processGCodeLine(String line, StepEngine& stepEngine, MachineState& cncState, GCodeProcessingState& gCodeState, const MachineConfig& config) {
     line.trim();
 
     // Skip puste linie i komentarze
@@ -1341,9 +1704,9 @@ bool processGCodeLine(String line, MultiStepper& multiStepper, AccelStepper& ste
             if (!isnan(feedRate)) {
                 // Zamień mm/min na mm/s jeśli F jest w mm/min
                 feedRate = feedRate / 60.0f;
-                // Ustaw prędkość dla obu osi z akceleracją = połowa prędkości
-                updateMotorSpeed('X', feedRate, 0.5f, multiStepper, stepperX, stepperY, config);
-                updateMotorSpeed('Y', feedRate, 0.5f, multiStepper, stepperX, stepperY, config);
+                // Ustaw prędkość dla obu osi (akceleracja z konfiguracji G1)
+                updateMotorSpeed('X', feedRate, stepEngine, config);
+                updateMotorSpeed('Y', feedRate, stepEngine, config);
                 gCodeState.currentFeedRate = feedRate; // Zapamiętaj aktualną prędkość w mm/s
             }
         }
@@ -1352,12 +1715,22 @@ bool processGCodeLine(String line, MultiStepper& multiStepper, AccelStepper& ste
 
     // G1 - Linear move (ruch roboczy)
     else if (line.startsWith("G1")) {
-        return processLinearMove(line, multiStepper, stepperX, stepperY, cncState, gCodeState, config, false);
+        gCodeState.motionMode = 1;
+        return processLinearMove(line, stepEngine, cncState, gCodeState, config, false);
     }
 
     // G0 - Rapid move (ruch szybki)
     else if (line.startsWith("G0")) {
-        return processLinearMove(line, multiStepper, stepperX, stepperY, cncState, gCodeState, config, true);
+        gCodeState.motionMode = 0;
+        return processLinearMove(line, stepEngine, cncState, gCodeState, config, true);
+    }
+
+    // Same współrzędne - kontynuacja modalnego G0/G1 (jak w analizie pliku i podglądzie ścieżki)
+    else if (line.startsWith("X") || line.startsWith("Y") || line.startsWith("U") || line.startsWith("V")) {
+        if (gCodeState.motionMode < 0) {
+            return false;
+        }
+        return processLinearMove(line, stepEngine, cncState, gCodeState, config, gCodeState.motionMode == 0);
     }
 
     // G90
@@ -1378,8 +1751,39 @@ bool processGCodeLine(String line, MultiStepper& multiStepper, AccelStepper& ste
         return false; // Nie ma ruchu, ale zmień stan
     }
 
+    // M700 P<n> - Profil materiału (0 = konfiguracja bazowa), parametry cięcia od kolejnego odcinka
+    else if (line.startsWith("M700")) {
+        uint8_t slot { 0 };
+        if (!toProfileSlot(getParameter(line, 'P'), slot)) {
+            gCodeState.stage = GCodeProcessingState::ProcessingStage::ERROR;
+            gCodeState.errorMessage = "Invalid material profile number";
+            return false;
+        }
+
+        // Odcinki w kolejce zaplanowane z poprzednim profilem (moc drutu) - przełączenie po ich wykonaniu
+        if (deferUntilIdle(stepEngine, gCodeState)) {
+            return false;
+        }
+
+        if (!materialProfiles.select(slot)) {
+            gCodeState.stage = GCodeProcessingState::ProcessingStage::ERROR;
+            gCodeState.errorMessage = "Material profile not available";
+            return false;
+        }
+        #ifdef DEBUG_CNC_TASK
+        Serial.printf("DEBUG G-CODE: M700 - Profil materiału %u\n", static_cast<unsigned>(materialProfiles.slot()));
+        #endif
+        cncState.activeProfile = materialProfiles.slot();
+        applyRuntimeConfig(cncState, gCodeState, stepEngine, materialProfiles.config());
+        return false; // Nie ma ruchu, ale zmień stan
+    }
+
     // M3 - Włącz silnik wrzeciona (jeśli jest)
     else if (line.startsWith("M3")) {
+        // Drut włączany po wykonaniu odcinków sprzed tej linii (np. po dojeździe do początku cięcia)
+        if (deferUntilIdle(stepEngine, gCodeState)) {
+            return false;
+        }
         #ifdef DEBUG_CNC_TASK
         Serial.println("DEBUG G-CODE: M3 ");
         #endif
@@ -1389,6 +1793,10 @@ bool processGCodeLine(String line, MultiStepper& multiStepper, AccelStepper& ste
     }
     // M5 - Wyłącz silnik wrzeciona (jeśli jest)
     else if (line.startsWith("M5")) {
+        // Drut wyłączany dopiero po zakończeniu cięcia zaplanowanego przed tą linią
+        if (deferUntilIdle(stepEngine, gCodeState)) {
+            return false;
+        }
         #ifdef DEBUG_CNC_TASK
         Serial.println("DEBUG G-CODE: M5 ");
         #endif
@@ -1413,7 +1821,51 @@ bool processGCodeLine(String line, MultiStepper& multiStepper, AccelStepper& ste
     return false;
 }
 
-bool processLinearMove(const String& line, MultiStepper& multiStepper, AccelStepper& stepperX, AccelStepper& stepperY, MachineState& cncState, GCodeProcessingState& gCodeState, MachineConfig& config, bool isRapid) {
+/**
+ * Wstrzymuje linię ze skutkiem poza ruchem (wyjścia drutu i wentylatora, profil materiału) do wykonania
+ * odcinków zaplanowanych przed nią - odczyt z wyprzedzeniem nie może zmienić wyjść w trakcie tych odcinków.
+ * Linia ponawiana jest po zdarzeniu CNCEvent::MOTION_IDLE
+ * @return true - generator kroków w ruchu, linia odłożona
+ */
+bool deferUntilIdle(const StepEngine& stepEngine, GCodeProcessingState& gCodeState) {
+    if (stepEngine.isIdle()) {
+        return false;
+    }
+    gCodeState.lineDeferred = true;
+    return true;
+}
+
+/**
+ * Dodaje odcinek programu do kolejki ruchu
+ * Pełna kolejka nie zmienia stanu - linia (PROCESSING_LINE) lub ruch etapu jest ponawiany w kolejnym
+ * cyklu. Pozostałe odrzucenia przerywają program: pozycja programu nie może wyprzedzić generatora.
+ * @return true - odcinek dodany do kolejki
+ */
+bool queueProgramMove(const long positions[AXIS_COUNT], StepEngine& stepEngine, GCodeProcessingState& gCodeState) {
+    // Odcinki linii programu oznaczane jej numerem (postęp wg wykonywanego odcinka), ruchy etapów bez numeru
+    const bool programLine { gCodeState.stage == GCodeProcessingState::ProcessingStage::PROCESSING_LINE };
+    const StepEngineStatus status { stepEngine.queueMove(positions, programLine ? gCodeState.lineNumber : 0) };
+    if (status == StepEngineStatus::OK) {
+        return true;
+    }
+
+    if (status == StepEngineStatus::QUEUE_FULL) {
+        gCodeState.lineDeferred = gCodeState.stage == GCodeProcessingState::ProcessingStage::PROCESSING_LINE;
+        return false;
+    }
+
+    gCodeState.stage = GCodeProcessingState::ProcessingStage::ERROR;
+    gCodeState.errorMessage = status == StepEngineStatus::INTERLOCKED
+        ? String("Move rejected - safety input active")
+        : "Move rejected by step engine (status " + String(static_cast<int>(status)) + ")";
+
+    #ifdef DEBUG_CNC_TASK
+    Serial.printf("DEBUG G-CODE: %s\n", gCodeState.errorMessage.c_str());
+    #endif
+    return false;
+}
+
+bool processLinearMove(const String& line, StepEngine& stepEngine, MachineState& cncState, GCodeProcessingState& gCodeState, const MachineConfig& config, bool isRapid) {
     float xPos { getParameter(line, 'X') };
     float yPos { getParameter(line, 'Y') };
     float feedRate { getParameter(line, 'F') };
@@ -1425,9 +1877,9 @@ bool processLinearMove(const String& line, MultiStepper& multiStepper, AccelStep
     if (!isnan(feedRate) && config.useGCodeFeedRate) {
         // Zamień mm/min na mm/s jeśli F jest w mm/min
         feedRate = feedRate / 60.0f;
-        // Prędkość z G-code, akceleracja = połowa prędkości
-        updateMotorSpeed('X', feedRate, 0.5f, multiStepper, stepperX, stepperY, config);
-        updateMotorSpeed('Y', feedRate, 0.5f, multiStepper, stepperX, stepperY, config);
+        // Prędkość z G-code, akceleracja z konfiguracji G1
+        updateMotorSpeed('X', feedRate, stepEngine, config);
+        updateMotorSpeed('Y', feedRate, stepEngine, config);
         gCodeState.currentFeedRate = feedRate;
         speedChanged = true;
     }
@@ -1443,15 +1895,75 @@ bool processLinearMove(const String& line, MultiStepper& multiStepper, AccelStep
 
     // Przygotuj pozycje docelowe dla synchronizacji
     long positions[2];
-    positions[0] = stepperX.currentPosition(); // Domyślnie - brak ruchu
-    positions[1] = stepperY.currentPosition(); // Domyślnie - brak ruchu
+    positions[0] = stepEngine.getPlannedPosition(AXIS_X); // Domyślnie - brak ruchu
+    positions[1] = stepEngine.getPlannedPosition(AXIS_Y); // Domyślnie - brak ruchu
+
+    // Etap kinematyki - współrzędne ścian bloku rzutowane na płaszczyzny wież
+    if (config.kinematics.enabled) {
+        float uPos { getParameter(line, 'U') };
+        float vPos { getParameter(line, 'V') };
+
+        if (isnan(xPos) && isnan(yPos) && isnan(uPos) && isnan(vPos)) {
+            return false;
+        }
+
+        WirePoint face {};
+        face.x = isnan(xPos) ? gCodeState.targetX : (cncState.relativeMode ? gCodeState.targetX + xPos : xPos);
+        face.y = isnan(yPos) ? gCodeState.targetY : (cncState.relativeMode ? gCodeState.targetY + yPos : yPos);
+
+        // Cięcie równoległe wybrane dla zadania - druga ściana podąża za pierwszą, słowa U/V są sprzeczne z trybem
+        // W pozostałych zadaniach U/V są modalne jak X/Y - linia bez U/V zachowuje stożek
+        if (gCodeState.parallelFaces) {
+            if (!isnan(uPos) || !isnan(vPos)) {
+                gCodeState.stage = GCodeProcessingState::ProcessingStage::ERROR;
+                gCodeState.errorMessage = "U/V words in parallel cutting job";
+                return false;
+            }
+            face.u = face.x;
+            face.v = face.y;
+        }
+        else {
+            face.u = isnan(uPos) ? gCodeState.targetU : (cncState.relativeMode ? gCodeState.targetU + uPos : uPos);
+            face.v = isnan(vPos) ? gCodeState.targetV : (cncState.relativeMode ? gCodeState.targetV + vPos : vPos);
+        }
+
+        WirePoint tower {};
+        if (Kinematics::projectToTowers(config.kinematics, face, tower) != KinematicsStatus::OK) {
+            gCodeState.stage = GCodeProcessingState::ProcessingStage::ERROR;
+            gCodeState.errorMessage = "Invalid kinematics geometry";
+            return false;
+        }
+
+        // Sterownik napędza wieżę XY - wynik dla wieży UV jest wyznaczany dla spójności ścieżki
+        positions[0] = (tower.x + config.X.offset) * config.X.stepsPerMM;
+        positions[1] = (tower.y + config.Y.offset) * config.Y.stepsPerMM;
+        if (!queueProgramMove(positions, stepEngine, gCodeState)) {
+            return false;
+        }
+
+        // Pozycja programu zmienia się dopiero po przyjęciu odcinka przez generator
+        gCodeState.targetX = face.x;
+        gCodeState.targetY = face.y;
+        gCodeState.targetU = face.u;
+        gCodeState.targetV = face.v;
+
+        #ifdef DEBUG_CNC_TASK
+        Serial.printf("DEBUG KINEMATICS: Ściany XY(%.3f, %.3f) UV(%.3f, %.3f) -> wieże XY(%.3f, %.3f) UV(%.3f, %.3f)\n",
+            face.x, face.y, face.u, face.v, tower.x, tower.y, tower.u, tower.v);
+        #endif
+        return true;
+    }
+
+    // Pozycja programu zmienia się dopiero po przyjęciu odcinka przez generator
+    float targetX { gCodeState.targetX };
+    float targetY { gCodeState.targetY };
 
     // Ruch w X
     if (!isnan(xPos)) {
-        float targetX;
         if (cncState.relativeMode) {
-            // Tryb relatywny - dodaj do aktualnej pozycji
-            targetX = cncState.currentX + xPos;
+            // Tryb relatywny - dodaj do ostatniej zaprogramowanej pozycji
+            // (pozycja silników pozostaje w tyle za kolejką ruchu)
+            targetX = gCodeState.targetX + xPos;
         }
         else {
             // Tryb absolutny - pozycja bezwzględna
@@ -1466,10 +1978,9 @@ bool processLinearMove(const String& line, MultiStepper& multiStepper, AccelStep
 
     // Ruch w Y
     if (!isnan(yPos)) {
-        float targetY;
         if (cncState.relativeMode) {
-            // Tryb relatywny - dodaj do aktualnej pozycji
-            targetY = cncState.currentY + yPos;
+            // Tryb relatywny - dodaj do ostatniej zaprogramowanej pozycji
+            targetY = gCodeState.targetY + yPos;
         }
         else {
             // Tryb absolutny - pozycja bezwzględna
@@ -1484,7 +1995,11 @@ bool processLinearMove(const String& line, MultiStepper& multiStepper, AccelStep
 
     // Wykonaj synchronizowany ruch tylko jeśli jest jakiś ruch
     if (hasMovement) {
-        multiStepper.moveTo(positions);
+        if (!queueProgramMove(positions, stepEngine, gCodeState)) {
+            return false;
+        }
+        gCodeState.targetX = targetX;
+        gCodeState.targetY = targetY;
     }
 
     return hasMovement;
@@ -1496,144 +2011,151 @@ bool processLinearMove(const String& line, MultiStepper& multiStepper, AccelStep
 * ------------------------------------------------------------------------------------------------------------
 */
 
-// Wykonuje sekwencję bazowania osi X i Y do pozycji zerowej
-void processHoming(MachineState& cncState, HomingState& homingState, MultiStepper& multiStepper, AccelStepper& stepperX, AccelStepper& stepperY, MachineConfig& config) {
+// Wykonuje dwuprędkościową sekwencję bazowania osi X i Y do pozycji zerowej:
+// szybkie wyszukanie krańcówek obu osi jednocześnie, wycofanie, powolny dojazd
+// (precyzyjne zatrzaśnięcie pozycji w przerwaniu) i odjazd do punktu zerowego
+void processHoming(MachineState& cncState, HomingState& homingState, StepEngine& stepEngine, const MachineConfig& config) {
+
+    static constexpr SafetyInput limitInputs[AXIS_COUNT] { SafetyInput::LIMIT_X, SafetyInput::LIMIT_Y };
+    static const char* const axisNames[AXIS_COUNT] { "X", "Y" };
+    const float stepsPerMM[AXIS_COUNT] { config.X.stepsPerMM, config.Y.stepsPerMM };
 
     // Sprawdzenie warunków bezpieczeństwa - bazowanie tylko gdy ESTOP nieaktywny
     if (cncState.estopOn) {
-        stepperX.stop();
-        stepperY.stop();
-        stepperX.setCurrentPosition(stepperX.currentPosition());
-        stepperY.setCurrentPosition(stepperY.currentPosition());
+        stepEngine.abort();
         homingState.stage = HomingState::HomingStage::ERROR;
         homingState.errorMessage = "ESTOP active during homing";
         return;
     }
 
+    // Zadziałanie krańcówki poza fazą wyszukiwania zatrzymało cały generator
+    if (stepEngine.isHalted()) {
+        stepEngine.abort();
+        homingState.stage = HomingState::HomingStage::ERROR;
+        homingState.errorMessage = "Limit switch triggered during homing move";
+        return;
+    }
+
     switch (homingState.stage) {
 
-        case HomingState::HomingStage::HOMING_X: {
+        case HomingState::HomingStage::SEEK:
+        case HomingState::HomingStage::APPROACH: {
+                const bool seek { homingState.stage == HomingState::HomingStage::SEEK };
+                const float speed { seek ? config.homing.seekSpeed : config.homing.approachSpeed };
 
                 if (!homingState.movementInProgress) {
-                    // Inicjalizacja bazowania osi X - ruch w stronę krańcówki
-                    float homingSpeedSteps = homingState.homingSpeed * config.X.stepsPerMM;
-                    float homingAccelSteps = homingState.homingAcceleration * config.X.stepsPerMM;
-
-                    stepperX.setMaxSpeed(homingSpeedSteps);
-                    stepperX.setAcceleration(homingAccelSteps);
+                    // Dojazd wymaga zwolnionych krańcówek po wycofaniu
+                    if (!seek) {
+                        for (uint8_t axis { 0 }; axis < AXIS_COUNT; ++axis) {
+                            if (!safetyManager.isTripped(limitInputs[axis])) {
+                                continue;
+                            }
+                            if (millis() - homingState.stageStartTime >= CONFIG::HOMING_RELEASE_TIMEOUT_MS) {
+                                stepEngine.abort();
+                                homingState.stage = HomingState::HomingStage::ERROR;
+                                homingState.errorMessage = String(axisNames[axis]) + " limit switch still active after backoff";
+                            }
+                            return;
+                        }
+                    }
 
-                    // Rozpoczęcie ruchu w kierunku ujemnym (długi dystans dla pewności dotarcia do krańcówki)
-                    stepperX.move(-1000 * config.X.stepsPerMM);
+                    // Oś stojąca już na krańcówce pomija wyszukiwanie
+                    for (uint8_t axis { 0 }; axis < AXIS_COUNT; ++axis) {
+                        homingState.axisLatched[axis] = safetyManager.isTripped(limitInputs[axis]);
+                        homingState.startPosition[axis] = stepEngine.getPosition(axis);
+                    }
                     homingState.movementInProgress = true;
-                    homingState.limitReached = false;
 
                     #ifdef DEBUG_CNC_TASK
-                    Serial.println("DEBUG HOME: Rozpoczęcie bazowania osi X");
+                    Serial.printf("DEBUG HOME: %s krańcówek z prędkością %.2f mm/s\n", seek ? "Wyszukiwanie" : "Dojazd do", speed);
                     #endif
                 }
 
-                // Detekcja osiągnięcia krańcówki osi X
-                if (cncState.limitXOn && !homingState.limitReached) {
-                    stepperX.stop();
-                    homingState.limitReached = true;
-                    homingState.movementInProgress = false;
+                // Ruch ciągły osi bez zatrzaśniętej krańcówki - wywołanie w każdym cyklu
+                // podtrzymuje ruch, a przerwanie krańcówki zatrzymuje wyłącznie swoją oś
+                float velocity[AXIS_COUNT] {};
+                float acceleration[AXIS_COUNT] {};
+                bool anyMoving { false };
 
-                    #ifdef DEBUG_CNC_TASK
-                    Serial.println("DEBUG HOME: Krańcówka X osiągnięta");
-                    #endif
+                for (uint8_t axis { 0 }; axis < AXIS_COUNT; ++axis) {
+                    if (safetyManager.isTripped(limitInputs[axis])) {
+                        homingState.axisLatched[axis] = true;
+                    }
+                    if (homingState.axisLatched[axis]) {
+                        continue;
+                    }
 
-                    // Wycofanie się o bezpieczną odległość od krańcówki
-                    long backoffSteps = homingState.backoffDistance * config.X.stepsPerMM;
-                    stepperX.move(backoffSteps);
-                    homingState.backoffComplete = false;
+                    // Zabezpieczenie przed uszkodzoną krańcówką - ograniczenie drogi wyszukiwania
+                    const long travel { labs(stepEngine.getPosition(axis) - homingState.startPosition[axis]) };
+                    if (travel > static_cast<long>(config.homing.maxTravel * stepsPerMM[axis])) {
+                        stepEngine.abort();
+                        homingState.stage = HomingState::HomingStage::ERROR;
+                        homingState.errorMessage = String(axisNames[axis]) + " limit switch not reached - check wiring";
+                        return;
+                    }
+
+                    velocity[axis] = -speed * stepsPerMM[axis];
+                    acceleration[axis] = config.homing.acceleration * stepsPerMM[axis];
+                    anyMoving = true;
                 }
 
-                // Sprawdzenie zakończenia procedury wycofania dla osi X
-                if (homingState.limitReached && stepperX.distanceToGo() == 0 && !homingState.backoffComplete) {
-                    // Ustawienie pozycji zerowej i przejście do bazowania osi Y
-                    stepperX.setCurrentPosition(0);
-                    cncState.currentX = 0.0f;
-                    homingState.backoffComplete = true;
-                    homingState.stage = HomingState::HomingStage::HOMING_Y;
+                if (anyMoving) {
+                    stepEngine.setJogVelocity(velocity, acceleration);
+                    break;
+                }
 
-                    #ifdef DEBUG_CNC_TASK
-                    Serial.println("DEBUG HOME: Oś X zbazowana, rozpoczęcie bazowania osi Y");
-                    #endif
+                // Obie krańcówki zatrzaśnięte - oczekiwanie na zakończenie ruchu ciągłego
+                if (stepEngine.isJogging()) {
+                    break;
                 }
 
-                // Obsługa błędu - krańcówka nie została osiągnięta w oczekiwanym czasie
-                if (homingState.movementInProgress && stepperX.distanceToGo() == 0 && !cncState.limitXOn) {
-                    stepperX.stop();
-                    stepperY.stop();
-                    stepperX.setCurrentPosition(stepperX.currentPosition());
-                    stepperY.setCurrentPosition(stepperY.currentPosition());
+                // Wycofanie po wyszukiwaniu lub odjazd do zera po precyzyjnym dojeździe
+                long target[AXIS_COUNT] {};
+                for (uint8_t axis { 0 }; axis < AXIS_COUNT; ++axis) {
+                    const float distance { seek ? config.homing.backoffDistance : config.homing.pulloffDistance };
+                    const long origin { seek ? stepEngine.getPosition(axis) : safetyManager.getTripPosition(limitInputs[axis], axis) };
+                    target[axis] = origin + static_cast<long>(distance * stepsPerMM[axis]);
+                    stepEngine.setAxisLimits(axis, config.homing.seekSpeed * stepsPerMM[axis], config.homing.acceleration * stepsPerMM[axis]);
+                }
+
+                if (stepEngine.queueMove(target) != StepEngineStatus::OK) {
+                    stepEngine.abort();
                     homingState.stage = HomingState::HomingStage::ERROR;
-                    homingState.errorMessage = "X limit switch not reached - check wiring";
+                    homingState.errorMessage = "Homing move rejected by step engine";
                     return;
                 }
 
+                homingState.movementInProgress = false;
+                homingState.stage = seek ? HomingState::HomingStage::BACKOFF : HomingState::HomingStage::PULLOFF;
+
+                #ifdef DEBUG_CNC_TASK
+                Serial.printf("DEBUG HOME: Krańcówki X i Y osiągnięte (%s)\n", seek ? "wyszukiwanie" : "dojazd");
+                #endif
                 break;
             }
 
-        case HomingState::HomingStage::HOMING_Y: {
-
-                if (!homingState.movementInProgress) {
-                    // Inicjalizacja bazowania osi Y - analogicznie do osi X
-                    float homingSpeedSteps = homingState.homingSpeed * config.Y.stepsPerMM;
-                    float homingAccelSteps = homingState.homingAcceleration * config.Y.stepsPerMM;
-
-                    stepperY.setMaxSpeed(homingSpeedSteps);
-                    stepperY.setAcceleration(homingAccelSteps);
-
-                    // Rozpoczęcie ruchu w kierunku ujemnym do krańcówki Y
-                    stepperY.move(-1000 * config.Y.stepsPerMM);
-                    homingState.movementInProgress = true;
-                    homingState.limitReached = false;
-
-                    #ifdef DEBUG_CNC_TASK
-                    Serial.println("DEBUG HOME: Rozpoczęcie bazowania osi Y");
-                    #endif
-                }
-
-                // Detekcja osiągnięcia krańcówki osi Y
-                if (cncState.limitYOn && !homingState.limitReached) {
-                    stepperY.stop();
-                    homingState.limitReached = true;
-                    homingState.movementInProgress = false;
-
-                    #ifdef DEBUG_CNC_TASK
-                    Serial.println("DEBUG HOME: Krańcówka Y osiągnięta");
-                    #endif
-
-                    // Wycofanie się o bezpieczną odległość od krańcówki Y
-                    long backoffSteps = homingState.backoffDistance * config.Y.stepsPerMM;
-                    stepperY.move(backoffSteps);
-                    homingState.backoffComplete = false;
+        case HomingState::HomingStage::BACKOFF: {
+                // Po wycofaniu krańcówki mają czas na stabilne zwolnienie przed dojazdem
+                if (stepEngine.isIdle()) {
+                    homingState.stage = HomingState::HomingStage::APPROACH;
+                    homingState.stageStartTime = millis();
                 }
+                break;
+            }
 
-                // Finalizacja procedury bazowania - obie osie w pozycji zerowej
-                if (homingState.limitReached && stepperY.distanceToGo() == 0 && !homingState.backoffComplete) {
-                    stepperY.setCurrentPosition(0);
+        case HomingState::HomingStage::PULLOFF: {
+                // Ustawienie pozycji zerowej obu osi po odjeździe od krańcówek
+                if (stepEngine.isIdle()) {
+                    stepEngine.setPosition(AXIS_X, 0);
+                    stepEngine.setPosition(AXIS_Y, 0);
+                    cncState.currentX = 0.0f;
                     cncState.currentY = 0.0f;
-                    homingState.backoffComplete = true;
                     homingState.stage = HomingState::HomingStage::FINISHED;
 
                     #ifdef DEBUG_CNC_TASK
-                    Serial.println("DEBUG HOME: Oś Y zbazowana, bazowanie zakończone");
+                    Serial.println("DEBUG HOME: Osie X i Y zbazowane, bazowanie zakończone");
                     #endif
                 }
-
-                // Obsługa błędu - krańcówka Y nie została osiągnięta
-                if (homingState.movementInProgress && stepperY.distanceToGo() == 0 && !cncState.limitYOn) {
-                    stepperX.stop();
-                    stepperY.stop();
-                    stepperX.setCurrentPosition(stepperX.currentPosition());
-                    stepperY.setCurrentPosition(stepperY.currentPosition());
-                    homingState.stage = HomingState::HomingStage::ERROR;
-                    homingState.errorMessage = "Y limit switch not reached - check wiring";
-                    return;
-                }
-
                 break;
             }
 
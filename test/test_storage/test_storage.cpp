@@ -0,0 +1,212 @@
+// ================================================================================
+//                  TESTY BACKENDÓW STORAGE (ŚRODOWISKO NATIVE)
+// ================================================================================
+// PosixStorage na katalogu tymczasowym, MemoryStorageFile i StorageLineReader
+
+#include <unity.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+
+#include "PosixStorage.h"
+#include "Storage.h"
+
+namespace {
+    std::string rootDirectory {};
+
+    size_t writeText(StorageFile& file, const char* text) {
+        return file.write(reinterpret_cast<const uint8_t*>(text), strlen(text));
+    }
+}
+
+void setUp() {
+    char pattern[] { "/tmp/storage_test_XXXXXX" };
+    const char* created { mkdtemp(pattern) };
+    TEST_ASSERT_NOT_NULL(created);
+    rootDirectory = created;
+}
+
+void tearDown() {
+    const std::string command { "rm -rf " + rootDirectory };
+    TEST_ASSERT_EQUAL(0, system(command.c_str()));
+}
+
+// ================================================================================
+//                                 POSIXSTORAGE
+// ================================================================================
+
+void test_posix_write_read() {
+    PosixStorage storage { rootDirectory.c_str() };
+    TEST_ASSERT_TRUE(storage.mkdir("/Projects"));
+
+    std::unique_ptr<StorageFile> output { storage.open("/Projects/a.gcode", StorageMode::WRITE) };
+    TEST_ASSERT_NOT_NULL(output.get());
+    TEST_ASSERT_EQUAL(11, writeText(*output, "G1 X1\nG1 Y2"));
+    output->close();
+    TEST_ASSERT_FALSE(output->isOpen());
+
+    std::unique_ptr<StorageFile> input { storage.open("/Projects/a.gcode", StorageMode::READ) };
+    TEST_ASSERT_NOT_NULL(input.get());
+    TEST_ASSERT_EQUAL(11, input->size());
+    TEST_ASSERT_TRUE(input->getLastWrite() > 0);
+
+    uint8_t buffer[16] {};
+    TEST_ASSERT_TRUE(input->seek(6));
+    TEST_ASSERT_EQUAL(5, input->read(buffer, sizeof(buffer)));
+    TEST_ASSERT_EQUAL_MEMORY("G1 Y2", buffer, 5);
+    TEST_ASSERT_EQUAL(11, input->position());
+}
+
+void test_posix_append() {
+    PosixStorage storage { rootDirectory.c_str() };
+
+    std::unique_ptr<StorageFile> first { storage.open("/log.txt", StorageMode::APPEND) };
+    TEST_ASSERT_NOT_NULL(first.get());
+    writeText(*first, "ab");
+    first.reset();
+
+    std::unique_ptr<StorageFile> second { storage.open("/log.txt", StorageMode::APPEND) };
+    writeText(*second, "cd");
+    second.reset();
+
+    std::unique_ptr<StorageFile> input { storage.open("/log.txt", StorageMode::READ) };
+    TEST_ASSERT_EQUAL(4, input->size());
+}
+
+void test_posix_missing_and_directory() {
+    PosixStorage storage { rootDirectory.c_str() };
+    TEST_ASSERT_TRUE(storage.mkdir("/Projects"));
+
+    TEST_ASSERT_NULL(storage.open("/missing.gcode", StorageMode::READ).get());
+    TEST_ASSERT_NULL(storage.open("/Projects/", StorageMode::READ).get());
+    TEST_ASSERT_FALSE(storage.exists("/missing.gcode"));
+    TEST_ASSERT_TRUE(storage.exists("/Projects/"));
+    TEST_ASSERT_FALSE(storage.list("/missing", [](const StorageEntry&) { return true; }));
+}
+
+void test_posix_rename_replaces_target() {
+    PosixStorage storage { rootDirectory.c_str() };
+
+    std::unique_ptr<StorageFile> target { storage.open("/a.gcode", StorageMode::WRITE) };
+    writeText(*target, "old");
+    target.reset();
+    std::unique_ptr<StorageFile> temp { storage.open("/a.gcode.1.part", StorageMode::WRITE) };
+    writeText(*temp, "new file");
+    temp.reset();
+
+    TEST_ASSERT_TRUE(storage.rename("/a.gcode.1.part", "/a.gcode"));
+    TEST_ASSERT_FALSE(storage.exists("/a.gcode.1.part"));
+    TEST_ASSERT_EQUAL(8, storage.open("/a.gcode", StorageMode::READ)->size());
+
+    TEST_ASSERT_TRUE(storage.remove("/a.gcode"));
+    TEST_ASSERT_FALSE(storage.exists("/a.gcode"));
+}
+
+void test_posix_list() {
+    PosixStorage storage { rootDirectory.c_str() };
+    TEST_ASSERT_TRUE(storage.mkdir("/Projects"));
+    TEST_ASSERT_TRUE(storage.mkdir("/Projects/sub"));
+    std::unique_ptr<StorageFile> file { storage.open("/Projects/a.gcode", StorageMode::WRITE) };
+    writeText(*file, "G1 X1\n");
+    file.reset();
+
+    int files { 0 };
+    int directories { 0 };
+    uint32_t size { 0 };
+    TEST_ASSERT_TRUE(storage.list("/Projects/", [&](const StorageEntry& entry) {
+        if (entry.directory) {
+            ++directories;
+        }
+        else {
+            ++files;
+            size = entry.size;
+            TEST_ASSERT_EQUAL_STRING("a.gcode", entry.name);
+        }
+        return true;
+    }));
+    TEST_ASSERT_EQUAL(1, files);
+    TEST_ASSERT_EQUAL(1, directories);
+    TEST_ASSERT_EQUAL(6, size);
+}
+
+// ================================================================================
+//                        PLIK W PAMIĘCI I ODCZYT LINIAMI
+// ================================================================================
+
+void test_memory_file() {
+    static const uint8_t data[] { 'a', 'b', 'c', 'd' };
+    MemoryStorageFile file { data, sizeof(data), 1234 };
+
+    uint8_t buffer[8] {};
+    TEST_ASSERT_EQUAL(0, file.write(data, sizeof(data)));
+    TEST_ASSERT_EQUAL(3, file.read(buffer, 3));
+    TEST_ASSERT_EQUAL(1, file.read(buffer, sizeof(buffer)));
+    TEST_ASSERT_EQUAL(0, file.read(buffer, sizeof(buffer)));
+    TEST_ASSERT_FALSE(file.seek(5));
+    TEST_ASSERT_TRUE(file.seek(1));
+    TEST_ASSERT_EQUAL(1, file.position());
+    TEST_ASSERT_EQUAL(1234, file.getLastWrite());
+
+    file.close();
+    TEST_ASSERT_FALSE(file.isOpen());
+    TEST_ASSERT_EQUAL(0, file.read(buffer, sizeof(buffer)));
+}
+
+void test_line_reader() {
+    // Linia dłuższa niż blok odczytu, CRLF i ostatnia linia bez znaku końca linii
+    std::string text { "G90\r\n" };
+    text += std::string(StorageLineReader::BLOCK_SIZE + 100, 'X');
+    text += "\nG1 X1\nM30";
+    MemoryStorageFile file { reinterpret_cast<const uint8_t*>(text.data()), text.size(), 0 };
+
+    StorageLineReader reader {};
+    char line[16] {};
+    TEST_ASSERT_TRUE(reader.readLine(file, line, sizeof(line)));
+    TEST_ASSERT_EQUAL_STRING("G90", line);
+    TEST_ASSERT_TRUE(reader.readLine(file, line, sizeof(line)));
+    TEST_ASSERT_EQUAL(sizeof(line) - 1, strlen(line));
+    TEST_ASSERT_TRUE(reader.readLine(file, line, sizeof(line)));
+    TEST_ASSERT_EQUAL_STRING("G1 X1", line);
+    TEST_ASSERT_TRUE(reader.readLine(file, line, sizeof(line)));
+    TEST_ASSERT_EQUAL_STRING("M30", line);
+    TEST_ASSERT_FALSE(reader.readLine(file, line, sizeof(line)));
+}
+
+// Potok zadania na PC: plik zapisany przez PosixStorage odczytywany liniami
+void test_posix_line_pipeline() {
+    PosixStorage storage { rootDirectory.c_str() };
+    std::unique_ptr<StorageFile> output { storage.open("/job.gcode", StorageMode::WRITE) };
+    for (int index { 0 }; index < 200; ++index) {
+        char line[32] {};
+        snprintf(line, sizeof(line), "G1 X%d Y%d\n", index, -index);
+        writeText(*output, line);
+    }
+    output.reset();
+
+    std::unique_ptr<StorageFile> input { storage.open("/job.gcode", StorageMode::READ) };
+    StorageLineReader reader {};
+    char line[32] {};
+    char lastLine[32] {};
+    int count { 0 };
+    while (reader.readLine(*input, line, sizeof(line))) {
+        strcpy(lastLine, line);
+        ++count;
+    }
+    TEST_ASSERT_EQUAL(200, count);
+    TEST_ASSERT_EQUAL_STRING("G1 X199 Y-199", lastLine);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_posix_write_read);
+    RUN_TEST(test_posix_append);
+    RUN_TEST(test_posix_missing_and_directory);
+    RUN_TEST(test_posix_rename_replaces_target);
+    RUN_TEST(test_posix_list);
+    RUN_TEST(test_memory_file);
+    RUN_TEST(test_line_reader);
+    RUN_TEST(test_posix_line_pipeline);
+    return UNITY_END();
+}